@@ -85,10 +85,10 @@
 
 /*Use a custom tick source that tells the elapsed time in milliseconds.
  *It removes the need to manually update the tick with `lv_tick_inc()`)*/
-#define LV_TICK_CUSTOM 0
+#define LV_TICK_CUSTOM 1
 #if LV_TICK_CUSTOM
-    #define LV_TICK_CUSTOM_INCLUDE "Arduino.h"         /*Header for the system time function*/
-    #define LV_TICK_CUSTOM_SYS_TIME_EXPR (millis())    /*Expression evaluating to current system time in ms*/
+    #define LV_TICK_CUSTOM_INCLUDE "lvgl_port_tick.h"    /*Header for the system time function*/
+    #define LV_TICK_CUSTOM_SYS_TIME_EXPR (lvgl_port_tick_get())  /*Expression evaluating to current system time in ms*/
     /*If using lvgl as ESP32 component*/
     // #define LV_TICK_CUSTOM_INCLUDE "esp_timer.h"
     // #define LV_TICK_CUSTOM_SYS_TIME_EXPR ((esp_timer_get_time() / 1000LL))
@@ -327,7 +327,13 @@
 #define LV_ATTRIBUTE_TIMER_HANDLER
 
 /*Define a custom attribute to `lv_disp_flush_ready` function*/
+#ifdef ESP_PLATFORM
+/*The port calls it from the vsync ISRs, which keep running while the flash cache is disabled*/
+#include "esp_attr.h"
+#define LV_ATTRIBUTE_FLUSH_READY IRAM_ATTR
+#else
 #define LV_ATTRIBUTE_FLUSH_READY
+#endif
 
 /*Required alignment size for buffers*/
 #define LV_ATTRIBUTE_MEM_ALIGN_SIZE 1
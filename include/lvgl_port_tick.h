@@ -0,0 +1,29 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Tick of LVGL, read by LVGL through `LV_TICK_CUSTOM_SYS_TIME_EXPR` of `lv_conf.h`, so no timer has to call
+ * `lv_tick_inc()`. It is here rather than in `lib/lvgl_port`, because LVGL itself is built with this header.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Get the tick of LVGL, implemented by `lvgl_v8_port.cpp`.
+ *
+ * @return The time of `esp_timer`, or the predicted presentation of the current frame while the frame scheduler runs,
+ *         in milliseconds
+ */
+uint32_t lvgl_port_tick_get(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,546 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include <string.h>
+#include "lvgl_port_async_copy.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_async_memcpy.h"
+#include "esp_cache.h"
+#include "esp_timer.h"
+#undef ESP_UTILS_LOG_TAG
+#define ESP_UTILS_LOG_TAG "LvPort"
+#include "esp_lib_utils.h"
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#define IRAM_ATTR
+#endif
+
+typedef enum {
+    COPY_JOB_IDLE,
+    COPY_JOB_ARMED,
+    COPY_JOB_RUNNING,
+    COPY_JOB_DONE,
+} copy_job_state_t;
+
+typedef struct {
+    uint8_t *dst;
+    const uint8_t *src;
+    lvgl_port_copy_rect_t rects[LVGL_PORT_ASYNC_COPY_RECT_MAX];
+    int rect_num;
+    uint32_t stride;            // Bytes per line of both buffers
+    uint32_t size;              // Bytes of one whole buffer
+    uint8_t bytes_per_pixel;
+    bool use_dma;               // False if the buffers can't satisfy the DMA alignment, copy is then done at the fence
+    // Cursor of the next span, advanced from the DMA done ISR
+    int rect_idx;
+    int y;
+    uint32_t pending_offset;
+    uint32_t pending_len;
+} copy_job_t;
+
+static copy_job_t copy_job;
+static std::atomic<int> copy_job_state(COPY_JOB_IDLE);
+static const void *copy_job_synced_dst = nullptr;
+static lvgl_port_async_copy_stats_t copy_stats = {};      // Updated from the DMA done ISR, under the stats lock
+
+static inline uint32_t align_down(uint32_t value)
+{
+    return value & ~(uint32_t)(LVGL_PORT_ASYNC_COPY_ALIGN - 1);
+}
+
+static inline uint32_t align_up(uint32_t value)
+{
+    return (value + LVGL_PORT_ASYNC_COPY_ALIGN - 1) & ~(uint32_t)(LVGL_PORT_ASYNC_COPY_ALIGN - 1);
+}
+
+/**
+ * @brief Get the next byte span `[offset, offset + len)` of the job.
+ *
+ * @note  Spans are widened to the DMA alignment, and rows whose widened spans touch or overlap are merged, so a
+ *        full-width rectangle becomes a single contiguous span. Spans longer than `LVGL_PORT_ASYNC_COPY_CHUNK_MAX`
+ *        are emitted in chunks.
+ */
+IRAM_ATTR static bool copy_job_next_span(copy_job_t *job, uint32_t *offset, uint32_t *len)
+{
+    if (job->pending_len == 0) {
+        bool has_span = false;
+        uint32_t span_start = 0;
+        uint32_t span_end = 0;
+
+        while (job->rect_idx < job->rect_num) {
+            const lvgl_port_copy_rect_t *rect = &job->rects[job->rect_idx];
+            if (job->y > rect->y2) {
+                job->rect_idx++;
+                if (job->rect_idx < job->rect_num) {
+                    job->y = job->rects[job->rect_idx].y1;
+                }
+                continue;
+            }
+
+            uint32_t line = job->y * job->stride;
+            uint32_t start = align_down(line + rect->x1 * job->bytes_per_pixel);
+            uint32_t end = align_up(line + (rect->x2 + 1) * job->bytes_per_pixel);
+            if (end > job->size) {
+                end = job->size;
+            }
+            if (!has_span) {
+                span_start = start;
+                span_end = end;
+                has_span = true;
+            } else if ((start >= span_start) && (start <= span_end)) {
+                span_end = (end > span_end) ? end : span_end;
+            } else {
+                break;
+            }
+            job->y++;
+        }
+        if (!has_span) {
+            return false;
+        }
+        job->pending_offset = span_start;
+        job->pending_len = span_end - span_start;
+    }
+
+    *offset = job->pending_offset;
+    *len = (job->pending_len > LVGL_PORT_ASYNC_COPY_CHUNK_MAX) ? LVGL_PORT_ASYNC_COPY_CHUNK_MAX : job->pending_len;
+    job->pending_offset += *len;
+    job->pending_len -= *len;
+
+    return true;
+}
+
+static void copy_job_rewind(copy_job_t *job)
+{
+    job->rect_idx = 0;
+    job->y = (job->rect_num > 0) ? job->rects[0].y1 : 0;
+    job->pending_offset = 0;
+    job->pending_len = 0;
+}
+
+#ifdef ESP_PLATFORM
+
+static async_memcpy_t copy_handle = nullptr;
+static SemaphoreHandle_t copy_fence = nullptr;
+static portMUX_TYPE copy_stats_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+// The 64-bit counters take two stores on the Xtensa, a reader must not see one without the other
+IRAM_ATTR static inline void copy_stats_lock(void)
+{
+    portENTER_CRITICAL_SAFE(&copy_stats_spinlock);
+}
+
+IRAM_ATTR static inline void copy_stats_unlock(void)
+{
+    portEXIT_CRITICAL_SAFE(&copy_stats_spinlock);
+}
+
+static inline int64_t copy_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+IRAM_ATTR static bool copy_issue_next_from_isr(void);
+
+IRAM_ATTR static bool on_copy_done(async_memcpy_t mcp_hdl, async_memcpy_event_t *event, void *cb_args)
+{
+    return copy_issue_next_from_isr();
+}
+
+IRAM_ATTR static bool copy_issue_next_from_isr(void)
+{
+    BaseType_t need_yield = pdFALSE;
+    uint32_t offset = 0;
+    uint32_t len = 0;
+
+    while (copy_job_next_span(&copy_job, &offset, &len)) {
+        if (esp_async_memcpy(
+                    copy_handle, copy_job.dst + offset, (void *)(copy_job.src + offset), len, on_copy_done, nullptr
+                ) == ESP_OK) {
+            copy_stats_lock();
+            copy_stats.dma_requests++;
+            copy_stats.dma_bytes += len;
+            copy_stats_unlock();
+            return false;
+        }
+        // The request was refused and there is no way to retry from here, so hand the whole job over to the fence
+        copy_job.use_dma = false;
+        break;
+    }
+
+    if (!copy_job.use_dma) {
+        xSemaphoreGiveFromISR(copy_fence, &need_yield);
+        return (need_yield == pdTRUE);
+    }
+
+    copy_stats_lock();
+    copy_stats.jobs++;
+    copy_stats_unlock();
+    copy_job_synced_dst = copy_job.dst;
+    copy_job_state.store(COPY_JOB_DONE);
+    xSemaphoreGiveFromISR(copy_fence, &need_yield);
+
+    return (need_yield == pdTRUE);
+}
+
+static void copy_sync_cache(copy_job_t *job)
+{
+    uint32_t offset = 0;
+    uint32_t len = 0;
+
+    // Only the spans the DMA writes: they are aligned to whole cache lines, so the lines of the destination around
+    // them, which may hold pixels the CPU hasn't written back yet, are left alone
+    copy_job_rewind(job);
+    while (copy_job_next_span(job, &offset, &len)) {
+        // Write back what the CPU rendered into the source, then the destination before dropping its lines, so the
+        // CPU reads what the DMA wrote once the fence has passed and no dirty line lands over it afterwards
+        esp_cache_msync((void *)(job->src + offset), len, ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+        esp_cache_msync(job->dst + offset, len, ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+        esp_cache_msync(job->dst + offset, len, ESP_CACHE_MSYNC_FLAG_INVALIDATE | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+    }
+    copy_job_rewind(job);
+}
+
+bool lvgl_port_async_copy_init(void)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(copy_handle == nullptr, false, "Async copy is already initialized");
+
+    copy_fence = xSemaphoreCreateBinary();
+    ESP_UTILS_CHECK_NULL_RETURN(copy_fence, false, "Create async copy fence failed");
+
+    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    config.psram_trans_align = LVGL_PORT_ASYNC_COPY_ALIGN;
+    config.sram_trans_align = 4;
+    ESP_UTILS_CHECK_ERROR_RETURN(
+        esp_async_memcpy_install(&config, &copy_handle), false, "Install async memcpy failed"
+    );
+
+    copy_job_state.store(COPY_JOB_IDLE);
+    copy_stats_lock();
+    copy_stats = {};
+    copy_stats_unlock();
+
+    return true;
+}
+
+bool lvgl_port_async_copy_deinit(void)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(copy_handle, false, "Async copy is not initialized");
+
+    lvgl_port_async_copy_wait(nullptr, -1);
+    ESP_UTILS_CHECK_ERROR_RETURN(esp_async_memcpy_uninstall(copy_handle), false, "Uninstall async memcpy failed");
+    copy_handle = nullptr;
+    vSemaphoreDelete(copy_fence);
+    copy_fence = nullptr;
+
+    return true;
+}
+
+IRAM_ATTR bool lvgl_port_async_copy_start_from_isr(void)
+{
+    int expected = COPY_JOB_ARMED;
+    if (!copy_job_state.compare_exchange_strong(expected, COPY_JOB_RUNNING)) {
+        return false;
+    }
+    if (!copy_job.use_dma) {
+        // Left to the fence, which runs the CPU copy in task context
+        return false;
+    }
+
+    return copy_issue_next_from_isr();
+}
+
+void lvgl_port_async_copy_start(void)
+{
+    // Only the DMA done ISR advances the job once it runs, so the first request can be issued from here as well
+    if (lvgl_port_async_copy_start_from_isr()) {
+        taskYIELD();
+    }
+}
+
+static void copy_sleep_ms(int ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(ms) ? pdMS_TO_TICKS(ms) : 1);
+}
+
+static bool copy_fence_take(int timeout_ms)
+{
+    const TickType_t timeout_ticks = (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return (xSemaphoreTake(copy_fence, timeout_ticks) == pdTRUE);
+}
+
+#else
+
+static std::mutex copy_mutex;
+static std::mutex copy_stats_mutex;
+static std::condition_variable copy_cond;
+static std::thread copy_worker;
+static bool copy_worker_exit = false;
+static bool copy_worker_kick = false;
+
+static inline int64_t copy_time_us(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+           ).count();
+}
+
+static inline void copy_stats_lock(void)
+{
+    copy_stats_mutex.lock();
+}
+
+static inline void copy_stats_unlock(void)
+{
+    copy_stats_mutex.unlock();
+}
+
+static void copy_sync_cache(copy_job_t *)
+{
+}
+
+/**
+ * @brief Host stand-in for the GDMA: copies the spans one by one on its own thread, exactly in the order the DMA
+ *        done ISR would issue them.
+ */
+static void copy_worker_loop(void)
+{
+    std::unique_lock<std::mutex> lock(copy_mutex);
+    while (true) {
+        copy_cond.wait(lock, [] { return copy_worker_kick || copy_worker_exit; });
+        if (copy_worker_exit) {
+            break;
+        }
+        copy_worker_kick = false;
+        lock.unlock();
+
+        uint32_t offset = 0;
+        uint32_t len = 0;
+        while (copy_job_next_span(&copy_job, &offset, &len)) {
+            memcpy(copy_job.dst + offset, copy_job.src + offset, len);
+            copy_stats_lock();
+            copy_stats.dma_requests++;
+            copy_stats.dma_bytes += len;
+            copy_stats_unlock();
+        }
+
+        lock.lock();
+        copy_stats_lock();
+        copy_stats.jobs++;
+        copy_stats_unlock();
+        copy_job_synced_dst = copy_job.dst;
+        copy_job_state.store(COPY_JOB_DONE);
+        copy_cond.notify_all();
+    }
+}
+
+bool lvgl_port_async_copy_init(void)
+{
+    if (copy_worker.joinable()) {
+        return false;
+    }
+    copy_job_state.store(COPY_JOB_IDLE);
+    copy_stats_lock();
+    copy_stats = {};
+    copy_stats_unlock();
+    copy_worker_exit = false;
+    copy_worker_kick = false;
+    copy_worker = std::thread(copy_worker_loop);
+
+    return true;
+}
+
+bool lvgl_port_async_copy_deinit(void)
+{
+    if (!copy_worker.joinable()) {
+        return false;
+    }
+    lvgl_port_async_copy_wait(nullptr, -1);
+    {
+        std::lock_guard<std::mutex> lock(copy_mutex);
+        copy_worker_exit = true;
+    }
+    copy_cond.notify_all();
+    copy_worker.join();
+
+    return true;
+}
+
+bool lvgl_port_async_copy_start_from_isr(void)
+{
+    int expected = COPY_JOB_ARMED;
+    if (!copy_job_state.compare_exchange_strong(expected, COPY_JOB_RUNNING)) {
+        return false;
+    }
+    if (copy_job.use_dma) {
+        std::lock_guard<std::mutex> lock(copy_mutex);
+        copy_worker_kick = true;
+        copy_cond.notify_all();
+    }
+
+    return false;
+}
+
+void lvgl_port_async_copy_start(void)
+{
+    lvgl_port_async_copy_start_from_isr();
+}
+
+static void copy_sleep_ms(int ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static bool copy_fence_take(int timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(copy_mutex);
+    auto done = [] { return copy_job_state.load() != COPY_JOB_RUNNING; };
+    if (timeout_ms < 0) {
+        copy_cond.wait(lock, done);
+        return true;
+    }
+    return copy_cond.wait_for(lock, std::chrono::milliseconds(timeout_ms), done);
+}
+
+#endif /* ESP_PLATFORM */
+
+/**
+ * @brief Copy the whole job with the CPU. Only used when the DMA can't be used for the buffers.
+ */
+static void copy_job_run_cpu(copy_job_t *job)
+{
+    uint32_t offset = 0;
+    uint32_t len = 0;
+    uint64_t bytes = 0;
+
+    copy_job_rewind(job);
+    while (copy_job_next_span(job, &offset, &len)) {
+        memcpy(job->dst + offset, job->src + offset, len);
+        bytes += len;
+    }
+    copy_stats_lock();
+    copy_stats.cpu_bytes += bytes;
+    copy_stats_unlock();
+}
+
+bool lvgl_port_async_copy_arm(
+    void *dst, const void *src, const lvgl_port_copy_rect_t *rects, int rect_num, uint16_t width, uint16_t height,
+    uint8_t bytes_per_pixel
+)
+{
+    int state = copy_job_state.load();
+    if ((state == COPY_JOB_ARMED) || (state == COPY_JOB_RUNNING)) {
+        return false;
+    }
+    // Whatever happens next, the previous job no longer describes the buffers
+    copy_job_synced_dst = nullptr;
+    copy_job_state.store(COPY_JOB_IDLE);
+    if ((dst == nullptr) || (src == nullptr) || (rects == nullptr) || (rect_num <= 0) ||
+            (rect_num > LVGL_PORT_ASYNC_COPY_RECT_MAX) || (bytes_per_pixel == 0)) {
+        return false;
+    }
+
+    copy_job.dst = (uint8_t *)dst;
+    copy_job.src = (const uint8_t *)src;
+    copy_job.stride = width * bytes_per_pixel;
+    copy_job.size = copy_job.stride * height;
+    copy_job.bytes_per_pixel = bytes_per_pixel;
+    // Widening a span to the alignment must land on the same pixels in both buffers and must not leave them
+    copy_job.use_dma = ((((uintptr_t)dst | (uintptr_t)src) % LVGL_PORT_ASYNC_COPY_ALIGN) == 0) &&
+                       ((copy_job.size % LVGL_PORT_ASYNC_COPY_ALIGN) == 0);
+    copy_job.rect_num = 0;
+    for (int i = 0; i < rect_num; i++) {
+        lvgl_port_copy_rect_t rect = rects[i];
+        rect.x1 = (rect.x1 < 0) ? 0 : rect.x1;
+        rect.y1 = (rect.y1 < 0) ? 0 : rect.y1;
+        rect.x2 = (rect.x2 >= width) ? (width - 1) : rect.x2;
+        rect.y2 = (rect.y2 >= height) ? (height - 1) : rect.y2;
+        if ((rect.x1 <= rect.x2) && (rect.y1 <= rect.y2)) {
+            copy_job.rects[copy_job.rect_num++] = rect;
+        }
+    }
+    if (copy_job.rect_num == 0) {
+        return false;
+    }
+    copy_job_rewind(&copy_job);
+    if (copy_job.use_dma) {
+        copy_sync_cache(&copy_job);
+    }
+#ifdef ESP_PLATFORM
+    xSemaphoreTake(copy_fence, 0);
+#endif
+    copy_job_state.store(COPY_JOB_ARMED);
+
+    return true;
+}
+
+bool lvgl_port_async_copy_wait(const void *dst, int timeout_ms)
+{
+    int state = copy_job_state.load();
+    if ((state == COPY_JOB_IDLE) || (state == COPY_JOB_DONE) || ((dst != nullptr) && (dst != copy_job.dst))) {
+        return true;
+    }
+
+    int64_t start_us = copy_time_us();
+    if (state == COPY_JOB_ARMED) {
+        if (dst == nullptr) {
+            // Nobody is going to render into the destination, simply drop the job
+            int expected = COPY_JOB_ARMED;
+            if (copy_job_state.compare_exchange_strong(expected, COPY_JOB_IDLE)) {
+                return true;
+            }
+        }
+        // The vsync that starts the job hasn't come yet, so the destination may still be on screen
+        while (copy_job_state.load() == COPY_JOB_ARMED) {
+            if ((timeout_ms >= 0) && ((copy_time_us() - start_us) >= (int64_t)timeout_ms * 1000)) {
+                return false;
+            }
+            copy_sleep_ms(1);
+        }
+    }
+    if (copy_job.use_dma) {
+        if (!copy_fence_take(timeout_ms)) {
+            return false;
+        }
+    }
+    if (!copy_job.use_dma) {
+        // Either the buffers were never DMA capable, or a request was refused midway; redo the whole job, the
+        // spans already copied by the DMA are simply copied again
+        copy_job_run_cpu(&copy_job);
+        copy_stats_lock();
+        copy_stats.jobs++;
+        copy_stats_unlock();
+        copy_job_synced_dst = copy_job.dst;
+        copy_job_state.store(COPY_JOB_DONE);
+    }
+    int64_t wait_us = copy_time_us() - start_us;
+    copy_stats_lock();
+    copy_stats.fence_waits++;
+    copy_stats.fence_wait_us += wait_us;
+    copy_stats_unlock();
+
+    return true;
+}
+
+bool lvgl_port_async_copy_synced(const void *dst)
+{
+    return (dst != nullptr) && (copy_job_state.load() == COPY_JOB_DONE) && (copy_job_synced_dst == dst);
+}
+
+void lvgl_port_async_copy_get_stats(lvgl_port_async_copy_stats_t *stats)
+{
+    if (stats != nullptr) {
+        copy_stats_lock();
+        *stats = copy_stats;
+        copy_stats_unlock();
+    }
+}
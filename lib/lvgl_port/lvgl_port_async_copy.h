@@ -0,0 +1,134 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Asynchronous rectangle copy engine for frame buffers.
+ *
+ * A job copies a list of rectangles between two frame buffers with the same geometry. The job is armed from task
+ * context (the geometry is resolved and the caches are synchronized there), then started from the vsync ISR so the
+ * transfer begins the moment the destination buffer leaves scanout. Rendering into the destination must be fenced
+ * with `lvgl_port_async_copy_wait()`.
+ *
+ * On ESP32-S3 the transfers run on the GDMA through `esp_async_memcpy`. On host builds (no `ESP_PLATFORM`) a worker
+ * thread stands in for the DMA, so the arm/start/fence ordering can be exercised off-device.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_ASYNC_COPY_RECT_MAX           (32)    // Maximum number of rectangles in one job, same as `LV_INV_BUF_SIZE`
+#define LVGL_PORT_ASYNC_COPY_ALIGN              (64)    // PSRAM DMA alignment of address and size, in bytes
+#define LVGL_PORT_ASYNC_COPY_CHUNK_MAX          (4032)  // Maximum bytes per DMA request, aligned to `LVGL_PORT_ASYNC_COPY_ALIGN`
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Rectangle in pixels, both ends inclusive (same convention as `lv_area_t`)
+ */
+typedef struct {
+    int16_t x1;
+    int16_t y1;
+    int16_t x2;
+    int16_t y2;
+} lvgl_port_copy_rect_t;
+
+/**
+ * @brief Statistics of the copy engine, accumulated since `lvgl_port_async_copy_init()`
+ */
+typedef struct {
+    uint32_t jobs;              // Number of completed jobs
+    uint32_t dma_requests;      // Number of DMA requests issued
+    uint64_t dma_bytes;         // Bytes moved by the DMA
+    uint64_t cpu_bytes;         // Bytes moved by the CPU because the row could not be aligned for the DMA
+    uint32_t fence_waits;       // Number of `lvgl_port_async_copy_wait()` calls that had to block
+    uint64_t fence_wait_us;     // Total time blocked in `lvgl_port_async_copy_wait()`
+} lvgl_port_async_copy_stats_t;
+
+/**
+ * @brief Initialize the copy engine.
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_async_copy_init(void);
+
+/**
+ * @brief Deinitialize the copy engine. Any running job is waited for first.
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_async_copy_deinit(void);
+
+/**
+ * @brief Arm a copy job. The job does not start until `lvgl_port_async_copy_start_from_isr()` or
+ *        `lvgl_port_async_copy_start()` is called.
+ *
+ * @note  Rectangles are widened to the DMA alignment. This is safe because `src` is fully up to date, so copying a few
+ *        more of its pixels into `dst` only brings them up to date earlier.
+ *
+ * @param dst             Destination frame buffer
+ * @param src             Source frame buffer
+ * @param rects           Rectangles to copy, in frame buffer coordinates
+ * @param rect_num        Number of rectangles, at most `LVGL_PORT_ASYNC_COPY_RECT_MAX`
+ * @param width           Width of both frame buffers, in pixels
+ * @param height          Height of both frame buffers, in pixels
+ * @param bytes_per_pixel Bytes per pixel of both frame buffers
+ *
+ * @return true if success, false if a previous job is still pending or the parameters are invalid
+ */
+bool lvgl_port_async_copy_arm(
+    void *dst, const void *src, const lvgl_port_copy_rect_t *rects, int rect_num, uint16_t width, uint16_t height,
+    uint8_t bytes_per_pixel
+);
+
+/**
+ * @brief Start the armed job from ISR context. Does nothing if no job is armed.
+ *
+ * @return true if a higher priority task has been woken, otherwise false
+ */
+bool lvgl_port_async_copy_start_from_isr(void);
+
+/**
+ * @brief Start the armed job from task context. Does nothing if no job is armed.
+ */
+void lvgl_port_async_copy_start(void);
+
+/**
+ * @brief Fence: block until no pending job writes into `dst`.
+ *
+ * @param dst        Frame buffer that is about to be written, or `NULL` to wait for any pending job
+ * @param timeout_ms Timeout in milliseconds, `-1` to wait indefinitely
+ *
+ * @return true if `dst` is safe to write, false on timeout
+ */
+bool lvgl_port_async_copy_wait(const void *dst, int timeout_ms);
+
+/**
+ * @brief Check whether the last completed job targeted `dst` and copied all its rectangles.
+ *
+ * @param dst Frame buffer to check
+ *
+ * @return true if `dst` has been synchronized by the engine, otherwise false
+ */
+bool lvgl_port_async_copy_synced(const void *dst);
+
+/**
+ * @brief Get the engine statistics.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_async_copy_get_stats(lvgl_port_async_copy_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,256 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "lvgl_port_bandwidth_sim.h"
+
+typedef struct {
+    const lvgl_port_bandwidth_sim_config_t *config;
+    const lvgl_port_bandwidth_sim_frame_t *trace;
+    int frame_num;
+    double scale;               // Scale of the trace's traffic
+    double chunk_ns;            // Time to stream one refill
+    double frame_ns;            // Scanout period of a frame, blanking included
+    uint32_t chunks;            // Refills per scanned frame
+    double refill_bytes;        // Bytes of a full refill
+    double refill_cpu_ns;       // Time of the fill callback of a full refill
+} sim_t;
+
+/**
+ * @brief State of the refill ISR, which serves one refill at a time
+ */
+typedef struct {
+    uint32_t index;             // Refill being served, counted from the first frame
+    bool busy;
+    double issue_ns;            // Interrupt of the refill
+    double bytes_left;
+    double cpu_left_ns;
+} sim_refill_t;
+
+/**
+ * @brief State of the renderer
+ */
+typedef struct {
+    uint32_t frame;             // Frame being rendered, counted from the first one
+    bool busy;
+    double start_ns;            // Start of the frame, or of the next one when idle
+    double bytes_left;
+    double demand;              // Bytes per nanosecond the frame would take with the PSRAM to itself
+} sim_render_t;
+
+static const lvgl_port_bandwidth_sim_frame_t *sim_trace_frame(const sim_t *sim, uint32_t frame)
+{
+    return &sim->trace[frame % sim->frame_num];
+}
+
+static double sim_refill_deadline_ns(const sim_t *sim, uint32_t index)
+{
+    // The active lines come first in a frame, the blanking last. The first frame starts once the refill of its first
+    // lines has been issued, in the blanking of the previous one.
+    return (index / sim->chunks + 1) * sim->frame_ns + (index % sim->chunks) * sim->chunk_ns;
+}
+
+static double sim_refill_lines(const sim_t *sim, uint32_t index)
+{
+    const lvgl_port_bandwidth_sim_config_t *config = sim->config;
+    uint32_t y = (index % sim->chunks) * config->bounce_lines;
+
+    return (y + config->bounce_lines <= config->height) ? config->bounce_lines : (config->height - y);
+}
+
+static void sim_render_begin(const sim_t *sim, sim_render_t *render)
+{
+    const lvgl_port_bandwidth_sim_frame_t *frame = sim_trace_frame(sim, render->frame);
+    double render_ns = (frame->render_us > 0) ? (frame->render_us * 1000.0) : 1000.0;
+
+    render->busy = true;
+    render->bytes_left = ((double)frame->read_bytes + frame->write_bytes) * sim->scale;
+    render->demand = render->bytes_left / render_ns;
+}
+
+/**
+ * @brief Run the trace once at `sim->scale`, `result` gets the refills and the stretch of the render times
+ */
+static void sim_run_once(const sim_t *sim, lvgl_port_bandwidth_sim_result_t *result)
+{
+    const lvgl_port_bandwidth_sim_config_t *config = sim->config;
+    const double bus = config->psram_bytes_per_us / 1000.0;
+    const double refill_max = config->refill_bytes_per_us / 1000.0;
+    const double latency_ns = config->refill_latency_us * 1000.0;
+    double now_ns = 0;
+    double bus_bytes = 0;
+    double refill_ns_total = 0;
+    double refill_ns_max = 0;
+    double render_ns_trace = 0;
+    double render_ns_real = 0;
+    sim_refill_t refill = {};
+    sim_render_t render = {};
+
+    *result = {};
+    refill.issue_ns = sim_refill_deadline_ns(sim, 0) - sim->chunk_ns + latency_ns;
+    render.start_ns = sim->frame_ns;
+
+    while (render.frame < config->frames) {
+        // Wake up whoever is due
+        if (!refill.busy && (refill.issue_ns <= now_ns)) {
+            double part = sim_refill_lines(sim, refill.index) / config->bounce_lines;
+            refill.busy = true;
+            refill.bytes_left = sim->refill_bytes * part;
+            refill.cpu_left_ns = sim->refill_cpu_ns * part;
+        }
+        if (!render.busy && (render.start_ns <= now_ns)) {
+            sim_render_begin(sim, &render);
+        }
+
+        // Share the bus: each side gets what it asks for if it fits, otherwise a share in proportion to it
+        double refill_rate = 0;
+        double render_rate = 0;
+        bool refill_reads = refill.busy && (refill.bytes_left > 0);
+        if (refill_reads && render.busy) {
+            double demand = refill_max + render.demand;
+            refill_rate = (demand <= bus) ? refill_max : (bus * refill_max / demand);
+            render_rate = (demand <= bus) ? render.demand : (bus - refill_rate);
+        } else if (refill_reads) {
+            refill_rate = (refill_max < bus) ? refill_max : bus;
+        } else if (render.busy) {
+            render_rate = (render.demand < bus) ? render.demand : bus;
+        }
+
+        // Advance to the next event
+        double step_ns = -1;
+        auto consider = [&step_ns](double ns) {
+            if ((ns >= 0) && ((step_ns < 0) || (ns < step_ns))) {
+                step_ns = ns;
+            }
+        };
+        if (refill_reads) {
+            consider(refill.bytes_left / refill_rate);
+        } else if (refill.busy) {
+            consider(refill.cpu_left_ns);
+        } else {
+            consider(refill.issue_ns - now_ns);
+        }
+        if (render.busy) {
+            consider((render_rate > 0) ? (render.bytes_left / render_rate) : -1);
+        } else {
+            consider(render.start_ns - now_ns);
+        }
+        step_ns = (step_ns > 0) ? step_ns : 0;
+        now_ns += step_ns;
+        bus_bytes += (refill_rate + render_rate) * step_ns;
+
+        if (refill_reads) {
+            refill.bytes_left -= refill_rate * step_ns;
+            refill.bytes_left = (refill.bytes_left > 1e-6) ? refill.bytes_left : 0;
+        } else if (refill.busy) {
+            refill.cpu_left_ns -= step_ns;
+        }
+        if (refill.busy && (refill.bytes_left <= 0) && (refill.cpu_left_ns <= 1e-6)) {
+            double deadline_ns = sim_refill_deadline_ns(sim, refill.index);
+            double refill_ns = now_ns - (refill.issue_ns - latency_ns);
+            result->refills++;
+            result->misses += (now_ns > deadline_ns);
+            refill_ns_total += refill_ns;
+            if (refill_ns > refill_ns_max) {
+                refill_ns_max = refill_ns;
+                result->worst_frame = render.frame % sim->frame_num;
+            }
+            // The ISR serves the next refill as soon as it is due, late if this one overran
+            refill.busy = false;
+            refill.index++;
+            refill.issue_ns = sim_refill_deadline_ns(sim, refill.index) - sim->chunk_ns + latency_ns;
+        }
+
+        if (render.busy) {
+            render.bytes_left -= render_rate * step_ns;
+            if (render.bytes_left <= 1e-6) {
+                const lvgl_port_bandwidth_sim_frame_t *frame = sim_trace_frame(sim, render.frame);
+                double period_ns = frame->period_us * 1000.0;
+                render_ns_trace += frame->render_us * 1000.0;
+                render_ns_real += now_ns - render.start_ns;
+                // A late frame delays the next one
+                render.busy = false;
+                render.frame++;
+                render.start_ns = (render.start_ns + period_ns > now_ns) ? (render.start_ns + period_ns) : now_ns;
+            }
+        }
+    }
+
+    result->deadline_us = sim->chunk_ns / 1000;
+    result->refill_us_max = refill_ns_max / 1000;
+    if (result->refills > 0) {
+        result->refill_us_avg = refill_ns_total / result->refills / 1000;
+    }
+    if ((result->misses == 0) && (refill_ns_max < sim->chunk_ns)) {
+        result->margin_percent = (sim->chunk_ns - refill_ns_max) * 100 / sim->chunk_ns;
+    }
+    if (now_ns > 0) {
+        result->bus_percent = bus_bytes * 100 / (bus * now_ns);
+    }
+    if (render_ns_trace > 0) {
+        result->render_stretch_percent = (render_ns_real > render_ns_trace) ?
+                                         ((render_ns_real - render_ns_trace) * 100 / render_ns_trace) : 0;
+    }
+}
+
+void lvgl_port_bandwidth_sim_profile(
+    lvgl_port_bandwidth_sim_profile_t *profile, uint16_t width, uint8_t bytes_per_pixel, uint8_t scale,
+    uint32_t fill_ns_per_line
+)
+{
+    scale = (scale > 0) ? scale : 1;
+    // A line of a scaled frame buffer is read for `scale` lines of the panel, through the cache after the first one
+    profile->refill_bytes_per_line = (uint32_t)width / scale * bytes_per_pixel / scale;
+    profile->fill_ns_per_line = fill_ns_per_line;
+}
+
+bool lvgl_port_bandwidth_sim_run(
+    const lvgl_port_bandwidth_sim_config_t *config, const lvgl_port_bandwidth_sim_profile_t *profile,
+    const lvgl_port_bandwidth_sim_frame_t *trace, int frame_num, lvgl_port_bandwidth_sim_result_t *result
+)
+{
+    if ((config == nullptr) || (profile == nullptr) || (trace == nullptr) || (frame_num <= 0) ||
+            (result == nullptr) || (config->width == 0) || (config->height == 0) || (config->pclk_hz == 0) ||
+            (config->bounce_lines == 0) || (config->psram_bytes_per_us == 0) || (config->refill_bytes_per_us == 0)) {
+        return false;
+    }
+
+    sim_t sim = {};
+    double line_ns = (config->width + config->hblank_px) * 1e9 / config->pclk_hz;
+    sim.config = config;
+    sim.trace = trace;
+    sim.frame_num = frame_num;
+    sim.chunk_ns = line_ns * config->bounce_lines;
+    sim.frame_ns = line_ns * (config->height + config->vblank_lines);
+    sim.chunks = (config->height + config->bounce_lines - 1) / config->bounce_lines;
+    sim.refill_bytes = (double)profile->refill_bytes_per_line * config->bounce_lines;
+    sim.refill_cpu_ns = (double)profile->fill_ns_per_line * config->bounce_lines;
+
+    sim.scale = 1.0;
+    sim_run_once(&sim, result);
+
+    // Safe margin: bisect the largest scale of the traffic that still misses nothing
+    lvgl_port_bandwidth_sim_result_t probe;
+    uint32_t low = 0;
+    uint32_t high = LVGL_PORT_BANDWIDTH_SIM_SCALE_MAX + 1;
+    sim.scale = 0;
+    sim_run_once(&sim, &probe);
+    if (probe.misses > 0) {
+        high = 0;
+    }
+    while (low + 1 < high) {
+        uint32_t mid = (low + high) / 2;
+        sim.scale = mid / 100.0;
+        sim_run_once(&sim, &probe);
+        if (probe.misses == 0) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    result->scale_max_percent = low;
+
+    return true;
+}
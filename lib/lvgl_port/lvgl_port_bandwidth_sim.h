@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Model of the PSRAM bandwidth shared by the scanout and the rendering, to plan a configuration before the panel
+ * starts drifting.
+ *
+ * With bounce buffers, the refill ISR has to copy each half of the bounce buffer from the frame buffer in PSRAM while
+ * the DMA streams the other half to the panel. If the refill is not over in time, the DMA streams stale or shifted
+ * lines, which the panel shows as drift. The refill competes for the PSRAM with everything else the frame costs:
+ * LVGL's rendering into the frame buffers, the synchronization of the dirty areas, the rotation, the write-back of the
+ * tiles. `lvgl_port_psram_stats_t` counts that traffic per frame, and `lvgl_port_start_frame_trace()` of the port
+ * records it frame by frame.
+ *
+ * The simulation replays such a trace against the timings of the panel: each frame spreads its traffic over its render
+ * time, each refill reads its lines from the start of the streaming of the previous half, and when both want more
+ * than the PSRAM can give, they share its bandwidth in proportion to what they ask for. The result is the time of the
+ * slowest refill against its deadline, and the safe margin: the largest scale of the trace's traffic the scanout still
+ * survives.
+ *
+ * It is a fluid model (the bytes flow at constant rates between events), without ESP-IDF or LVGL dependencies, so it
+ * runs on the host with a trace captured on the device, as well as on the device itself.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_BANDWIDTH_SIM_SCALE_MAX       (1000)  // Largest traffic scale searched for the safe margin, in
+                                                        // percent of the trace
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One rendered frame of a trace
+ */
+typedef struct {
+    uint32_t period_us;             // Time from the start of this frame to the start of the next one
+    uint32_t render_us;             // Time spent rendering, the traffic is spread over it
+    uint32_t read_bytes;            // Bytes read from the frame buffers
+    uint32_t write_bytes;           // Bytes written into the frame buffers
+} lvgl_port_bandwidth_sim_frame_t;
+
+/**
+ * @brief Panel timings, bounce buffers and memory of a simulation
+ */
+typedef struct {
+    uint16_t width;                 // Width of the panel, in pixels
+    uint16_t height;                // Height of the panel, in pixels
+    uint16_t hblank_px;             // Horizontal sync and porches, in pixel clocks
+    uint16_t vblank_lines;          // Vertical sync and porches, in lines
+    uint32_t pclk_hz;               // Pixel clock
+    uint16_t bounce_lines;          // Lines per refill, half of the bounce buffer
+    uint32_t psram_bytes_per_us;    // Bandwidth of the PSRAM, shared by the CPUs and the GDMA
+    uint32_t refill_bytes_per_us;   // Fastest copy of the refill ISR, when it has the PSRAM to itself
+    uint32_t refill_latency_us;     // Latency of the refill ISR
+    uint32_t frames;                // Frames to render, the trace is repeated
+} lvgl_port_bandwidth_sim_config_t;
+
+/**
+ * @brief Default configuration: the 800x480 panel of the Waveshare ESP32-S3-Touch-LCD-7 at 16 MHz, with the bounce
+ *        buffer of `setup()` (a tenth of the height per refill) and octal PSRAM at 80 MHz
+ */
+#define LVGL_PORT_BANDWIDTH_SIM_CONFIG_DEFAULT()    \
+    {                                               \
+        .width = 800,                               \
+        .height = 480,                              \
+        .hblank_px = 20,                            \
+        .vblank_lines = 20,                         \
+        .pclk_hz = 16000000,                        \
+        .bounce_lines = 48,                         \
+        .psram_bytes_per_us = 120,                  \
+        .refill_bytes_per_us = 80,                  \
+        .refill_latency_us = 10,                    \
+        .frames = 120,                              \
+    }
+
+/**
+ * @brief What the refills of a mode cost
+ */
+typedef struct {
+    uint32_t refill_bytes_per_line; // Bytes a refill reads from PSRAM per line of the panel
+    uint32_t fill_ns_per_line;      // Time a fill callback spends per line beyond reading it, `0` for a copy
+} lvgl_port_bandwidth_sim_profile_t;
+
+/**
+ * @brief Result of a simulation
+ */
+typedef struct {
+    uint32_t refills;               // Refills simulated
+    uint32_t misses;                // Refills over after their deadline, shown as drift on the panel
+    uint32_t deadline_us;           // Time the DMA takes to stream one refill
+    uint32_t refill_us_max;         // Slowest refill, from its interrupt to its end
+    uint32_t refill_us_avg;
+    uint32_t worst_frame;           // Frame of the trace rendered during the slowest refill
+    uint32_t margin_percent;        // Share of the deadline left by the slowest refill, `0` if any refill missed
+    uint32_t bus_percent;           // Average load of the PSRAM
+    uint32_t render_stretch_percent;// Render time added by sharing the PSRAM with the scanout
+    uint32_t scale_max_percent;     // Safe margin: largest scale of the trace's traffic without any miss, up to
+                                    // `LVGL_PORT_BANDWIDTH_SIM_SCALE_MAX`
+} lvgl_port_bandwidth_sim_result_t;
+
+/**
+ * @brief Get the profile of a scanout reading a frame buffer.
+ *
+ * @param profile         Output
+ * @param width           Width of the panel, in pixels
+ * @param bytes_per_pixel Bytes per pixel of the frame buffer (`1` for the indexed mode)
+ * @param scale           Pixels of the panel per pixel of the frame buffer, in both directions (`2` for the
+ *                        half-resolution mode)
+ * @param fill_ns_per_line Time a fill callback spends per line (palette, upscale, rotation), `0` for a copy
+ */
+void lvgl_port_bandwidth_sim_profile(
+    lvgl_port_bandwidth_sim_profile_t *profile, uint16_t width, uint8_t bytes_per_pixel, uint8_t scale,
+    uint32_t fill_ns_per_line
+);
+
+/**
+ * @brief Replay a trace against the scanout, then search the safe margin.
+ *
+ * @param config    Configuration
+ * @param profile   Cost of the refills
+ * @param trace     Frames to replay, repeated up to `config->frames`
+ * @param frame_num Number of frames of the trace
+ * @param result    Output
+ *
+ * @return true if success, otherwise false (invalid configuration)
+ */
+bool lvgl_port_bandwidth_sim_run(
+    const lvgl_port_bandwidth_sim_config_t *config, const lvgl_port_bandwidth_sim_profile_t *profile,
+    const lvgl_port_bandwidth_sim_frame_t *trace, int frame_num, lvgl_port_bandwidth_sim_result_t *result
+);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,211 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "lvgl_port_damage.h"
+
+typedef struct {
+    lvgl_port_copy_rect_t rects[LVGL_PORT_DAMAGE_RECT_MAX];
+    int rect_num;
+} damage_frame_t;
+
+static damage_frame_t damage_frames[LVGL_PORT_DAMAGE_HISTORY];     // Ring buffer, indexed by `frame % HISTORY`
+static uint32_t damage_frame_count = 0;                             // Number of committed frames
+static uint32_t damage_buffer_frame[LVGL_PORT_DAMAGE_BUFFER_MAX];   // Frame (1-based) last rendered into each buffer
+static int damage_buffer_num = 0;
+static int damage_latest = -1;
+static uint16_t damage_width = 0;
+static uint16_t damage_height = 0;
+
+static inline int32_t rect_area(const lvgl_port_copy_rect_t *rect)
+{
+    return (int32_t)(rect->x2 - rect->x1 + 1) * (rect->y2 - rect->y1 + 1);
+}
+
+static inline bool rect_is_in(const lvgl_port_copy_rect_t *in, const lvgl_port_copy_rect_t *holder)
+{
+    return (in->x1 >= holder->x1) && (in->y1 >= holder->y1) && (in->x2 <= holder->x2) && (in->y2 <= holder->y2);
+}
+
+static inline lvgl_port_copy_rect_t rect_bound(const lvgl_port_copy_rect_t *a, const lvgl_port_copy_rect_t *b)
+{
+    lvgl_port_copy_rect_t bound;
+    bound.x1 = (a->x1 < b->x1) ? a->x1 : b->x1;
+    bound.y1 = (a->y1 < b->y1) ? a->y1 : b->y1;
+    bound.x2 = (a->x2 > b->x2) ? a->x2 : b->x2;
+    bound.y2 = (a->y2 > b->y2) ? a->y2 : b->y2;
+    return bound;
+}
+
+int lvgl_port_damage_union_add(lvgl_port_copy_rect_t *rects, int rect_num, int rect_max, const lvgl_port_copy_rect_t *rect)
+{
+    for (int i = 0; i < rect_num; i++) {
+        if (rect_is_in(rect, &rects[i])) {
+            return rect_num;
+        }
+    }
+
+    // Drop the rectangles covered by the new one
+    int kept = 0;
+    for (int i = 0; i < rect_num; i++) {
+        if (!rect_is_in(&rects[i], rect)) {
+            rects[kept++] = rects[i];
+        }
+    }
+    rect_num = kept;
+
+    // Same rule as LVGL's `lv_refr_join_area()`: join if the bounding box is smaller than the two areas together.
+    // Otherwise, if the union is full, join with the rectangle whose bounding box grows least.
+    int best = -1;
+    int32_t best_growth = 0;
+    for (int i = 0; i < rect_num; i++) {
+        lvgl_port_copy_rect_t bound = rect_bound(&rects[i], rect);
+        int32_t growth = rect_area(&bound) - rect_area(&rects[i]) - rect_area(rect);
+        if ((best < 0) || (growth < best_growth)) {
+            best = i;
+            best_growth = growth;
+        }
+    }
+    if ((best >= 0) && ((best_growth < 0) || (rect_num >= rect_max))) {
+        lvgl_port_copy_rect_t bound = rect_bound(&rects[best], rect);
+        rects[best] = rects[--rect_num];
+        return lvgl_port_damage_union_add(rects, rect_num, rect_max, &bound);
+    }
+    if (rect_num < rect_max) {
+        rects[rect_num++] = *rect;
+    }
+
+    return rect_num;
+}
+
+uint32_t lvgl_port_damage_union_area(const lvgl_port_copy_rect_t *rects, int rect_num)
+{
+    int32_t edges[2 * LVGL_PORT_DAMAGE_RECT_MAX];
+    int32_t spans[LVGL_PORT_DAMAGE_RECT_MAX][2];
+    int edge_num = 0;
+    uint32_t area = 0;
+
+    rect_num = (rect_num < LVGL_PORT_DAMAGE_RECT_MAX) ? rect_num : LVGL_PORT_DAMAGE_RECT_MAX;
+    // The left and right edges cut the union into columns, each one is covered by the same rectangles all along
+    for (int i = 0; i < rect_num; i++) {
+        int32_t rect_edges[2] = {rects[i].x1, rects[i].x2 + 1};
+        for (int32_t edge : rect_edges) {
+            int j = edge_num++;
+            for (; (j > 0) && (edges[j - 1] > edge); j--) {
+                edges[j] = edges[j - 1];
+            }
+            edges[j] = edge;
+        }
+    }
+    for (int e = 0; e + 1 < edge_num; e++) {
+        int32_t width = edges[e + 1] - edges[e];
+        if (width == 0) {
+            continue;
+        }
+        // The vertical spans of the rectangles over the column, sorted by their top
+        int span_num = 0;
+        for (int i = 0; i < rect_num; i++) {
+            if ((rects[i].x1 > edges[e]) || (rects[i].x2 < edges[e])) {
+                continue;
+            }
+            int j = span_num++;
+            for (; (j > 0) && (spans[j - 1][0] > rects[i].y1); j--) {
+                spans[j][0] = spans[j - 1][0];
+                spans[j][1] = spans[j - 1][1];
+            }
+            spans[j][0] = rects[i].y1;
+            spans[j][1] = rects[i].y2 + 1;
+        }
+        int32_t height = 0;
+        int32_t bottom = INT32_MIN;
+        for (int j = 0; j < span_num; j++) {
+            int32_t top = (spans[j][0] > bottom) ? spans[j][0] : bottom;
+            if (spans[j][1] > top) {
+                height += spans[j][1] - top;
+                bottom = spans[j][1];
+            }
+        }
+        area += (uint32_t)width * height;
+    }
+
+    return area;
+}
+
+bool lvgl_port_damage_init(int buffer_num, uint16_t width, uint16_t height)
+{
+    if ((buffer_num <= 0) || (buffer_num > LVGL_PORT_DAMAGE_BUFFER_MAX) || (width == 0) || (height == 0)) {
+        return false;
+    }
+
+    damage_buffer_num = buffer_num;
+    damage_width = width;
+    damage_height = height;
+    damage_frame_count = 0;
+    damage_latest = -1;
+    for (int i = 0; i < LVGL_PORT_DAMAGE_BUFFER_MAX; i++) {
+        damage_buffer_frame[i] = 0;
+    }
+    for (int i = 0; i < LVGL_PORT_DAMAGE_HISTORY; i++) {
+        damage_frames[i].rect_num = 0;
+    }
+
+    return true;
+}
+
+void lvgl_port_damage_commit(int buffer_index, const lvgl_port_copy_rect_t *rects, int rect_num)
+{
+    if ((buffer_index < 0) || (buffer_index >= damage_buffer_num)) {
+        return;
+    }
+
+    damage_frame_count++;
+    damage_frame_t *frame = &damage_frames[damage_frame_count % LVGL_PORT_DAMAGE_HISTORY];
+    frame->rect_num = 0;
+    for (int i = 0; i < rect_num; i++) {
+        frame->rect_num = lvgl_port_damage_union_add(frame->rects, frame->rect_num, LVGL_PORT_DAMAGE_RECT_MAX, &rects[i]);
+    }
+    damage_buffer_frame[buffer_index] = damage_frame_count;
+    damage_latest = buffer_index;
+}
+
+int lvgl_port_damage_get_age(int buffer_index)
+{
+    if ((buffer_index < 0) || (buffer_index >= damage_buffer_num) || (damage_buffer_frame[buffer_index] == 0)) {
+        return 0;
+    }
+
+    return damage_frame_count - damage_buffer_frame[buffer_index] + 1;
+}
+
+int lvgl_port_damage_get_latest(void)
+{
+    return damage_latest;
+}
+
+int lvgl_port_damage_collect(int buffer_index, lvgl_port_copy_rect_t *rects)
+{
+    int age = lvgl_port_damage_get_age(buffer_index);
+    if (age == 1) {
+        return 0;
+    }
+    if ((age == 0) || (age - 1 > LVGL_PORT_DAMAGE_HISTORY)) {
+        rects[0].x1 = 0;
+        rects[0].y1 = 0;
+        rects[0].x2 = damage_width - 1;
+        rects[0].y2 = damage_height - 1;
+        return 1;
+    }
+
+    // Union of the frames the buffer has missed: `(last rendered, latest]`
+    int rect_num = 0;
+    for (uint32_t frame = damage_buffer_frame[buffer_index] + 1; frame <= damage_frame_count; frame++) {
+        const damage_frame_t *damage = &damage_frames[frame % LVGL_PORT_DAMAGE_HISTORY];
+        for (int i = 0; i < damage->rect_num; i++) {
+            rect_num = lvgl_port_damage_union_add(rects, rect_num, LVGL_PORT_DAMAGE_RECT_MAX, &damage->rects[i]);
+        }
+    }
+
+    return rect_num;
+}
@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl_port_async_copy.h"
+
+/**
+ * Buffer-age damage tracking for direct-mode rendering with three or more frame buffers.
+ *
+ * Every presented frame commits its damage (the areas LVGL has rendered) together with the index of the buffer it
+ * was rendered into. The age of a buffer is the number of frames since it was last rendered into (`0` means its
+ * content is undefined). Before a buffer is rendered into again, the union of the damage of the frames it has missed
+ * has to be copied into it from the latest frame, which is what `lvgl_port_damage_collect()` returns.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_DAMAGE_HISTORY                (4)     // Number of frames whose damage is kept, older buffers are
+                                                        // brought up to date with a full-screen copy
+#define LVGL_PORT_DAMAGE_BUFFER_MAX             (4)     // Maximum number of tracked frame buffers
+#define LVGL_PORT_DAMAGE_RECT_MAX               (LVGL_PORT_ASYNC_COPY_RECT_MAX)
+                                                        // Maximum number of rectangles per frame and per union,
+                                                        // rectangles beyond this are merged
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize the damage tracking. All buffers start with age `0`.
+ *
+ * @param buffer_num Number of frame buffers, at most `LVGL_PORT_DAMAGE_BUFFER_MAX`
+ * @param width      Width of the frame buffers, in pixels
+ * @param height     Height of the frame buffers, in pixels
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_damage_init(int buffer_num, uint16_t width, uint16_t height);
+
+/**
+ * @brief Record the damage of a frame that has just been rendered into a buffer.
+ *
+ * @param buffer_index Index of the buffer the frame was rendered into
+ * @param rects        Rendered areas of the frame
+ * @param rect_num     Number of rectangles, extra ones are merged
+ */
+void lvgl_port_damage_commit(int buffer_index, const lvgl_port_copy_rect_t *rects, int rect_num);
+
+/**
+ * @brief Get the age of a buffer.
+ *
+ * @param buffer_index Index of the buffer
+ *
+ * @return `0` if the content is undefined, `1` if the buffer holds the latest frame, `n` if it is `n - 1` frames old
+ */
+int lvgl_port_damage_get_age(int buffer_index);
+
+/**
+ * @brief Get the index of the buffer holding the latest frame.
+ *
+ * @return The buffer index, or `-1` if no frame has been committed yet
+ */
+int lvgl_port_damage_get_latest(void);
+
+/**
+ * @brief Collect the areas to copy from the latest frame into a buffer, before it is rendered into.
+ *
+ * @param buffer_index Index of the buffer about to be rendered into
+ * @param rects        Output rectangles, with room for `LVGL_PORT_DAMAGE_RECT_MAX` entries
+ *
+ * @return Number of rectangles, a single full-screen one if the buffer is too old or undefined
+ */
+int lvgl_port_damage_collect(int buffer_index, lvgl_port_copy_rect_t *rects);
+
+/**
+ * @brief Add a rectangle to a union of rectangles. A rectangle already covered is dropped, rectangles covered by the
+ *        new one are removed, and when the union is full the pair whose bounding box grows least is merged.
+ *
+ * @param rects    Union of rectangles, with room for `rect_max` entries
+ * @param rect_num Number of rectangles in the union
+ * @param rect_max Maximum number of rectangles in the union
+ * @param rect     Rectangle to add
+ *
+ * @return New number of rectangles in the union
+ */
+int lvgl_port_damage_union_add(lvgl_port_copy_rect_t *rects, int rect_num, int rect_max, const lvgl_port_copy_rect_t *rect);
+
+/**
+ * @brief Get the area of a union of rectangles, the overlaps counted once.
+ *
+ * @param rects    Union of rectangles, as built by `lvgl_port_damage_union_add()`
+ * @param rect_num Number of rectangles, at most `LVGL_PORT_DAMAGE_RECT_MAX`, extra ones are ignored
+ *
+ * @return Area in pixels
+ */
+uint32_t lvgl_port_damage_union_area(const lvgl_port_copy_rect_t *rects, int rect_num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,372 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include <string.h>
+#include "lvgl_port_flush_worker.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#undef ESP_UTILS_LOG_TAG
+#define ESP_UTILS_LOG_TAG "LvPort"
+#include "esp_lib_utils.h"
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#define IRAM_ATTR
+#endif
+
+#define WORKER_QUEUE_MASK       (LVGL_PORT_FLUSH_WORKER_BUF_NUM - 1)
+
+static_assert((LVGL_PORT_FLUSH_WORKER_BUF_NUM & WORKER_QUEUE_MASK) == 0,
+              "The number of render buffers of the flush worker must be a power of 2");
+
+/**
+ * Events of the worker, each one is pending until it is waited for, like a binary semaphore
+ */
+typedef enum {
+    WORKER_EVENT_JOB,           // A job was submitted, for the worker
+    WORKER_EVENT_DONE,          // A buffer was handed back or a job is over, for the fences
+    WORKER_EVENT_VSYNC,         // A vsync, for the present callback
+    WORKER_EVENT_MAX,
+} worker_event_t;
+
+typedef struct {
+    lvgl_port_copy_rect_t rects[LVGL_PORT_FLUSH_WORKER_RECT_MAX];
+    int rect_num;
+} worker_job_t;
+
+static worker_job_t worker_jobs[LVGL_PORT_FLUSH_WORKER_BUF_NUM];    // Written by the owner of each buffer
+static std::atomic<bool> worker_owned[LVGL_PORT_FLUSH_WORKER_BUF_NUM];  // The worker owns the buffer
+static int worker_queue[LVGL_PORT_FLUSH_WORKER_BUF_NUM];            // Buffers of the submitted jobs, in order
+static std::atomic<uint32_t> worker_tail(0);                        // Jobs submitted
+static std::atomic<uint32_t> worker_head(0);                        // Jobs over
+static std::atomic<bool> worker_exit(false);
+static lvgl_port_flush_worker_copy_cb_t worker_copy_cb = nullptr;
+static lvgl_port_flush_worker_present_cb_t worker_present_cb = nullptr;
+static void *worker_user_data = nullptr;
+static lvgl_port_flush_worker_stats_t worker_stats = {};
+static uint64_t worker_copy_us_total = 0;
+static uint64_t worker_present_us_total = 0;
+
+#ifdef ESP_PLATFORM
+
+static SemaphoreHandle_t worker_events[WORKER_EVENT_MAX] = {};
+static TaskHandle_t worker_task = nullptr;
+
+static inline int64_t worker_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+static void worker_signal(worker_event_t event)
+{
+    xSemaphoreGive(worker_events[event]);
+}
+
+static bool worker_wait(worker_event_t event, int timeout_ms)
+{
+    const TickType_t timeout_ticks = (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return (xSemaphoreTake(worker_events[event], timeout_ticks) == pdTRUE);
+}
+
+IRAM_ATTR bool lvgl_port_flush_worker_vsync_from_isr(void)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    if (worker_events[WORKER_EVENT_VSYNC] != nullptr) {
+        xSemaphoreGiveFromISR(worker_events[WORKER_EVENT_VSYNC], &need_yield);
+    }
+
+    return (need_yield == pdTRUE);
+}
+
+#else
+
+static std::mutex worker_mutex;
+static std::condition_variable worker_cond;
+static bool worker_pending[WORKER_EVENT_MAX] = {};
+static std::thread worker_thread;
+
+static inline int64_t worker_time_us(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+           ).count();
+}
+
+static void worker_signal(worker_event_t event)
+{
+    std::lock_guard<std::mutex> lock(worker_mutex);
+    worker_pending[event] = true;
+    worker_cond.notify_all();
+}
+
+static bool worker_wait(worker_event_t event, int timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(worker_mutex);
+    auto pending = [event] { return worker_pending[event]; };
+    if (timeout_ms < 0) {
+        worker_cond.wait(lock, pending);
+    } else if (!worker_cond.wait_for(lock, std::chrono::milliseconds(timeout_ms), pending)) {
+        return false;
+    }
+    worker_pending[event] = false;
+
+    return true;
+}
+
+bool lvgl_port_flush_worker_vsync_from_isr(void)
+{
+    worker_signal(WORKER_EVENT_VSYNC);
+
+    return false;
+}
+
+#endif /* ESP_PLATFORM */
+
+/**
+ * @brief Run the jobs in the order they were submitted. The buffer is handed back right after its copy, so LVGL can
+ *        render into it while the worker presents.
+ */
+static void worker_run(void)
+{
+    uint32_t head = worker_head.load(std::memory_order_relaxed);
+
+    while (head != worker_tail.load(std::memory_order_acquire)) {
+        int buf = worker_queue[head & WORKER_QUEUE_MASK];
+        const worker_job_t *job = &worker_jobs[buf];
+
+        int64_t start_us = worker_time_us();
+        worker_copy_cb(buf, job->rects, job->rect_num, worker_user_data);
+        int64_t copied_us = worker_time_us();
+        worker_owned[buf].store(false, std::memory_order_release);
+        worker_signal(WORKER_EVENT_DONE);
+
+        worker_present_cb(worker_user_data);
+        uint32_t copy_us = copied_us - start_us;
+        worker_stats.jobs++;
+        worker_copy_us_total += copy_us;
+        worker_present_us_total += worker_time_us() - copied_us;
+        worker_stats.copy_us_avg = worker_copy_us_total / worker_stats.jobs;
+        worker_stats.copy_us_max = (copy_us > worker_stats.copy_us_max) ? copy_us : worker_stats.copy_us_max;
+        worker_stats.present_us_avg = worker_present_us_total / worker_stats.jobs;
+
+        worker_head.store(++head, std::memory_order_release);
+        worker_signal(WORKER_EVENT_DONE);
+    }
+}
+
+#ifdef ESP_PLATFORM
+
+static void worker_task_loop(void *arg)
+{
+    while (true) {
+        worker_wait(WORKER_EVENT_JOB, -1);
+        worker_run();
+    }
+}
+
+#else
+
+static void worker_task_loop(void)
+{
+    while (true) {
+        worker_wait(WORKER_EVENT_JOB, -1);
+        if (worker_exit.load()) {
+            break;
+        }
+        worker_run();
+    }
+}
+
+#endif /* ESP_PLATFORM */
+
+static void worker_reset(void)
+{
+    for (int i = 0; i < LVGL_PORT_FLUSH_WORKER_BUF_NUM; i++) {
+        worker_owned[i].store(false);
+    }
+    worker_tail.store(0);
+    worker_head.store(0);
+    worker_exit.store(false);
+    worker_copy_cb = nullptr;
+    worker_present_cb = nullptr;
+    worker_user_data = nullptr;
+    worker_stats = {};
+    worker_copy_us_total = 0;
+    worker_present_us_total = 0;
+}
+
+#ifdef ESP_PLATFORM
+
+bool lvgl_port_flush_worker_init(int core)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(worker_task == nullptr, false, "Flush worker is already initialized");
+
+    worker_reset();
+    for (int i = 0; i < WORKER_EVENT_MAX; i++) {
+        worker_events[i] = xSemaphoreCreateBinary();
+        ESP_UTILS_CHECK_NULL_RETURN(worker_events[i], false, "Create flush worker event %d failed", i);
+    }
+    BaseType_t ret = xTaskCreatePinnedToCore(
+                         worker_task_loop, "lvgl_flush", LVGL_PORT_FLUSH_WORKER_STACK_SIZE, nullptr,
+                         LVGL_PORT_FLUSH_WORKER_PRIORITY, &worker_task, (core < 0) ? tskNO_AFFINITY : core
+                     );
+    ESP_UTILS_CHECK_FALSE_RETURN(ret == pdPASS, false, "Create flush worker task failed");
+
+    return true;
+}
+
+bool lvgl_port_flush_worker_deinit(void)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(worker_task, false, "Flush worker is not initialized");
+
+    // Once idle, the worker only waits for the next job
+    lvgl_port_flush_worker_wait_idle(-1);
+    vTaskDelete(worker_task);
+    worker_task = nullptr;
+    for (int i = 0; i < WORKER_EVENT_MAX; i++) {
+        vSemaphoreDelete(worker_events[i]);
+        worker_events[i] = nullptr;
+    }
+
+    return true;
+}
+
+#else
+
+bool lvgl_port_flush_worker_init(int)
+{
+    if (worker_thread.joinable()) {
+        return false;
+    }
+    worker_reset();
+    for (int i = 0; i < WORKER_EVENT_MAX; i++) {
+        worker_pending[i] = false;
+    }
+    worker_thread = std::thread(worker_task_loop);
+
+    return true;
+}
+
+bool lvgl_port_flush_worker_deinit(void)
+{
+    if (!worker_thread.joinable()) {
+        return false;
+    }
+    lvgl_port_flush_worker_wait_idle(-1);
+    worker_exit.store(true);
+    worker_signal(WORKER_EVENT_JOB);
+    worker_thread.join();
+
+    return true;
+}
+
+#endif /* ESP_PLATFORM */
+
+bool lvgl_port_flush_worker_set_callbacks(
+    lvgl_port_flush_worker_copy_cb_t copy_cb, lvgl_port_flush_worker_present_cb_t present_cb, void *user_data
+)
+{
+    if ((copy_cb == nullptr) || (present_cb == nullptr) ||
+            (worker_head.load(std::memory_order_acquire) != worker_tail.load(std::memory_order_relaxed))) {
+        return false;
+    }
+    // Published to the worker with the next job
+    worker_copy_cb = copy_cb;
+    worker_present_cb = present_cb;
+    worker_user_data = user_data;
+
+    return true;
+}
+
+bool lvgl_port_flush_worker_submit(int buf, const lvgl_port_copy_rect_t *rects, int rect_num)
+{
+    if ((buf < 0) || (buf >= LVGL_PORT_FLUSH_WORKER_BUF_NUM) || (rects == nullptr) || (rect_num < 0) ||
+            (rect_num > LVGL_PORT_FLUSH_WORKER_RECT_MAX) || (worker_copy_cb == nullptr) ||
+            worker_owned[buf].load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    // Each buffer is queued at most once, so the queue can't be full
+    uint32_t tail = worker_tail.load(std::memory_order_relaxed);
+    memcpy(worker_jobs[buf].rects, rects, rect_num * sizeof(rects[0]));
+    worker_jobs[buf].rect_num = rect_num;
+    worker_queue[tail & WORKER_QUEUE_MASK] = buf;
+    worker_owned[buf].store(true, std::memory_order_relaxed);
+    // The job, the buffer and everything rendered into it are the worker's from here
+    worker_tail.store(tail + 1, std::memory_order_release);
+    worker_signal(WORKER_EVENT_JOB);
+
+    return true;
+}
+
+bool lvgl_port_flush_worker_fence(int buf, int timeout_ms)
+{
+    if ((buf < 0) || (buf >= LVGL_PORT_FLUSH_WORKER_BUF_NUM) || !worker_owned[buf].load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    int64_t start_us = worker_time_us();
+    while (worker_owned[buf].load(std::memory_order_acquire)) {
+        int wait_ms = -1;
+        if (timeout_ms >= 0) {
+            wait_ms = timeout_ms - (int)((worker_time_us() - start_us) / 1000);
+            if (wait_ms <= 0) {
+                return false;
+            }
+        }
+        worker_wait(WORKER_EVENT_DONE, wait_ms);
+    }
+    worker_stats.fence_waits++;
+    worker_stats.fence_wait_us += worker_time_us() - start_us;
+
+    return true;
+}
+
+bool lvgl_port_flush_worker_wait_idle(int timeout_ms)
+{
+    int64_t start_us = worker_time_us();
+
+    while (worker_head.load(std::memory_order_acquire) != worker_tail.load(std::memory_order_relaxed)) {
+        int wait_ms = -1;
+        if (timeout_ms >= 0) {
+            wait_ms = timeout_ms - (int)((worker_time_us() - start_us) / 1000);
+            if (wait_ms <= 0) {
+                return false;
+            }
+        }
+        worker_wait(WORKER_EVENT_DONE, wait_ms);
+    }
+
+    return true;
+}
+
+bool lvgl_port_flush_worker_wait_vsync(int timeout_ms)
+{
+    // A vsync pending from before the switch did not show the new frame
+    worker_wait(WORKER_EVENT_VSYNC, 0);
+    if (!worker_wait(WORKER_EVENT_VSYNC, timeout_ms)) {
+        worker_stats.vsync_timeouts++;
+        return false;
+    }
+
+    return true;
+}
+
+void lvgl_port_flush_worker_get_stats(lvgl_port_flush_worker_stats_t *stats)
+{
+    if (stats != nullptr) {
+        *stats = worker_stats;
+    }
+}
@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl_port_async_copy.h"
+
+/**
+ * Flush worker: the second half of the frame pipeline, on the core the LVGL task doesn't use.
+ *
+ * When LVGL's frame has to be copied into the frame buffers by the CPU (rotated), the LVGL task renders a frame,
+ * copies it, switches the frame buffer and waits for the vsync, all on one core while the other is idle. With the
+ * worker, LVGL renders into two render buffers in turn. Once a frame is rendered, its buffer and its damage are handed
+ * to the worker, which copies the damage into the frame buffer off screen, switches to it and waits for the vsync,
+ * while LVGL renders the next frame into the other render buffer.
+ *
+ * Each render buffer belongs either to the LVGL task or to the worker. `lvgl_port_flush_worker_submit()` hands it to
+ * the worker, which hands it back as soon as its copy is over, before the switch and the vsync wait. The LVGL task
+ * fences with `lvgl_port_flush_worker_fence()` before writing into a render buffer, including LVGL's synchronization
+ * of the dirty areas between them: it only blocks if the worker is still reading that buffer, meaning the worker is
+ * the slower half of the pipeline. The ownership is an atomic flag per buffer, released by its owner after its last
+ * access and acquired by the other side before its first one.
+ *
+ * The worker runs the jobs in the order they were submitted, one at a time. The port supplies the copy and the
+ * present (switch and vsync wait) through callbacks, the module doesn't know LVGL or the LCD. On host builds (no
+ * `ESP_PLATFORM`), the worker is a thread, so the handoff can be exercised off-device.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_FLUSH_WORKER_BUF_NUM          (2)     // Render buffers handed between LVGL and the worker
+#define LVGL_PORT_FLUSH_WORKER_RECT_MAX         (2 * LVGL_PORT_ASYNC_COPY_RECT_MAX)
+                                                        // Rectangles of a job: damage of a frame and of the last one
+#define LVGL_PORT_FLUSH_WORKER_STACK_SIZE       (4 * 1024)  // Stack of the worker task, in bytes
+#define LVGL_PORT_FLUSH_WORKER_PRIORITY         (2)     // Priority of the worker task, the same as the LVGL task
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Copy the rectangles of a render buffer into the frame buffer off screen, called by the worker
+ */
+typedef void (*lvgl_port_flush_worker_copy_cb_t)(
+    int buf, const lvgl_port_copy_rect_t *rects, int rect_num, void *user_data
+);
+
+/**
+ * @brief Show the frame copied by the last call of the copy callback, called by the worker once the render buffer is
+ *        handed back. It should switch the frame buffer and wait with `lvgl_port_flush_worker_wait_vsync()`.
+ */
+typedef void (*lvgl_port_flush_worker_present_cb_t)(void *user_data);
+
+/**
+ * @brief Statistics of the worker, accumulated since `lvgl_port_flush_worker_init()`
+ */
+typedef struct {
+    uint32_t jobs;                  // Frames copied and presented
+    uint32_t copy_us_avg;           // Time the render buffer was held by the worker, per job
+    uint32_t copy_us_max;
+    uint32_t present_us_avg;        // Time of the present, vsync wait included, per job
+    uint32_t fence_waits;           // Fences that had to block, the LVGL task waited for the worker
+    uint64_t fence_wait_us;         // Total time blocked in the fences
+    uint32_t vsync_timeouts;        // Vsync waits that timed out
+} lvgl_port_flush_worker_stats_t;
+
+/**
+ * @brief Start the worker. All render buffers belong to the LVGL task.
+ *
+ * @param core Core of the worker task, `-1` for any. Ignored on host builds.
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_flush_worker_init(int core);
+
+/**
+ * @brief Stop the worker, once the submitted jobs are over.
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_flush_worker_deinit(void);
+
+/**
+ * @brief Set the callbacks of the next jobs. The worker must be idle, see `lvgl_port_flush_worker_wait_idle()`.
+ *
+ * @param copy_cb    Copy of a job
+ * @param present_cb Present of a job
+ * @param user_data  Passed to the callbacks
+ *
+ * @return true if success, false if the worker is not idle
+ */
+bool lvgl_port_flush_worker_set_callbacks(
+    lvgl_port_flush_worker_copy_cb_t copy_cb, lvgl_port_flush_worker_present_cb_t present_cb, void *user_data
+);
+
+/**
+ * @brief Hand a rendered buffer to the worker. It must not be written until `lvgl_port_flush_worker_fence()` passes.
+ *
+ * @param buf      Index of the render buffer, below `LVGL_PORT_FLUSH_WORKER_BUF_NUM`
+ * @param rects    Rectangles to copy, copied
+ * @param rect_num Number of rectangles, at most `LVGL_PORT_FLUSH_WORKER_RECT_MAX`
+ *
+ * @return true if success, false if the buffer already belongs to the worker or the parameters are invalid
+ */
+bool lvgl_port_flush_worker_submit(int buf, const lvgl_port_copy_rect_t *rects, int rect_num);
+
+/**
+ * @brief Fence: block until the worker has handed a render buffer back.
+ *
+ * @param buf        Index of the render buffer about to be written
+ * @param timeout_ms Timeout in milliseconds, `-1` to wait indefinitely
+ *
+ * @return true if the buffer belongs to the caller, false on timeout
+ */
+bool lvgl_port_flush_worker_fence(int buf, int timeout_ms);
+
+/**
+ * @brief Block until every submitted job is over, present included.
+ *
+ * @param timeout_ms Timeout in milliseconds, `-1` to wait indefinitely
+ *
+ * @return true if the worker is idle, false on timeout
+ */
+bool lvgl_port_flush_worker_wait_idle(int timeout_ms);
+
+/**
+ * @brief Signal a vsync to `lvgl_port_flush_worker_wait_vsync()`, called from the vsync ISR.
+ *
+ * @return true if a higher priority task has been woken, otherwise false
+ */
+bool lvgl_port_flush_worker_vsync_from_isr(void);
+
+/**
+ * @brief Wait for the next vsync, called by the present callback after the switch.
+ *
+ * @param timeout_ms Timeout in milliseconds
+ *
+ * @return true if a vsync came, false on timeout
+ */
+bool lvgl_port_flush_worker_wait_vsync(int timeout_ms);
+
+/**
+ * @brief Get the statistics of the worker.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_flush_worker_get_stats(lvgl_port_flush_worker_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,130 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include "lvgl_port_frame_sched.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+
+static std::atomic<uint32_t> sched_divisor(0);
+static std::atomic<bool> sched_pending(false);      // A vsync asked for a frame that hasn't started yet
+static std::atomic<uint32_t> sched_vsync_us(0);     // Last vsync
+static std::atomic<uint32_t> sched_period_us(0);
+static std::atomic<uint32_t> sched_skipped(0);
+static uint32_t sched_vsyncs = 0;                   // Vsyncs seen, only written by the ISR
+static uint32_t sched_count = 0;                    // Vsyncs since the last frame asked for
+static lvgl_port_frame_sched_stats_t sched_stats = {};  // Fields of the LVGL task
+static int64_t sched_slack_us_total = 0;
+static int64_t sched_begin_us = 0;                  // Start of the last frame
+static bool sched_begun = false;                    // A frame started since `lvgl_port_frame_sched_init()`
+
+void lvgl_port_frame_sched_init(uint32_t divisor)
+{
+    sched_divisor.store(0, std::memory_order_relaxed);
+    sched_pending.store(false, std::memory_order_relaxed);
+    sched_skipped.store(0, std::memory_order_relaxed);
+    sched_count = 0;
+    sched_stats = {};
+    sched_slack_us_total = 0;
+    sched_begun = false;
+    sched_divisor.store(divisor, std::memory_order_release);
+}
+
+uint32_t lvgl_port_frame_sched_get_divisor(void)
+{
+    return sched_divisor.load(std::memory_order_relaxed);
+}
+
+IRAM_ATTR bool lvgl_port_frame_sched_on_vsync(int64_t now_us)
+{
+    uint32_t now = (uint32_t)now_us;
+    uint32_t last = sched_vsync_us.load(std::memory_order_relaxed);
+    uint32_t period = sched_period_us.load(std::memory_order_relaxed);
+
+    // Average the period, ignoring a gap where vsyncs were lost (the first one included)
+    if (sched_vsyncs > 0) {
+        uint32_t delta = now - last;
+        if (period == 0) {
+            period = delta;
+        } else if (delta < 2 * period) {
+            period = (period * 7 + delta) / 8;
+        }
+        sched_period_us.store(period, std::memory_order_relaxed);
+    }
+    sched_vsync_us.store(now, std::memory_order_release);
+    sched_vsyncs++;
+
+    uint32_t divisor = sched_divisor.load(std::memory_order_acquire);
+    if ((divisor == 0) || (++sched_count < divisor)) {
+        return false;
+    }
+    sched_count = 0;
+    if (sched_pending.exchange(true, std::memory_order_acq_rel)) {
+        // The last frame asked for hasn't started, this one is merged into it
+        sched_skipped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return true;
+}
+
+bool lvgl_port_frame_sched_begin(int64_t now_us, uint32_t timeout_us, int64_t *present_us)
+{
+    if (sched_pending.exchange(false, std::memory_order_acq_rel)) {
+        sched_stats.wakes++;
+    } else if (!sched_begun || (now_us - sched_begin_us >= (int64_t)timeout_us)) {
+        // Without vsyncs (the panel is stopped), the frames still run, one per timeout
+        sched_stats.timeouts++;
+    } else {
+        // Woken up by something else than a vsync, the frame waits for the next one
+        return false;
+    }
+    sched_begin_us = now_us;
+    sched_begun = true;
+
+    uint32_t vsync = sched_vsync_us.load(std::memory_order_acquire);
+    uint32_t period = sched_period_us.load(std::memory_order_relaxed);
+    int64_t predicted_us = now_us;
+    if (period > 0) {
+        // The first vsync after now, right after a vsync that's the next one
+        int32_t since_us = (int32_t)((uint32_t)now_us - vsync);
+        since_us = (since_us > 0) ? since_us : 0;
+        predicted_us = now_us - since_us + (int64_t)(since_us / period + 1) * period;
+    }
+    sched_stats.present_us = predicted_us;
+    *present_us = predicted_us;
+
+    return true;
+}
+
+void lvgl_port_frame_sched_end(int64_t now_us, bool rendered)
+{
+    if (!rendered) {
+        return;
+    }
+
+    int32_t slack_us = sched_stats.present_us - now_us;
+    sched_stats.frames++;
+    sched_stats.missed += (slack_us < 0);
+    sched_stats.slack_us_last = slack_us;
+    if ((sched_stats.frames == 1) || (slack_us < sched_stats.slack_us_min)) {
+        sched_stats.slack_us_min = slack_us;
+    }
+    sched_slack_us_total += slack_us;
+    sched_stats.slack_us_avg = sched_slack_us_total / sched_stats.frames;
+}
+
+void lvgl_port_frame_sched_get_stats(lvgl_port_frame_sched_stats_t *stats)
+{
+    *stats = sched_stats;
+    stats->divisor = sched_divisor.load(std::memory_order_relaxed);
+    stats->period_us = sched_period_us.load(std::memory_order_relaxed);
+    stats->vsyncs = sched_vsyncs;
+    stats->skipped = sched_skipped.load(std::memory_order_relaxed);
+}
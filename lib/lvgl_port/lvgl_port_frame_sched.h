@@ -0,0 +1,100 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Frame scheduler locked to the vsync of the panel.
+ *
+ * Without it, the LVGL task sleeps for what `lv_timer_handler()` asks, the animations step on LVGL's millisecond tick
+ * and LVGL refreshes every `LV_DISP_DEF_REFR_PERIOD`: none of these clocks is the refresh of the panel, so the frames
+ * beat against the vsync and the motion judders. With the scheduler, the vsync ISR wakes the LVGL task once every
+ * `divisor` vsyncs, and each frame is one pass of the timers then one render, stamped with the time it is predicted to
+ * be shown: the first vsync after the frame starts, extrapolated from the measured vsync period. The port sets LVGL's
+ * tick to that time, so the animations step by whole vsync periods and land where they are seen.
+ *
+ * The frame is late if it is not over by its predicted presentation, and it is then shown one vsync later or more. The
+ * slack of each frame (its predicted presentation minus its end) tells how close the frames run to the vsync.
+ *
+ * The timestamps are in microseconds, only their low 32 bits are kept by the ISR, which is fine for differences.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Statistics of the scheduler, accumulated since `lvgl_port_frame_sched_init()`
+ */
+typedef struct {
+    uint32_t divisor;               // Vsyncs per frame, `0` if the scheduler is stopped
+    uint32_t period_us;             // Measured vsync period, `0` until two vsyncs have been seen
+    uint32_t vsyncs;                // Vsyncs seen
+    uint32_t wakes;                 // Frames started by a vsync
+    uint32_t timeouts;              // Frames started by the timeout, without a vsync
+    uint32_t skipped;               // Vsyncs that should have started a frame, but found the last one still running
+    uint32_t frames;                // Frames rendered, the others only ran the timers
+    uint32_t missed;                // Frames rendered after their predicted presentation
+    int32_t slack_us_last;          // Predicted presentation minus the end of the last rendered frame
+    int32_t slack_us_min;
+    int32_t slack_us_avg;
+    int64_t present_us;             // Predicted presentation of the last frame
+} lvgl_port_frame_sched_stats_t;
+
+/**
+ * @brief Start the scheduler, or stop it with `divisor = 0`. The statistics are reset, the vsync period is kept.
+ *
+ * @param divisor Vsyncs per frame
+ */
+void lvgl_port_frame_sched_init(uint32_t divisor);
+
+/**
+ * @brief Get the vsyncs per frame, `0` if the scheduler is stopped.
+ */
+uint32_t lvgl_port_frame_sched_get_divisor(void);
+
+/**
+ * @brief Count a vsync, called from the vsync ISR. The vsync period is measured even if the scheduler is stopped.
+ *
+ * @param now_us Current time
+ *
+ * @return true if a frame should start, the LVGL task is to be woken up
+ */
+bool lvgl_port_frame_sched_on_vsync(int64_t now_us);
+
+/**
+ * @brief Start a frame when the LVGL task wakes up, if a vsync asked for one or if none started for `timeout_us`.
+ *
+ * @note  The other wakes of the task (commands, touch) don't start a frame, they wait for the next vsync.
+ *
+ * @param now_us     Current time
+ * @param timeout_us Longest time between two frames, when the vsyncs stop
+ * @param present_us Filled with the predicted presentation of the frame, `now_us` until the vsync period is known
+ *
+ * @return true if the frame started, otherwise false
+ */
+bool lvgl_port_frame_sched_begin(int64_t now_us, uint32_t timeout_us, int64_t *present_us);
+
+/**
+ * @brief End the frame started by `lvgl_port_frame_sched_begin()`.
+ *
+ * @param now_us   Current time
+ * @param rendered Whether the frame was rendered, only rendered frames count for the slack
+ */
+void lvgl_port_frame_sched_end(int64_t now_us, bool rendered);
+
+/**
+ * @brief Get the statistics of the scheduler.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_frame_sched_get_stats(lvgl_port_frame_sched_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,411 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "lvgl_port_governor.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#elif defined(CONFIG_ARDUINO_RUNNING_CORE)
+#include "esp32-hal-cpu.h"
+#endif
+#include "esp_timer.h"
+#undef ESP_UTILS_LOG_TAG
+#define ESP_UTILS_LOG_TAG "LvPort"
+#include "esp_lib_utils.h"
+#else
+#include <chrono>
+#endif
+
+#define GOVERNOR_LEVEL_MAX      (LVGL_PORT_GOVERNOR_LEVEL_NUM - 1)
+
+typedef struct {
+    lvgl_port_governor_config_t config;
+    int level;
+    int min_level;                  // Level of `config.min_mhz`
+    uint32_t below;                 // Frames in a row that allowed the step down
+    uint32_t hold;                  // Frames left before the clock may step down
+    bool pinned;
+    bool apply;                     // Set the clock of the CPUs, false for a replay
+    int64_t level_since_us;         // Start of the time not accounted yet
+    int64_t last_frame_us;
+    lvgl_port_governor_stats_t stats;
+} governor_t;
+
+static const uint16_t governor_levels_mhz[LVGL_PORT_GOVERNOR_LEVEL_NUM] = LVGL_PORT_GOVERNOR_LEVELS_MHZ;
+static governor_t governor = {};
+static bool governor_running = false;
+
+#ifdef ESP_PLATFORM
+
+static inline int64_t governor_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+#if CONFIG_PM_ENABLE
+
+static esp_pm_lock_handle_t governor_cpu_lock = nullptr;    // Keeps the clock at the level between frames
+static esp_pm_lock_handle_t governor_switch_lock = nullptr; // Forces the switch to a new level
+
+static bool governor_clock_set(uint16_t mhz)
+{
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = mhz,
+        .min_freq_mhz = governor_levels_mhz[0],
+        .light_sleep_enable = false,
+    };
+    ESP_UTILS_CHECK_FALSE_RETURN(esp_pm_configure(&pm_config) == ESP_OK, false, "Configure PM failed");
+    // The new bound only applies at the next switch of the mode of the power management, taking a lock of another
+    // mode makes one
+    esp_pm_lock_acquire(governor_switch_lock);
+    esp_pm_lock_release(governor_switch_lock);
+
+    return true;
+}
+
+static bool governor_clock_init(void)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "lvgl_gov", &governor_cpu_lock) == ESP_OK, false,
+        "Create PM lock failed"
+    );
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "lvgl_gov_switch", &governor_switch_lock) == ESP_OK, false,
+        "Create PM lock failed"
+    );
+    esp_pm_lock_acquire(governor_cpu_lock);
+
+    return true;
+}
+
+static void governor_clock_deinit(void)
+{
+    governor_clock_set(governor_levels_mhz[GOVERNOR_LEVEL_MAX]);
+    esp_pm_lock_release(governor_cpu_lock);
+    esp_pm_lock_delete(governor_cpu_lock);
+    governor_cpu_lock = nullptr;
+    esp_pm_lock_delete(governor_switch_lock);
+    governor_switch_lock = nullptr;
+}
+
+#elif defined(CONFIG_ARDUINO_RUNNING_CORE)
+
+static bool governor_clock_set(uint16_t mhz)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(setCpuFrequencyMhz(mhz), false, "Set CPU frequency(%d MHz) failed", mhz);
+
+    return true;
+}
+
+static bool governor_clock_init(void)
+{
+    return true;
+}
+
+static void governor_clock_deinit(void)
+{
+    governor_clock_set(governor_levels_mhz[GOVERNOR_LEVEL_MAX]);
+}
+
+#else
+
+static bool governor_clock_set(uint16_t)
+{
+    return false;
+}
+
+static bool governor_clock_init(void)
+{
+    ESP_UTILS_LOGE("The governor needs `CONFIG_PM_ENABLE`");
+
+    return false;
+}
+
+static void governor_clock_deinit(void)
+{
+}
+
+#endif /* CONFIG_PM_ENABLE */
+
+#else
+
+static inline int64_t governor_time_us(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+           ).count();
+}
+
+static bool governor_clock_set(uint16_t)
+{
+    return true;
+}
+
+static bool governor_clock_init(void)
+{
+    return true;
+}
+
+static void governor_clock_deinit(void)
+{
+}
+
+#endif /* ESP_PLATFORM */
+
+/**
+ * @brief Find the level of a clock
+ *
+ * @return The level, or -1 if the clock isn't one
+ */
+static int governor_level_find(uint16_t mhz)
+{
+    for (int i = 0; i < LVGL_PORT_GOVERNOR_LEVEL_NUM; i++) {
+        if (governor_levels_mhz[i] == mhz) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static bool governor_config_check(const lvgl_port_governor_config_t *config)
+{
+    return (governor_level_find(config->min_mhz) >= 0) && (config->down_percent < config->up_percent) &&
+           (config->up_percent <= 100) && (config->scaling_percent <= 100);
+}
+
+/**
+ * @brief Predict the time of a frame at another clock, only `scaling_percent` of it scales
+ */
+static uint32_t governor_predict_us(const governor_t *g, uint32_t busy_us, uint16_t from_mhz, uint16_t to_mhz)
+{
+    uint64_t scaled = (uint64_t)busy_us * g->config.scaling_percent * from_mhz / to_mhz;
+    uint64_t fixed = (uint64_t)busy_us * (100 - g->config.scaling_percent);
+
+    return (uint32_t)((scaled + fixed) / 100);
+}
+
+/**
+ * @brief Add the time since the last accounting to the current level
+ */
+static void governor_account(governor_t *g, int64_t now_us)
+{
+    if (now_us > g->level_since_us) {
+        g->stats.level_us[g->level] += now_us - g->level_since_us;
+        g->level_since_us = now_us;
+    }
+}
+
+static void governor_set_level(governor_t *g, int level, int64_t now_us)
+{
+    if (level == g->level) {
+        return;
+    }
+    governor_account(g, now_us);
+    if (g->apply && !governor_clock_set(governor_levels_mhz[level])) {
+        return;
+    }
+    if (level > g->level) {
+        g->stats.steps_up++;
+    } else {
+        g->stats.steps_down++;
+    }
+    g->level = level;
+    g->below = 0;
+}
+
+static void governor_start(governor_t *g, const lvgl_port_governor_config_t *config, bool apply, int64_t now_us)
+{
+    static const lvgl_port_governor_config_t config_default = LVGL_PORT_GOVERNOR_CONFIG_DEFAULT();
+
+    *g = {};
+    g->config = (config != nullptr) ? *config : config_default;
+    g->min_level = governor_level_find(g->config.min_mhz);
+    g->level = GOVERNOR_LEVEL_MAX;
+    g->apply = apply;
+    g->level_since_us = now_us;
+    g->last_frame_us = now_us;
+}
+
+static void governor_frame(governor_t *g, int64_t now_us, uint32_t busy_us, uint32_t period_us)
+{
+    if (period_us == 0) {
+        return;
+    }
+    bool late = (busy_us > period_us);
+    g->stats.frames++;
+    g->stats.level_frames[g->level]++;
+    g->stats.late += late;
+    g->stats.load_percent_last = (uint32_t)((uint64_t)busy_us * 100 / period_us);
+    g->last_frame_us = now_us;
+    if (g->pinned) {
+        return;
+    }
+
+    uint16_t mhz = governor_levels_mhz[g->level];
+    if (late || (g->stats.load_percent_last >= g->config.up_percent)) {
+        // The lowest level landing in the middle of the band, so the next frames neither step up nor down
+        uint64_t band_us = (uint64_t)period_us * (g->config.up_percent + g->config.down_percent) / 200;
+        int level = GOVERNOR_LEVEL_MAX;
+        for (int i = g->level + 1; !late && (i < GOVERNOR_LEVEL_MAX); i++) {
+            if (governor_predict_us(g, busy_us, mhz, governor_levels_mhz[i]) < band_us) {
+                level = i;
+                break;
+            }
+        }
+        governor_set_level(g, level, now_us);
+        g->hold = g->config.hold_frames;
+        return;
+    }
+
+    if (g->hold > 0) {
+        g->hold--;
+    }
+    if ((g->level > g->min_level) &&
+            ((uint64_t)governor_predict_us(g, busy_us, mhz, governor_levels_mhz[g->level - 1]) * 100 <
+             (uint64_t)period_us * g->config.down_percent)) {
+        g->below++;
+    } else {
+        g->below = 0;
+    }
+    if ((g->below >= g->config.down_frames) && (g->hold == 0)) {
+        governor_set_level(g, g->level - 1, now_us);
+    }
+}
+
+static uint32_t governor_idle(governor_t *g, int64_t now_us)
+{
+    if (g->pinned || (g->level <= g->min_level)) {
+        return UINT32_MAX;
+    }
+    int64_t left_us = g->config.idle_ms * 1000LL - (now_us - g->last_frame_us);
+    if (left_us > 0) {
+        return (uint32_t)((left_us + 999) / 1000);
+    }
+    governor_set_level(g, g->min_level, now_us);
+    g->hold = 0;
+    g->stats.idle_drops++;
+
+    return UINT32_MAX;
+}
+
+static void governor_get_stats(governor_t *g, int64_t now_us, lvgl_port_governor_stats_t *stats)
+{
+    governor_account(g, now_us);
+    *stats = g->stats;
+    stats->mhz = governor_levels_mhz[g->level];
+    uint64_t total_us = 0;
+    uint64_t mhz_us = 0;
+    for (int i = 0; i < LVGL_PORT_GOVERNOR_LEVEL_NUM; i++) {
+        stats->level_mhz[i] = governor_levels_mhz[i];
+        total_us += stats->level_us[i];
+        mhz_us += stats->level_us[i] * governor_levels_mhz[i];
+    }
+    stats->mhz_avg = (total_us > 0) ? (uint32_t)(mhz_us / total_us) : stats->mhz;
+}
+
+bool lvgl_port_governor_init(const lvgl_port_governor_config_t *config)
+{
+    if (governor_running || ((config != nullptr) && !governor_config_check(config)) || !governor_clock_init()) {
+        return false;
+    }
+    governor_start(&governor, config, true, governor_time_us());
+    if (!governor_clock_set(governor_levels_mhz[GOVERNOR_LEVEL_MAX])) {
+        governor_clock_deinit();
+        return false;
+    }
+    governor_running = true;
+
+    return true;
+}
+
+bool lvgl_port_governor_deinit(void)
+{
+    if (!governor_running) {
+        return false;
+    }
+    governor_clock_deinit();
+    governor_running = false;
+
+    return true;
+}
+
+bool lvgl_port_governor_set_config(const lvgl_port_governor_config_t *config)
+{
+    if ((config == nullptr) || !governor_config_check(config)) {
+        return false;
+    }
+    governor.config = *config;
+    governor.min_level = governor_level_find(config->min_mhz);
+    if (governor_running && (governor.level < governor.min_level)) {
+        governor_set_level(&governor, governor.min_level, governor_time_us());
+    }
+
+    return true;
+}
+
+void lvgl_port_governor_frame(int64_t now_us, uint32_t busy_us, uint32_t period_us)
+{
+    if (governor_running) {
+        governor_frame(&governor, now_us, busy_us, period_us);
+    }
+}
+
+uint32_t lvgl_port_governor_idle(int64_t now_us)
+{
+    return governor_running ? governor_idle(&governor, now_us) : UINT32_MAX;
+}
+
+void lvgl_port_governor_pin(bool pinned)
+{
+    if (!governor_running) {
+        return;
+    }
+    int64_t now_us = governor_time_us();
+    if (pinned) {
+        governor_set_level(&governor, GOVERNOR_LEVEL_MAX, now_us);
+    } else {
+        // What ran pinned says nothing of the frames to come, they start from the fastest clock
+        governor.hold = governor.config.hold_frames;
+        governor.last_frame_us = now_us;
+    }
+    governor.pinned = pinned;
+}
+
+void lvgl_port_governor_get_stats(lvgl_port_governor_stats_t *stats)
+{
+    if (stats != nullptr) {
+        governor_get_stats(&governor, governor_running ? governor_time_us() : governor.level_since_us, stats);
+    }
+}
+
+bool lvgl_port_governor_replay(
+    const lvgl_port_governor_config_t *config, const lvgl_port_bandwidth_sim_frame_t *frames, int frame_num,
+    uint16_t trace_mhz, uint32_t frame_us, lvgl_port_governor_stats_t *result
+)
+{
+    if (((config != nullptr) && !governor_config_check(config)) || (frames == nullptr) || (frame_num <= 0) ||
+            (trace_mhz == 0) || (frame_us == 0) || (result == nullptr)) {
+        return false;
+    }
+
+    governor_t g;
+    governor_start(&g, config, false, 0);
+    int64_t start_us = 0;
+    for (int i = 0; i < frame_num; i++) {
+        // The LVGL task wakes up for the drop, when `lvgl_port_governor_idle()` says it is due
+        int64_t idle_us = g.last_frame_us + g.config.idle_ms * 1000LL;
+        governor_idle(&g, (idle_us < start_us) ? idle_us : start_us);
+        uint32_t busy_us = governor_predict_us(&g, frames[i].render_us, trace_mhz, governor_levels_mhz[g.level]);
+        governor_frame(&g, start_us + busy_us, busy_us, frame_us);
+        start_us += (busy_us > frames[i].period_us) ? busy_us : frames[i].period_us;
+    }
+    governor_get_stats(&g, start_us, result);
+
+    return true;
+}
@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl_port_bandwidth_sim.h"
+
+/**
+ * CPU frequency governor keyed to the load of the frames.
+ *
+ * The CPUs run at their fastest clock whatever the screen asks of them, while most frames of a dashboard leave most of
+ * their period unused. The governor takes the load of each rendered frame, the time of `lv_timer_handler()` over the
+ * frame period, and steps the clock between the levels of `LVGL_PORT_GOVERNOR_LEVELS_MHZ`:
+ *
+ * - Up at once, so the frame rate holds: a frame over `up_percent` of its period moves the clock to the lowest level
+ *   that would have rendered it in the middle of the hysteresis band (between `down_percent` and `up_percent`), and a
+ *   frame over its period moves it to the fastest level. The level is then kept for `hold_frames` frames at least.
+ * - Down slowly: the load each frame would have had one level lower is predicted, and only after `down_frames` frames
+ *   in a row predicted under `down_percent` does the clock step down one level. The gap between the two thresholds
+ *   keeps a load near one of them from making the clock oscillate.
+ * - To the lowest level after `idle_ms` without a rendered frame, a static screen needs no CPU.
+ *
+ * Not all of a frame scales with the clock, waiting for the PSRAM doesn't: the predictions assume that
+ * `scaling_percent` of the frame does, and that the rest is fixed.
+ *
+ * On the device, the clock is set through the power management of ESP-IDF (`CONFIG_PM_ENABLE`): `esp_pm_configure()`
+ * bounds the clock to the level, and a lock of type `ESP_PM_CPU_FREQ_MAX` held by the governor keeps the clock there
+ * while the LVGL task sleeps between frames, so the ISRs of the panel (the refill of the bounce buffers) don't slow
+ * down in between. The governor owns the configuration of the power management while it runs. Without it, Arduino's
+ * `setCpuFrequencyMhz()` is used if available.
+ *
+ * The decisions don't depend on ESP-IDF: `lvgl_port_governor_replay()` replays a trace recorded with
+ * `lvgl_port_start_frame_trace()` through them, on the host as well, to tune the thresholds against the late frames
+ * and the time spent at each clock. All the other calls are from the LVGL task or with its lock held.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_GOVERNOR_LEVEL_NUM            (3)
+#define LVGL_PORT_GOVERNOR_LEVELS_MHZ           {80, 160, 240}  // CPU clocks of the ESP32-S3, slowest first
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Thresholds of the governor
+ */
+typedef struct {
+    uint16_t min_mhz;               // Lowest clock used, one of `LVGL_PORT_GOVERNOR_LEVELS_MHZ`. The refill ISR of the
+                                    // bounce buffers must keep up with the panel at this clock
+    uint8_t up_percent;             // Load of a frame that steps the clock up at once
+    uint8_t down_percent;           // Load predicted one level lower under which the clock may step down
+    uint16_t down_frames;           // Frames in a row predicted under `down_percent` before stepping down
+    uint16_t hold_frames;           // Frames after a step up before the clock may step down
+    uint16_t idle_ms;               // Time without a rendered frame before dropping to `min_mhz`
+    uint8_t scaling_percent;        // Share of the frame time that scales with the clock
+} lvgl_port_governor_config_t;
+
+#define LVGL_PORT_GOVERNOR_CONFIG_DEFAULT() \
+    {                                       \
+        .min_mhz = 160,                     \
+        .up_percent = 85,                   \
+        .down_percent = 60,                 \
+        .down_frames = 30,                  \
+        .hold_frames = 60,                  \
+        .idle_ms = 1000,                    \
+        .scaling_percent = 80,              \
+    }
+
+/**
+ * @brief Time spent at each clock and decisions, accumulated since `lvgl_port_governor_init()`
+ */
+typedef struct {
+    uint16_t mhz;                   // Current clock
+    uint16_t level_mhz[LVGL_PORT_GOVERNOR_LEVEL_NUM];       // Clock of each level
+    uint64_t level_us[LVGL_PORT_GOVERNOR_LEVEL_NUM];        // Time spent at each level
+    uint32_t level_frames[LVGL_PORT_GOVERNOR_LEVEL_NUM];    // Frames rendered at each level
+    uint32_t frames;                // Frames rendered
+    uint32_t late;                  // Frames longer than their period
+    uint32_t steps_up;
+    uint32_t steps_down;
+    uint32_t idle_drops;            // Drops to the lowest level after `idle_ms` without a frame
+    uint32_t load_percent_last;     // Load of the last frame
+    uint32_t mhz_avg;               // Clock averaged over the time
+} lvgl_port_governor_stats_t;
+
+/**
+ * @brief Start the governor at the fastest clock.
+ *
+ * @param config Thresholds, `NULL` for `LVGL_PORT_GOVERNOR_CONFIG_DEFAULT()`
+ *
+ * @return true if success, false if the config is invalid or the clock can't be set
+ */
+bool lvgl_port_governor_init(const lvgl_port_governor_config_t *config);
+
+/**
+ * @brief Stop the governor, the clock goes back to the fastest level.
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_governor_deinit(void);
+
+/**
+ * @brief Change the thresholds, the statistics are kept.
+ *
+ * @param config Thresholds
+ *
+ * @return true if success, false if the config is invalid
+ */
+bool lvgl_port_governor_set_config(const lvgl_port_governor_config_t *config);
+
+/**
+ * @brief Count a rendered frame, and step the clock.
+ *
+ * @param now_us    End of the frame
+ * @param busy_us   Time of the frame at the current clock
+ * @param period_us Period of the frames
+ */
+void lvgl_port_governor_frame(int64_t now_us, uint32_t busy_us, uint32_t period_us);
+
+/**
+ * @brief Drop to the lowest level if no frame was rendered for `idle_ms`.
+ *
+ * @param now_us Current time
+ *
+ * @return Milliseconds until the drop is due, the LVGL task should wake up by then; `UINT32_MAX` if none is
+ */
+uint32_t lvgl_port_governor_idle(int64_t now_us);
+
+/**
+ * @brief Keep the fastest clock, for a benchmark, or let the governor decide again.
+ *
+ * @param pinned Whether to keep the fastest clock
+ */
+void lvgl_port_governor_pin(bool pinned);
+
+/**
+ * @brief Get the time spent at each clock and the decisions.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_governor_get_stats(lvgl_port_governor_stats_t *stats);
+
+/**
+ * @brief Replay a trace through the decisions of the governor. Each frame takes its `render_us` scaled to the clock
+ *        of the moment, and starts `period_us` after the previous one, or later if the previous one took longer.
+ *
+ * @param config    Thresholds, `NULL` for `LVGL_PORT_GOVERNOR_CONFIG_DEFAULT()`
+ * @param frames    Trace, as recorded by `lvgl_port_start_frame_trace()`
+ * @param frame_num Frames of the trace
+ * @param trace_mhz Clock the trace was recorded at
+ * @param frame_us  Period of the frames, a frame is late beyond it
+ * @param result    Pointer to the statistics to be filled, their times run from the start of the trace
+ *
+ * @return true if success, false if an argument is invalid
+ */
+bool lvgl_port_governor_replay(
+    const lvgl_port_governor_config_t *config, const lvgl_port_bandwidth_sim_frame_t *frames, int frame_num,
+    uint16_t trace_mhz, uint32_t frame_us, lvgl_port_governor_stats_t *result
+);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,292 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+#include "lvgl_port_gradient.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#else
+#define IRAM_ATTR
+#endif
+
+#define GRADIENT_FRONT      (0x01)  // Bit of `gradient_state`: the frame read by the fill
+#define GRADIENT_PENDING    (0x02)  // Bit of `gradient_state`: the other frame is ready to be latched
+
+typedef struct {
+    uint16_t r;                 // Channels of the node, 0 to 65535
+    uint16_t g;
+    uint16_t b;
+} gradient_node_t;
+
+typedef struct {
+    gradient_node_t *nodes;     // `gradient_node_cols` x `gradient_node_rows` nodes
+    bool valid;                 // Whether the nodes have been evaluated
+    lvgl_port_copy_rect_t overlays[LVGL_PORT_GRADIENT_OVERLAY_MAX];
+    int overlay_num;
+    uint16_t key;
+} gradient_frame_t;
+
+static gradient_frame_t gradient_frames[2] = {};
+static std::atomic<uint8_t> gradient_state(0);
+static gradient_node_t *gradient_nodes = nullptr;      // The nodes of both frames
+static uint16_t gradient_width = 0;
+static uint16_t gradient_height = 0;
+static int gradient_node_cols = 0;
+static int gradient_node_rows = 0;
+
+bool lvgl_port_gradient_init(uint16_t width, uint16_t height)
+{
+    if ((width == 0) || (height == 0)) {
+        return false;
+    }
+
+    lvgl_port_gradient_deinit();
+
+    int cols = (width + LVGL_PORT_GRADIENT_CELL - 1) / LVGL_PORT_GRADIENT_CELL + 1;
+    int rows = (height + LVGL_PORT_GRADIENT_CELL - 1) / LVGL_PORT_GRADIENT_CELL + 1;
+    // The fill reads the nodes from the ISR, keep them in internal RAM
+#ifdef ESP_PLATFORM
+    gradient_nodes = (gradient_node_t *)heap_caps_calloc(
+                         2 * cols * rows, sizeof(gradient_node_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT
+                     );
+#else
+    gradient_nodes = (gradient_node_t *)calloc(2 * cols * rows, sizeof(gradient_node_t));
+#endif
+    if (gradient_nodes == nullptr) {
+        return false;
+    }
+    gradient_width = width;
+    gradient_height = height;
+    gradient_node_cols = cols;
+    gradient_node_rows = rows;
+    gradient_frames[0].nodes = gradient_nodes;
+    gradient_frames[1].nodes = gradient_nodes + cols * rows;
+
+    return true;
+}
+
+void lvgl_port_gradient_deinit(void)
+{
+    free(gradient_nodes);
+    gradient_nodes = nullptr;
+    gradient_frames[0] = {};
+    gradient_frames[1] = {};
+    gradient_state.store(0);
+    gradient_node_cols = 0;
+    gradient_node_rows = 0;
+}
+
+/**
+ * @brief Get the frame that isn't read by the fill, holding the latest state
+ *
+ * @note  A frame waiting to be latched is withdrawn first, so the fill can't latch it while it changes. Only the fill
+ *        flips the front frame, and only while a frame is pending, so the front is stable once nothing is pending.
+ */
+static gradient_frame_t *gradient_begin_update(void)
+{
+    uint8_t state = gradient_state.load(std::memory_order_acquire);
+
+    while (!gradient_state.compare_exchange_weak(state, state & GRADIENT_FRONT, std::memory_order_acq_rel)) {
+    }
+
+    gradient_frame_t *front = &gradient_frames[state & GRADIENT_FRONT];
+    gradient_frame_t *back = &gradient_frames[(state & GRADIENT_FRONT) ^ 1];
+    if (!(state & GRADIENT_PENDING)) {
+        // The back frame is older than the front one
+        memcpy(back->nodes, front->nodes, (size_t)gradient_node_cols * gradient_node_rows * sizeof(gradient_node_t));
+        memcpy(back->overlays, front->overlays, sizeof(back->overlays));
+        back->valid = front->valid;
+        back->overlay_num = front->overlay_num;
+        back->key = front->key;
+    }
+
+    return back;
+}
+
+static void gradient_end_update(void)
+{
+    gradient_state.fetch_or(GRADIENT_PENDING, std::memory_order_release);
+}
+
+/**
+ * @brief Inverse distance weighting of the points at a node, with the weights `1 / (d^2 + 1)`
+ */
+static void gradient_eval(
+    const lvgl_port_gradient_point_t *points, int point_num, float x, float y, gradient_node_t *node
+)
+{
+    const float snap_sq = LVGL_PORT_GRADIENT_SNAP_DISTANCE * LVGL_PORT_GRADIENT_SNAP_DISTANCE;
+    float weight_sum = 0;
+    float r = 0;
+    float g = 0;
+    float b = 0;
+
+    for (int i = 0; i < point_num; i++) {
+        float dx = x - points[i].x;
+        float dy = y - points[i].y;
+        float d_sq = dx * dx + dy * dy;
+        uint16_t color = points[i].color;
+        float weight = 1.0f / (d_sq + 1.0f);
+        if (d_sq < snap_sq) {
+            // Close to a point, take its color
+            r = color >> 11;
+            g = (color >> 5) & 0x3F;
+            b = color & 0x1F;
+            weight_sum = 1;
+            break;
+        }
+        r += weight * (color >> 11);
+        g += weight * ((color >> 5) & 0x3F);
+        b += weight * (color & 0x1F);
+        weight_sum += weight;
+    }
+    node->r = (uint16_t)(r / weight_sum * (65535.0f / 31));
+    node->g = (uint16_t)(g / weight_sum * (65535.0f / 63));
+    node->b = (uint16_t)(b / weight_sum * (65535.0f / 31));
+}
+
+bool lvgl_port_gradient_set_points(const lvgl_port_gradient_point_t *points, int point_num)
+{
+    if ((gradient_nodes == nullptr) || (points == nullptr) || (point_num < 1) ||
+            (point_num > LVGL_PORT_GRADIENT_POINT_MAX)) {
+        return false;
+    }
+
+    gradient_frame_t *frame = gradient_begin_update();
+    gradient_node_t *node = frame->nodes;
+    for (int row = 0; row < gradient_node_rows; row++) {
+        for (int col = 0; col < gradient_node_cols; col++) {
+            gradient_eval(
+                points, point_num, (float)(col * LVGL_PORT_GRADIENT_CELL), (float)(row * LVGL_PORT_GRADIENT_CELL),
+                node++
+            );
+        }
+    }
+    frame->valid = true;
+    gradient_end_update();
+
+    return true;
+}
+
+bool lvgl_port_gradient_set_overlays(const lvgl_port_copy_rect_t *rects, int rect_num, uint16_t key)
+{
+    if ((gradient_nodes == nullptr) || ((rects == nullptr) && (rect_num > 0)) || (rect_num < 0) ||
+            (rect_num > LVGL_PORT_GRADIENT_OVERLAY_MAX)) {
+        return false;
+    }
+
+    gradient_frame_t *frame = gradient_begin_update();
+    for (int i = 0; i < rect_num; i++) {
+        frame->overlays[i] = rects[i];
+    }
+    frame->overlay_num = rect_num;
+    frame->key = key;
+    gradient_end_update();
+
+    return true;
+}
+
+__attribute__((always_inline))
+static inline int32_t gradient_lerp(int32_t from, int32_t to, int fraction)
+{
+    return from + (((to - from) * fraction) >> LVGL_PORT_GRADIENT_CELL_SHIFT);
+}
+
+/**
+ * @brief Interpolate one line segment of the grid
+ *
+ * @note  The nodes of the line are interpolated vertically per cell, then each channel is stepped horizontally in a
+ *        32-bit accumulator whose top bits are the bits of the channel in RGB565, so a pixel is three additions and
+ *        the packing.
+ */
+IRAM_ATTR static void gradient_fill_line(const gradient_frame_t *frame, uint16_t *dst, int x, int y, int len_px)
+{
+    const int fy = y & (LVGL_PORT_GRADIENT_CELL - 1);
+    const gradient_node_t *top = frame->nodes + (y >> LVGL_PORT_GRADIENT_CELL_SHIFT) * gradient_node_cols;
+    const gradient_node_t *bottom = top + gradient_node_cols;
+    const int end = x + len_px;
+    int col = x >> LVGL_PORT_GRADIENT_CELL_SHIFT;
+    int32_t left_r = gradient_lerp(top[col].r, bottom[col].r, fy);
+    int32_t left_g = gradient_lerp(top[col].g, bottom[col].g, fy);
+    int32_t left_b = gradient_lerp(top[col].b, bottom[col].b, fy);
+
+    while (x < end) {
+        int32_t right_r = gradient_lerp(top[col + 1].r, bottom[col + 1].r, fy);
+        int32_t right_g = gradient_lerp(top[col + 1].g, bottom[col + 1].g, fy);
+        int32_t right_b = gradient_lerp(top[col + 1].b, bottom[col + 1].b, fy);
+        uint32_t step_r = (uint32_t)(right_r - left_r) << (16 - LVGL_PORT_GRADIENT_CELL_SHIFT);
+        uint32_t step_g = (uint32_t)(right_g - left_g) << (16 - LVGL_PORT_GRADIENT_CELL_SHIFT);
+        uint32_t step_b = (uint32_t)(right_b - left_b) << (16 - LVGL_PORT_GRADIENT_CELL_SHIFT);
+        uint32_t offset = x & (LVGL_PORT_GRADIENT_CELL - 1);
+        uint32_t r = ((uint32_t)left_r << 16) + step_r * offset;
+        uint32_t g = ((uint32_t)left_g << 16) + step_g * offset;
+        uint32_t b = ((uint32_t)left_b << 16) + step_b * offset;
+        int cell_end = (col + 1) << LVGL_PORT_GRADIENT_CELL_SHIFT;
+
+        if (cell_end > end) {
+            cell_end = end;
+        }
+        for (; x < cell_end; x++) {
+            *dst++ = ((r >> 16) & 0xF800) | ((g >> 21) & 0x07E0) | (b >> 27);
+            r += step_r;
+            g += step_g;
+            b += step_b;
+        }
+        left_r = right_r;
+        left_g = right_g;
+        left_b = right_b;
+        col++;
+    }
+}
+
+IRAM_ATTR void lvgl_port_gradient_fill(void *dst, const void *src, int x, int y, int len_px, void *)
+{
+    uint8_t state = gradient_state.load(std::memory_order_acquire);
+
+    if ((x == 0) && (y == 0) && (state & GRADIENT_PENDING)) {
+        // A new frame starts, latch the pending state unless it is being withdrawn
+        uint8_t latched = (state & GRADIENT_FRONT) ^ 1;
+        if (gradient_state.compare_exchange_strong(state, latched, std::memory_order_acq_rel)) {
+            state = latched;
+        }
+    }
+
+    const gradient_frame_t *frame = &gradient_frames[state & GRADIENT_FRONT];
+    uint16_t *pixels = (uint16_t *)dst;
+    if (!frame->valid || (y >= gradient_height)) {
+        if (src != nullptr) {
+            memcpy(dst, src, len_px * sizeof(uint16_t));
+        }
+        return;
+    }
+
+    gradient_fill_line(frame, pixels, x, y, len_px);
+    if (src == nullptr) {
+        return;
+    }
+
+    // Composite the frame buffer inside the overlay windows, only they are read from PSRAM
+    const uint16_t *fb_pixels = (const uint16_t *)src;
+    const int end = x + len_px - 1;
+    for (int i = 0; i < frame->overlay_num; i++) {
+        const lvgl_port_copy_rect_t *rect = &frame->overlays[i];
+        if ((y < rect->y1) || (y > rect->y2) || (rect->x2 < x) || (rect->x1 > end)) {
+            continue;
+        }
+        int from = ((rect->x1 > x) ? rect->x1 : x) - x;
+        int to = ((rect->x2 < end) ? rect->x2 : end) - x;
+        for (int j = from; j <= to; j++) {
+            uint16_t pixel = fb_pixels[j];
+            if (pixel != frame->key) {
+                pixels[j] = pixel;
+            }
+        }
+    }
+}
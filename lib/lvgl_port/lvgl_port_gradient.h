@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl_port_async_copy.h"
+
+/**
+ * Inverse-distance-weighted gradient generated at scanout, as a fill callback of `lvgl_port_scanout.h`.
+ *
+ * The gradient is evaluated in the task context on a coarse grid of nodes `LVGL_PORT_GRADIENT_CELL` pixels apart
+ * (`lvgl_port_gradient_set_points()`, a few hundred IDW evaluations). The fill callback interpolates the grid
+ * bilinearly in fixed point, line by line into the bounce buffer, so the layer costs a few additions per pixel in the
+ * ISR and no frame buffer at all. A new grid is picked up at the start of the next scanned frame, so the gradient
+ * never tears.
+ *
+ * Sparse content drawn by LVGL (text, icons) is composited on top from overlay windows: inside them, the pixels of the
+ * frame buffer replace the gradient unless they are the key color, which the screen background is filled with. Only
+ * the overlay windows are read from PSRAM.
+ *
+ * The colors are RGB565, `lvgl_port_gradient_fill()` only supports 16-bit frame buffers.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_GRADIENT_CELL_SHIFT           (5)     // Distance between two nodes of the grid, as a power of 2
+#define LVGL_PORT_GRADIENT_CELL                 (1 << LVGL_PORT_GRADIENT_CELL_SHIFT)
+#define LVGL_PORT_GRADIENT_POINT_MAX            (4)     // Maximum number of color points
+#define LVGL_PORT_GRADIENT_OVERLAY_MAX          (4)     // Maximum number of overlay windows
+#define LVGL_PORT_GRADIENT_SNAP_DISTANCE        (5)     // Nodes closer than this to a point take its color, in pixels
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Color point of the gradient
+ */
+typedef struct {
+    float x;                        // Position, in pixels
+    float y;
+    uint16_t color;                 // RGB565
+} lvgl_port_gradient_point_t;
+
+/**
+ * @brief Initialize the gradient. Until the first `lvgl_port_gradient_set_points()`, the fill copies the frame buffer.
+ *
+ * @param width  Width of the screen, in pixels
+ * @param height Height of the screen, in pixels
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_gradient_init(uint16_t width, uint16_t height);
+
+/**
+ * @brief Deinitialize the gradient, the fill callback must be detached first.
+ */
+void lvgl_port_gradient_deinit(void);
+
+/**
+ * @brief Evaluate the gradient of new color points on the grid, shown from the next scanned frame.
+ *
+ * @param points    Color points
+ * @param point_num Number of points, from 1 to `LVGL_PORT_GRADIENT_POINT_MAX`
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_gradient_set_points(const lvgl_port_gradient_point_t *points, int point_num);
+
+/**
+ * @brief Set the windows where the frame buffer is composited on top of the gradient, from the next scanned frame.
+ *
+ * @param rects    Windows, in screen coordinates, inclusive
+ * @param rect_num Number of windows, up to `LVGL_PORT_GRADIENT_OVERLAY_MAX`, `0` for the gradient alone
+ * @param key      Color of the frame buffer pixels that let the gradient through
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_gradient_set_overlays(const lvgl_port_copy_rect_t *rects, int rect_num, uint16_t key);
+
+/**
+ * @brief Fill callback generating the gradient, see `lvgl_port_scanout_fill_cb_t`. `user_data` is not used.
+ */
+void lvgl_port_gradient_fill(void *dst, const void *src, int x, int y, int len_px, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,437 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include "lvgl_port_jobs.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#undef ESP_UTILS_LOG_TAG
+#define ESP_UTILS_LOG_TAG "LvPort"
+#include "esp_lib_utils.h"
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#define JOBS_SHARE(begin, end)  (((uint32_t)(begin) << 16) | (uint32_t)(end))
+#define JOBS_SHARE_BEGIN(share) ((int)((share) >> 16))
+#define JOBS_SHARE_END(share)   ((int)((share) & 0xffff))
+
+/**
+ * Share of a worker in the call in progress, alone in its cache line since both workers update it
+ */
+typedef struct alignas(LVGL_PORT_JOBS_CACHE_LINE) {
+    std::atomic<uint32_t> share;    // Tiles not taken yet, `[begin, end)`
+    uint32_t tiles;                 // Tiles run by the worker in the call, only written by the worker
+    uint32_t steals;
+} jobs_slot_t;
+
+/**
+ * Grid of the tiles of a call, starting at the coordinate `0`
+ */
+typedef struct {
+    lvgl_port_copy_rect_t range;
+    int tile_w;
+    int tile_h;
+    int col_first;                  // Grid column of the first tile
+    int row_first;
+    int cols;                       // Tiles per line
+    int tile_num;
+} jobs_grid_t;
+
+static jobs_slot_t jobs_slots[LVGL_PORT_JOBS_WORKER_NUM];
+static std::atomic<bool> jobs_running(false);   // The workers are waiting for calls
+static std::atomic<bool> jobs_busy(false);      // A call owns the workers
+static std::atomic<uint32_t> jobs_runs_inline(0);
+static lvgl_port_jobs_stats_t jobs_stats = {};  // Fields of the calls that own the workers
+
+// Call in progress, written by its caller before the workers are woken up
+static lvgl_port_jobs_fn_t jobs_fn = nullptr;
+static void *jobs_user_data = nullptr;
+static jobs_grid_t jobs_grid = {};
+
+static void jobs_grid_init(jobs_grid_t *grid, const lvgl_port_copy_rect_t *range, int tile_w, int tile_h)
+{
+    grid->range = *range;
+    grid->tile_w = tile_w;
+    grid->tile_h = tile_h;
+    grid->col_first = range->x1 / tile_w;
+    grid->row_first = range->y1 / tile_h;
+    grid->cols = range->x2 / tile_w - grid->col_first + 1;
+    grid->tile_num = grid->cols * (range->y2 / tile_h - grid->row_first + 1);
+}
+
+/**
+ * @brief Get a tile by its index, clipped by the range
+ */
+static void jobs_grid_get_tile(const jobs_grid_t *grid, int index, lvgl_port_copy_rect_t *tile)
+{
+    int x1 = (grid->col_first + index % grid->cols) * grid->tile_w;
+    int y1 = (grid->row_first + index / grid->cols) * grid->tile_h;
+    int x2 = x1 + grid->tile_w - 1;
+    int y2 = y1 + grid->tile_h - 1;
+
+    tile->x1 = (x1 > grid->range.x1) ? x1 : grid->range.x1;
+    tile->y1 = (y1 > grid->range.y1) ? y1 : grid->range.y1;
+    tile->x2 = (x2 < grid->range.x2) ? x2 : grid->range.x2;
+    tile->y2 = (y2 < grid->range.y2) ? y2 : grid->range.y2;
+}
+
+/**
+ * @brief Take the first tile of a share, by its owner
+ *
+ * @return Index of the tile, or `-1` if the share is empty
+ */
+static int jobs_take(jobs_slot_t *slot)
+{
+    uint32_t share = slot->share.load(std::memory_order_relaxed);
+
+    while (JOBS_SHARE_BEGIN(share) < JOBS_SHARE_END(share)) {
+        if (slot->share.compare_exchange_weak(
+                    share, JOBS_SHARE(JOBS_SHARE_BEGIN(share) + 1, JOBS_SHARE_END(share)), std::memory_order_relaxed
+                )) {
+            return JOBS_SHARE_BEGIN(share);
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Steal the last tile of a share, by another worker
+ *
+ * @return Index of the tile, or `-1` if the share is empty
+ */
+static int jobs_steal(jobs_slot_t *slot)
+{
+    uint32_t share = slot->share.load(std::memory_order_relaxed);
+
+    while (JOBS_SHARE_BEGIN(share) < JOBS_SHARE_END(share)) {
+        if (slot->share.compare_exchange_weak(
+                    share, JOBS_SHARE(JOBS_SHARE_BEGIN(share), JOBS_SHARE_END(share) - 1), std::memory_order_relaxed
+                )) {
+            return JOBS_SHARE_END(share) - 1;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Run the share of a worker, then steal from the others until every tile is taken
+ *
+ * @note  The tiles themselves are published by the wake-up of the workers and handed back by their completion, the
+ *        shares only decide who runs what.
+ */
+static void jobs_work(int worker)
+{
+    jobs_slot_t *slot = &jobs_slots[worker];
+    lvgl_port_copy_rect_t tile;
+    int index;
+
+    while ((index = jobs_take(slot)) >= 0) {
+        jobs_grid_get_tile(&jobs_grid, index, &tile);
+        jobs_fn(&tile, worker, jobs_user_data);
+        slot->tiles++;
+    }
+    for (int i = 1; i < LVGL_PORT_JOBS_WORKER_NUM; i++) {
+        jobs_slot_t *victim = &jobs_slots[(worker + i) % LVGL_PORT_JOBS_WORKER_NUM];
+        while ((index = jobs_steal(victim)) >= 0) {
+            jobs_grid_get_tile(&jobs_grid, index, &tile);
+            jobs_fn(&tile, worker, jobs_user_data);
+            slot->tiles++;
+            slot->steals++;
+        }
+    }
+}
+
+#ifdef ESP_PLATFORM
+
+static TaskHandle_t jobs_tasks[LVGL_PORT_JOBS_WORKER_NUM] = {};
+static SemaphoreHandle_t jobs_done = nullptr;   // The task notifications of the callers are taken by the vsync
+
+static inline int64_t jobs_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+static void jobs_task_loop(void *arg)
+{
+    int worker = (int)(intptr_t)arg;
+
+    while (true) {
+        // The notification orders the writes of the caller before the reads of the worker, and the give after them
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        jobs_work(worker);
+        xSemaphoreGive(jobs_done);
+    }
+}
+
+static inline int jobs_get_caller_worker(void)
+{
+    return xPortGetCoreID();
+}
+
+static inline void jobs_start(int caller)
+{
+    for (int i = 0; i < LVGL_PORT_JOBS_WORKER_NUM; i++) {
+        if (i != caller) {
+            xTaskNotifyGive(jobs_tasks[i]);
+        }
+    }
+}
+
+static inline void jobs_wait(void)
+{
+    for (int i = 1; i < LVGL_PORT_JOBS_WORKER_NUM; i++) {
+        xSemaphoreTake(jobs_done, portMAX_DELAY);
+    }
+}
+
+static void jobs_delete(void)
+{
+    for (int i = 0; i < LVGL_PORT_JOBS_WORKER_NUM; i++) {
+        if (jobs_tasks[i] != nullptr) {
+            vTaskDelete(jobs_tasks[i]);
+            jobs_tasks[i] = nullptr;
+        }
+    }
+    if (jobs_done != nullptr) {
+        vSemaphoreDelete(jobs_done);
+        jobs_done = nullptr;
+    }
+}
+
+bool lvgl_port_jobs_init(void)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(jobs_done == nullptr, false, "Job system is already initialized");
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        portNUM_PROCESSORS == LVGL_PORT_JOBS_WORKER_NUM, false, "Job system needs one worker per core"
+    );
+
+    jobs_stats = {};
+    jobs_runs_inline.store(0, std::memory_order_relaxed);
+    jobs_done = xSemaphoreCreateCounting(LVGL_PORT_JOBS_WORKER_NUM, 0);
+    ESP_UTILS_CHECK_NULL_RETURN(jobs_done, false, "Create job system semaphore failed");
+    for (int i = 0; i < LVGL_PORT_JOBS_WORKER_NUM; i++) {
+        BaseType_t ret = xTaskCreatePinnedToCore(
+                             jobs_task_loop, "lvgl_jobs", LVGL_PORT_JOBS_STACK_SIZE, (void *)(intptr_t)i,
+                             LVGL_PORT_JOBS_PRIORITY, &jobs_tasks[i], i
+                         );
+        if (ret != pdPASS) {
+            jobs_tasks[i] = nullptr;
+            jobs_delete();
+        }
+        ESP_UTILS_CHECK_FALSE_RETURN(ret == pdPASS, false, "Create job system worker %d failed", i);
+    }
+    jobs_running.store(true, std::memory_order_release);
+
+    return true;
+}
+
+bool lvgl_port_jobs_deinit(void)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(jobs_done, false, "Job system is not initialized");
+
+    // Once the call in progress is over, the workers only wait for their notification
+    jobs_running.store(false, std::memory_order_relaxed);
+    while (jobs_busy.exchange(true, std::memory_order_acquire)) {
+        vTaskDelay(1);
+    }
+    jobs_delete();
+    jobs_busy.store(false, std::memory_order_release);
+
+    return true;
+}
+
+#else
+
+static std::mutex jobs_mutex;
+static std::condition_variable jobs_cond;
+static uint32_t jobs_generation = 0;            // Calls started, each worker runs each call once
+static int jobs_finished = 0;                   // Workers over with the call in progress
+static bool jobs_exit = false;
+static std::thread jobs_threads[LVGL_PORT_JOBS_WORKER_NUM];     // The caller is the worker `0`
+
+static inline int64_t jobs_time_us(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+           ).count();
+}
+
+static void jobs_task_loop(int worker, uint32_t generation)
+{
+    std::unique_lock<std::mutex> lock(jobs_mutex);
+
+    while (true) {
+        jobs_cond.wait(lock, [&generation] { return (jobs_generation != generation) || jobs_exit; });
+        if (jobs_exit) {
+            break;
+        }
+        generation = jobs_generation;
+        lock.unlock();
+        jobs_work(worker);
+        lock.lock();
+        jobs_finished++;
+        jobs_cond.notify_all();
+    }
+}
+
+static inline int jobs_get_caller_worker(void)
+{
+    return 0;
+}
+
+static inline void jobs_start(int)
+{
+    std::lock_guard<std::mutex> lock(jobs_mutex);
+    jobs_generation++;
+    jobs_finished = 0;
+    jobs_cond.notify_all();
+}
+
+static inline void jobs_wait(void)
+{
+    std::unique_lock<std::mutex> lock(jobs_mutex);
+    jobs_cond.wait(lock, [] { return jobs_finished == LVGL_PORT_JOBS_WORKER_NUM - 1; });
+}
+
+bool lvgl_port_jobs_init(void)
+{
+    if (jobs_threads[1].joinable()) {
+        return false;
+    }
+    jobs_stats = {};
+    jobs_runs_inline.store(0, std::memory_order_relaxed);
+    jobs_exit = false;
+    // The generation is passed rather than read by the thread, a call may start before it runs
+    for (int i = 1; i < LVGL_PORT_JOBS_WORKER_NUM; i++) {
+        jobs_threads[i] = std::thread(jobs_task_loop, i, jobs_generation);
+    }
+    jobs_running.store(true, std::memory_order_release);
+
+    return true;
+}
+
+bool lvgl_port_jobs_deinit(void)
+{
+    if (!jobs_threads[1].joinable()) {
+        return false;
+    }
+    jobs_running.store(false, std::memory_order_relaxed);
+    while (jobs_busy.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        jobs_exit = true;
+        jobs_cond.notify_all();
+    }
+    for (int i = 1; i < LVGL_PORT_JOBS_WORKER_NUM; i++) {
+        jobs_threads[i].join();
+    }
+    jobs_busy.store(false, std::memory_order_release);
+
+    return true;
+}
+
+#endif /* ESP_PLATFORM */
+
+void lvgl_port_jobs_tile_size(const lvgl_port_copy_rect_t *range, int bytes_per_element, int *tile_w, int *tile_h)
+{
+    const int w = range->x2 - range->x1 + 1;
+    const int h = range->y2 - range->y1 + 1;
+    const int tile_num = LVGL_PORT_JOBS_TILES_PER_WORKER * LVGL_PORT_JOBS_WORKER_NUM;
+    int min_lines = (LVGL_PORT_JOBS_TILE_MIN_BYTES + w * bytes_per_element - 1) / (w * bytes_per_element);
+
+    if (h >= min_lines * LVGL_PORT_JOBS_WORKER_NUM) {
+        // Bands of whole lines, one column of tiles holds the range
+        int lines = (h + tile_num - 1) / tile_num;
+        *tile_w = range->x2 + 1;
+        *tile_h = (lines > min_lines) ? lines : min_lines;
+        return;
+    }
+
+    // Too few lines, columns as high as the range, cut on cache lines
+    int line_elements = (LVGL_PORT_JOBS_CACHE_LINE > bytes_per_element) ?
+                        (LVGL_PORT_JOBS_CACHE_LINE / bytes_per_element) : 1;
+    int min_cols = (LVGL_PORT_JOBS_TILE_MIN_BYTES + h * bytes_per_element - 1) / (h * bytes_per_element);
+    int cols = (w + tile_num - 1) / tile_num;
+    cols = (cols > min_cols) ? cols : min_cols;
+    *tile_w = (cols + line_elements - 1) / line_elements * line_elements;
+    *tile_h = range->y2 + 1;
+}
+
+bool lvgl_port_jobs_parallel_for(
+    const lvgl_port_copy_rect_t *range, int tile_w, int tile_h, lvgl_port_jobs_fn_t fn, void *user_data
+)
+{
+    if ((range == nullptr) || (fn == nullptr) || (tile_w <= 0) || (tile_h <= 0) || (range->x1 < 0) ||
+            (range->y1 < 0) || (range->x2 < range->x1) || (range->y2 < range->y1)) {
+        return false;
+    }
+
+    jobs_grid_t grid;
+    jobs_grid_init(&grid, range, tile_w, tile_h);
+    bool owned = !jobs_busy.exchange(true, std::memory_order_acquire);
+    if (!owned || !jobs_running.load(std::memory_order_acquire) || (grid.tile_num < 2) ||
+            (grid.tile_num > LVGL_PORT_JOBS_TILE_NUM_MAX)) {
+        // The call in progress may be the caller's own (from inside a tile), its state is left alone
+        lvgl_port_copy_rect_t tile;
+        for (int i = 0; i < grid.tile_num; i++) {
+            jobs_grid_get_tile(&grid, i, &tile);
+            fn(&tile, 0, user_data);
+        }
+        if (owned) {
+            jobs_busy.store(false, std::memory_order_release);
+        }
+        jobs_runs_inline.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    jobs_fn = fn;
+    jobs_user_data = user_data;
+    jobs_grid = grid;
+    for (int i = 0; i < LVGL_PORT_JOBS_WORKER_NUM; i++) {
+        jobs_slots[i].share.store(
+            JOBS_SHARE(grid.tile_num * i / LVGL_PORT_JOBS_WORKER_NUM,
+                       grid.tile_num * (i + 1) / LVGL_PORT_JOBS_WORKER_NUM),
+            std::memory_order_relaxed
+        );
+        jobs_slots[i].tiles = 0;
+        jobs_slots[i].steals = 0;
+    }
+
+    int caller = jobs_get_caller_worker();
+    jobs_start(caller);
+    jobs_work(caller);
+    int64_t wait_start_us = jobs_time_us();
+    jobs_wait();
+    jobs_stats.wait_us += jobs_time_us() - wait_start_us;
+    jobs_stats.runs++;
+    for (int i = 0; i < LVGL_PORT_JOBS_WORKER_NUM; i++) {
+        jobs_stats.tiles += jobs_slots[i].tiles;
+        jobs_stats.steals += jobs_slots[i].steals;
+    }
+    jobs_busy.store(false, std::memory_order_release);
+
+    return true;
+}
+
+void lvgl_port_jobs_get_stats(lvgl_port_jobs_stats_t *stats)
+{
+    if (stats != nullptr) {
+        *stats = jobs_stats;
+        stats->runs_inline = jobs_runs_inline.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl_port_async_copy.h"
+
+/**
+ * Job system: split pixel work (copies, fills, gradients, decoding) over both cores.
+ *
+ * There is one persistent worker task per core, pinned to it and asleep on its task notification.
+ * `lvgl_port_jobs_parallel_for()` cuts a 2D range into a grid of tiles and deals an equal share of the tiles to each
+ * worker. The caller takes the share of the core it runs on, so its own worker isn't woken up, and the worker of the
+ * other core takes the other share. A worker that runs out of tiles steals them one by one from the end of the other
+ * share, so the shares even out when the tiles don't cost the same. The call returns once every tile has run, as
+ * synchronous as the loop it replaces.
+ *
+ * Each share is a pair of 16-bit tile indices packed into one atomic word: the owner takes tiles from the front and the
+ * thief from the back, both with a compare-and-swap of the whole word, so a tile is never run twice. Dispatch costs a
+ * notification and a semaphore per call, and one compare-and-swap per tile.
+ *
+ * Two workers must not write into the same cache line, or the line bounces between the cores and the writes of one may
+ * be lost when the other one writes its copy back. `lvgl_port_jobs_tile_size()` picks tiles of whole lines of the range
+ * when it can, and otherwise cuts the columns on cache lines; the grid starts at the coordinate `0`, so buffers whose
+ * lines start on cache lines keep the tiles apart.
+ *
+ * One call runs at a time: a call made while another is in progress (from another task, or from inside a tile) runs
+ * its tiles inline instead of waiting. On host builds (no `ESP_PLATFORM`), the workers are threads, the caller always
+ * takes the share of the worker `0`, so the system can be tested and benchmarked off-device.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_JOBS_WORKER_NUM               (2)     // Workers, one per core
+#define LVGL_PORT_JOBS_CACHE_LINE               (32)    // Data cache line of the ESP32-S3, in bytes
+#define LVGL_PORT_JOBS_TILES_PER_WORKER         (8)     // Tiles per worker picked by `lvgl_port_jobs_tile_size()`,
+                                                        // more tiles even the shares out at the cost of more steps
+#define LVGL_PORT_JOBS_TILE_MIN_BYTES           (1024)  // Smallest tile picked by `lvgl_port_jobs_tile_size()`
+#define LVGL_PORT_JOBS_TILE_NUM_MAX             (0xffff)    // Most tiles of a call, the indices are 16-bit
+#define LVGL_PORT_JOBS_STACK_SIZE               (3 * 1024)  // Stack of each worker task, in bytes
+#define LVGL_PORT_JOBS_PRIORITY                 (2)     // Priority of the worker tasks, the same as the LVGL task
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Run one tile, `tile` is inclusive and inside the range of the call
+ *
+ * @param tile      Tile to run
+ * @param worker    Worker running the tile, below `LVGL_PORT_JOBS_WORKER_NUM`, to index per-worker scratch buffers
+ * @param user_data User data of the call
+ */
+typedef void (*lvgl_port_jobs_fn_t)(const lvgl_port_copy_rect_t *tile, int worker, void *user_data);
+
+/**
+ * @brief Statistics of the job system, accumulated since `lvgl_port_jobs_init()`
+ */
+typedef struct {
+    uint32_t runs;                  // Calls spread over the workers
+    uint32_t runs_inline;           // Calls run inline, the workers were busy or not running
+    uint32_t tiles;                 // Tiles run by the calls spread over the workers
+    uint32_t steals;                // Tiles run by the worker they were not dealt to
+    uint64_t wait_us;               // Time the callers waited for the other worker after running out of tiles
+} lvgl_port_jobs_stats_t;
+
+/**
+ * @brief Start one worker per core.
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_jobs_init(void);
+
+/**
+ * @brief Stop the workers, once the call in progress is over. The next calls run inline.
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_jobs_deinit(void);
+
+/**
+ * @brief Pick a tile size for a range of elements of `bytes_per_element` bytes: whole lines of the range if there are
+ *        enough of them, otherwise columns cut on cache lines. The tiles are at least `LVGL_PORT_JOBS_TILE_MIN_BYTES`.
+ *
+ * @param range             Range to cut, inclusive
+ * @param bytes_per_element Size of an element, in bytes
+ * @param tile_w            Width of the tiles, in elements
+ * @param tile_h            Height of the tiles, in elements
+ */
+void lvgl_port_jobs_tile_size(const lvgl_port_copy_rect_t *range, int bytes_per_element, int *tile_w, int *tile_h);
+
+/**
+ * @brief Run `fn` on every tile of a range, over both cores, and return once all tiles have run.
+ *
+ * @note  The grid of tiles starts at the coordinate `0`, so the first and last tiles of each line or column may be
+ *        clipped by the range. A range of more than `LVGL_PORT_JOBS_TILE_NUM_MAX` tiles runs inline.
+ *
+ * @param range     Range to cover, inclusive
+ * @param tile_w    Width of the tiles, in elements
+ * @param tile_h    Height of the tiles, in elements
+ * @param fn        Function run on each tile
+ * @param user_data Passed to `fn`
+ *
+ * @return true if the tiles were spread over the workers, false if they ran inline or the parameters are invalid
+ */
+bool lvgl_port_jobs_parallel_for(
+    const lvgl_port_copy_rect_t *range, int tile_w, int tile_h, lvgl_port_jobs_fn_t fn, void *user_data
+);
+
+/**
+ * @brief Get the statistics of the job system.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_jobs_get_stats(lvgl_port_jobs_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,438 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+#include "lvgl_port_layer.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#undef ESP_UTILS_LOG_TAG
+#define ESP_UTILS_LOG_TAG "LvPort"
+#include "esp_lib_utils.h"
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#define LAYER_NONE          (-1)
+
+/**
+ * Events of the producer, each one is pending until it is waited for, like a binary semaphore
+ */
+typedef enum {
+    LAYER_EVENT_REQUEST,        // A layer was requested, for the producer
+    LAYER_EVENT_READY,          // A layer is over, for the acquires
+    LAYER_EVENT_MAX,
+} layer_event_t;
+
+// Handoff, only accessed under the lock, which is never held while rendering or waiting
+static uint8_t layer_params[LVGL_PORT_LAYER_PARAMS_MAX];    // Parameters of the pending request
+static size_t layer_params_size = 0;
+static uint32_t layer_pending_seq = 0;      // Request not started yet, `0` for none
+static uint32_t layer_writing_seq = 0;      // Request being rendered, `0` for none
+static uint32_t layer_seq[2] = {};          // Frame of the layer in each buffer, `0` while it isn't valid
+static int layer_reading = LAYER_NONE;      // Buffer acquired for the current frame
+static lvgl_port_layer_stats_t layer_stats = {};
+static uint64_t layer_render_us_total = 0;
+
+// Set up by the init, read-only while the producer runs
+static void *layer_bufs[2] = {};
+static int layer_width = 0;
+static int layer_height = 0;
+static lvgl_port_layer_render_cb_t layer_render_cb = nullptr;
+static void *layer_user_data = nullptr;
+static std::atomic<bool> layer_exit(false);
+
+#ifdef ESP_PLATFORM
+
+static portMUX_TYPE layer_spinlock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t layer_events[LAYER_EVENT_MAX] = {};
+static SemaphoreHandle_t layer_stopped = nullptr;
+static TaskHandle_t layer_task = nullptr;
+
+static inline int64_t layer_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+static inline void layer_lock(void)
+{
+    portENTER_CRITICAL(&layer_spinlock);
+}
+
+static inline void layer_unlock(void)
+{
+    portEXIT_CRITICAL(&layer_spinlock);
+}
+
+static void layer_signal(layer_event_t event)
+{
+    xSemaphoreGive(layer_events[event]);
+}
+
+static bool layer_wait(layer_event_t event, int timeout_us)
+{
+    TickType_t timeout_ticks = portMAX_DELAY;
+    if (timeout_us >= 0) {
+        // At least one tick, or a wait shorter than a tick would never wait
+        timeout_ticks = pdMS_TO_TICKS((timeout_us + 999) / 1000);
+        timeout_ticks = (timeout_ticks > 0) ? timeout_ticks : 1;
+    }
+    return (xSemaphoreTake(layer_events[event], timeout_ticks) == pdTRUE);
+}
+
+static void *layer_alloc(size_t size)
+{
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+}
+
+#else
+
+static std::mutex layer_mutex;
+static std::mutex layer_event_mutex;
+static std::condition_variable layer_cond;
+static bool layer_pending[LAYER_EVENT_MAX] = {};
+static std::thread layer_thread;
+
+static inline int64_t layer_time_us(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+           ).count();
+}
+
+static inline void layer_lock(void)
+{
+    layer_mutex.lock();
+}
+
+static inline void layer_unlock(void)
+{
+    layer_mutex.unlock();
+}
+
+static void layer_signal(layer_event_t event)
+{
+    std::lock_guard<std::mutex> lock(layer_event_mutex);
+    layer_pending[event] = true;
+    layer_cond.notify_all();
+}
+
+static bool layer_wait(layer_event_t event, int timeout_us)
+{
+    std::unique_lock<std::mutex> lock(layer_event_mutex);
+    auto pending = [event] { return layer_pending[event]; };
+    if (timeout_us < 0) {
+        layer_cond.wait(lock, pending);
+    } else if (!layer_cond.wait_for(lock, std::chrono::microseconds(timeout_us), pending)) {
+        return false;
+    }
+    layer_pending[event] = false;
+
+    return true;
+}
+
+static void *layer_alloc(size_t size)
+{
+    return malloc(size);
+}
+
+#endif /* ESP_PLATFORM */
+
+/**
+ * @brief Render the pending request, if any
+ *
+ * @return true if a layer was rendered, false if there was no request
+ */
+static bool layer_produce(void)
+{
+    uint8_t params[LVGL_PORT_LAYER_PARAMS_MAX];
+
+    layer_lock();
+    uint32_t seq = layer_pending_seq;
+    if (seq == 0) {
+        layer_unlock();
+        return false;
+    }
+    // The buffer of the current frame is left alone, otherwise the older one, the newer one may be acquired next
+    int buf = (layer_reading != LAYER_NONE) ? (layer_reading ^ 1) : ((layer_seq[0] < layer_seq[1]) ? 0 : 1);
+    memcpy(params, layer_params, layer_params_size);
+    layer_pending_seq = 0;
+    layer_writing_seq = seq;
+    layer_seq[buf] = 0;
+    layer_unlock();
+
+    int64_t start_us = layer_time_us();
+    layer_render_cb(layer_bufs[buf], layer_width, layer_height, params, layer_user_data);
+    uint32_t render_us = (uint32_t)(layer_time_us() - start_us);
+
+    layer_lock();
+    layer_seq[buf] = seq;
+    layer_writing_seq = 0;
+    layer_stats.produced++;
+    layer_render_us_total += render_us;
+    layer_stats.render_us_max = (render_us > layer_stats.render_us_max) ? render_us : layer_stats.render_us_max;
+    layer_unlock();
+    layer_signal(LAYER_EVENT_READY);
+
+    return true;
+}
+
+#ifdef ESP_PLATFORM
+
+static void layer_task_loop(void *arg)
+{
+    while (!layer_exit.load()) {
+        layer_wait(LAYER_EVENT_REQUEST, -1);
+        // A request made while rendering leaves the event pending, so every request is seen
+        layer_produce();
+    }
+    xSemaphoreGive(layer_stopped);
+    vTaskSuspend(nullptr);
+}
+
+#else
+
+static void layer_task_loop(void)
+{
+    while (!layer_exit.load()) {
+        layer_wait(LAYER_EVENT_REQUEST, -1);
+        layer_produce();
+    }
+}
+
+#endif /* ESP_PLATFORM */
+
+static bool layer_setup(
+    int width, int height, int bytes_per_pixel, lvgl_port_layer_render_cb_t render_cb, void *user_data
+)
+{
+    if ((width <= 0) || (height <= 0) || (bytes_per_pixel <= 0) || (render_cb == nullptr)) {
+        return false;
+    }
+    size_t size = (size_t)width * height * bytes_per_pixel;
+    for (int i = 0; i < 2; i++) {
+        layer_bufs[i] = layer_alloc(size);
+        if (layer_bufs[i] == nullptr) {
+            free(layer_bufs[0]);
+            layer_bufs[0] = nullptr;
+            return false;
+        }
+    }
+    layer_width = width;
+    layer_height = height;
+    layer_render_cb = render_cb;
+    layer_user_data = user_data;
+    layer_params_size = 0;
+    layer_pending_seq = 0;
+    layer_writing_seq = 0;
+    layer_seq[0] = 0;
+    layer_seq[1] = 0;
+    layer_reading = LAYER_NONE;
+    layer_stats = {};
+    layer_render_us_total = 0;
+    layer_exit.store(false);
+
+    return true;
+}
+
+static void layer_release_bufs(void)
+{
+    for (int i = 0; i < 2; i++) {
+        free(layer_bufs[i]);
+        layer_bufs[i] = nullptr;
+    }
+    layer_render_cb = nullptr;
+}
+
+#ifdef ESP_PLATFORM
+
+static void layer_delete_events(void)
+{
+    for (int i = 0; i < LAYER_EVENT_MAX; i++) {
+        if (layer_events[i] != nullptr) {
+            vSemaphoreDelete(layer_events[i]);
+            layer_events[i] = nullptr;
+        }
+    }
+    if (layer_stopped != nullptr) {
+        vSemaphoreDelete(layer_stopped);
+        layer_stopped = nullptr;
+    }
+}
+
+bool lvgl_port_layer_init(
+    int width, int height, int bytes_per_pixel, lvgl_port_layer_render_cb_t render_cb, void *user_data, int core
+)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(layer_task == nullptr, false, "Layer producer is already initialized");
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        layer_setup(width, height, bytes_per_pixel, render_cb, user_data), false, "Allocate layer buffers failed"
+    );
+
+    // On a failure, everything set up so far is undone, so that the init can be tried again
+    for (int i = 0; i < LAYER_EVENT_MAX; i++) {
+        layer_events[i] = xSemaphoreCreateBinary();
+        if (layer_events[i] == nullptr) {
+            ESP_UTILS_LOGE("Create layer producer event %d failed", i);
+            layer_delete_events();
+            layer_release_bufs();
+            return false;
+        }
+    }
+    layer_stopped = xSemaphoreCreateBinary();
+    if (layer_stopped == nullptr) {
+        ESP_UTILS_LOGE("Create layer producer semaphore failed");
+        layer_delete_events();
+        layer_release_bufs();
+        return false;
+    }
+    BaseType_t ret = xTaskCreatePinnedToCore(
+                         layer_task_loop, "lvgl_layer", LVGL_PORT_LAYER_STACK_SIZE, nullptr,
+                         LVGL_PORT_LAYER_PRIORITY, &layer_task, (core < 0) ? tskNO_AFFINITY : core
+                     );
+    if (ret != pdPASS) {
+        ESP_UTILS_LOGE("Create layer producer task failed");
+        layer_task = nullptr;
+        layer_delete_events();
+        layer_release_bufs();
+        return false;
+    }
+
+    return true;
+}
+
+bool lvgl_port_layer_deinit(void)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(layer_task, false, "Layer producer is not initialized");
+
+    // The producer finishes its layer, then stops before it waits again
+    layer_exit.store(true);
+    layer_signal(LAYER_EVENT_REQUEST);
+    xSemaphoreTake(layer_stopped, portMAX_DELAY);
+    vTaskDelete(layer_task);
+    layer_task = nullptr;
+    layer_delete_events();
+    layer_release_bufs();
+
+    return true;
+}
+
+#else
+
+bool lvgl_port_layer_init(
+    int width, int height, int bytes_per_pixel, lvgl_port_layer_render_cb_t render_cb, void *user_data, int
+)
+{
+    if (layer_thread.joinable() || !layer_setup(width, height, bytes_per_pixel, render_cb, user_data)) {
+        return false;
+    }
+    for (int i = 0; i < LAYER_EVENT_MAX; i++) {
+        layer_pending[i] = false;
+    }
+    layer_thread = std::thread(layer_task_loop);
+
+    return true;
+}
+
+bool lvgl_port_layer_deinit(void)
+{
+    if (!layer_thread.joinable()) {
+        return false;
+    }
+    layer_exit.store(true);
+    layer_signal(LAYER_EVENT_REQUEST);
+    layer_thread.join();
+    layer_release_bufs();
+
+    return true;
+}
+
+#endif /* ESP_PLATFORM */
+
+bool lvgl_port_layer_request(uint32_t seq, const void *params, size_t params_size)
+{
+    if ((seq == 0) || (params_size > LVGL_PORT_LAYER_PARAMS_MAX) || ((params == nullptr) && (params_size > 0)) ||
+            (layer_render_cb == nullptr)) {
+        return false;
+    }
+
+    layer_lock();
+    if (layer_pending_seq != 0) {
+        layer_stats.skipped++;
+    }
+    if (params_size > 0) {
+        memcpy(layer_params, params, params_size);
+    }
+    layer_params_size = params_size;
+    layer_pending_seq = seq;
+    layer_reading = LAYER_NONE;
+    layer_stats.requests++;
+    layer_unlock();
+    layer_signal(LAYER_EVENT_REQUEST);
+
+    return true;
+}
+
+const void *lvgl_port_layer_acquire(uint32_t seq, int timeout_ms)
+{
+    if ((seq == 0) || (layer_render_cb == nullptr)) {
+        return nullptr;
+    }
+
+    int64_t start_us = layer_time_us();
+    int64_t deadline_us = start_us + (int64_t)timeout_ms * 1000;
+    const void *layer = nullptr;
+
+    while (true) {
+        layer_lock();
+        int buf = (layer_seq[0] == seq) ? 0 : ((layer_seq[1] == seq) ? 1 : LAYER_NONE);
+        if (buf != LAYER_NONE) {
+            layer_reading = buf;
+            layer = layer_bufs[buf];
+            layer_unlock();
+            break;
+        }
+        // Only wait for a layer that is still coming, a skipped one never will
+        bool coming = (layer_pending_seq == seq) || (layer_writing_seq == seq);
+        layer_unlock();
+        int64_t remaining_us = deadline_us - layer_time_us();
+        if (!coming || (remaining_us <= 0) || !layer_wait(LAYER_EVENT_READY, (int)remaining_us)) {
+            break;
+        }
+    }
+
+    layer_lock();
+    if (layer != nullptr) {
+        layer_stats.hits++;
+    } else {
+        layer_stats.misses++;
+    }
+    layer_stats.wait_us += layer_time_us() - start_us;
+    layer_unlock();
+
+    return layer;
+}
+
+void lvgl_port_layer_get_stats(lvgl_port_layer_stats_t *stats)
+{
+    if (stats == nullptr) {
+        return;
+    }
+
+    layer_lock();
+    *stats = layer_stats;
+    stats->render_us_avg = (layer_stats.produced > 0) ? (uint32_t)(layer_render_us_total / layer_stats.produced) : 0;
+    layer_unlock();
+}
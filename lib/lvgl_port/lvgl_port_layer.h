@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Background layer produced ahead of LVGL, on the other core.
+ *
+ * A full-screen background computed in a draw callback (a gradient, a procedural pattern) runs inside LVGL's render
+ * pass, on the core of the LVGL task, one after the other with the widgets. With the producer, the application requests
+ * the layer of frame N+1 with the parameters of that frame (`lvgl_port_layer_request()`), and a producer task on the
+ * other core renders it into a layer buffer in PSRAM while the LVGL task renders and presents frame N. When frame N+1
+ * is rendered, the draw callback acquires the layer of its sequence number (`lvgl_port_layer_acquire()`) and only
+ * copies it, clipped to the draw area.
+ *
+ * There are two layer buffers: the one acquired by the LVGL task for the current frame, and the one the producer
+ * renders into. A request releases the layer of the last frame, so the producer always renders into a buffer nobody
+ * reads. A request made while the producer is busy replaces the request it hasn't started yet, the skipped frame is
+ * never produced. If the layer of a frame is not ready in time, `lvgl_port_layer_acquire()` gives up, and the draw
+ * callback renders that frame inline as before: the producer is allowed to fall behind, it never stalls LVGL longer
+ * than the wait given. The render callback and the inline path should then produce the same pixels.
+ *
+ * On host builds (no `ESP_PLATFORM`), the producer is a thread, so the handoff can be exercised off-device.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_LAYER_PARAMS_MAX              (64)    // Largest parameters of a request, in bytes
+#define LVGL_PORT_LAYER_STACK_SIZE              (4 * 1024)  // Stack of the producer task, in bytes
+#define LVGL_PORT_LAYER_PRIORITY                (1)     // Priority of the producer task, below the LVGL task and the
+                                                        // workers that it waits for on the same core
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Render a layer, called by the producer
+ *
+ * @param layer     Layer buffer, `width` x `height` pixels
+ * @param width     Width of the layer, in pixels
+ * @param height    Height of the layer, in pixels
+ * @param params    Parameters of the request
+ * @param user_data User data of `lvgl_port_layer_init()`
+ */
+typedef void (*lvgl_port_layer_render_cb_t)(void *layer, int width, int height, const void *params, void *user_data);
+
+/**
+ * @brief Statistics of the producer, accumulated since `lvgl_port_layer_init()`
+ */
+typedef struct {
+    uint32_t requests;              // Layers requested
+    uint32_t produced;              // Layers rendered by the producer
+    uint32_t skipped;               // Requests replaced by the next one before the producer started them
+    uint32_t hits;                  // Acquires that got their layer
+    uint32_t misses;                // Acquires that gave up, the frame was rendered inline
+    uint32_t render_us_avg;         // Time of the render callback, per layer
+    uint32_t render_us_max;
+    uint64_t wait_us;               // Time the acquires waited for the producer
+} lvgl_port_layer_stats_t;
+
+/**
+ * @brief Allocate the two layer buffers in PSRAM and start the producer.
+ *
+ * @param width           Width of the layer, in pixels
+ * @param height          Height of the layer, in pixels
+ * @param bytes_per_pixel Size of a pixel, in bytes
+ * @param render_cb       Render callback
+ * @param user_data       Passed to `render_cb`
+ * @param core            Core of the producer task, the one the LVGL task doesn't use, `-1` for any. Ignored on host
+ *                        builds.
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_layer_init(
+    int width, int height, int bytes_per_pixel, lvgl_port_layer_render_cb_t render_cb, void *user_data, int core
+);
+
+/**
+ * @brief Stop the producer once its layer is over, and free the layer buffers. No layer may be in use.
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_layer_deinit(void);
+
+/**
+ * @brief Request the layer of a frame, and release the layer acquired for the last frame.
+ *
+ * @param seq         Sequence number of the frame, increasing and not `0`
+ * @param params      Parameters passed to the render callback, copied
+ * @param params_size Size of the parameters, at most `LVGL_PORT_LAYER_PARAMS_MAX`
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_layer_request(uint32_t seq, const void *params, size_t params_size);
+
+/**
+ * @brief Get the layer of a frame, waiting for the producer if it is being rendered. The layer stays valid until the
+ *        next `lvgl_port_layer_request()`, it can be acquired again for each draw of the frame.
+ *
+ * @param seq        Sequence number of the frame
+ * @param timeout_ms Longest wait for the producer, in milliseconds, `0` not to wait
+ *
+ * @return The layer, or `NULL` if it was skipped or isn't ready in time: render the frame inline
+ */
+const void *lvgl_port_layer_acquire(uint32_t seq, int timeout_ms);
+
+/**
+ * @brief Get the statistics of the producer.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_layer_get_stats(lvgl_port_layer_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,212 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include "lvgl_port_overlay.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+
+#define OVERLAY_FRONT       (0x01)  // Bit of `overlay_state`: the planes read by the compose
+#define OVERLAY_PENDING     (0x02)  // Bit of `overlay_state`: the other planes are ready to be latched
+
+typedef struct {
+    lvgl_port_overlay_sprite_t sprites[LVGL_PORT_OVERLAY_PLANE_MAX];
+    bool visible[LVGL_PORT_OVERLAY_PLANE_MAX];
+    uint8_t order[LVGL_PORT_OVERLAY_PLANE_MAX];     // Visible planes from the bottom to the top
+    int order_num;
+} overlay_frame_t;
+
+static overlay_frame_t overlay_frames[2] = {};
+static std::atomic<uint8_t> overlay_state(0);
+static std::atomic<uint32_t> overlay_positions[LVGL_PORT_OVERLAY_PLANE_MAX] = {};  // Set by the task, `x << 16 | y`
+static uint32_t overlay_frame_positions[LVGL_PORT_OVERLAY_PLANE_MAX] = {};         // Latched by the compose
+
+static inline uint32_t overlay_pack(int x, int y)
+{
+    return ((uint32_t)(uint16_t)x << 16) | (uint16_t)y;
+}
+
+/**
+ * @brief Get the planes that aren't read by the compose, holding the latest state
+ *
+ * @note  Planes waiting to be latched are withdrawn first, so the compose can't latch them while they change.
+ */
+static overlay_frame_t *overlay_begin_update(void)
+{
+    uint8_t state = overlay_state.load(std::memory_order_acquire);
+
+    while (!overlay_state.compare_exchange_weak(state, state & OVERLAY_FRONT, std::memory_order_acq_rel)) {
+    }
+
+    overlay_frame_t *back = &overlay_frames[(state & OVERLAY_FRONT) ^ 1];
+    if (!(state & OVERLAY_PENDING)) {
+        // The back planes are older than the front ones
+        *back = overlay_frames[state & OVERLAY_FRONT];
+    }
+
+    return back;
+}
+
+static void overlay_end_update(overlay_frame_t *frame)
+{
+    // Sort the visible planes by `z`, a stable insertion sort keeps the planes of the same `z` by their index
+    frame->order_num = 0;
+    for (int plane = 0; plane < LVGL_PORT_OVERLAY_PLANE_MAX; plane++) {
+        if (!frame->visible[plane]) {
+            continue;
+        }
+        int i = frame->order_num++;
+        while ((i > 0) && (frame->sprites[frame->order[i - 1]].z > frame->sprites[plane].z)) {
+            frame->order[i] = frame->order[i - 1];
+            i--;
+        }
+        frame->order[i] = plane;
+    }
+    overlay_state.fetch_or(OVERLAY_PENDING, std::memory_order_release);
+}
+
+bool lvgl_port_overlay_show(int plane, const lvgl_port_overlay_sprite_t *sprite, int x, int y)
+{
+    if ((plane < 0) || (plane >= LVGL_PORT_OVERLAY_PLANE_MAX) || (sprite == nullptr) || (sprite->pixels == nullptr) ||
+            (sprite->width == 0) || (sprite->height == 0) ||
+            ((sprite->format == LVGL_PORT_OVERLAY_ALPHA) && (sprite->alpha == nullptr))) {
+        return false;
+    }
+
+    overlay_frame_t *frame = overlay_begin_update();
+    int line_px = sprite->width;
+    for (int i = 0; i < LVGL_PORT_OVERLAY_PLANE_MAX; i++) {
+        line_px += ((i != plane) && frame->visible[i]) ? frame->sprites[i].width : 0;
+    }
+    if (line_px > LVGL_PORT_OVERLAY_LINE_PX_MAX) {
+        // Nothing changed, hand the planes back
+        overlay_state.fetch_or(OVERLAY_PENDING, std::memory_order_release);
+        return false;
+    }
+    frame->sprites[plane] = *sprite;
+    frame->visible[plane] = true;
+    overlay_positions[plane].store(overlay_pack(x, y), std::memory_order_relaxed);
+    overlay_end_update(frame);
+
+    return true;
+}
+
+bool lvgl_port_overlay_hide(int plane)
+{
+    if ((plane < 0) || (plane >= LVGL_PORT_OVERLAY_PLANE_MAX)) {
+        return false;
+    }
+
+    overlay_frame_t *frame = overlay_begin_update();
+    frame->visible[plane] = false;
+    overlay_end_update(frame);
+
+    return true;
+}
+
+bool lvgl_port_overlay_move(int plane, int x, int y)
+{
+    if ((plane < 0) || (plane >= LVGL_PORT_OVERLAY_PLANE_MAX)) {
+        return false;
+    }
+
+    overlay_positions[plane].store(overlay_pack(x, y), std::memory_order_relaxed);
+
+    return true;
+}
+
+/**
+ * @brief Blend two RGB565 pixels, `alpha` from 0 (`bg`) to 32 (`fg`)
+ *
+ * @note  The channels are spread over 32 bits with gaps between them, so they are blended with one multiplication.
+ */
+__attribute__((always_inline))
+static inline uint16_t overlay_blend(uint16_t bg, uint16_t fg, uint32_t alpha)
+{
+    uint32_t b = (bg | ((uint32_t)bg << 16)) & 0x07E0F81F;
+    uint32_t f = (fg | ((uint32_t)fg << 16)) & 0x07E0F81F;
+    uint32_t result = ((((f - b) * alpha) >> 5) + b) & 0x07E0F81F;
+
+    return (uint16_t)((result >> 16) | result);
+}
+
+/**
+ * @brief Blend `len` pixels of a line of a sprite from the column `col`
+ */
+IRAM_ATTR static void overlay_blend_line(
+    const lvgl_port_overlay_sprite_t *sprite, int row, int col, uint16_t *dst, int len
+)
+{
+    const uint16_t *src = sprite->pixels + row * sprite->width + col;
+
+    if (sprite->format == LVGL_PORT_OVERLAY_KEYED) {
+        const uint16_t key = sprite->key;
+        if (sprite->opa == 255) {
+            for (int i = 0; i < len; i++) {
+                if (src[i] != key) {
+                    dst[i] = src[i];
+                }
+            }
+        } else {
+            const uint32_t alpha = (sprite->opa + 4) >> 3;
+            for (int i = 0; i < len; i++) {
+                if (src[i] != key) {
+                    dst[i] = overlay_blend(dst[i], src[i], alpha);
+                }
+            }
+        }
+        return;
+    }
+
+    const uint8_t *alpha = sprite->alpha + row * sprite->width + col;
+    const uint32_t opa = sprite->opa + 1;
+    for (int i = 0; i < len; i++) {
+        // Scale the alpha by the opacity, then down to 5 bits with 255 still opaque
+        uint32_t a = (((alpha[i] * opa) >> 8) + 4) >> 3;
+        if (a != 0) {
+            dst[i] = overlay_blend(dst[i], src[i], a);
+        }
+    }
+}
+
+IRAM_ATTR void lvgl_port_overlay_compose(void *dst, int x, int y, int len_px, void *)
+{
+    uint8_t state = overlay_state.load(std::memory_order_acquire);
+
+    if ((x == 0) && (y == 0)) {
+        // A new frame starts, latch the pending planes unless they are being withdrawn, and the positions
+        if (state & OVERLAY_PENDING) {
+            uint8_t latched = (state & OVERLAY_FRONT) ^ 1;
+            if (overlay_state.compare_exchange_strong(state, latched, std::memory_order_acq_rel)) {
+                state = latched;
+            }
+        }
+        for (int i = 0; i < LVGL_PORT_OVERLAY_PLANE_MAX; i++) {
+            overlay_frame_positions[i] = overlay_positions[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    const overlay_frame_t *frame = &overlay_frames[state & OVERLAY_FRONT];
+    const int end = x + len_px;
+    for (int n = 0; n < frame->order_num; n++) {
+        const int plane = frame->order[n];
+        const lvgl_port_overlay_sprite_t *sprite = &frame->sprites[plane];
+        const int sprite_x = (int16_t)(overlay_frame_positions[plane] >> 16);
+        const int row = y - (int16_t)(overlay_frame_positions[plane] & 0xFFFF);
+        if ((row < 0) || (row >= sprite->height)) {
+            continue;
+        }
+        const int from = (sprite_x > x) ? sprite_x : x;
+        const int to = (sprite_x + sprite->width < end) ? (sprite_x + sprite->width) : end;
+        if (from < to) {
+            overlay_blend_line(sprite, row, from - sprite_x, (uint16_t *)dst + (from - x), to - from);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Overlay planes composed at scanout, as a compose callback of `lvgl_port_scanout.h`.
+ *
+ * Each plane shows a small sprite (a cursor, a touch indicator, an FPS counter) on top of whatever the scanout
+ * produces, blended into the bounce buffer line by line. Moving a plane only changes its position, nothing is
+ * rendered or written into a frame buffer, and LVGL doesn't invalidate anything. The planes are stacked by their
+ * `z`, and both the sprites and the positions are picked up at the start of the next scanned frame, so they never
+ * tear.
+ *
+ * Sprites are RGB565, either keyed (the key color is transparent) or with an 8-bit alpha per pixel, and a global
+ * opacity. They are read by the ISR, so they should be in internal RAM, and must stay valid until the frame after they
+ * are replaced or hidden.
+ *
+ * The cost per line is bounded: the sum of the widths of the visible sprites can't exceed
+ * `LVGL_PORT_OVERLAY_LINE_PX_MAX`, wherever they are. A line with every plane on it is then at most that many blended
+ * pixels on top of its refill, which is the budget to check against the deadline with `lvgl_port_scanout_sim_fill()`.
+ *
+ * The planes are changed from one task at a time.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_OVERLAY_PLANE_MAX             (4)     // Number of overlay planes
+#define LVGL_PORT_OVERLAY_LINE_PX_MAX           (256)   // Maximum sum of the widths of the visible sprites, in pixels
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Transparency of a sprite
+ */
+typedef enum {
+    LVGL_PORT_OVERLAY_KEYED = 0,    // The pixels of the key color are transparent
+    LVGL_PORT_OVERLAY_ALPHA,        // Each pixel has an 8-bit alpha
+} lvgl_port_overlay_format_t;
+
+/**
+ * @brief Sprite of an overlay plane
+ */
+typedef struct {
+    lvgl_port_overlay_format_t format;
+    const uint16_t *pixels;         // `width * height` pixels, RGB565
+    const uint8_t *alpha;           // `width * height` alpha values, only for `LVGL_PORT_OVERLAY_ALPHA`
+    uint16_t width;
+    uint16_t height;
+    uint16_t key;                   // Transparent color, only for `LVGL_PORT_OVERLAY_KEYED`
+    uint8_t opa;                    // Opacity of the whole sprite, 255 for opaque
+    int8_t z;                       // Stacking order, higher is on top, planes of the same `z` by their index
+} lvgl_port_overlay_sprite_t;
+
+/**
+ * @brief Show a sprite on a plane from the next scanned frame, replacing the previous one.
+ *
+ * @param plane  Index of the plane, below `LVGL_PORT_OVERLAY_PLANE_MAX`
+ * @param sprite Sprite, copied, its pixels are not
+ * @param x      Position of the top-left corner on the screen, may be partly outside
+ * @param y
+ *
+ * @return true if success, otherwise false (invalid sprite, or the visible sprites would exceed
+ *         `LVGL_PORT_OVERLAY_LINE_PX_MAX`)
+ */
+bool lvgl_port_overlay_show(int plane, const lvgl_port_overlay_sprite_t *sprite, int x, int y);
+
+/**
+ * @brief Hide a plane from the next scanned frame.
+ *
+ * @param plane Index of the plane
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_overlay_hide(int plane);
+
+/**
+ * @brief Move a plane from the next scanned frame, the only cost of an animated overlay.
+ *
+ * @param plane Index of the plane
+ * @param x     Position of the top-left corner on the screen
+ * @param y
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_overlay_move(int plane, int x, int y);
+
+/**
+ * @brief Compose callback blending the visible planes, see `lvgl_port_scanout_compose_cb_t`. `user_data` is not used.
+ */
+void lvgl_port_overlay_compose(void *dst, int x, int y, int len_px, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
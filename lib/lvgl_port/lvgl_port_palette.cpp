@@ -0,0 +1,212 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include <string.h>
+#include "lvgl_port_palette.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+
+#define PALETTE_FRONT       (0x01)  // Bit of `palette_state`: the palette read by the fill
+#define PALETTE_PENDING     (0x02)  // Bit of `palette_state`: the other palette is ready to be latched
+#define PALETTE_DITHER_SIZE (4)     // Width and height of the ordered dither matrix
+
+typedef struct {
+    uint16_t colors[2][LVGL_PORT_PALETTE_SIZE];
+} palette_table_t;
+
+/**
+ * @brief Lookup tables of the ordered dither, by position in the matrix and channel value, holding the bits of the
+ *        channel in the index
+ */
+typedef struct {
+    uint8_t r[PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE][32];
+    uint8_t g[PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE][64];
+    uint8_t b[PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE][32];
+} palette_dither_t;
+
+static constexpr uint16_t palette_expand_rgb332(int index)
+{
+    return (((((index >> 5) & 0x07) * 31 + 3) / 7) << 11) | (((((index >> 2) & 0x07) * 63 + 3) / 7) << 5) |
+           (((index & 0x03) * 31 + 1) / 3);
+}
+
+static constexpr palette_table_t palette_table_init(void)
+{
+    palette_table_t table = {};
+
+    for (int i = 0; i < LVGL_PORT_PALETTE_SIZE; i++) {
+        table.colors[0][i] = palette_expand_rgb332(i);
+        table.colors[1][i] = table.colors[0][i];
+    }
+
+    return table;
+}
+
+/**
+ * @brief Quantize a channel from `0..max` to the palette levels `0..levels`, with the threshold `threshold / 16` of
+ *        the dither between the two nearest levels, so the colors of the palette are kept as they are
+ */
+static constexpr uint8_t palette_quantize(int value, int max, int levels, int threshold)
+{
+    // Same rounding as `palette_expand_rgb332()`
+    int level = 0;
+    while ((level < levels) && (((level + 1) * max + levels / 2) / levels <= value)) {
+        level++;
+    }
+    if (level == levels) {
+        return level;
+    }
+    int low = (level * max + levels / 2) / levels;
+    int high = ((level + 1) * max + levels / 2) / levels;
+
+    return level + (((value - low) * 32) > ((2 * threshold + 1) * (high - low)));
+}
+
+static constexpr palette_dither_t palette_dither_init(void)
+{
+    const uint8_t bayer[PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE] = {
+        0, 8, 2, 10,
+        12, 4, 14, 6,
+        3, 11, 1, 9,
+        15, 7, 13, 5,
+    };
+    palette_dither_t dither = {};
+
+    for (int p = 0; p < PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE; p++) {
+        for (int v = 0; v < 32; v++) {
+            dither.r[p][v] = palette_quantize(v, 31, 7, bayer[p]) << 5;
+            dither.b[p][v] = palette_quantize(v, 31, 3, bayer[p]);
+        }
+        for (int v = 0; v < 64; v++) {
+            dither.g[p][v] = palette_quantize(v, 63, 7, bayer[p]) << 2;
+        }
+    }
+
+    return dither;
+}
+
+// Both are read often enough to stay in internal RAM, the palette is also read by the ISR
+static palette_table_t palette_table = palette_table_init();
+static palette_dither_t palette_dither = palette_dither_init();
+static std::atomic<uint8_t> palette_state(0);
+static const uint8_t *palette_indices = nullptr;
+static uint16_t palette_width = 0;
+static uint16_t palette_height = 0;
+
+bool lvgl_port_palette_init(void *indices, uint16_t width, uint16_t height)
+{
+    if ((indices == nullptr) || (width == 0) || (height == 0)) {
+        return false;
+    }
+
+    palette_width = width;
+    palette_height = height;
+    palette_indices = (const uint8_t *)indices;
+
+    return true;
+}
+
+void lvgl_port_palette_deinit(void)
+{
+    palette_indices = nullptr;
+    palette_width = 0;
+    palette_height = 0;
+}
+
+bool lvgl_port_palette_set(const uint16_t *colors, int first, int num)
+{
+    if ((colors == nullptr) || (first < 0) || (num < 0) || (first + num > LVGL_PORT_PALETTE_SIZE)) {
+        return false;
+    }
+
+    // Withdraw a palette waiting to be latched, then the front one can't change until `PALETTE_PENDING` is set again
+    uint8_t state = palette_state.load(std::memory_order_acquire);
+    while (!palette_state.compare_exchange_weak(state, state & PALETTE_FRONT, std::memory_order_acq_rel)) {
+    }
+
+    uint16_t *back = palette_table.colors[(state & PALETTE_FRONT) ^ 1];
+    if (!(state & PALETTE_PENDING)) {
+        // The back palette is older than the front one
+        memcpy(back, palette_table.colors[state & PALETTE_FRONT], sizeof(palette_table.colors[0]));
+    }
+    memcpy(back + first, colors, num * sizeof(uint16_t));
+    palette_state.fetch_or(PALETTE_PENDING, std::memory_order_release);
+
+    return true;
+}
+
+uint16_t lvgl_port_palette_rgb332(uint8_t index)
+{
+    return palette_expand_rgb332(index);
+}
+
+void lvgl_port_palette_convert(
+    uint8_t *dst, int dst_stride, const uint16_t *src, int src_stride, int x, int y, int width, int height
+)
+{
+    for (int row = 0; row < height; row++) {
+        const int line = ((y + row) & (PALETTE_DITHER_SIZE - 1)) * PALETTE_DITHER_SIZE;
+        for (int i = 0; i < width; i++) {
+            const int p = line + ((x + i) & (PALETTE_DITHER_SIZE - 1));
+            uint16_t pixel = src[i];
+            dst[i] = palette_dither.r[p][pixel >> 11] | palette_dither.g[p][(pixel >> 5) & 0x3F] |
+                     palette_dither.b[p][pixel & 0x1F];
+        }
+        dst += dst_stride;
+        src += src_stride;
+    }
+}
+
+IRAM_ATTR void lvgl_port_palette_expand(uint16_t *dst, const uint8_t *src, int len, const uint16_t *palette)
+{
+    // Read the indices a word at a time, PSRAM is much faster with 32-bit accesses
+    while ((len > 0) && ((uintptr_t)src & 0x03)) {
+        *dst++ = palette[*src++];
+        len--;
+    }
+    const uint32_t *words = (const uint32_t *)src;
+    for (; len >= 4; len -= 4) {
+        uint32_t word = *words++;
+        dst[0] = palette[word & 0xFF];
+        dst[1] = palette[(word >> 8) & 0xFF];
+        dst[2] = palette[(word >> 16) & 0xFF];
+        dst[3] = palette[word >> 24];
+        dst += 4;
+    }
+    src = (const uint8_t *)words;
+    while (len-- > 0) {
+        *dst++ = palette[*src++];
+    }
+}
+
+IRAM_ATTR void lvgl_port_palette_fill(void *dst, const void *src, int x, int y, int len_px, void *)
+{
+    uint8_t state = palette_state.load(std::memory_order_acquire);
+
+    if ((x == 0) && (y == 0) && (state & PALETTE_PENDING)) {
+        // A new frame starts, latch the pending palette unless it is being withdrawn
+        uint8_t latched = (state & PALETTE_FRONT) ^ 1;
+        if (palette_state.compare_exchange_strong(state, latched, std::memory_order_acq_rel)) {
+            state = latched;
+        }
+    }
+
+    const uint8_t *indices = palette_indices;
+    if ((indices == nullptr) || (y >= palette_height)) {
+        if (src != nullptr) {
+            memcpy(dst, src, len_px * sizeof(uint16_t));
+        }
+        return;
+    }
+    lvgl_port_palette_expand(
+        (uint16_t *)dst, indices + (size_t)y * palette_width + x, len_px, palette_table.colors[state & PALETTE_FRONT]
+    );
+}
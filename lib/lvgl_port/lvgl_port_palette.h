@@ -0,0 +1,103 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Frame buffer of 8-bit color indices, expanded to RGB565 at scanout through a palette of 256 colors.
+ *
+ * The frame buffer in PSRAM holds one byte per pixel, so both its writes and the reads of the scanout are halved. The
+ * fill callback `lvgl_port_palette_fill()` (see `lvgl_port_scanout.h`) looks every index up in the palette, which
+ * lives in internal RAM, while it refills the bounce buffer.
+ *
+ * The indices are RGB332 (`RRRGGGBB`), and the palette starts as their expansion to RGB565. Pixels are converted into
+ * indices with a 4x4 ordered dither (`lvgl_port_palette_convert()`), which hides most of the banding of the 256-color
+ * cube in smooth content. Rewriting palette entries (`lvgl_port_palette_set()`) recolors every pixel with that index
+ * on the whole screen without rendering anything, for color cycling or fades. A new palette is picked up at the start
+ * of the next scanned frame, so it never tears.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_PALETTE_SIZE                  (256)   // Number of colors of the palette
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Use a frame buffer of indices. The palette keeps its colors, RGB332 until the first
+ *        `lvgl_port_palette_set()`.
+ *
+ * @param indices Frame buffer, `width * height` bytes
+ * @param width   Width of the screen, in pixels
+ * @param height  Height of the screen, in pixels
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_palette_init(void *indices, uint16_t width, uint16_t height);
+
+/**
+ * @brief Stop using the frame buffer of indices, the fill callback must be detached first.
+ */
+void lvgl_port_palette_deinit(void);
+
+/**
+ * @brief Change colors of the palette, shown from the next scanned frame.
+ *
+ * @param colors Colors, RGB565
+ * @param first  First index to change
+ * @param num    Number of colors, `first + num` up to `LVGL_PORT_PALETTE_SIZE`
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_palette_set(const uint16_t *colors, int first, int num);
+
+/**
+ * @brief Get the RGB565 color of an index in the initial palette.
+ */
+uint16_t lvgl_port_palette_rgb332(uint8_t index);
+
+/**
+ * @brief Convert RGB565 pixels into indices of the initial palette, with an ordered dither.
+ *
+ * @param dst        Indices
+ * @param dst_stride Indices per line of `dst`
+ * @param src        Pixels, RGB565
+ * @param src_stride Pixels per line of `src`
+ * @param x          Screen position of the first pixel, which sets the phase of the dither
+ * @param y
+ * @param width      Pixels per line to convert
+ * @param height     Lines to convert
+ */
+void lvgl_port_palette_convert(
+    uint8_t *dst, int dst_stride, const uint16_t *src, int src_stride, int x, int y, int width, int height
+);
+
+/**
+ * @brief Expand indices into RGB565 pixels, the kernel of `lvgl_port_palette_fill()`.
+ *
+ * @param dst     Pixels, `len` of them
+ * @param src     Indices
+ * @param len     Number of pixels
+ * @param palette `LVGL_PORT_PALETTE_SIZE` colors
+ */
+void lvgl_port_palette_expand(uint16_t *dst, const uint8_t *src, int len, const uint16_t *palette);
+
+/**
+ * @brief Fill callback expanding the frame buffer of indices, see `lvgl_port_scanout_fill_cb_t`. The indices are read
+ *        from the frame buffer of `lvgl_port_palette_init()`, `src` is only copied when there is none. `user_data` is
+ *        not used.
+ */
+void lvgl_port_palette_fill(void *dst, const void *src, int x, int y, int len_px, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
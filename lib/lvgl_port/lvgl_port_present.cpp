@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include "lvgl_port_present.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#else
+#include <mutex>
+#define IRAM_ATTR
+#endif
+
+static int present_buffer_num = 2;
+static std::atomic<int> present_mode(LVGL_PORT_PRESENT_FIFO);
+static std::atomic<bool> present_queued(false);      // A frame has been switched to but not latched yet
+static std::atomic<bool> present_deferred(false);    // The flush of the queued frame waits for the vsync
+static int64_t present_submit_us = 0;                // Under the stats lock
+static lvgl_port_present_stats_t present_stats = {}; // Updated from the vsync ISR, under the stats lock
+
+#ifdef ESP_PLATFORM
+static portMUX_TYPE present_stats_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+// The 64-bit fields take two stores on the Xtensa, a reader must not see one without the other
+IRAM_ATTR static inline void present_stats_lock(void)
+{
+    portENTER_CRITICAL_SAFE(&present_stats_spinlock);
+}
+
+IRAM_ATTR static inline void present_stats_unlock(void)
+{
+    portEXIT_CRITICAL_SAFE(&present_stats_spinlock);
+}
+#else
+static std::mutex present_stats_mutex;
+
+static inline void present_stats_lock(void)
+{
+    present_stats_mutex.lock();
+}
+
+static inline void present_stats_unlock(void)
+{
+    present_stats_mutex.unlock();
+}
+#endif
+
+static lvgl_port_present_mode_t present_effective_mode(lvgl_port_present_mode_t mode)
+{
+    // Rendering never waits only if there is a buffer that is neither on screen nor pending
+    if ((mode == LVGL_PORT_PRESENT_MAILBOX) && (present_buffer_num < 3)) {
+        return LVGL_PORT_PRESENT_FIFO;
+    }
+    return mode;
+}
+
+void lvgl_port_present_init(int buffer_num, lvgl_port_present_mode_t mode, int64_t now_us)
+{
+    present_buffer_num = buffer_num;
+    present_queued.store(false);
+    present_deferred.store(false);
+    lvgl_port_present_set_mode(mode, now_us);
+}
+
+lvgl_port_present_mode_t lvgl_port_present_set_mode(lvgl_port_present_mode_t mode, int64_t now_us)
+{
+    mode = present_effective_mode(mode);
+    present_mode.store(mode);
+    lvgl_port_present_reset_stats(now_us);
+
+    return mode;
+}
+
+lvgl_port_present_mode_t lvgl_port_present_get_mode(void)
+{
+    return (lvgl_port_present_mode_t)present_mode.load();
+}
+
+static void present_queue(int64_t now_us)
+{
+    present_stats_lock();
+    present_stats.submitted++;
+    if (present_queued.exchange(true)) {
+        // Only mailbox and immediate modes can submit again before the vsync, the pending frame is never shown
+        present_stats.dropped++;
+    }
+    present_submit_us = now_us;
+    present_stats_unlock();
+}
+
+bool lvgl_port_present_submit(int64_t now_us)
+{
+    present_queue(now_us);
+
+    if (present_mode.load() == LVGL_PORT_PRESENT_FIFO) {
+        present_deferred.store(true);
+        return false;
+    }
+
+    return true;
+}
+
+void lvgl_port_present_submit_spare(int64_t now_us)
+{
+    present_queue(now_us);
+}
+
+bool lvgl_port_present_is_queued(void)
+{
+    return present_queued.load();
+}
+
+IRAM_ATTR bool lvgl_port_present_on_vsync(int64_t now_us)
+{
+    present_stats_lock();
+    present_stats.vsyncs++;
+    if (present_queued.exchange(false)) {
+        uint32_t latency_us = (uint32_t)(now_us - present_submit_us);
+        present_stats.presented++;
+        present_stats.latency_us_sum += latency_us;
+        if (latency_us > present_stats.latency_us_max) {
+            present_stats.latency_us_max = latency_us;
+        }
+    }
+    present_stats_unlock();
+
+    return present_deferred.exchange(false);
+}
+
+void lvgl_port_present_add_wait(int64_t wait_us)
+{
+    present_stats_lock();
+    present_stats.render_wait_us += wait_us;
+    present_stats_unlock();
+}
+
+void lvgl_port_present_get_stats(lvgl_port_present_stats_t *stats)
+{
+    if (stats != nullptr) {
+        present_stats_lock();
+        *stats = present_stats;
+        present_stats_unlock();
+        stats->mode = (lvgl_port_present_mode_t)present_mode.load();
+    }
+}
+
+void lvgl_port_present_reset_stats(int64_t now_us)
+{
+    present_stats_lock();
+    present_stats = {};
+    present_stats.start_us = now_us;
+    present_stats_unlock();
+}
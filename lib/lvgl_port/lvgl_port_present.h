@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Present queue: decides when a flushed frame gives its buffers back to LVGL.
+ *
+ * `flush_callback()` switches the LCD frame buffer and submits the frame here, then returns immediately. Depending on
+ * the present mode, `lv_disp_flush_ready()` is either called right away or deferred to the vsync ISR that latches the
+ * frame. LVGL itself waits for the flush (through `wait_cb`) only when it actually needs the buffer again, so the LVGL
+ * task keeps handling input and timers in the meantime.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    LVGL_PORT_PRESENT_FIFO = 0,     // Vsync-locked: every frame is shown, rendering waits until a buffer is free
+    LVGL_PORT_PRESENT_MAILBOX,      // The latest frame replaces a pending one, rendering never waits (3 buffers)
+    LVGL_PORT_PRESENT_IMMEDIATE,    // Buffers are given back right after the switch, may tear with 2 buffers
+} lvgl_port_present_mode_t;
+
+/**
+ * @brief Statistics of the present queue, accumulated since the last mode change or reset
+ */
+typedef struct {
+    lvgl_port_present_mode_t mode;  // Effective mode, `MAILBOX` falls back to `FIFO` with less than 3 buffers
+    uint32_t submitted;             // Frames submitted by `flush_callback()`
+    uint32_t presented;             // Frames latched by a vsync
+    uint32_t dropped;               // Frames replaced by a newer one before any vsync
+    uint32_t vsyncs;                // Vsyncs seen
+    uint64_t latency_us_sum;        // Sum of submit-to-vsync latencies of the presented frames
+    uint32_t latency_us_max;        // Maximum submit-to-vsync latency
+    uint64_t render_wait_us;        // Time LVGL spent waiting for a deferred flush
+    int64_t start_us;               // Time of the last mode change or reset
+} lvgl_port_present_stats_t;
+
+/**
+ * @brief Initialize the present queue.
+ *
+ * @param buffer_num Number of LCD frame buffers
+ * @param mode       Initial present mode
+ * @param now_us     Current time, in microseconds
+ */
+void lvgl_port_present_init(int buffer_num, lvgl_port_present_mode_t mode, int64_t now_us);
+
+/**
+ * @brief Change the present mode. Statistics are reset. A deferred flush still completes at the next vsync.
+ *
+ * @param mode   New present mode
+ * @param now_us Current time, in microseconds
+ *
+ * @return The effective mode
+ */
+lvgl_port_present_mode_t lvgl_port_present_set_mode(lvgl_port_present_mode_t mode, int64_t now_us);
+
+/**
+ * @brief Get the effective present mode.
+ */
+lvgl_port_present_mode_t lvgl_port_present_get_mode(void);
+
+/**
+ * @brief Submit a frame whose LCD frame buffer has just been switched to.
+ *
+ * @param now_us Current time, in microseconds
+ *
+ * @return true if the flush is complete now, false if it is completed by `lvgl_port_present_on_vsync()`
+ */
+bool lvgl_port_present_submit(int64_t now_us);
+
+/**
+ * @brief Submit a frame like `lvgl_port_present_submit()`, for a mode that still has a spare buffer to render the next
+ *        frame into, neither on screen nor pending. The flush is complete now whatever the mode.
+ *
+ * @note  In FIFO mode, the next frame must not be switched to before this one is latched, see
+ *        `lvgl_port_present_is_queued()`.
+ *
+ * @param now_us Current time, in microseconds
+ */
+void lvgl_port_present_submit_spare(int64_t now_us);
+
+/**
+ * @brief Check whether the last submitted frame still waits for its vsync.
+ */
+bool lvgl_port_present_is_queued(void);
+
+/**
+ * @brief Handle a vsync, called from the vsync ISR.
+ *
+ * @param now_us Current time, in microseconds
+ *
+ * @return true if a deferred flush must be completed now with `lv_disp_flush_ready()`
+ */
+bool lvgl_port_present_on_vsync(int64_t now_us);
+
+/**
+ * @brief Account time LVGL spent waiting for a deferred flush.
+ *
+ * @param wait_us Waited time, in microseconds
+ */
+void lvgl_port_present_add_wait(int64_t wait_us);
+
+/**
+ * @brief Get the statistics.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_present_get_stats(lvgl_port_present_stats_t *stats);
+
+/**
+ * @brief Reset the statistics.
+ *
+ * @param now_us Current time, in microseconds
+ */
+void lvgl_port_present_reset_stats(int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
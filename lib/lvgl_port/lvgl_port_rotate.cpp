@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lvgl_port_rotate.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#else
+#define IRAM_ATTR
+#endif
+
+static int rotate_degree = 0;                   // `0` while not rotating
+static uint16_t rotate_width = 0;               // Width of the panel, the height of LVGL's frame for 90/270
+static uint16_t rotate_height = 0;
+static uint16_t *rotate_band = nullptr;         // Lines of the panel transposed from the frame buffer, for 90/270
+static size_t rotate_band_size = 0;
+static int rotate_band_y = -1;                  // First line of the panel in `rotate_band`, `-1` if none
+static int rotate_band_lines = 0;
+
+bool lvgl_port_rotate_init(int degree, uint16_t width, uint16_t height)
+{
+    if (((degree != 90) && (degree != 180) && (degree != 270)) || (width == 0) || (height == 0)) {
+        return false;
+    }
+
+    size_t size = (size_t)width * LVGL_PORT_ROTATE_BAND_LINES * sizeof(uint16_t);
+    if ((degree != 180) && (size > rotate_band_size)) {
+        // The fill reads the band from the ISR, keep it in internal RAM
+#ifdef ESP_PLATFORM
+        uint16_t *band = (uint16_t *)heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#else
+        uint16_t *band = (uint16_t *)malloc(size);
+#endif
+        if (band == nullptr) {
+            return false;
+        }
+        free(rotate_band);
+        rotate_band = band;
+        rotate_band_size = size;
+    }
+    rotate_width = width;
+    rotate_height = height;
+    rotate_band_y = -1;
+    rotate_degree = degree;
+
+    return true;
+}
+
+void lvgl_port_rotate_deinit(void)
+{
+    // The band is kept, a refill in flight may still read it
+    rotate_degree = 0;
+    rotate_band_y = -1;
+}
+
+/**
+ * @brief Copy `len` pixels of a line read backwards, from `src_last` down
+ *
+ * @note  When both sides are aligned, pairs of pixels are read and written as words with their halves swapped.
+ */
+IRAM_ATTR static void rotate_line_reverse(uint16_t *dst, const uint16_t *src_last, int len)
+{
+    if ((((uintptr_t)dst | (uintptr_t)(src_last - 1)) & 3) == 0) {
+        for (; len >= 2; len -= 2) {
+            uint32_t pair = *(const uint32_t *)(src_last - 1);
+            *(uint32_t *)dst = (pair >> 16) | (pair << 16);
+            dst += 2;
+            src_last -= 2;
+        }
+    }
+    for (int i = 0; i < len; i++) {
+        dst[i] = src_last[-i];
+    }
+}
+
+/**
+ * @brief Transpose the lines `[band_y, band_y + lines)` of the panel into the band
+ *
+ * @note  LVGL's frame is `rotate_height` pixels wide. At 90 degrees, the pixel `(x, y)` of the panel is the pixel
+ *        `(rotate_height - 1 - y, x)` of LVGL's frame, and at 270 degrees the pixel `(y, rotate_width - 1 - x)`. So
+ *        the band reads the same `lines` pixels of every line of LVGL's frame, and two of them at a time, to write
+ *        the band in words.
+ */
+template <int Degree>
+IRAM_ATTR static void rotate_transpose_band(const uint16_t *fb, int band_y, int lines)
+{
+    const int width = rotate_width;
+    const int height = rotate_height;
+    const ptrdiff_t row_step = (Degree == 90) ? height : -(ptrdiff_t)height;
+    const uint16_t *row = fb + ((Degree == 90) ? (ptrdiff_t)(height - band_y - lines) :
+                                ((ptrdiff_t)(width - 1) * height + band_y));
+    uint16_t *band = rotate_band;
+    int x = 0;
+
+    // The lines of the band are only word-aligned if the width is even
+    for (; !(width & 1) && (x < width); x += 2) {
+        const uint16_t *row0 = row;
+        const uint16_t *row1 = row + row_step;
+        uint32_t *dst = (uint32_t *)(band + x);
+        for (int j = 0; j < lines; j++) {
+            int i = (Degree == 90) ? (lines - 1 - j) : j;
+            *dst = row0[i] | ((uint32_t)row1[i] << 16);
+            dst += width / 2;
+        }
+        row += 2 * row_step;
+    }
+    for (; x < width; x++) {
+        for (int j = 0; j < lines; j++) {
+            band[j * width + x] = row[(Degree == 90) ? (lines - 1 - j) : j];
+        }
+        row += row_step;
+    }
+}
+
+IRAM_ATTR void lvgl_port_rotate_fill(void *dst, const void *src, int x, int y, int len_px, void *)
+{
+    const int degree = rotate_degree;
+
+    if ((degree == 0) || (src == nullptr) || (y >= rotate_height)) {
+        return;
+    }
+
+    const int width = rotate_width;
+    const uint16_t *fb = (const uint16_t *)src - ((size_t)y * width + x);
+    if (degree == 180) {
+        rotate_line_reverse(
+            (uint16_t *)dst, fb + (size_t)(rotate_height - 1 - y) * width + (width - 1 - x), len_px
+        );
+        return;
+    }
+
+    // A new frame may come from another frame buffer, the band of the last one is stale
+    if (((x == 0) && (y == 0)) || (rotate_band_y < 0) || (y < rotate_band_y) ||
+            (y >= rotate_band_y + rotate_band_lines)) {
+        int band_y = y - y % LVGL_PORT_ROTATE_BAND_LINES;
+        int lines = rotate_height - band_y;
+        lines = (lines < LVGL_PORT_ROTATE_BAND_LINES) ? lines : LVGL_PORT_ROTATE_BAND_LINES;
+        if (degree == 90) {
+            rotate_transpose_band<90>(fb, band_y, lines);
+        } else {
+            rotate_transpose_band<270>(fb, band_y, lines);
+        }
+        rotate_band_y = band_y;
+        rotate_band_lines = lines;
+    }
+    memcpy(dst, rotate_band + (size_t)(y - rotate_band_y) * width + x, len_px * sizeof(uint16_t));
+}
@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Rotation of LVGL's frame applied at scanout, instead of a rotated copy into another frame buffer.
+ *
+ * LVGL renders into the frame buffers in its own orientation, and the fill callback `lvgl_port_rotate_fill()` (see
+ * `lvgl_port_scanout.h`) reads them rotated while it refills the bounce buffers. The frame buffer that LVGL renders
+ * into before the rotated copy is no longer needed, and neither is the copy: a full-screen frame is written and read
+ * once in PSRAM, like without rotation, instead of being read and written a second time by the copy.
+ *
+ *      - 180 degrees: each line of the panel is a line of LVGL's frame read backwards, from the last line up
+ *      - 90/270 degrees: each line of the panel is a column of LVGL's frame, which would cost one PSRAM access per
+ *        pixel. The lines are rather produced in bands of `LVGL_PORT_ROTATE_BAND_LINES`: the band is the same short
+ *        span of every line of LVGL's frame (`LVGL_PORT_ROTATE_BAND_LINES` pixels, one cache line), transposed into
+ *        SRAM when the refill reaches it, and the lines of the panel are then copied from there.
+ *
+ * The frame buffers are read in the layout of LVGL's frame (`height` x `width` for 90/270), through the pointer the
+ * scanout hands to the fill callback, so the frame buffer being scanned out can change every frame. The colors are
+ * RGB565, `lvgl_port_rotate_fill()` only supports 16-bit frame buffers.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_ROTATE_BAND_LINES             (16)    // Lines of the panel transposed at once for 90/270 degrees,
+                                                        // `width * LVGL_PORT_ROTATE_BAND_LINES` pixels of SRAM
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Rotate the frame buffers at scanout. The band of 90/270 degrees is allocated in internal RAM, and kept for
+ *        the next init once allocated.
+ *
+ * @param degree Rotation of LVGL's frame, 90, 180 or 270, like `Rotate<>` of `lvgl_port_pipeline.hpp`
+ * @param width  Width of the panel, in pixels
+ * @param height Height of the panel, in pixels
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_rotate_init(int degree, uint16_t width, uint16_t height);
+
+/**
+ * @brief Stop rotating, the fill callback must be detached first.
+ */
+void lvgl_port_rotate_deinit(void);
+
+/**
+ * @brief Fill callback reading the frame buffer rotated, see `lvgl_port_scanout_fill_cb_t`. `src` only locates the
+ *        frame buffer being scanned out, nothing is filled when there is none. `user_data` is not used.
+ */
+void lvgl_port_rotate_fill(void *dst, const void *src, int x, int y, int len_px, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
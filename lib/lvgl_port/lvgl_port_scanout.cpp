@@ -0,0 +1,456 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include <string.h>
+#include "lvgl_port_scanout.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_lcd_panel_rgb.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#undef ESP_UTILS_LOG_TAG
+#define ESP_UTILS_LOG_TAG "LvPort"
+#include "esp_lib_utils.h"
+#else
+#include <chrono>
+#include <thread>
+#define IRAM_ATTR
+#endif
+
+#define SCANOUT_RETRY_US_MIN    (20)    // Shortest sleep before the beam is checked again
+
+typedef struct {
+    int64_t frame_start_us;     // Time of the first refill of the current frame
+    uint32_t frame_us;          // Period of the last frame, `0` until measured
+    uint32_t refill_us;         // Shortest time between two refills in the last frame, `0` until measured
+    uint32_t read_px;           // Pixels of the current frame already read
+    uint32_t refill_px;         // Pixels read per refill
+} scanout_beam_t;
+
+static scanout_beam_t scanout_beam = {};
+static std::atomic<uint32_t> scanout_beam_seq(0);   // Odd while the ISR updates `scanout_beam`
+static int64_t scanout_last_refill_us = 0;
+static uint32_t scanout_frame_refill_us = 0;        // Shortest time between two refills in the current frame
+static const uint8_t *volatile scanout_fb = nullptr;
+static const uint8_t *volatile scanout_next_fb = nullptr;
+static uint16_t scanout_width = 0;
+static uint16_t scanout_height = 0;
+static uint8_t scanout_bpp = 0;
+static bool (*volatile scanout_vsync_cb)(void *user_data) = nullptr;
+static void *volatile scanout_vsync_user_data = nullptr;
+static volatile lvgl_port_scanout_fill_cb_t scanout_fill_cb = nullptr;
+static void *volatile scanout_fill_user_data = nullptr;
+static volatile lvgl_port_scanout_compose_cb_t scanout_compose_cb = nullptr;
+static void *volatile scanout_compose_user_data = nullptr;
+static bool scanout_is_attached = false;
+static bool scanout_owns_vsync = false;             // The callbacks of the LCD driver have been replaced
+static uint32_t scanout_write_ns_per_kb = LVGL_PORT_SCANOUT_WRITE_NS_PER_KB;
+static lvgl_port_scanout_stats_t scanout_stats = {};
+
+#ifdef ESP_PLATFORM
+
+static inline int64_t scanout_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+static void scanout_sleep_us(uint32_t us)
+{
+    const uint32_t tick_us = portTICK_PERIOD_MS * 1000;
+
+    if (us >= tick_us) {
+        vTaskDelay(us / tick_us);
+    } else {
+        esp_rom_delay_us(us);
+    }
+}
+
+IRAM_ATTR static bool scanout_on_bounce_empty(
+    esp_lcd_panel_handle_t panel, void *bounce_buf, int pos_px, int len_bytes, void *user_ctx
+)
+{
+    lvgl_port_scanout_refill(bounce_buf, pos_px, len_bytes, esp_timer_get_time());
+
+    return false;
+}
+
+IRAM_ATTR static bool scanout_on_frame_finish(
+    esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx
+)
+{
+    return lvgl_port_scanout_frame_end();
+}
+
+bool lvgl_port_scanout_attach(void *panel_handle, bool (*vsync_cb)(void *user_data), void *user_data)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(panel_handle, false, "Invalid panel handle");
+
+    // Both are only read together by the ISR, and the user data is the same for every vsync callback of the port
+    scanout_vsync_user_data = user_data;
+    scanout_vsync_cb = vsync_cb;
+    if (scanout_is_attached) {
+        return true;
+    }
+
+    esp_lcd_rgb_panel_event_callbacks_t callbacks = {};
+    callbacks.on_bounce_empty = scanout_on_bounce_empty;
+    callbacks.on_bounce_frame_finish = scanout_on_frame_finish;
+    ESP_UTILS_CHECK_ERROR_RETURN(
+        esp_lcd_rgb_panel_register_event_callbacks((esp_lcd_panel_handle_t)panel_handle, &callbacks, nullptr), false,
+        "Register RGB panel callbacks failed"
+    );
+    scanout_is_attached = true;
+    scanout_owns_vsync = true;
+
+    return true;
+}
+
+IRAM_ATTR static bool scanout_on_detached_frame_finish(
+    esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx
+)
+{
+    bool (*vsync_cb)(void *user_data) = scanout_vsync_cb;
+    return (vsync_cb != nullptr) ? vsync_cb(scanout_vsync_user_data) : false;
+}
+
+bool lvgl_port_scanout_detach(void *panel_handle, bool (*vsync_cb)(void *user_data), void *user_data)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(panel_handle, false, "Invalid panel handle");
+
+    scanout_vsync_user_data = user_data;
+    scanout_vsync_cb = vsync_cb;
+    if (!scanout_is_attached) {
+        return true;
+    }
+
+    // Without `on_bounce_empty`, the driver refills the bounce buffers from the frame buffer again
+    esp_lcd_rgb_panel_event_callbacks_t callbacks = {};
+    callbacks.on_bounce_frame_finish = scanout_on_detached_frame_finish;
+    ESP_UTILS_CHECK_ERROR_RETURN(
+        esp_lcd_rgb_panel_register_event_callbacks((esp_lcd_panel_handle_t)panel_handle, &callbacks, nullptr), false,
+        "Register RGB panel callbacks failed"
+    );
+    scanout_is_attached = false;
+
+    return true;
+}
+
+#else
+
+static inline int64_t scanout_time_us(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+           ).count();
+}
+
+static void scanout_sleep_us(uint32_t us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+bool lvgl_port_scanout_attach(void *, bool (*vsync_cb)(void *user_data), void *user_data)
+{
+    scanout_vsync_user_data = user_data;
+    scanout_vsync_cb = vsync_cb;
+    scanout_is_attached = true;
+    scanout_owns_vsync = true;
+
+    return true;
+}
+
+bool lvgl_port_scanout_detach(void *, bool (*vsync_cb)(void *user_data), void *user_data)
+{
+    scanout_vsync_user_data = user_data;
+    scanout_vsync_cb = vsync_cb;
+    scanout_is_attached = false;
+
+    return true;
+}
+
+#endif
+
+/**
+ * @brief Get a consistent copy of the beam, the ISR may update it meanwhile
+ */
+static void scanout_get_beam(scanout_beam_t *beam)
+{
+    uint32_t seq;
+
+    do {
+        seq = scanout_beam_seq.load(std::memory_order_acquire);
+        *beam = scanout_beam;
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || (seq != scanout_beam_seq.load(std::memory_order_relaxed)));
+}
+
+bool lvgl_port_scanout_init(uint16_t width, uint16_t height, uint8_t bytes_per_pixel)
+{
+    if ((width == 0) || (height == 0) || (bytes_per_pixel == 0)) {
+        return false;
+    }
+
+    scanout_width = width;
+    scanout_height = height;
+    scanout_bpp = bytes_per_pixel;
+    scanout_beam = {};
+    scanout_last_refill_us = 0;
+    scanout_frame_refill_us = 0;
+    scanout_fb = nullptr;
+    scanout_next_fb = nullptr;
+    scanout_write_ns_per_kb = LVGL_PORT_SCANOUT_WRITE_NS_PER_KB;
+    scanout_stats = {};
+
+    return true;
+}
+
+bool lvgl_port_scanout_attached(void)
+{
+    return scanout_is_attached;
+}
+
+bool lvgl_port_scanout_owns_vsync(void)
+{
+    return scanout_owns_vsync;
+}
+
+void lvgl_port_scanout_set_frame_buffer(const void *fb)
+{
+    scanout_next_fb = (const uint8_t *)fb;
+    if (scanout_fb == nullptr) {
+        // Nothing is scanned out yet, don't leave the bounce buffers stale until the next frame
+        scanout_fb = (const uint8_t *)fb;
+    }
+}
+
+void lvgl_port_scanout_set_fill(lvgl_port_scanout_fill_cb_t fill_cb, void *user_data)
+{
+    scanout_fill_user_data = user_data;
+    scanout_fill_cb = fill_cb;
+}
+
+void lvgl_port_scanout_set_compose(lvgl_port_scanout_compose_cb_t compose_cb, void *user_data)
+{
+    scanout_compose_user_data = user_data;
+    scanout_compose_cb = compose_cb;
+}
+
+/**
+ * @brief Hand a refill to the fill callback, one line segment at a time
+ */
+IRAM_ATTR static void scanout_fill(
+    lvgl_port_scanout_fill_cb_t fill_cb, uint8_t *dst, const uint8_t *fb, int pos_px, int len_px
+)
+{
+    void *user_data = scanout_fill_user_data;
+    int x = pos_px % scanout_width;
+    int y = pos_px / scanout_width;
+
+    while (len_px > 0) {
+        int segment_px = (scanout_width - x < len_px) ? (scanout_width - x) : len_px;
+        const uint8_t *src = (fb != nullptr) ? (fb + ((size_t)y * scanout_width + x) * scanout_bpp) : nullptr;
+        fill_cb(dst, src, x, y, segment_px, user_data);
+        dst += segment_px * scanout_bpp;
+        len_px -= segment_px;
+        x = 0;
+        y++;
+    }
+}
+
+/**
+ * @brief Hand a filled refill to the compose callback, one line segment at a time
+ */
+IRAM_ATTR static void scanout_compose(lvgl_port_scanout_compose_cb_t compose_cb, uint8_t *dst, int pos_px, int len_px)
+{
+    void *user_data = scanout_compose_user_data;
+    int x = pos_px % scanout_width;
+    int y = pos_px / scanout_width;
+
+    while (len_px > 0) {
+        int segment_px = (scanout_width - x < len_px) ? (scanout_width - x) : len_px;
+        compose_cb(dst, x, y, segment_px, user_data);
+        dst += segment_px * scanout_bpp;
+        len_px -= segment_px;
+        x = 0;
+        y++;
+    }
+}
+
+IRAM_ATTR void lvgl_port_scanout_refill(void *bounce_buf, int pos_px, int len_bytes, int64_t now_us)
+{
+    const uint8_t *fb = scanout_fb;
+    lvgl_port_scanout_fill_cb_t fill_cb = scanout_fill_cb;
+    lvgl_port_scanout_compose_cb_t compose_cb = scanout_compose_cb;
+    uint32_t len_px = len_bytes / scanout_bpp;
+    uint32_t seq = scanout_beam_seq.load(std::memory_order_relaxed);
+
+    if (fill_cb != nullptr) {
+        scanout_fill(fill_cb, (uint8_t *)bounce_buf, fb, pos_px, len_px);
+    } else if (fb != nullptr) {
+        memcpy(bounce_buf, fb + (size_t)pos_px * scanout_bpp, len_bytes);
+    }
+    if (compose_cb != nullptr) {
+        scanout_compose(compose_cb, (uint8_t *)bounce_buf, pos_px, len_px);
+    }
+
+    scanout_beam_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (pos_px == 0) {
+        if (scanout_beam.frame_start_us != 0) {
+            scanout_beam.frame_us = now_us - scanout_beam.frame_start_us;
+            scanout_beam.refill_us = scanout_frame_refill_us;
+        }
+        scanout_beam.frame_start_us = now_us;
+        scanout_frame_refill_us = 0;
+    } else if (scanout_last_refill_us != 0) {
+        uint32_t interval_us = now_us - scanout_last_refill_us;
+        if ((scanout_frame_refill_us == 0) || (interval_us < scanout_frame_refill_us)) {
+            scanout_frame_refill_us = interval_us;
+        }
+    }
+    scanout_beam.read_px = pos_px + len_px;
+    scanout_beam.refill_px = len_px;
+    scanout_beam_seq.store(seq + 2, std::memory_order_release);
+
+    scanout_last_refill_us = now_us;
+    scanout_stats.refills++;
+}
+
+IRAM_ATTR bool lvgl_port_scanout_frame_end(void)
+{
+    // Like the RGB driver, the frame buffer to scan out is latched once the last refill of a frame is done
+    scanout_fb = scanout_next_fb;
+    scanout_stats.frames++;
+
+    bool (*vsync_cb)(void *user_data) = scanout_vsync_cb;
+    return (vsync_cb != nullptr) ? vsync_cb(scanout_vsync_user_data) : false;
+}
+
+lvgl_port_scanout_band_t lvgl_port_scanout_check_band(
+    int y1, int y2, uint32_t write_us, int64_t now_us, uint32_t *retry_us
+)
+{
+    scanout_beam_t beam;
+    scanout_get_beam(&beam);
+
+    *retry_us = LVGL_PORT_SCANOUT_RETRY_US_MAX;
+    if ((beam.frame_us == 0) || (beam.refill_us == 0) || (beam.refill_px == 0) ||
+            (now_us > beam.frame_start_us + 2 * (int64_t)beam.frame_us)) {
+        // The beam is unknown until two frames have been refilled, or lost if the refills stopped
+        return LVGL_PORT_SCANOUT_BAND_WAIT;
+    }
+
+    // Refills read whole chunks of `refill_px`, at least `refill_us` apart. Predicting every read at the earliest
+    // keeps the decisions on the safe side.
+    int64_t end_us = now_us + write_us + LVGL_PORT_SCANOUT_MARGIN_US;
+    uint32_t chunk1 = (uint32_t)y1 * scanout_width / beam.refill_px;
+    uint32_t chunk2 = ((uint32_t)(y2 + 1) * scanout_width - 1) / beam.refill_px;
+    uint32_t read_chunks = beam.read_px / beam.refill_px;
+    int64_t wait_until_us;
+
+    if (chunk1 >= read_chunks) {
+        // The band is ahead of the beam, check that the write is over before the beam reads its first line
+        int64_t read_us = beam.frame_start_us + (int64_t)chunk1 * beam.refill_us;
+        if (end_us <= read_us) {
+            return LVGL_PORT_SCANOUT_BAND_AHEAD;
+        }
+        // Too close, let the beam pass the band
+        wait_until_us = beam.frame_start_us + (int64_t)(chunk2 + 1) * beam.refill_us;
+    } else if (chunk2 < read_chunks) {
+        // The band is behind the beam, check that the write is over before the next frame reads its first line
+        int64_t read_us = beam.frame_start_us + beam.frame_us + (int64_t)chunk1 * beam.refill_us;
+        if (end_us <= read_us) {
+            return LVGL_PORT_SCANOUT_BAND_BEHIND;
+        }
+        // Too late in this frame, the band is ahead of the beam once the next frame starts
+        wait_until_us = beam.frame_start_us + beam.frame_us;
+    } else {
+        // The beam is in the band
+        wait_until_us = beam.frame_start_us + (int64_t)(chunk2 + 1) * beam.refill_us;
+    }
+
+    int64_t wait_us = wait_until_us - now_us;
+    *retry_us = (wait_us < SCANOUT_RETRY_US_MIN) ? SCANOUT_RETRY_US_MIN :
+                (wait_us > LVGL_PORT_SCANOUT_RETRY_US_MAX) ? LVGL_PORT_SCANOUT_RETRY_US_MAX : (uint32_t)wait_us;
+
+    return LVGL_PORT_SCANOUT_BAND_WAIT;
+}
+
+lvgl_port_scanout_band_t lvgl_port_scanout_wait_band(int y1, int y2, uint32_t bytes, uint32_t timeout_us)
+{
+    uint32_t write_us = lvgl_port_scanout_write_estimate(bytes);
+    int64_t start_us = scanout_time_us();
+    lvgl_port_scanout_band_t band;
+
+    while (true) {
+        int64_t now_us = scanout_time_us();
+        uint32_t retry_us = 0;
+        band = lvgl_port_scanout_check_band(y1, y2, write_us, now_us, &retry_us);
+        if (band != LVGL_PORT_SCANOUT_BAND_WAIT) {
+            break;
+        }
+        if (now_us - start_us >= timeout_us) {
+            band = LVGL_PORT_SCANOUT_BAND_TIMEOUT;
+            break;
+        }
+        scanout_sleep_us(retry_us);
+    }
+
+    uint32_t waited_us = scanout_time_us() - start_us;
+    if (waited_us > SCANOUT_RETRY_US_MIN) {
+        scanout_stats.band_waits++;
+        scanout_stats.band_wait_us += waited_us;
+    }
+    switch (band) {
+    case LVGL_PORT_SCANOUT_BAND_AHEAD:
+        scanout_stats.bands_ahead++;
+        break;
+    case LVGL_PORT_SCANOUT_BAND_BEHIND:
+        scanout_stats.bands_behind++;
+        break;
+    default:
+        scanout_stats.band_timeouts++;
+        break;
+    }
+
+    return band;
+}
+
+void lvgl_port_scanout_band_done(uint32_t bytes, uint32_t write_us)
+{
+    if (bytes == 0) {
+        return;
+    }
+
+    // Follow a slower write at once and a faster one slowly, the estimate has to cover the slow cases
+    uint32_t ns_per_kb = (uint64_t)write_us * 1000 * 1024 / bytes;
+    if (ns_per_kb >= scanout_write_ns_per_kb) {
+        scanout_write_ns_per_kb = ns_per_kb;
+    } else {
+        scanout_write_ns_per_kb -= (scanout_write_ns_per_kb - ns_per_kb) / 16;
+    }
+}
+
+uint32_t lvgl_port_scanout_write_estimate(uint32_t bytes)
+{
+    return ((uint64_t)bytes * scanout_write_ns_per_kb / 1024 + 999) / 1000;
+}
+
+void lvgl_port_scanout_get_stats(lvgl_port_scanout_stats_t *stats)
+{
+    scanout_beam_t beam;
+
+    if (stats == nullptr) {
+        return;
+    }
+    scanout_get_beam(&beam);
+    *stats = scanout_stats;
+    stats->frame_us = beam.frame_us;
+    stats->refill_us = beam.refill_us;
+}
@@ -0,0 +1,248 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Scanout of the RGB frame buffer through the bounce buffers, and the position of the "beam".
+ *
+ * With bounce buffers, the RGB driver streams one half of an SRAM bounce buffer to the panel while an ISR refills the
+ * other half from the frame buffer. This module takes over that refill (`on_bounce_empty` of `esp_lcd_rgb_panel`): it
+ * copies the pixels of the frame buffer being scanned out like the driver does, and records where and when each
+ * refill read the frame buffer. That read position is the beam that writers of a single frame buffer must avoid: a
+ * band of lines is written either entirely behind it (already read in this frame, and written before the next frame
+ * reads it) or entirely ahead of it (written before it is read), so no line is ever read while being written.
+ *
+ * The pixels of a refill can also be generated instead of copied (`lvgl_port_scanout_set_fill()`), line by line
+ * straight into the bounce buffer: a procedural layer like a gradient then needs neither a frame buffer write nor a
+ * PSRAM read, only CPU time in the ISR, which has to stay below the time the DMA takes to stream the other half.
+ * Small layers can be composed on top of the refilled lines the same way (`lvgl_port_scanout_set_compose()`).
+ *
+ * The module also dispatches the end of each scanned frame (`on_bounce_frame_finish`) to the vsync callback of the
+ * port, because registering the refill replaces the callbacks of the LCD driver.
+ *
+ * The beam model only depends on the times passed to it, so `lvgl_port_scanout_sim.h` drives the same code with a
+ * simulated clock on the host. On host builds (no `ESP_PLATFORM`), `lvgl_port_scanout_attach()` only records the
+ * callback and the refills are issued by the caller.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_SCANOUT_MARGIN_US             (200)   // Time kept between the end of a write and the next read of
+                                                        // its lines, covers the ISR latency and the refill jitter
+#define LVGL_PORT_SCANOUT_WRITE_NS_PER_KB       (25000) // Initial estimate of the write time, 40 MB/s into PSRAM
+                                                        // while the scanout reads it
+#define LVGL_PORT_SCANOUT_RETRY_US_MAX          (1000)  // Longest sleep before the beam is checked again
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Where a band can be written relative to the beam
+ */
+typedef enum {
+    LVGL_PORT_SCANOUT_BAND_WAIT = 0,    // The beam is in the band, or would reach it before the write is over
+    LVGL_PORT_SCANOUT_BAND_AHEAD,       // The band is written before the beam reads it in this frame
+    LVGL_PORT_SCANOUT_BAND_BEHIND,      // The band has been read in this frame, and is written before the next frame
+    LVGL_PORT_SCANOUT_BAND_TIMEOUT,     // The beam was not found in time, see `lvgl_port_scanout_wait_band()`
+} lvgl_port_scanout_band_t;
+
+/**
+ * @brief Fill one line segment of the bounce buffer instead of copying it from the frame buffer.
+ *
+ * @note  Called from the ISR, so it must be in IRAM and must not block. The segments of a frame come in order, the
+ *        first one (`x == 0` and `y == 0`) is the place to latch the state of the new frame.
+ *
+ * @param dst       Bounce buffer, `len_px` pixels
+ * @param src       The same pixels in the frame buffer being scanned out, `NULL` if there is none
+ * @param x         Column of the first pixel
+ * @param y         Line of the segment
+ * @param len_px    Pixels to fill, the segment never crosses a line
+ * @param user_data User data of `lvgl_port_scanout_set_fill()`
+ */
+typedef void (*lvgl_port_scanout_fill_cb_t)(void *dst, const void *src, int x, int y, int len_px, void *user_data);
+
+/**
+ * @brief Compose pixels on top of one line segment of the bounce buffer, once it has been filled or copied.
+ *
+ * @note  Same constraints and order as `lvgl_port_scanout_fill_cb_t`.
+ *
+ * @param dst       Bounce buffer, `len_px` pixels
+ * @param x         Column of the first pixel
+ * @param y         Line of the segment
+ * @param len_px    Pixels of the segment, it never crosses a line
+ * @param user_data User data of `lvgl_port_scanout_set_compose()`
+ */
+typedef void (*lvgl_port_scanout_compose_cb_t)(void *dst, int x, int y, int len_px, void *user_data);
+
+/**
+ * @brief Statistics of the scanout, accumulated since `lvgl_port_scanout_init()`
+ */
+typedef struct {
+    uint32_t frames;                // Frames scanned out
+    uint32_t refills;               // Refills of the bounce buffer
+    uint32_t frame_us;              // Last measured frame period
+    uint32_t refill_us;             // Shortest time between two refills in the last frame
+    uint32_t bands_ahead;           // Bands written ahead of the beam
+    uint32_t bands_behind;          // Bands written behind the beam
+    uint32_t band_waits;            // Bands that had to wait for the beam
+    uint64_t band_wait_us;          // Total time waited for the beam
+    uint32_t band_timeouts;         // Bands written without a safe window, the beam was lost
+} lvgl_port_scanout_stats_t;
+
+/**
+ * @brief Initialize the scanout state. The beam is unknown until a whole frame has been refilled.
+ *
+ * @param width           Width of the frame buffer, in pixels
+ * @param height          Height of the frame buffer, in pixels
+ * @param bytes_per_pixel Bytes per pixel of the frame buffer
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_scanout_init(uint16_t width, uint16_t height, uint8_t bytes_per_pixel);
+
+/**
+ * @brief Take over the bounce buffer refill and the end-of-frame event of an RGB panel.
+ *
+ * @note  The callbacks of the LCD driver are replaced and can't be registered back, so once attached, the vsync
+ *        callback of every avoid tearing mode goes through here, see `lvgl_port_scanout_detach()`. It can be called
+ *        again to change `vsync_cb`.
+ *
+ * @param panel_handle `esp_lcd_panel_handle_t` of the RGB panel, configured with bounce buffers
+ * @param vsync_cb     Called from the ISR after the last refill of each frame, may be `NULL`
+ * @param user_data    Passed to `vsync_cb`
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_scanout_attach(void *panel_handle, bool (*vsync_cb)(void *user_data), void *user_data);
+
+/**
+ * @brief Give the bounce buffer refill back to the LCD driver, which copies the frame buffer again.
+ *
+ * @note  The end-of-frame event stays here and is forwarded to `vsync_cb`, as the LCD driver does with its refresh
+ *        finish callback. If the refill isn't taken over, only `vsync_cb` is changed.
+ *
+ * @param panel_handle `esp_lcd_panel_handle_t` of the RGB panel
+ * @param vsync_cb     Called from the ISR at the end of each frame, may be `NULL`
+ * @param user_data    Passed to `vsync_cb`
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_scanout_detach(void *panel_handle, bool (*vsync_cb)(void *user_data), void *user_data);
+
+/**
+ * @brief Check whether the refill has been taken over.
+ */
+bool lvgl_port_scanout_attached(void);
+
+/**
+ * @brief Check whether the end-of-frame event of the panel comes through here, since the first attach.
+ */
+bool lvgl_port_scanout_owns_vsync(void);
+
+/**
+ * @brief Set the frame buffer to scan out from the next frame, like `esp_lcd_panel_draw_bitmap()` does with a frame
+ *        buffer. `NULL` leaves the bounce buffer untouched, which the simulation uses.
+ *
+ * @param fb Frame buffer
+ */
+void lvgl_port_scanout_set_frame_buffer(const void *fb);
+
+/**
+ * @brief Generate the refills with a callback instead of copying the frame buffer.
+ *
+ * @param fill_cb   Fill callback, `NULL` to copy the frame buffer again
+ * @param user_data Passed to `fill_cb`
+ */
+void lvgl_port_scanout_set_fill(lvgl_port_scanout_fill_cb_t fill_cb, void *user_data);
+
+/**
+ * @brief Compose on top of every refill, whether it is copied or generated.
+ *
+ * @param compose_cb Compose callback, `NULL` to stop composing
+ * @param user_data  Passed to `compose_cb`
+ */
+void lvgl_port_scanout_set_compose(lvgl_port_scanout_compose_cb_t compose_cb, void *user_data);
+
+/**
+ * @brief Refill a bounce buffer and move the beam, called from the ISR on device and by the simulation on host.
+ *
+ * @param bounce_buf Bounce buffer to fill
+ * @param pos_px     Position of the first pixel to fill in the frame
+ * @param len_bytes  Bytes to fill
+ * @param now_us     Time of the refill, in microseconds
+ */
+void lvgl_port_scanout_refill(void *bounce_buf, int pos_px, int len_bytes, int64_t now_us);
+
+/**
+ * @brief End of a scanned frame: latch the next frame buffer and call the vsync callback. Called from the ISR on
+ *        device and by the simulation on host.
+ *
+ * @return true if a higher priority task has been woken, otherwise false
+ */
+bool lvgl_port_scanout_frame_end(void);
+
+/**
+ * @brief Decide where the lines `[y1, y2]` can be written now.
+ *
+ * @param y1       First line of the band
+ * @param y2       Last line of the band, inclusive
+ * @param write_us Duration of the write
+ * @param now_us   Current time, in microseconds
+ * @param retry_us Output, when to check again if the result is `LVGL_PORT_SCANOUT_BAND_WAIT`
+ *
+ * @return `AHEAD` or `BEHIND` if the write can start now, otherwise `WAIT`
+ */
+lvgl_port_scanout_band_t lvgl_port_scanout_check_band(
+    int y1, int y2, uint32_t write_us, int64_t now_us, uint32_t *retry_us
+);
+
+/**
+ * @brief Block until the lines `[y1, y2]` can be written for the time `bytes` take, see
+ *        `lvgl_port_scanout_check_band()`. The write must start right after and be reported with
+ *        `lvgl_port_scanout_band_done()`.
+ *
+ * @param y1         First line of the band
+ * @param y2         Last line of the band, inclusive
+ * @param bytes      Bytes to write
+ * @param timeout_us Maximum wait, after which the band should be written anyway
+ *
+ * @return `AHEAD`, `BEHIND`, or `TIMEOUT` if the beam was not found in time (no bounce buffer, scanout stopped)
+ */
+lvgl_port_scanout_band_t lvgl_port_scanout_wait_band(int y1, int y2, uint32_t bytes, uint32_t timeout_us);
+
+/**
+ * @brief Report the duration of a band write, to refine the estimate of the next ones.
+ *
+ * @param bytes    Bytes written
+ * @param write_us Measured duration
+ */
+void lvgl_port_scanout_band_done(uint32_t bytes, uint32_t write_us);
+
+/**
+ * @brief Estimate the duration of a band write, from the slowest recent writes.
+ *
+ * @param bytes Bytes to write
+ *
+ * @return Duration, in microseconds
+ */
+uint32_t lvgl_port_scanout_write_estimate(uint32_t bytes);
+
+/**
+ * @brief Get the statistics.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_scanout_get_stats(lvgl_port_scanout_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
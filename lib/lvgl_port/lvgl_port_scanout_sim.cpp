@@ -0,0 +1,255 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include "lvgl_port_scanout.h"
+#include "lvgl_port_scanout_sim.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#else
+#include <chrono>
+#endif
+
+#define SIM_BYTES_PER_PIXEL (2)
+#define SIM_AREA_MAX        (3)     // Maximum dirty areas per frame
+#define SIM_WAIT_FRAMES     (2)     // Frames a band waits for the beam before it is written anyway
+
+typedef struct {
+    const lvgl_port_scanout_sim_config_t *config;
+    lvgl_port_scanout_sim_result_t *result;
+    int64_t frame_ns;           // Scanout period of a frame, blanking included
+    int64_t refill_ns;          // Nominal time between two refills
+    uint32_t chunks;            // Refills per frame
+    uint32_t chunk;             // Next chunk to refill
+    int64_t frame_start_ns;     // Nominal start of the frame being refilled
+    int64_t refill_at_ns;       // Time of the next refill, jitter included
+    bool writing;               // Whether a band is being written
+    int write_y1;               // Lines of the band being written
+    int write_y2;
+    uint32_t rng;
+} sim_t;
+
+static uint32_t sim_random(sim_t *sim, uint32_t range)
+{
+    // xorshift32, enough for dirty areas and jitters
+    sim->rng ^= sim->rng << 13;
+    sim->rng ^= sim->rng >> 17;
+    sim->rng ^= sim->rng << 5;
+
+    return (range == 0) ? 0 : (sim->rng % range);
+}
+
+static void sim_schedule_refill(sim_t *sim)
+{
+    int64_t nominal_ns = sim->frame_start_ns + sim->chunk * sim->refill_ns;
+    int64_t at_ns = nominal_ns + (int64_t)sim_random(sim, sim->config->refill_jitter_us + 1) * 1000;
+
+    // The ISR can be late but never reorders the refills
+    sim->refill_at_ns = (at_ns > sim->refill_at_ns) ? at_ns : (sim->refill_at_ns + 1);
+}
+
+/**
+ * @brief Run the scanout until `until_ns`, checking every refill against the band being written
+ */
+static void sim_advance(sim_t *sim, int64_t until_ns)
+{
+    const lvgl_port_scanout_sim_config_t *config = sim->config;
+
+    while (sim->refill_at_ns <= until_ns) {
+        int y1 = sim->chunk * config->bounce_lines;
+        int y2 = (y1 + config->bounce_lines <= config->height) ? (y1 + config->bounce_lines - 1) :
+                 (config->height - 1);
+        if (sim->writing && (y1 <= sim->write_y2) && (sim->write_y1 <= y2)) {
+            sim->result->tears++;
+        }
+        lvgl_port_scanout_refill(
+            nullptr, y1 * config->width, (y2 - y1 + 1) * config->width * SIM_BYTES_PER_PIXEL,
+            sim->refill_at_ns / 1000
+        );
+
+        if (++sim->chunk == sim->chunks) {
+            lvgl_port_scanout_frame_end();
+            sim->result->frames_scanned++;
+            sim->chunk = 0;
+            sim->frame_start_ns += sim->frame_ns;
+        }
+        sim_schedule_refill(sim);
+    }
+}
+
+/**
+ * @brief Render and write one band, returns the time when the write is over
+ */
+static int64_t sim_band(sim_t *sim, int64_t now_ns, int x1, int x2, int y1, int y2)
+{
+    const lvgl_port_scanout_sim_config_t *config = sim->config;
+    lvgl_port_scanout_sim_result_t *result = sim->result;
+    uint32_t bytes = (uint32_t)(x2 - x1 + 1) * (y2 - y1 + 1) * SIM_BYTES_PER_PIXEL;
+
+    now_ns += (int64_t)config->render_ns_per_line * (y2 - y1 + 1) * (x2 - x1 + 1) / config->width;
+    sim_advance(sim, now_ns);
+
+    int64_t wait_start_ns = now_ns;
+    lvgl_port_scanout_band_t band;
+    while (true) {
+        uint32_t retry_us = 0;
+        band = lvgl_port_scanout_check_band(
+                   y1, y2, lvgl_port_scanout_write_estimate(bytes), now_ns / 1000, &retry_us
+               );
+        if (band != LVGL_PORT_SCANOUT_BAND_WAIT) {
+            break;
+        }
+        if (now_ns - wait_start_ns >= SIM_WAIT_FRAMES * sim->frame_ns) {
+            band = LVGL_PORT_SCANOUT_BAND_TIMEOUT;
+            break;
+        }
+        now_ns += (int64_t)retry_us * 1000;
+        sim_advance(sim, now_ns);
+    }
+
+    uint32_t wait_us = (now_ns - wait_start_ns) / 1000;
+    if (wait_us > 0) {
+        result->band_waits++;
+        result->band_wait_us += wait_us;
+        result->band_wait_us_max = (wait_us > result->band_wait_us_max) ? wait_us : result->band_wait_us_max;
+    }
+    result->bands++;
+    result->bands_ahead += (band == LVGL_PORT_SCANOUT_BAND_AHEAD);
+    result->bands_behind += (band == LVGL_PORT_SCANOUT_BAND_BEHIND);
+    result->bands_forced += (band == LVGL_PORT_SCANOUT_BAND_TIMEOUT);
+
+    int64_t write_ns = (int64_t)bytes * config->write_ns_per_kb / 1024;
+    write_ns += write_ns * sim_random(sim, config->write_jitter_percent + 1) / 100;
+    // Refills up to the start of the write see the old lines, the ones until its end would tear
+    sim->writing = true;
+    sim->write_y1 = y1;
+    sim->write_y2 = y2;
+    sim_advance(sim, now_ns + write_ns - 1);
+    sim->writing = false;
+    lvgl_port_scanout_band_done(bytes, (write_ns + 999) / 1000);
+
+    return now_ns + write_ns;
+}
+
+bool lvgl_port_scanout_sim_run(const lvgl_port_scanout_sim_config_t *config, lvgl_port_scanout_sim_result_t *result)
+{
+    if ((config == nullptr) || (result == nullptr) || (config->width == 0) || (config->height == 0) ||
+            (config->line_ns == 0) || (config->bounce_lines == 0) || (config->band_lines == 0)) {
+        return false;
+    }
+    if (!lvgl_port_scanout_init(config->width, config->height, SIM_BYTES_PER_PIXEL)) {
+        return false;
+    }
+    lvgl_port_scanout_set_frame_buffer(nullptr);
+
+    sim_t sim = {};
+    sim.config = config;
+    sim.result = result;
+    sim.frame_ns = (int64_t)(config->height + config->blank_lines) * config->line_ns;
+    sim.refill_ns = (int64_t)config->bounce_lines * config->line_ns;
+    sim.chunks = (config->height + config->bounce_lines - 1) / config->bounce_lines;
+    sim.rng = (config->seed != 0) ? config->seed : 1;
+    sim_schedule_refill(&sim);
+    *result = {};
+
+    // Like the port, the renderer starts once the panel has run long enough for the beam to be known
+    int64_t now_ns = SIM_WAIT_FRAMES * sim.frame_ns;
+    sim_advance(&sim, now_ns);
+
+    for (uint32_t frame = 0; frame < config->frames; frame++) {
+        int area_num = 1 + sim_random(&sim, SIM_AREA_MAX);
+        for (int i = 0; i < area_num; i++) {
+            int x1 = sim_random(&sim, config->width);
+            int x2 = x1 + sim_random(&sim, config->width - x1);
+            int y1 = sim_random(&sim, config->height);
+            int y2 = y1 + sim_random(&sim, config->height - y1);
+            // LVGL renders an area in bands of the render buffer height, from its top
+            for (int y = y1; y <= y2; y += config->band_lines) {
+                int band_y2 = (y + config->band_lines - 1 < y2) ? (y + config->band_lines - 1) : y2;
+                now_ns = sim_band(&sim, now_ns, x1, x2, y, band_y2);
+            }
+        }
+        result->frames_rendered++;
+        // Idle until the next frame, to vary its phase against the scanout
+        now_ns += (int64_t)sim_random(&sim, sim.frame_ns / 1000) * 1000;
+    }
+    sim_advance(&sim, now_ns);
+    result->elapsed_us = now_ns / 1000;
+
+    return true;
+}
+
+static inline int64_t sim_clock_ns(void)
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time() * 1000;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+           ).count();
+#endif
+}
+
+bool lvgl_port_scanout_sim_fill(
+    const lvgl_port_scanout_sim_config_t *config, const void *fb, lvgl_port_scanout_sim_fill_result_t *result
+)
+{
+    if ((config == nullptr) || (result == nullptr) || (config->width == 0) || (config->height == 0) ||
+            (config->line_ns == 0) || (config->bounce_lines == 0)) {
+        return false;
+    }
+    if (!lvgl_port_scanout_init(config->width, config->height, SIM_BYTES_PER_PIXEL)) {
+        return false;
+    }
+    lvgl_port_scanout_set_frame_buffer(fb);
+
+    // Like the bounce buffers of the RGB driver, the refills go to internal RAM
+    size_t bounce_bytes = (size_t)config->width * config->bounce_lines * SIM_BYTES_PER_PIXEL;
+#ifdef ESP_PLATFORM
+    void *bounce_buf = heap_caps_malloc(bounce_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+#else
+    void *bounce_buf = malloc(bounce_bytes);
+#endif
+    if (bounce_buf == nullptr) {
+        return false;
+    }
+
+    uint64_t fill_ns_total = 0;
+    int64_t refill_ns = (int64_t)config->bounce_lines * config->line_ns;
+    int64_t sim_ns = 0;
+    *result = {};
+    result->deadline_ns = refill_ns;
+    for (uint32_t frame = 0; frame < config->frames; frame++) {
+        for (int y = 0; y < config->height; y += config->bounce_lines) {
+            int lines = (y + config->bounce_lines <= config->height) ? config->bounce_lines : (config->height - y);
+            int64_t start_ns = sim_clock_ns();
+            lvgl_port_scanout_refill(
+                bounce_buf, y * config->width, lines * config->width * SIM_BYTES_PER_PIXEL, sim_ns / 1000
+            );
+            uint32_t fill_ns = sim_clock_ns() - start_ns;
+
+            if (fill_ns > result->fill_ns_max) {
+                result->fill_ns_max = fill_ns;
+                result->worst_line = y;
+            }
+            result->misses += (fill_ns > refill_ns);
+            result->refills++;
+            fill_ns_total += fill_ns;
+            sim_ns += refill_ns;
+        }
+        lvgl_port_scanout_frame_end();
+    }
+    free(bounce_buf);
+
+    if (result->refills > 0) {
+        result->fill_ns_avg = fill_ns_total / result->refills;
+        result->load_percent = result->fill_ns_avg * 100 / refill_ns;
+    }
+
+    return true;
+}
@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Simulation of a single frame buffer written in bands while it is scanned out.
+ *
+ * A simulated RGB panel refills its bounce buffers on a simulated clock and drives `lvgl_port_scanout_refill()` and
+ * `lvgl_port_scanout_frame_end()`, and a simulated renderer flushes random dirty areas in bands, each one placed with
+ * `lvgl_port_scanout_check_band()` like the race-the-beam mode of the port does. Every refill is checked against the
+ * band being written at that time: a refill that reads a line while it is written is a tear.
+ *
+ * It has no dependency on LVGL or ESP-IDF and runs as fast as the host can, to check the beam model (and its margins)
+ * against panel timings, refill jitter and write speeds before trying them on a device. It resets the scanout module,
+ * so it must not run while the port uses it.
+ *
+ * `lvgl_port_scanout_sim_fill()` checks the other constraint of the scanout: a fill callback runs in the refill ISR,
+ * and each refill must be over before the DMA has streamed the other half of the bounce buffer. It runs the refills of
+ * whole frames back to back on the real clock, and compares each of them with that deadline. On the host, the times
+ * only compare fill callbacks with each other; the same function runs on the device for the real figures.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Panel, renderer and run length of a simulation
+ */
+typedef struct {
+    uint16_t width;                 // Width of the panel, in pixels
+    uint16_t height;                // Height of the panel, in pixels
+    uint16_t blank_lines;           // Vertical porches and sync, in lines
+    uint32_t line_ns;               // Time to scan out one line
+    uint16_t bounce_lines;          // Lines per refill, half of the bounce buffer
+    uint32_t refill_jitter_us;      // Maximum latency of the refill ISR
+    uint16_t band_lines;            // Lines per band, the height of LVGL's render buffer
+    uint32_t render_ns_per_line;    // Render time of one full-width line
+    uint32_t write_ns_per_kb;       // Write speed of a band into the frame buffer
+    uint8_t write_jitter_percent;   // Maximum slowdown of a write
+    uint32_t frames;                // Frames to render
+    uint32_t seed;                  // Seed of the random dirty areas and jitters
+} lvgl_port_scanout_sim_config_t;
+
+/**
+ * @brief Default configuration: 800x480 panel at about 60 Hz with 10-line refills, 40-line bands
+ */
+#define LVGL_PORT_SCANOUT_SIM_CONFIG_DEFAULT()  \
+    {                                           \
+        .width = 800,                           \
+        .height = 480,                          \
+        .blank_lines = 45,                      \
+        .line_ns = 31750,                       \
+        .bounce_lines = 10,                     \
+        .refill_jitter_us = 50,                 \
+        .band_lines = 40,                       \
+        .render_ns_per_line = 60000,            \
+        .write_ns_per_kb = 20000,               \
+        .write_jitter_percent = 20,             \
+        .frames = 1000,                         \
+        .seed = 1,                              \
+    }
+
+/**
+ * @brief Result of a simulation
+ */
+typedef struct {
+    uint32_t frames_rendered;       // Frames rendered
+    uint32_t frames_scanned;        // Frames scanned out meanwhile
+    uint32_t bands;                 // Bands written
+    uint32_t bands_ahead;           // Bands written ahead of the beam
+    uint32_t bands_behind;          // Bands written behind the beam
+    uint32_t bands_forced;          // Bands written without a safe window, after waiting for two frames
+    uint32_t band_waits;            // Bands that had to wait for the beam
+    uint64_t band_wait_us;          // Total time waited for the beam
+    uint32_t band_wait_us_max;      // Longest wait of a band
+    uint32_t tears;                 // Refills that read a line while it was written
+    uint64_t elapsed_us;            // Simulated time
+} lvgl_port_scanout_sim_result_t;
+
+/**
+ * @brief Result of `lvgl_port_scanout_sim_fill()`
+ */
+typedef struct {
+    uint32_t refills;               // Refills measured
+    uint32_t deadline_ns;           // Time to stream one refill, `bounce_lines * line_ns`
+    uint32_t fill_ns_max;           // Worst time of a refill, each one is a batch of `bounce_lines` lines
+    uint32_t fill_ns_avg;           // Average time of a refill
+    uint32_t worst_line;            // First line of the worst refill
+    uint32_t misses;                // Refills longer than the deadline
+    uint32_t load_percent;          // Average share of the deadline spent filling, the CPU the refill ISR takes
+} lvgl_port_scanout_sim_fill_result_t;
+
+/**
+ * @brief Run a simulation.
+ *
+ * @param config Configuration
+ * @param result Output
+ *
+ * @return true if success, otherwise false (invalid configuration)
+ */
+bool lvgl_port_scanout_sim_run(const lvgl_port_scanout_sim_config_t *config, lvgl_port_scanout_sim_result_t *result);
+
+/**
+ * @brief Measure the refills of `config->frames` frames with the fill callback set by `lvgl_port_scanout_set_fill()`.
+ *
+ * @note  Only `width`, `height`, `line_ns`, `bounce_lines` and `frames` of the configuration are used.
+ *
+ * @param config Configuration
+ * @param fb     Frame buffer passed to the fill callback, RGB565, may be `NULL`
+ * @param result Output
+ *
+ * @return true if success, otherwise false (invalid configuration, no memory)
+ */
+bool lvgl_port_scanout_sim_fill(
+    const lvgl_port_scanout_sim_config_t *config, const void *fb, lvgl_port_scanout_sim_fill_result_t *result
+);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,324 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include "lvgl_port_screen_prep.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#undef ESP_UTILS_LOG_TAG
+#define ESP_UTILS_LOG_TAG "LvPort"
+#include "esp_lib_utils.h"
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * Stage of the preparation, the owner of `prep_job` and `prep_stats` follows it
+ */
+typedef enum {
+    PREP_STATE_IDLE,            // No preparation, `lvgl_port_screen_prep_start()` may claim it
+    PREP_STATE_PREPARING,       // Claimed by a start, then `prepare_cb` runs on the worker
+    PREP_STATE_BUILDING,        // Build steps run in the LVGL task
+    PREP_STATE_READY,           // `ready_cb` was called, the time to interactive waits for a rendered frame
+} prep_state_t;
+
+static std::atomic<int> prep_state(PREP_STATE_IDLE);
+static std::atomic<bool> prep_running(false);
+static std::atomic<bool> prep_exit(false);
+static lvgl_port_screen_prep_t prep_job = {};
+static lvgl_port_screen_prep_stats_t prep_stats = {};
+static lvgl_port_screen_prep_wake_cb_t prep_wake_cb = nullptr;
+static int64_t prep_start_us = 0;
+static int prep_step = 0;
+
+#ifdef ESP_PLATFORM
+
+static SemaphoreHandle_t prep_event = nullptr;
+static SemaphoreHandle_t prep_stopped = nullptr;
+static TaskHandle_t prep_task = nullptr;
+
+static inline int64_t prep_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+static void prep_signal(void)
+{
+    xSemaphoreGive(prep_event);
+}
+
+static void prep_wait(void)
+{
+    xSemaphoreTake(prep_event, portMAX_DELAY);
+}
+
+#else
+
+static std::mutex prep_mutex;
+static std::condition_variable prep_cond;
+static bool prep_pending = false;
+static std::thread prep_thread;
+
+static inline int64_t prep_time_us(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+           ).count();
+}
+
+static void prep_signal(void)
+{
+    std::lock_guard<std::mutex> lock(prep_mutex);
+    prep_pending = true;
+    prep_cond.notify_all();
+}
+
+static void prep_wait(void)
+{
+    std::unique_lock<std::mutex> lock(prep_mutex);
+    prep_cond.wait(lock, [] { return prep_pending; });
+    prep_pending = false;
+}
+
+#endif /* ESP_PLATFORM */
+
+/**
+ * @brief Hand the preparation over to the build steps, and wake the LVGL task up for them
+ */
+static void prep_start_building(void)
+{
+    prep_state.store(PREP_STATE_BUILDING, std::memory_order_release);
+    if (prep_wake_cb != nullptr) {
+        prep_wake_cb();
+    }
+}
+
+/**
+ * @brief Run the expensive part of the preparation claimed by the last start
+ */
+static void prep_work(void)
+{
+    // The signal orders the writes of the start before these reads
+    if (prep_state.load(std::memory_order_acquire) != PREP_STATE_PREPARING) {
+        return;
+    }
+    int64_t start_us = prep_time_us();
+    prep_job.prepare_cb(prep_job.user_data);
+    prep_stats.prepare_us = (uint32_t)(prep_time_us() - start_us);
+    prep_start_building();
+}
+
+#ifdef ESP_PLATFORM
+
+static void prep_task_loop(void *arg)
+{
+    while (!prep_exit.load()) {
+        prep_wait();
+        if (!prep_exit.load()) {
+            prep_work();
+        }
+    }
+    xSemaphoreGive(prep_stopped);
+    vTaskSuspend(nullptr);
+}
+
+static void prep_delete_events(void)
+{
+    if (prep_stopped != nullptr) {
+        vSemaphoreDelete(prep_stopped);
+        prep_stopped = nullptr;
+    }
+    if (prep_event != nullptr) {
+        vSemaphoreDelete(prep_event);
+        prep_event = nullptr;
+    }
+}
+
+bool lvgl_port_screen_prep_init(int core, lvgl_port_screen_prep_wake_cb_t wake_cb)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(prep_task == nullptr, false, "Screen preparation is already initialized");
+
+    prep_wake_cb = wake_cb;
+    prep_stats = {};
+    prep_exit.store(false);
+    prep_state.store(PREP_STATE_IDLE);
+    // On a failure, the semaphores created so far are deleted, so that the init can be tried again
+    prep_event = xSemaphoreCreateBinary();
+    ESP_UTILS_CHECK_NULL_RETURN(prep_event, false, "Create screen preparation event failed");
+    prep_stopped = xSemaphoreCreateBinary();
+    if (prep_stopped == nullptr) {
+        ESP_UTILS_LOGE("Create screen preparation semaphore failed");
+        prep_delete_events();
+        return false;
+    }
+    BaseType_t ret = xTaskCreatePinnedToCore(
+                         prep_task_loop, "lvgl_prep", LVGL_PORT_SCREEN_PREP_STACK_SIZE, nullptr,
+                         LVGL_PORT_SCREEN_PREP_PRIORITY, &prep_task, (core < 0) ? tskNO_AFFINITY : core
+                     );
+    if (ret != pdPASS) {
+        ESP_UTILS_LOGE("Create screen preparation task failed");
+        prep_task = nullptr;
+        prep_delete_events();
+        return false;
+    }
+    prep_running.store(true, std::memory_order_release);
+
+    return true;
+}
+
+bool lvgl_port_screen_prep_deinit(void)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(prep_task, false, "Screen preparation is not initialized");
+
+    // The worker finishes its `prepare_cb`, then stops before it waits again
+    prep_running.store(false);
+    prep_exit.store(true);
+    prep_signal();
+    xSemaphoreTake(prep_stopped, portMAX_DELAY);
+    vTaskDelete(prep_task);
+    prep_task = nullptr;
+    prep_delete_events();
+    prep_state.store(PREP_STATE_IDLE);
+
+    return true;
+}
+
+#else
+
+static void prep_task_loop(void)
+{
+    while (!prep_exit.load()) {
+        prep_wait();
+        if (!prep_exit.load()) {
+            prep_work();
+        }
+    }
+}
+
+bool lvgl_port_screen_prep_init(int, lvgl_port_screen_prep_wake_cb_t wake_cb)
+{
+    if (prep_thread.joinable()) {
+        return false;
+    }
+    prep_wake_cb = wake_cb;
+    prep_stats = {};
+    prep_exit.store(false);
+    prep_state.store(PREP_STATE_IDLE);
+    prep_pending = false;
+    prep_thread = std::thread(prep_task_loop);
+    prep_running.store(true, std::memory_order_release);
+
+    return true;
+}
+
+bool lvgl_port_screen_prep_deinit(void)
+{
+    if (!prep_thread.joinable()) {
+        return false;
+    }
+    prep_running.store(false);
+    prep_exit.store(true);
+    prep_signal();
+    prep_thread.join();
+    prep_state.store(PREP_STATE_IDLE);
+
+    return true;
+}
+
+#endif /* ESP_PLATFORM */
+
+bool lvgl_port_screen_prep_start(const lvgl_port_screen_prep_t *prep)
+{
+    if ((prep == nullptr) || (prep->build_cb == nullptr) || !prep_running.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    // A preparation waiting for its time to interactive is over enough to be replaced
+    int state = PREP_STATE_IDLE;
+    if (!prep_state.compare_exchange_strong(state, PREP_STATE_PREPARING, std::memory_order_acquire)) {
+        state = PREP_STATE_READY;
+        if (!prep_state.compare_exchange_strong(state, PREP_STATE_PREPARING, std::memory_order_acquire)) {
+            return false;
+        }
+    }
+
+    prep_job = *prep;
+    prep_start_us = prep_time_us();
+    prep_step = 0;
+    uint32_t preps = prep_stats.preps;
+    prep_stats = {};
+    prep_stats.preps = preps;
+    if (prep_job.prepare_cb == nullptr) {
+        prep_start_building();
+    } else {
+        prep_signal();
+    }
+
+    return true;
+}
+
+bool lvgl_port_screen_prep_run(int64_t deadline_us)
+{
+    if (prep_state.load(std::memory_order_acquire) != PREP_STATE_BUILDING) {
+        return false;
+    }
+
+    int64_t start_us = prep_time_us();
+    int64_t slice_end_us = start_us + LVGL_PORT_SCREEN_PREP_SLICE_US;
+    slice_end_us = (deadline_us < slice_end_us) ? deadline_us : slice_end_us;
+    bool more = true;
+    int64_t now_us = start_us;
+    // At least one step per slice, even past the deadline, so the construction always progresses
+    do {
+        more = prep_job.build_cb(prep_step++, prep_job.user_data);
+        prep_stats.build_steps++;
+        now_us = prep_time_us();
+    } while (more && (now_us < slice_end_us));
+
+    uint32_t slice_us = (uint32_t)(now_us - start_us);
+    prep_stats.build_us += slice_us;
+    prep_stats.build_slices++;
+    prep_stats.slice_us_max = (slice_us > prep_stats.slice_us_max) ? slice_us : prep_stats.slice_us_max;
+    if (more) {
+        return true;
+    }
+
+    prep_stats.ready_us = (uint32_t)(now_us - prep_start_us);
+    prep_stats.preps++;
+    prep_state.store(PREP_STATE_READY, std::memory_order_release);
+    if (prep_job.ready_cb != nullptr) {
+        // The callback may start the next preparation
+        lvgl_port_screen_prep_stats_t stats = prep_stats;
+        prep_job.ready_cb(&stats, prep_job.user_data);
+    }
+
+    return (prep_state.load(std::memory_order_acquire) == PREP_STATE_BUILDING);
+}
+
+void lvgl_port_screen_prep_frame_rendered(int64_t now_us)
+{
+    if (prep_state.load(std::memory_order_acquire) != PREP_STATE_READY) {
+        return;
+    }
+    // Written before the preparation is released, a start claiming it next resets the timings afterwards
+    prep_stats.tti_us = (uint32_t)(now_us - prep_start_us);
+    int state = PREP_STATE_READY;
+    prep_state.compare_exchange_strong(state, PREP_STATE_IDLE, std::memory_order_acq_rel);
+}
+
+void lvgl_port_screen_prep_get_stats(lvgl_port_screen_prep_stats_t *stats)
+{
+    if (stats != nullptr) {
+        *stats = prep_stats;
+    }
+}
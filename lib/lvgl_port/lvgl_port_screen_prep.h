@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Preparation of a screen in the background, so navigating doesn't freeze the UI.
+ *
+ * Building a complex screen in one go (dozens of objects, their styles, decoded images) holds the LVGL mutex for
+ * hundreds of milliseconds, and no frame is rendered meanwhile. A preparation splits it in two stages:
+ *
+ * - The expensive work that doesn't touch LVGL objects (decoding images into buffers of the application, reading
+ *   fonts and assets, laying text out) runs in `prepare_cb`, on a worker task on the other core, without the lock.
+ * - The construction of the object tree runs in `build_cb`, in the LVGL task between two frames, one small step at a
+ *   time: each frame gives the steps a slice of `LVGL_PORT_SCREEN_PREP_SLICE_US` at most, or less if the next frame
+ *   is due sooner. At least one step runs per frame, so the construction always progresses. The steps build the
+ *   screen off-display (a screen created with `lv_obj_create(NULL)`), which costs no render. What needs LVGL but no
+ *   object, such as opening an image into LVGL's cache (`lv_img_cache_open()`), is a build step of its own.
+ *
+ * Once the last step is done, `ready_cb` is called in the LVGL task, where the screen is usually loaded. The time to
+ * interactive of the preparation runs from its start to the end of the first frame rendered after `ready_cb`.
+ *
+ * One preparation runs at a time. On host builds (no `ESP_PLATFORM`), the worker is a thread.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_SCREEN_PREP_SLICE_US          (4000)  // Longest slice of build steps per frame, in microseconds
+#define LVGL_PORT_SCREEN_PREP_STACK_SIZE        (6 * 1024)  // Stack of the worker task, in bytes
+#define LVGL_PORT_SCREEN_PREP_PRIORITY          (1)     // Priority of the worker task, below the LVGL task and the
+                                                        // workers that it waits for on the same core
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Timings of a preparation
+ */
+typedef struct {
+    uint32_t preps;                 // Preparations over, since `lvgl_port_screen_prep_init()`
+    uint32_t prepare_us;            // Time of `prepare_cb` on the worker
+    uint32_t build_us;              // Time of the build steps, all slices
+    uint32_t build_steps;           // Build steps run
+    uint32_t build_slices;          // Frames the build steps were spread over
+    uint32_t slice_us_max;          // Longest slice, the longest the LVGL task was held up by the build
+    uint32_t ready_us;              // Start of the preparation to `ready_cb`
+    uint32_t tti_us;                // Start of the preparation to the end of the first frame rendered after `ready_cb`,
+                                    // `0` until then
+} lvgl_port_screen_prep_stats_t;
+
+/**
+ * @brief A screen to prepare
+ */
+typedef struct {
+    /**
+     * Expensive work run on the worker task, without the LVGL lock: it must not touch LVGL objects. `NULL` to start
+     * with the build steps.
+     */
+    void (*prepare_cb)(void *user_data);
+    /**
+     * One build step, in the LVGL task with the lock held. Steps should be a few milliseconds at most.
+     *
+     * @return true if there are more steps, false if this was the last one
+     */
+    bool (*build_cb)(int step, void *user_data);
+    /**
+     * Called in the LVGL task after the last build step, usually to load the screen. May be `NULL`.
+     */
+    void (*ready_cb)(const lvgl_port_screen_prep_stats_t *stats, void *user_data);
+    void *user_data;
+} lvgl_port_screen_prep_t;
+
+/**
+ * @brief Called when the build steps can start, to wake the LVGL task up
+ */
+typedef void (*lvgl_port_screen_prep_wake_cb_t)(void);
+
+/**
+ * @brief Start the worker.
+ *
+ * @param core    Core of the worker task, the one the LVGL task doesn't use, `-1` for any. Ignored on host builds.
+ * @param wake_cb Called by the worker when `prepare_cb` is over, may be `NULL`
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_screen_prep_init(int core, lvgl_port_screen_prep_wake_cb_t wake_cb);
+
+/**
+ * @brief Stop the worker, once its `prepare_cb` is over. A preparation in progress is dropped.
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_screen_prep_deinit(void);
+
+/**
+ * @brief Start preparing a screen. Callable from any task.
+ *
+ * @param prep Screen to prepare, copied
+ *
+ * @return true if started, false if another preparation is in progress or the worker isn't running
+ */
+bool lvgl_port_screen_prep_start(const lvgl_port_screen_prep_t *prep);
+
+/**
+ * @brief Run a slice of build steps, in the LVGL task between two frames. Calls `ready_cb` after the last step.
+ *
+ * @param deadline_us Time the slice should end by, at most `LVGL_PORT_SCREEN_PREP_SLICE_US` from now is used
+ *
+ * @return true if build steps are left for the next frames
+ */
+bool lvgl_port_screen_prep_run(int64_t deadline_us);
+
+/**
+ * @brief Count a rendered frame, in the LVGL task, to measure the time to interactive.
+ *
+ * @param now_us End of the frame
+ */
+void lvgl_port_screen_prep_frame_rendered(int64_t now_us);
+
+/**
+ * @brief Get the timings of the last preparation.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_screen_prep_get_stats(lvgl_port_screen_prep_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
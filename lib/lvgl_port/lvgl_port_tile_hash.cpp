@@ -0,0 +1,213 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "lvgl_port_damage.h"
+#include "lvgl_port_tile_hash.h"
+
+#define TILE_HASH_UNKNOWN   (0)             // Stored hash of a tile whose content is unknown, never computed
+#define TILE_HASH_PRIME     (0x9E3779B1U)   // Odd multiplier: every step is a bijection, a single changed word
+                                            // always changes the hash
+
+typedef struct {
+    uint32_t hash;      // Hash of the tile in the latest frame
+    uint32_t frame;     // Frame that last hashed the tile, to hash it once per frame
+    bool changed;       // Whether the tile changed in that frame
+} tile_t;
+
+static tile_t *tile_table = nullptr;
+static uint16_t tile_width = 0;
+static uint16_t tile_height = 0;
+static uint8_t tile_bpp = 0;
+static int tile_cols = 0;
+static int tile_rows = 0;
+static uint32_t tile_frame = 0;
+static lvgl_port_tile_hash_stats_t tile_stats = {};
+
+static inline uint32_t rect_bytes(const lvgl_port_copy_rect_t *rect)
+{
+    return (uint32_t)(rect->x2 - rect->x1 + 1) * (rect->y2 - rect->y1 + 1) * tile_bpp;
+}
+
+static uint32_t tile_compute_hash(const uint8_t *buf, int col, int row)
+{
+    int x1 = col * LVGL_PORT_TILE_HASH_SIZE;
+    int y1 = row * LVGL_PORT_TILE_HASH_SIZE;
+    int w = ((x1 + LVGL_PORT_TILE_HASH_SIZE) <= tile_width) ? LVGL_PORT_TILE_HASH_SIZE : (tile_width - x1);
+    int h = ((y1 + LVGL_PORT_TILE_HASH_SIZE) <= tile_height) ? LVGL_PORT_TILE_HASH_SIZE : (tile_height - y1);
+    size_t stride = (size_t)tile_width * tile_bpp;
+    size_t row_bytes = (size_t)w * tile_bpp;
+    size_t words = row_bytes / sizeof(uint32_t);
+    const uint8_t *line = buf + y1 * stride + x1 * tile_bpp;
+
+    uint32_t hash = 0x811C9DC5U;
+    for (int y = 0; y < h; y++, line += stride) {
+        // Tiles are 4-byte aligned whenever the row stride is, fall back to `memcpy()` loads otherwise
+        if ((((uintptr_t)line) & (sizeof(uint32_t) - 1)) == 0) {
+            const uint32_t *word = (const uint32_t *)line;
+            for (size_t i = 0; i < words; i++) {
+                hash = (hash ^ word[i]) * TILE_HASH_PRIME;
+            }
+        } else {
+            for (size_t i = 0; i < words; i++) {
+                uint32_t word;
+                memcpy(&word, line + i * sizeof(uint32_t), sizeof(word));
+                hash = (hash ^ word) * TILE_HASH_PRIME;
+            }
+        }
+        for (size_t i = words * sizeof(uint32_t); i < row_bytes; i++) {
+            hash = (hash ^ line[i]) * TILE_HASH_PRIME;
+        }
+    }
+
+    return (hash == TILE_HASH_UNKNOWN) ? 1 : hash;
+}
+
+bool lvgl_port_tile_hash_init(uint16_t width, uint16_t height, uint8_t bytes_per_pixel)
+{
+    if ((width == 0) || (height == 0) || (bytes_per_pixel == 0)) {
+        return false;
+    }
+
+    lvgl_port_tile_hash_deinit();
+
+    int cols = (width + LVGL_PORT_TILE_HASH_SIZE - 1) / LVGL_PORT_TILE_HASH_SIZE;
+    int rows = (height + LVGL_PORT_TILE_HASH_SIZE - 1) / LVGL_PORT_TILE_HASH_SIZE;
+    tile_table = (tile_t *)calloc(cols * rows, sizeof(tile_t));
+    if (tile_table == nullptr) {
+        return false;
+    }
+    tile_width = width;
+    tile_height = height;
+    tile_bpp = bytes_per_pixel;
+    tile_cols = cols;
+    tile_rows = rows;
+    tile_frame = 0;
+    lvgl_port_tile_hash_reset_stats();
+
+    return true;
+}
+
+void lvgl_port_tile_hash_deinit(void)
+{
+    free(tile_table);
+    tile_table = nullptr;
+    tile_cols = 0;
+    tile_rows = 0;
+}
+
+void lvgl_port_tile_hash_reset(void)
+{
+    for (int i = 0; i < tile_cols * tile_rows; i++) {
+        tile_table[i].hash = TILE_HASH_UNKNOWN;
+    }
+}
+
+int lvgl_port_tile_hash_filter(const void *buf, const lvgl_port_copy_rect_t *rects, int rect_num,
+                               lvgl_port_copy_rect_t *changed)
+{
+    if (tile_table == nullptr) {
+        for (int i = 0; i < rect_num; i++) {
+            changed[i] = rects[i];
+        }
+        return rect_num;
+    }
+
+    tile_frame++;
+    uint32_t dirty_bytes = 0;
+    uint32_t changed_bytes = 0;
+    int changed_num = 0;
+    for (int i = 0; i < rect_num; i++) {
+        const lvgl_port_copy_rect_t *rect = &rects[i];
+        int col1 = rect->x1 / LVGL_PORT_TILE_HASH_SIZE;
+        int col2 = rect->x2 / LVGL_PORT_TILE_HASH_SIZE;
+        int row1 = rect->y1 / LVGL_PORT_TILE_HASH_SIZE;
+        int row2 = rect->y2 / LVGL_PORT_TILE_HASH_SIZE;
+        dirty_bytes += rect_bytes(rect);
+
+        // Runs of changed tiles in a tile row become one rectangle, runs with the same columns in consecutive tile
+        // rows are stacked into the previous one
+        lvgl_port_copy_rect_t prev[LVGL_PORT_TILE_HASH_RECT_MAX];
+        int prev_num = 0;
+        for (int row = row1; row <= row2; row++) {
+            lvgl_port_copy_rect_t cur[LVGL_PORT_TILE_HASH_RECT_MAX];
+            int cur_num = 0;
+            int run_start = -1;
+            for (int col = col1; col <= col2 + 1; col++) {
+                bool is_changed = false;
+                if (col <= col2) {
+                    tile_t *tile = &tile_table[row * tile_cols + col];
+                    if (tile->frame != tile_frame) {
+                        uint32_t hash = tile_compute_hash((const uint8_t *)buf, col, row);
+                        tile->frame = tile_frame;
+                        tile->changed = (hash != tile->hash);
+                        tile->hash = hash;
+                        tile_stats.tiles_hashed++;
+                    }
+                    is_changed = tile->changed;
+                }
+                if (is_changed && (run_start < 0)) {
+                    run_start = col;
+                } else if (!is_changed && (run_start >= 0)) {
+                    lvgl_port_copy_rect_t run;
+                    run.x1 = (run_start == col1) ? rect->x1 : run_start * LVGL_PORT_TILE_HASH_SIZE;
+                    run.x2 = (col - 1 == col2) ? rect->x2 : col * LVGL_PORT_TILE_HASH_SIZE - 1;
+                    run.y1 = (row == row1) ? rect->y1 : row * LVGL_PORT_TILE_HASH_SIZE;
+                    run.y2 = (row == row2) ? rect->y2 : (row + 1) * LVGL_PORT_TILE_HASH_SIZE - 1;
+                    for (int j = 0; j < prev_num; j++) {
+                        if ((prev[j].x1 == run.x1) && (prev[j].x2 == run.x2) && (prev[j].y2 + 1 == run.y1)) {
+                            run.y1 = prev[j].y1;
+                            prev[j] = prev[--prev_num];
+                            break;
+                        }
+                    }
+                    if (cur_num < LVGL_PORT_TILE_HASH_RECT_MAX) {
+                        cur[cur_num++] = run;
+                    } else {
+                        changed_bytes += rect_bytes(&run);
+                        changed_num = lvgl_port_damage_union_add(changed, changed_num, LVGL_PORT_TILE_HASH_RECT_MAX,
+                                                                 &run);
+                    }
+                    run_start = -1;
+                }
+            }
+            // The runs that were not continued in this row are complete
+            for (int j = 0; j < prev_num; j++) {
+                changed_bytes += rect_bytes(&prev[j]);
+                changed_num = lvgl_port_damage_union_add(changed, changed_num, LVGL_PORT_TILE_HASH_RECT_MAX, &prev[j]);
+            }
+            memcpy(prev, cur, cur_num * sizeof(cur[0]));
+            prev_num = cur_num;
+        }
+        for (int j = 0; j < prev_num; j++) {
+            changed_bytes += rect_bytes(&prev[j]);
+            changed_num = lvgl_port_damage_union_add(changed, changed_num, LVGL_PORT_TILE_HASH_RECT_MAX, &prev[j]);
+        }
+    }
+
+    uint32_t skipped_bytes = (changed_bytes < dirty_bytes) ? (dirty_bytes - changed_bytes) : 0;
+    tile_stats.frames++;
+    tile_stats.frames_unchanged += (changed_num == 0) ? 1 : 0;
+    tile_stats.dirty_bytes += dirty_bytes;
+    tile_stats.skipped_bytes += skipped_bytes;
+    tile_stats.last_dirty_bytes = dirty_bytes;
+    tile_stats.last_skipped_bytes = skipped_bytes;
+
+    return changed_num;
+}
+
+void lvgl_port_tile_hash_get_stats(lvgl_port_tile_hash_stats_t *stats)
+{
+    if (stats != nullptr) {
+        *stats = tile_stats;
+    }
+}
+
+void lvgl_port_tile_hash_reset_stats(void)
+{
+    tile_stats = {};
+}
@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl_port_async_copy.h"
+
+/**
+ * Tile-hash damage filter for direct-mode rendering.
+ *
+ * The screen is split into fixed-size tiles and the hash of every tile of the latest frame is kept. After a frame is
+ * rendered, the tiles touched by its dirty areas are hashed again from the full-screen render buffer and compared with
+ * the stored hashes. The dirty areas are shrunk to the tiles whose hash changed, so pixels that were redrawn with the
+ * same value are neither copied to the other frame buffers nor rotated. A frame without any changed tile does not need
+ * to be presented at all.
+ *
+ * The stored hashes must always describe the latest frame: a frame presented without going through
+ * `lvgl_port_tile_hash_filter()` has to be followed by `lvgl_port_tile_hash_reset()`. Hashes are 32-bit, a collision
+ * (two different tile contents with the same hash, probability about 2^-32 per changed tile) leaves the tile stale
+ * until it is redrawn.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_TILE_HASH_SIZE                (32)    // Width and height of a tile, in pixels
+#define LVGL_PORT_TILE_HASH_RECT_MAX            (LVGL_PORT_ASYNC_COPY_RECT_MAX)
+                                                        // Maximum number of changed rectangles per frame,
+                                                        // rectangles beyond this are merged
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Statistics of the filter, accumulated since the last reset
+ */
+typedef struct {
+    uint32_t frames;                // Frames filtered
+    uint32_t frames_unchanged;      // Frames without any changed tile, their present is skipped
+    uint32_t tiles_hashed;          // Tiles hashed
+    uint64_t dirty_bytes;           // Bytes covered by the dirty areas
+    uint64_t skipped_bytes;         // Bytes of the dirty areas that were found unchanged
+    uint32_t last_dirty_bytes;      // Bytes covered by the dirty areas of the last frame
+    uint32_t last_skipped_bytes;    // Bytes of the dirty areas of the last frame that were found unchanged
+} lvgl_port_tile_hash_stats_t;
+
+/**
+ * @brief Initialize the filter. All tiles start as unknown, so the first frame is never shrunk.
+ *
+ * @param width           Width of the render buffer, in pixels
+ * @param height          Height of the render buffer, in pixels
+ * @param bytes_per_pixel Bytes per pixel of the render buffer
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_tile_hash_init(uint16_t width, uint16_t height, uint8_t bytes_per_pixel);
+
+/**
+ * @brief Deinitialize the filter and free the hash table.
+ */
+void lvgl_port_tile_hash_deinit(void);
+
+/**
+ * @brief Forget the stored hashes, every tile is reported as changed the next time it is filtered.
+ */
+void lvgl_port_tile_hash_reset(void);
+
+/**
+ * @brief Hash the tiles touched by the dirty areas of a rendered frame and shrink the areas to the changed tiles.
+ *
+ * The render buffer must hold the whole frame, not only the dirty areas: partially covered tiles are hashed in full.
+ * Every touched tile is hashed once, even if several dirty areas overlap it.
+ *
+ * @param buf         Full-screen render buffer holding the new frame
+ * @param rects       Dirty areas of the frame
+ * @param rect_num    Number of dirty areas
+ * @param changed     Output, the parts of the dirty areas that changed, at most `LVGL_PORT_TILE_HASH_RECT_MAX`
+ *
+ * @return Number of changed rectangles, `0` if the frame is identical to the previous one
+ */
+int lvgl_port_tile_hash_filter(const void *buf, const lvgl_port_copy_rect_t *rects, int rect_num,
+                               lvgl_port_copy_rect_t *changed);
+
+/**
+ * @brief Get the statistics.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_tile_hash_get_stats(lvgl_port_tile_hash_stats_t *stats);
+
+/**
+ * @brief Reset the statistics.
+ */
+void lvgl_port_tile_hash_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,202 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+#include "lvgl_port_timer_sched.h"
+
+/**
+ * Smoothed cost and its deviation, the estimate is their sum with twice the deviation
+ */
+typedef struct {
+    uint32_t avg_us;
+    uint32_t dev_us;
+} timer_cost_t;
+
+typedef struct {
+    const void *timer;              // `nullptr` if the entry is free
+    lvgl_port_timer_stats_t stats;
+    timer_cost_t cost;
+    uint32_t deferred;              // Deferrals in a row
+    uint64_t cost_us_total;
+} timer_entry_t;
+
+static timer_entry_t timer_entries[LVGL_PORT_TIMER_SCHED_MAX] = {};
+static lvgl_port_timer_sched_stats_t timer_stats = {};
+static timer_cost_t timer_rest = {};        // Cost of the frames without the deferrable timers
+static bool timer_in_frame = false;         // Between the begin and the end of a frame
+static int64_t timer_frame_begin_us = 0;
+static int64_t timer_frame_deadline_us = 0;
+static uint32_t timer_frame_deferrable_us = 0;  // Time of the deferrable timers run in the frame
+
+/**
+ * @brief Add a measure to a cost, the first one sets it
+ *
+ * @return The new estimate
+ */
+static uint32_t timer_estimate(timer_cost_t *cost, uint32_t measure_us, bool first)
+{
+    if (first) {
+        cost->avg_us = measure_us;
+        cost->dev_us = measure_us / 2;
+    } else {
+        int32_t error = (int32_t)(measure_us - cost->avg_us);
+        uint32_t error_abs = (error < 0) ? -error : error;
+        cost->avg_us += error / 8;
+        cost->dev_us = cost->dev_us + ((int32_t)(error_abs - cost->dev_us)) / 4;
+    }
+
+    return cost->avg_us + 2 * cost->dev_us;
+}
+
+static timer_entry_t *timer_find(const void *timer)
+{
+    if (timer == nullptr) {
+        return nullptr;
+    }
+    for (int i = 0; i < LVGL_PORT_TIMER_SCHED_MAX; i++) {
+        if (timer_entries[i].timer == timer) {
+            return &timer_entries[i];
+        }
+    }
+
+    return nullptr;
+}
+
+void lvgl_port_timer_sched_reset(void)
+{
+    memset(timer_entries, 0, sizeof(timer_entries));
+    timer_stats = {};
+    timer_rest = {};
+    timer_in_frame = false;
+    timer_frame_deferrable_us = 0;
+}
+
+bool lvgl_port_timer_sched_register(const void *timer, lvgl_port_timer_class_t timer_class)
+{
+    if ((timer == nullptr) || (timer_find(timer) != nullptr)) {
+        return false;
+    }
+
+    timer_entry_t *entry = nullptr;
+    for (int i = 0; (entry == nullptr) && (i < LVGL_PORT_TIMER_SCHED_MAX); i++) {
+        if (timer_entries[i].timer == nullptr) {
+            entry = &timer_entries[i];
+        }
+    }
+    if (entry == nullptr) {
+        return false;
+    }
+    *entry = {};
+    entry->timer = timer;
+    entry->stats.timer_class = timer_class;
+
+    return true;
+}
+
+bool lvgl_port_timer_sched_unregister(const void *timer)
+{
+    timer_entry_t *entry = timer_find(timer);
+    if (entry == nullptr) {
+        return false;
+    }
+    *entry = {};
+
+    return true;
+}
+
+void lvgl_port_timer_sched_frame_begin(int64_t now_us, int64_t deadline_us)
+{
+    timer_in_frame = true;
+    timer_frame_begin_us = now_us;
+    timer_frame_deadline_us = deadline_us;
+    timer_frame_deferrable_us = 0;
+}
+
+void lvgl_port_timer_sched_frame_end(int64_t now_us, bool rendered)
+{
+    if (!timer_in_frame) {
+        return;
+    }
+    timer_in_frame = false;
+    if (!rendered) {
+        return;
+    }
+
+    int64_t rest_us = now_us - timer_frame_begin_us - timer_frame_deferrable_us;
+    timer_stats.rest_us_est = timer_estimate(&timer_rest, (rest_us > 0) ? (uint32_t)rest_us : 0,
+                                             timer_stats.frames == 0);
+    timer_stats.frames++;
+    timer_stats.late += (now_us > timer_frame_deadline_us);
+}
+
+bool lvgl_port_timer_sched_should_run(const void *timer, int64_t now_us)
+{
+    timer_entry_t *entry = timer_find(timer);
+    if ((entry == nullptr) || (entry->stats.timer_class != LVGL_PORT_TIMER_CLASS_DEFERRABLE) || !timer_in_frame) {
+        return true;
+    }
+    if (entry->deferred >= LVGL_PORT_TIMER_SCHED_DEFER_MAX) {
+        // Postponed long enough, it runs whatever the budget
+        entry->stats.forced++;
+        timer_stats.forced++;
+        return true;
+    }
+
+    // What is left of the frame once this timer has run: the part of the estimated rest not done yet
+    int64_t rest_done_us = now_us - timer_frame_begin_us - timer_frame_deferrable_us;
+    int64_t rest_left_us = (int64_t)timer_stats.rest_us_est - rest_done_us;
+    rest_left_us = (rest_left_us > 0) ? rest_left_us : 0;
+    int64_t end_us = now_us + entry->stats.cost_us_est + rest_left_us + LVGL_PORT_TIMER_SCHED_MARGIN_US;
+    if (end_us <= timer_frame_deadline_us) {
+        return true;
+    }
+
+    entry->deferred++;
+    entry->stats.deferrals++;
+    entry->stats.deferred_max = (entry->deferred > entry->stats.deferred_max) ? entry->deferred :
+                                entry->stats.deferred_max;
+    timer_stats.deferrals++;
+
+    return false;
+}
+
+void lvgl_port_timer_sched_ran(const void *timer, uint32_t cost_us)
+{
+    timer_entry_t *entry = timer_find(timer);
+    if (entry == nullptr) {
+        return;
+    }
+
+    lvgl_port_timer_stats_t *stats = &entry->stats;
+    stats->cost_us_est = timer_estimate(&entry->cost, cost_us, stats->runs == 0);
+    stats->runs++;
+    stats->cost_us_last = cost_us;
+    stats->cost_us_max = (cost_us > stats->cost_us_max) ? cost_us : stats->cost_us_max;
+    entry->cost_us_total += cost_us;
+    stats->cost_us_avg = (uint32_t)(entry->cost_us_total / stats->runs);
+    entry->deferred = 0;
+    if ((stats->timer_class == LVGL_PORT_TIMER_CLASS_DEFERRABLE) && timer_in_frame) {
+        timer_frame_deferrable_us += cost_us;
+    }
+}
+
+bool lvgl_port_timer_sched_get_timer_stats(const void *timer, lvgl_port_timer_stats_t *stats)
+{
+    timer_entry_t *entry = timer_find(timer);
+    if ((entry == nullptr) || (stats == nullptr)) {
+        return false;
+    }
+    *stats = entry->stats;
+
+    return true;
+}
+
+void lvgl_port_timer_sched_get_stats(lvgl_port_timer_sched_stats_t *stats)
+{
+    if (stats != nullptr) {
+        *stats = timer_stats;
+    }
+}
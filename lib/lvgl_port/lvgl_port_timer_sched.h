@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Budget of the LVGL timers within a frame.
+ *
+ * Every timer of LVGL runs inside `lv_timer_handler()`, before the render of the frame, whatever time is left: one
+ * slow timer (a data refresh, a chart update) pushes the frame past its presentation. The timers created through the
+ * port are registered here with a class. A frame-critical timer (an animation step) always runs. A deferrable timer
+ * only runs if its estimated cost fits in what is left of the frame: the deadline (the predicted presentation of the
+ * frame) minus the time, minus the estimated rest of the frame without the deferrable timers. Otherwise it is postponed
+ * to the next frame, and after `LVGL_PORT_TIMER_SCHED_DEFER_MAX` frames in a row it runs anyway: a timer is never
+ * starved longer than that.
+ *
+ * The cost of a timer is estimated from its runs like a round-trip time: a smoothed average plus twice the smoothed
+ * deviation, so a timer that is sometimes slow is planned for its slow runs. The rest of the frame is estimated the
+ * same way from the frames that rendered. A deferrable timer that has never run has no estimate yet, and runs.
+ *
+ * The module doesn't know LVGL: the port registers the timers by their address and wraps their callbacks, all calls
+ * are from the LVGL task.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_TIMER_SCHED_MAX               (16)    // Timers registered at once
+#define LVGL_PORT_TIMER_SCHED_DEFER_MAX         (8)     // Frames a deferrable timer may be postponed in a row
+#define LVGL_PORT_TIMER_SCHED_MARGIN_US         (500)   // Kept free before the deadline, in microseconds
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Class of a timer
+ */
+typedef enum {
+    LVGL_PORT_TIMER_CLASS_CRITICAL = 0,     // Runs in every frame it is due, an animation step
+    LVGL_PORT_TIMER_CLASS_DEFERRABLE,       // May run a few frames late, to frames with slack
+} lvgl_port_timer_class_t;
+
+/**
+ * @brief Statistics of a timer, accumulated since its registration
+ */
+typedef struct {
+    lvgl_port_timer_class_t timer_class;
+    uint32_t runs;                  // Runs of the callback
+    uint32_t deferrals;             // Runs postponed to the next frame
+    uint32_t forced;                // Runs over the budget, after `LVGL_PORT_TIMER_SCHED_DEFER_MAX` deferrals
+    uint32_t deferred_max;          // Most deferrals in a row
+    uint32_t cost_us_last;          // Time of the callback
+    uint32_t cost_us_avg;
+    uint32_t cost_us_max;
+    uint32_t cost_us_est;           // Estimate the decisions are based on
+} lvgl_port_timer_stats_t;
+
+/**
+ * @brief Statistics of the frames, accumulated since `lvgl_port_timer_sched_reset()`
+ */
+typedef struct {
+    uint32_t frames;                // Frames that rendered
+    uint32_t late;                  // Frames that rendered after their deadline
+    uint32_t deferrals;             // Runs postponed, all timers
+    uint32_t forced;                // Runs forced over the budget, all timers
+    uint32_t rest_us_est;           // Estimated frame without the deferrable timers
+} lvgl_port_timer_sched_stats_t;
+
+/**
+ * @brief Forget the registered timers and the statistics.
+ */
+void lvgl_port_timer_sched_reset(void);
+
+/**
+ * @brief Register a timer.
+ *
+ * @param timer       Address of the timer, the key of the other calls
+ * @param timer_class Class of the timer
+ *
+ * @return true if success, false if the timer is already registered or there is no room left
+ */
+bool lvgl_port_timer_sched_register(const void *timer, lvgl_port_timer_class_t timer_class);
+
+/**
+ * @brief Unregister a timer.
+ *
+ * @param timer Address of the timer
+ *
+ * @return true if success, false if the timer isn't registered
+ */
+bool lvgl_port_timer_sched_unregister(const void *timer);
+
+/**
+ * @brief Start a frame, before the timers run.
+ *
+ * @param now_us      Current time
+ * @param deadline_us Time the frame should be over by, its predicted presentation
+ */
+void lvgl_port_timer_sched_frame_begin(int64_t now_us, int64_t deadline_us);
+
+/**
+ * @brief End the frame started by `lvgl_port_timer_sched_frame_begin()`.
+ *
+ * @param now_us   Current time
+ * @param rendered Whether the frame was rendered, only rendered frames update the estimated rest of the frame
+ */
+void lvgl_port_timer_sched_frame_end(int64_t now_us, bool rendered);
+
+/**
+ * @brief Decide whether a due timer runs now, or is postponed to the next frame. A critical timer always runs.
+ *
+ * @param timer  Address of the timer
+ * @param now_us Current time
+ *
+ * @return true if the callback is to be run, then timed with `lvgl_port_timer_sched_ran()`; also true for a timer that
+ *         isn't registered
+ */
+bool lvgl_port_timer_sched_should_run(const void *timer, int64_t now_us);
+
+/**
+ * @brief Record the cost of a run allowed by `lvgl_port_timer_sched_should_run()`.
+ *
+ * @param timer   Address of the timer
+ * @param cost_us Time of the callback
+ */
+void lvgl_port_timer_sched_ran(const void *timer, uint32_t cost_us);
+
+/**
+ * @brief Get the statistics of a timer.
+ *
+ * @param timer Address of the timer
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, false if the timer isn't registered
+ */
+bool lvgl_port_timer_sched_get_timer_stats(const void *timer, lvgl_port_timer_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the frames.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_timer_sched_get_stats(lvgl_port_timer_sched_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
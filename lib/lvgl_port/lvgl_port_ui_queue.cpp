@@ -0,0 +1,216 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <atomic>
+#include "lvgl_port_ui_queue.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#include "esp_timer.h"
+#else
+#include <chrono>
+#define IRAM_ATTR
+#endif
+
+#define UI_QUEUE_MASK           (LVGL_PORT_UI_QUEUE_SIZE - 1)
+#define UI_HANDLE_INDEX_MASK    (LVGL_PORT_UI_QUEUE_HANDLE_MAX - 1)
+
+static_assert((LVGL_PORT_UI_QUEUE_SIZE & UI_QUEUE_MASK) == 0, "The size of the UI queue must be a power of 2");
+static_assert(
+    (LVGL_PORT_UI_QUEUE_HANDLE_MAX & UI_HANDLE_INDEX_MASK) == 0, "The number of UI handles must be a power of 2"
+);
+
+/**
+ * @brief Slot of the ring
+ *
+ * @note  `seq` counts the laps of the slot from the first position of the lap (`pos & ~UI_QUEUE_MASK`), so zeroed
+ *        slots are free for the first lap: it is the base of the lap when the slot is free, the base plus one once a
+ *        producer published its command, and the base of the next lap once the consumer took it.
+ */
+typedef struct {
+    std::atomic<uint32_t> seq;
+    lvgl_port_ui_cmd_t cmd;
+} ui_queue_slot_t;
+
+/**
+ * @brief Entry of the table of handles
+ *
+ * @note  A handle is the index of its entry in the low bits and the generation of the entry above, which is never `0`,
+ *        so no handle is `LVGL_PORT_UI_HANDLE_INVALID`.
+ */
+typedef struct {
+    void *target;                   // `NULL` while free
+    uint32_t generation;            // Bumped each time the entry is freed
+} ui_queue_handle_entry_t;
+
+static ui_queue_handle_entry_t ui_queue_handles[LVGL_PORT_UI_QUEUE_HANDLE_MAX] = {};
+static ui_queue_slot_t ui_queue_slots[LVGL_PORT_UI_QUEUE_SIZE] = {};
+static std::atomic<uint32_t> ui_queue_tail(0);              // Next position claimed by a producer
+static uint32_t ui_queue_head = 0;                          // Next position taken by the consumer
+static lvgl_port_ui_cmd_t ui_queue_batch[LVGL_PORT_UI_QUEUE_SIZE];  // Commands of the current drain
+
+static std::atomic<uint32_t> ui_queue_pushed(0);
+static std::atomic<uint32_t> ui_queue_dropped(0);
+static std::atomic<uint32_t> ui_queue_push_us_max(0);
+static lvgl_port_ui_queue_stats_t ui_queue_stats = {};      // Fields of the consumer
+static uint64_t ui_queue_latency_us_total = 0;
+
+IRAM_ATTR static inline uint32_t ui_queue_time_us(void)
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+           ).count();
+#endif
+}
+
+static inline lvgl_port_ui_handle_t ui_queue_handle(int index)
+{
+    return (ui_queue_handles[index].generation * LVGL_PORT_UI_QUEUE_HANDLE_MAX) | index;
+}
+
+lvgl_port_ui_handle_t lvgl_port_ui_queue_register(void *target)
+{
+    if (target == nullptr) {
+        return LVGL_PORT_UI_HANDLE_INVALID;
+    }
+
+    for (int i = 0; i < LVGL_PORT_UI_QUEUE_HANDLE_MAX; i++) {
+        if (ui_queue_handles[i].target == nullptr) {
+            // The generations wrap around past the bits of the index, skipping `0`
+            if (ui_queue_handle(i) == (lvgl_port_ui_handle_t)i) {
+                ui_queue_handles[i].generation++;
+            }
+            ui_queue_handles[i].target = target;
+            return ui_queue_handle(i);
+        }
+    }
+
+    return LVGL_PORT_UI_HANDLE_INVALID;
+}
+
+void lvgl_port_ui_queue_unregister(lvgl_port_ui_handle_t handle)
+{
+    if (lvgl_port_ui_queue_resolve(handle) == nullptr) {
+        return;
+    }
+
+    ui_queue_handle_entry_t *entry = &ui_queue_handles[handle & UI_HANDLE_INDEX_MASK];
+    entry->target = nullptr;
+    entry->generation++;
+}
+
+void *lvgl_port_ui_queue_resolve(lvgl_port_ui_handle_t handle)
+{
+    int index = handle & UI_HANDLE_INDEX_MASK;
+
+    if ((handle == LVGL_PORT_UI_HANDLE_INVALID) || (ui_queue_handles[index].target == nullptr) ||
+            (ui_queue_handle(index) != handle)) {
+        return nullptr;
+    }
+
+    return ui_queue_handles[index].target;
+}
+
+IRAM_ATTR bool lvgl_port_ui_queue_push(const lvgl_port_ui_cmd_t *cmd)
+{
+    if ((cmd == nullptr) || (cmd->target == LVGL_PORT_UI_HANDLE_INVALID) || (cmd->type >= LVGL_PORT_UI_CMD_MAX)) {
+        return false;
+    }
+
+    uint32_t start_us = ui_queue_time_us();
+    uint32_t pos = ui_queue_tail.load(std::memory_order_relaxed);
+    ui_queue_slot_t *slot = nullptr;
+    while (true) {
+        slot = &ui_queue_slots[pos & UI_QUEUE_MASK];
+        int32_t lap = (int32_t)(slot->seq.load(std::memory_order_acquire) - (pos & ~UI_QUEUE_MASK));
+        if (lap == 0) {
+            // Free for this lap, claim it
+            if (ui_queue_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lap < 0) {
+            // Still holds the command of the previous lap, the queue is full
+            ui_queue_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            // Another producer claimed it first
+            pos = ui_queue_tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    // The slot belongs to the consumer once published
+    uint32_t end_us = ui_queue_time_us();
+    slot->cmd = *cmd;
+    slot->cmd.push_us = end_us;
+    slot->seq.store((pos & ~UI_QUEUE_MASK) + 1, std::memory_order_release);
+
+    ui_queue_pushed.fetch_add(1, std::memory_order_relaxed);
+    uint32_t push_us = end_us - start_us;
+    uint32_t push_us_max = ui_queue_push_us_max.load(std::memory_order_relaxed);
+    while ((push_us > push_us_max) &&
+            !ui_queue_push_us_max.compare_exchange_weak(push_us_max, push_us, std::memory_order_relaxed)) {
+    }
+
+    return true;
+}
+
+int lvgl_port_ui_queue_drain(lvgl_port_ui_queue_apply_cb_t apply_cb, void *user_data)
+{
+    // Take what is published, up to a slot claimed but not published yet
+    uint32_t depth = ui_queue_tail.load(std::memory_order_relaxed) - ui_queue_head;
+    int cmd_num = 0;
+    while (cmd_num < LVGL_PORT_UI_QUEUE_SIZE) {
+        ui_queue_slot_t *slot = &ui_queue_slots[ui_queue_head & UI_QUEUE_MASK];
+        uint32_t lap = ui_queue_head & ~UI_QUEUE_MASK;
+        if (slot->seq.load(std::memory_order_acquire) != lap + 1) {
+            break;
+        }
+        ui_queue_batch[cmd_num++] = slot->cmd;
+        slot->seq.store(lap + LVGL_PORT_UI_QUEUE_SIZE, std::memory_order_release);
+        ui_queue_head++;
+    }
+    ui_queue_stats.depth = depth;
+    ui_queue_stats.depth_max = (depth > ui_queue_stats.depth_max) ? depth : ui_queue_stats.depth_max;
+    if (cmd_num == 0) {
+        return 0;
+    }
+
+    uint32_t now_us = ui_queue_time_us();
+    for (int i = 0; i < cmd_num; i++) {
+        const lvgl_port_ui_cmd_t *cmd = &ui_queue_batch[i];
+        bool overridden = false;
+        for (int j = i + 1; !overridden && (j < cmd_num); j++) {
+            overridden = (ui_queue_batch[j].target == cmd->target) && (ui_queue_batch[j].type == cmd->type);
+        }
+        if (overridden) {
+            ui_queue_stats.coalesced++;
+            continue;
+        }
+
+        if (apply_cb != nullptr) {
+            apply_cb(cmd, user_data);
+        }
+        uint32_t latency_us = now_us - cmd->push_us;
+        ui_queue_stats.applied++;
+        ui_queue_latency_us_total += latency_us;
+        ui_queue_stats.latency_us_max = (latency_us > ui_queue_stats.latency_us_max) ? latency_us :
+                                        ui_queue_stats.latency_us_max;
+    }
+    ui_queue_stats.latency_us_avg = ui_queue_latency_us_total / ui_queue_stats.applied;
+
+    return cmd_num;
+}
+
+void lvgl_port_ui_queue_get_stats(lvgl_port_ui_queue_stats_t *stats)
+{
+    *stats = ui_queue_stats;
+    stats->pushed = ui_queue_pushed.load(std::memory_order_relaxed);
+    stats->dropped = ui_queue_dropped.load(std::memory_order_relaxed);
+    stats->push_us_max = ui_queue_push_us_max.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,156 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Queue of UI commands, for the tasks that update the UI without taking the LVGL mutex.
+ *
+ * The LVGL task holds the mutex for the whole `lv_timer_handler()`, vsync wait included, so a task calling
+ * `lvgl_port_lock()` to change a label can stall for a frame or more. Such tasks rather push a command (set the text
+ * of a label, set the value of a bar, move, show or hide an object) and return at once. The LVGL task drains the queue
+ * once at the start of each frame and applies the commands in the order they were pushed, skipping those overridden
+ * by a later command of the same type for the same target: a sensor pushing faster than the frame rate only costs the
+ * last of its updates.
+ *
+ * The queue is a bounded ring of `LVGL_PORT_UI_QUEUE_SIZE` commands, lock-free for any number of producers (tasks or
+ * ISRs) and one consumer. Each slot has a sequence number telling whether it is free or holds a command of the current
+ * lap, producers claim a slot with a CAS on the tail and publish it with its sequence. A producer never waits for the
+ * consumer: when the ring is full, the command is dropped and counted.
+ *
+ * The commands don't carry the target as a pointer: once its object is deleted, a pointer could be dangling or, worse,
+ * point to a new object allocated at the same address. They carry a handle of the target instead, taken from a table
+ * of `LVGL_PORT_UI_QUEUE_HANDLE_MAX` entries by `lvgl_port_ui_queue_register()`. Each entry counts its generations:
+ * `lvgl_port_ui_queue_unregister()`, called when the object is deleted, bumps it, so the handles given out before no
+ * longer resolve, in constant time. The module doesn't know LVGL, the consumer resolves the handles and applies the
+ * commands.
+ */
+
+// *INDENT-OFF*
+
+#define LVGL_PORT_UI_QUEUE_SIZE                 (32)    // Commands in the ring, a power of 2
+#define LVGL_PORT_UI_QUEUE_TEXT_MAX             (32)    // Maximum length of a text, terminator included
+#define LVGL_PORT_UI_QUEUE_HANDLE_MAX           (64)    // Targets registered at the same time, a power of 2
+
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Handle of a target, `LVGL_PORT_UI_HANDLE_INVALID` if none
+ */
+typedef uint32_t lvgl_port_ui_handle_t;
+
+#define LVGL_PORT_UI_HANDLE_INVALID             (0)
+
+/**
+ * @brief Type of a UI command
+ */
+typedef enum {
+    LVGL_PORT_UI_CMD_SET_TEXT = 0,  // Text of a label
+    LVGL_PORT_UI_CMD_SET_VALUE,     // Value of a bar, a slider or an arc
+    LVGL_PORT_UI_CMD_MOVE,          // Position of an object
+    LVGL_PORT_UI_CMD_SET_HIDDEN,    // Visibility of an object
+    LVGL_PORT_UI_CMD_MAX,
+} lvgl_port_ui_cmd_type_t;
+
+/**
+ * @brief UI command
+ */
+typedef struct {
+    lvgl_port_ui_cmd_type_t type;
+    lvgl_port_ui_handle_t target;   // Object to change
+    uint32_t push_us;               // Time of the push, set by the queue
+    union {
+        char text[LVGL_PORT_UI_QUEUE_TEXT_MAX];
+        int32_t value;
+        struct {
+            int16_t x;
+            int16_t y;
+        } pos;
+        bool hidden;
+    };
+} lvgl_port_ui_cmd_t;
+
+/**
+ * @brief Statistics of the queue, accumulated since the start
+ */
+typedef struct {
+    uint32_t pushed;                // Commands queued
+    uint32_t dropped;               // Commands dropped because the queue was full
+    uint32_t applied;               // Commands applied
+    uint32_t coalesced;             // Commands skipped, overridden by a later one
+    uint32_t depth;                 // Commands in the queue at the last drain
+    uint32_t depth_max;             // Most commands in the queue at a drain
+    uint32_t push_us_max;           // Longest push, retries of the CAS included: the wait of a producer
+    uint32_t latency_us_avg;        // Time from the push to the apply, of the applied commands
+    uint32_t latency_us_max;
+} lvgl_port_ui_queue_stats_t;
+
+/**
+ * @brief Apply a command, called by `lvgl_port_ui_queue_drain()` for each command that isn't overridden
+ */
+typedef void (*lvgl_port_ui_queue_apply_cb_t)(const lvgl_port_ui_cmd_t *cmd, void *user_data);
+
+/**
+ * @brief Register a target. Called by the consumer's task, like the two functions below.
+ *
+ * @param target Target, registering it twice gives two handles
+ *
+ * @return Its handle, `LVGL_PORT_UI_HANDLE_INVALID` if the target is `NULL` or the table is full
+ */
+lvgl_port_ui_handle_t lvgl_port_ui_queue_register(void *target);
+
+/**
+ * @brief Unregister a target, its handle and the commands queued for it no longer resolve.
+ *
+ * @param handle Handle of the target, ignored if it no longer resolves
+ */
+void lvgl_port_ui_queue_unregister(lvgl_port_ui_handle_t handle);
+
+/**
+ * @brief Get the target of a handle.
+ *
+ * @param handle Handle
+ *
+ * @return The target, `NULL` if it was unregistered since
+ */
+void *lvgl_port_ui_queue_resolve(lvgl_port_ui_handle_t handle);
+
+/**
+ * @brief Push a command, without blocking. Callable from any task or ISR.
+ *
+ * @param cmd Command, copied. Its `text` must be terminated.
+ *
+ * @return true if queued, false if the queue is full or the command has no target
+ */
+bool lvgl_port_ui_queue_push(const lvgl_port_ui_cmd_t *cmd);
+
+/**
+ * @brief Apply the commands queued so far, skipping those overridden by a later command of the same type for the same
+ *        target. Only one task may drain, the commands pushed meanwhile are left for the next drain.
+ *
+ * @param apply_cb  Called for each command to apply, in the order of the pushes
+ * @param user_data Passed to `apply_cb`
+ *
+ * @return The number of commands drained, applied or skipped
+ */
+int lvgl_port_ui_queue_drain(lvgl_port_ui_queue_apply_cb_t apply_cb, void *user_data);
+
+/**
+ * @brief Get the statistics of the queue.
+ *
+ * @param stats Pointer to the statistics to be filled
+ */
+void lvgl_port_ui_queue_get_stats(lvgl_port_ui_queue_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
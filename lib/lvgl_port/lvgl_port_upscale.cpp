@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+#include "lvgl_port_upscale.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+
+static const uint16_t *upscale_src = nullptr;
+static uint16_t upscale_width = 0;
+static uint16_t upscale_height = 0;
+static bool upscale_bilinear = false;
+
+bool lvgl_port_upscale_init(const void *src, uint16_t width, uint16_t height, bool bilinear)
+{
+    if ((src == nullptr) || (width == 0) || (height == 0)) {
+        return false;
+    }
+
+    upscale_width = width;
+    upscale_height = height;
+    upscale_bilinear = bilinear;
+    upscale_src = (const uint16_t *)src;
+
+    return true;
+}
+
+void lvgl_port_upscale_deinit(void)
+{
+    upscale_src = nullptr;
+    upscale_width = 0;
+    upscale_height = 0;
+}
+
+void lvgl_port_upscale_get_lines(int y1, int y2, int *out_y1, int *out_y2)
+{
+    // An odd line of the panel reads the lines above and below it with the bilinear filter
+    int first = 2 * y1 - (upscale_bilinear ? 1 : 0);
+    int last = 2 * y2 + 1;
+
+    *out_y1 = (first > 0) ? first : 0;
+    *out_y2 = (last < 2 * upscale_height - 1) ? last : (2 * upscale_height - 1);
+}
+
+/**
+ * @brief Average of two RGB565 pixels, rounded down per channel
+ */
+__attribute__((always_inline))
+static inline uint16_t upscale_average(uint16_t a, uint16_t b)
+{
+    return (a & b) + (((a ^ b) & 0xF7DE) >> 1);
+}
+
+template <bool Vertical>
+__attribute__((always_inline))
+static inline uint16_t upscale_sample(const uint16_t *row0, const uint16_t *row1, int i)
+{
+    return Vertical ? upscale_average(row0[i], row1[i]) : row0[i];
+}
+
+IRAM_ATTR static void upscale_line_nearest(uint16_t *dst, const uint16_t *row, int x, int len_px)
+{
+    const int end = x + len_px;
+
+    if ((x & 1) && (x < end)) {
+        *dst++ = row[x >> 1];
+        x++;
+    }
+    for (; x + 1 < end; x += 2) {
+        uint16_t pixel = row[x >> 1];
+        dst[0] = pixel;
+        dst[1] = pixel;
+        dst += 2;
+    }
+    if (x < end) {
+        *dst = row[x >> 1];
+    }
+}
+
+/**
+ * @brief Upscale one line segment with the bilinear filter, from one line (`Vertical = false`) or from the average
+ *        of two lines
+ *
+ * @note  Each pixel of the frame buffer is read once, the odd pixels of the panel average it with the next one.
+ */
+template <bool Vertical>
+IRAM_ATTR static void upscale_line_bilinear(
+    uint16_t *dst, const uint16_t *row0, const uint16_t *row1, int x, int len_px
+)
+{
+    const int end = x + len_px;
+    const int last = upscale_width - 1;
+
+    if ((x & 1) && (x < end)) {
+        int i = x >> 1;
+        uint16_t left = upscale_sample<Vertical>(row0, row1, i);
+        *dst++ = upscale_average(left, upscale_sample<Vertical>(row0, row1, (i < last) ? (i + 1) : last));
+        x++;
+    }
+    if (x >= end) {
+        return;
+    }
+
+    uint16_t pixel = upscale_sample<Vertical>(row0, row1, x >> 1);
+    for (; x + 1 < end; x += 2) {
+        int i = x >> 1;
+        uint16_t next = upscale_sample<Vertical>(row0, row1, (i < last) ? (i + 1) : last);
+        dst[0] = pixel;
+        dst[1] = upscale_average(pixel, next);
+        dst += 2;
+        pixel = next;
+    }
+    if (x < end) {
+        *dst = pixel;
+    }
+}
+
+IRAM_ATTR void lvgl_port_upscale_fill(void *dst, const void *src, int x, int y, int len_px, void *)
+{
+    const uint16_t *pixels = upscale_src;
+
+    if ((pixels == nullptr) || (y >= 2 * upscale_height)) {
+        if (src != nullptr) {
+            memcpy(dst, src, len_px * sizeof(uint16_t));
+        }
+        return;
+    }
+
+    const int line = y >> 1;
+    const uint16_t *row = pixels + (size_t)line * upscale_width;
+    if (!upscale_bilinear) {
+        upscale_line_nearest((uint16_t *)dst, row, x, len_px);
+    } else if (!(y & 1) || (line == upscale_height - 1)) {
+        upscale_line_bilinear<false>((uint16_t *)dst, row, row, x, len_px);
+    } else {
+        upscale_line_bilinear<true>((uint16_t *)dst, row, row + upscale_width, x, len_px);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Frame buffer at half the resolution of the panel, upscaled 2x in both directions at scanout.
+ *
+ * The fill callback `lvgl_port_upscale_fill()` (see `lvgl_port_scanout.h`) expands each line of the small frame buffer
+ * into the bounce buffer, so a quarter of the pixels are rendered and written, and the scanout reads half as many
+ * bytes (each line of the small frame buffer is read for two lines of the panel).
+ *
+ * Two filters are available:
+ *      - Nearest: each pixel is repeated 2x2, for UI content whose edges must stay sharp
+ *      - Bilinear: the pixels in between are the averages of their neighbors, for smooth content like gradients. The
+ *        odd lines read two lines of the small frame buffer.
+ *
+ * The colors are RGB565, `lvgl_port_upscale_fill()` only supports 16-bit frame buffers.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Use a frame buffer at half the resolution of the panel
+ *
+ * @param src      Frame buffer, `width * height` pixels
+ * @param width    Width of the frame buffer, half of the panel width, in pixels
+ * @param height   Height of the frame buffer, half of the panel height, in pixels
+ * @param bilinear Use the bilinear filter instead of the nearest one
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_upscale_init(const void *src, uint16_t width, uint16_t height, bool bilinear);
+
+/**
+ * @brief Stop using the frame buffer, the fill callback must be detached first.
+ */
+void lvgl_port_upscale_deinit(void);
+
+/**
+ * @brief Get the lines of the panel that read the lines `y1` to `y2` of the frame buffer, for the filter in use.
+ *
+ * @param y1    First line of the frame buffer
+ * @param y2    Last line of the frame buffer
+ * @param out_y1 First line of the panel
+ * @param out_y2 Last line of the panel
+ */
+void lvgl_port_upscale_get_lines(int y1, int y2, int *out_y1, int *out_y2);
+
+/**
+ * @brief Fill callback upscaling the frame buffer, see `lvgl_port_scanout_fill_cb_t`. The pixels are read from the
+ *        frame buffer of `lvgl_port_upscale_init()`, `src` is only copied when there is none. `user_data` is not used.
+ */
+void lvgl_port_upscale_fill(void *dst, const void *src, int x, int y, int len_px, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
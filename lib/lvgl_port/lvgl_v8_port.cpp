@@ -4,205 +4,314 @@
  * SPDX-License-Identifier: CC0-1.0
  */
 
+#include <atomic>
 #include "esp_timer.h"
 #undef ESP_UTILS_LOG_TAG
 #define ESP_UTILS_LOG_TAG "LvPort"
 #include "esp_lib_utils.h"
 #include "lvgl_v8_port.h"
+#include "lvgl_port_tick.h"
+#include "lvgl_port_async_copy.h"
+#include "lvgl_port_damage.h"
+#include "lvgl_port_flush_worker.h"
+#include "lvgl_port_frame_sched.h"
+#include "lvgl_port_jobs.h"
+#include "lvgl_port_overlay.h"
+#include "lvgl_port_palette.h"
+#include "lvgl_port_pipeline.hpp"
+#include "lvgl_port_rotate.h"
+#include "lvgl_port_scanout.h"
+#include "lvgl_port_screen_prep.h"
+#include "lvgl_port_tile_hash.h"
+#include "lvgl_port_timer_sched.h"
+#include "lvgl_port_ui_queue.h"
+#include "lvgl_port_upscale.h"
 
 using namespace esp_panel::drivers;
 
-#define LVGL_PORT_ENABLE_ROTATION_OPTIMIZED     (1)
 #define LVGL_PORT_BUFFER_NUM_MAX                (2)
 
+// The modes of direct-mode hook internals of LVGL 8.3 and 8.4, which later versions change: the synchronization of the
+// dirty areas between the render buffers (`sync_areas` of the display, `buffer_copy` of the draw context) and the
+// refresh timer of the display, which the adaptive mode wraps. See `display_update_hooks()`
+#if (LVGL_VERSION_MAJOR != 8) || (LVGL_VERSION_MINOR < 3)
+#error "The port supports LVGL 8.3 and 8.4"
+#endif
+
+typedef enum {
+    STRATEGY_SYNC_NONE,                 // The mode doesn't synchronize dirty areas between frame buffers
+    STRATEGY_SYNC_CPU,                  // Used without `async_copy`
+    STRATEGY_SYNC_ASYNC,                // Used with `async_copy`
+    STRATEGY_SYNC_WORKER,               // Used with `pipeline`, the flush worker copies on the other core
+} lvgl_port_strategy_sync_t;
+
+/**
+ * Everything that differs between the avoid tearing modes. The callbacks are instances of the flush pipeline templates
+ * for the rotation and synchronization of the entry (see `lvgl_port_pipeline.hpp`), handed to LVGL and to the LCD as
+ * they are, so choosing the mode at runtime costs nothing per frame.
+ */
+typedef struct {
+    lvgl_port_avoid_tearing_mode_t mode;
+    int rotation;
+    lvgl_port_strategy_sync_t sync;
+    int frame_buffer_num;
+    bool present_queue;                 // `flush_cb` returns without waiting for the vsync, see `lvgl_port_present.h`
+    bool scanout;                       // Needs the position of the scanout, see `lvgl_port_scanout.h`
+    void (*setup)(lv_disp_drv_t *drv);  // Hand the frame buffers to LVGL and reset the state of the mode
+    void (*flush_cb)(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
+    void (*render_start_cb)(lv_disp_drv_t *drv);
+    bool (*vsync_cb)(void *user_data);
+    void (*refr_timer_cb)(lv_timer_t *timer);
+                                        // Wrap LVGL's refresh timer, to act before the invalid areas are joined
+    void (*buffer_copy)(
+        lv_draw_ctx_t *draw_ctx, void *dest_buf, lv_coord_t dest_stride, const lv_area_t *dest_area, void *src_buf,
+        lv_coord_t src_stride, const lv_area_t *src_area
+    );                                  // Replace LVGL's synchronization of the dirty areas in direct-mode
+} lvgl_port_strategy_t;
+
+typedef struct {
+    uint32_t frames;
+    lvgl_port_benchmark_result_t *results;
+    int result_max;
+    int result_num;
+    SemaphoreHandle_t done;
+} lvgl_port_benchmark_t;
+
 static SemaphoreHandle_t lvgl_mux = nullptr;                  // LVGL mutex
 static TaskHandle_t lvgl_task_handle = nullptr;
-static esp_timer_handle_t lvgl_tick_timer = NULL;
 static void *lvgl_buf[LVGL_PORT_BUFFER_NUM_MAX] = {};
+static lv_disp_drv_t *lvgl_disp_drv = nullptr;                // Completed from the vsync ISR by the present queue
+static lvgl_port_config_t lvgl_port_config = LVGL_PORT_CONFIG_DEFAULT();
+static const lvgl_port_strategy_t *lvgl_port_strategy = nullptr;   // `nullptr` if avoid tearing is disabled
+static void *lvgl_port_fbs[LVGL_PORT_FRAME_BUFFER_NUM_MAX] = {};
+static lvgl_port_benchmark_t *volatile lvgl_port_benchmark_request = nullptr;
+static uint32_t lvgl_port_benchmark_rendered = 0;            // Frames counted by `monitor_callback()`
+static SemaphoreHandle_t lvgl_task_wake = nullptr;            // Wakes up the LVGL task before its next timer
+static int lvgl_lock_depth = 0;                               // Nesting of the lock, only changed with it held
+static lvgl_port_task_stats_t lvgl_task_stats = {};
+static lv_indev_t *lvgl_touch_indev = nullptr;
+static bool touch_by_interrupt = false;                       // The touch panel tells when it is touched
+static volatile bool touch_pending = false;                   // Set by the touch interrupt for the LVGL task
+static volatile bool tick_by_frame = false;                   // LVGL's tick follows the frames of the scheduler
+static std::atomic<int64_t> tick_frame_us(0);                 // Time of LVGL's tick while it follows the frames, and
+                                                              // the least it can be otherwise. LVGL reads the tick
+                                                              // from any task, the LVGL task alone moves it
+static int64_t frame_start_us = 0;                            // Start of the frame of the scheduler
+static int64_t frame_present_us = 0;                          // Predicted presentation of the frame of the scheduler
+static lv_timer_cb_t timer_cbs[LVGL_PORT_TIMER_SCHED_MAX] = {};   // Callbacks of the timers of the port
+static lv_timer_t *timer_handles[LVGL_PORT_TIMER_SCHED_MAX] = {};
+static bool screen_prep_running = false;                      // The worker of the screen preparations is started
+
+static const char *mode_names[LVGL_PORT_AVOID_TEARING_MODE_MAX] = {
+    "none", "double full-refresh", "triple full-refresh", "double direct-mode", "triple direct-mode", "double adaptive",
+    "double tiled", "single beam", "single indexed", "single half-resolution"
+};
+
+static void *lvgl_port_next_fb = NULL;          // The frame buffer last rotated into
+
+static void *get_next_frame_buffer(void)
+{
+    if (lvgl_port_next_fb == NULL) {
+        lvgl_port_next_fb = lvgl_port_fbs[1];
+    } else {
+        lvgl_port_next_fb = (lvgl_port_next_fb == lvgl_port_fbs[0]) ? lvgl_port_fbs[1] : lvgl_port_fbs[0];
+    }
+
+    return lvgl_port_next_fb;
+}
+
+using lvgl_port::Rotate;
+using lvgl_port::SyncAsync;
+using lvgl_port::SyncCpu;
 
-#if LVGL_PORT_ROTATION_DEGREE != 0
-static void *get_next_frame_buffer(LCD *lcd)
+typedef lvgl_port::PixelOf<sizeof(lv_color_t)>::type lvgl_port_pixel_t;
+
+static uint32_t parallel_copy_min_pixels[4] = {     // Crossover of each rotation, by 90 degrees
+    LVGL_PORT_PARALLEL_COPY_MIN_PIXELS, LVGL_PORT_PARALLEL_COPY_MIN_PIXELS, LVGL_PORT_PARALLEL_COPY_MIN_PIXELS,
+    LVGL_PORT_PARALLEL_COPY_MIN_PIXELS
+};
+
+/**
+ * @brief Copy a rectangle of LVGL's frame rotated by the CPU, split over both cores above the crossover
+ */
+template <class Rotation>
+static inline void display_rotate_copy(const void *from, void *to, const lvgl_port_copy_rect_t &rect, int w, int h)
 {
-    static void *next_fb = NULL;
-    static void *fbs[2] = { NULL };
+    uint32_t pixels = (uint32_t)(rect.x2 - rect.x1 + 1) * (rect.y2 - rect.y1 + 1);
 
-    if (next_fb == NULL) {
-        fbs[0] = lcd->getFrameBufferByIndex(0);
-        fbs[1] = lcd->getFrameBufferByIndex(1);
-        next_fb = fbs[1];
+    if (lvgl_port_config.parallel_copy && (pixels >= parallel_copy_min_pixels[Rotation::degree / 90])) {
+        lvgl_port::rotate_copy_parallel<Rotation, lvgl_port_pixel_t>(from, to, rect, w, h);
     } else {
-        next_fb = (next_fb == fbs[0]) ? fbs[1] : fbs[0];
+        lvgl_port::rotate_copy<Rotation, lvgl_port_pixel_t>(from, to, rect, w, h);
     }
+}
+
+static void wait_callback(lv_disp_drv_t *drv);
+static void monitor_callback(lv_disp_drv_t *drv, uint32_t time_ms, uint32_t px);
+void rounder_callback(lv_disp_drv_t *drv, lv_area_t *area);
+static bool display_attach_vsync(LCD *lcd, const lvgl_port_strategy_t *strategy);
 
-    return next_fb;
+static void *lvgl_port_fb_shown = nullptr;      // The frame buffer last switched to
+static bool lvgl_port_mode_fill = false;        // The fill of the scanout belongs to the mode, not to the user
+static bool lvgl_port_user_fill = false;        // The user fills the scanout
+static bool lvgl_port_user_overlays = false;    // The user composes overlays into the scanout
+static int lvgl_port_scale = 1;                 // Pixels of the panel per pixel of LVGL, in both directions
+
+/**
+ * @brief Switch the frame buffer scanned out by the LCD, the scanout refill has to follow it once attached
+ */
+static inline void display_switch_frame_buffer(LCD *lcd, void *fb)
+{
+    lvgl_port_fb_shown = fb;
+    lvgl_port_scanout_set_frame_buffer(fb);
+    lcd->switchFrameBufferTo(fb);
 }
 
-__attribute__((always_inline))
-static inline void copy_pixel_8bpp(uint8_t *to, const uint8_t *from)
+/**
+ * @brief Prepare the scanout before it is attached, starting from the frame buffer on screen
+ */
+static bool display_init_scanout(LCD *lcd)
 {
-    *to++ = *from++;
+    if (lvgl_port_scanout_attached()) {
+        return true;
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        lvgl_port_scanout_init(lcd->getFrameWidth(), lcd->getFrameHeight(), sizeof(lv_color_t)), false,
+        "Initialize scanout failed"
+    );
+    lvgl_port_scanout_set_frame_buffer(
+        (lvgl_port_fb_shown != nullptr) ? lvgl_port_fb_shown : lcd->getFrameBufferByIndex(0)
+    );
+
+    return true;
 }
 
-__attribute__((always_inline))
-static inline void copy_pixel_16bpp(uint8_t *to, const uint8_t *from)
+/**
+ * @brief Take over the refill of the bounce buffers in any mode for the users of the scanout, or give it back once
+ *        neither the user nor the mode needs it. The lock must be held.
+ */
+static bool display_update_scanout(void)
 {
-    *(uint16_t *)to++ = *(const uint16_t *)from++;
+    LCD *lcd = (LCD *)lvgl_disp_drv->user_data;
+
+    ESP_UTILS_CHECK_FALSE_RETURN(display_init_scanout(lcd), false, "Initialize scanout failed");
+
+    return display_attach_vsync(lcd, lvgl_port_strategy);
 }
 
-__attribute__((always_inline))
-static inline void copy_pixel_24bpp(uint8_t *to, const uint8_t *from)
+/**
+ * @brief Let the mode generate the scanout from its own frame buffer format, until the next mode is applied
+ */
+static void display_set_mode_fill(lvgl_port_scanout_fill_cb_t fill_cb)
 {
-    *to++ = *from++;
-    *to++ = *from++;
-    *to++ = *from++;
+    lvgl_port_scanout_set_fill(fill_cb, nullptr);
+    lvgl_port_mode_fill = (fill_cb != nullptr);
 }
 
-#define _COPY_PIXEL(_bpp, to, from) copy_pixel_##_bpp##bpp(to, from)
-#define COPY_PIXEL(_bpp, to, from)  _COPY_PIXEL(_bpp, to, from)
+/**
+ * @brief Pixels of the panel per pixel of LVGL, fixed at `lvgl_port_init_with_config()` since LVGL's content is laid
+ *        out for the resolution of the display
+ */
+static inline int mode_scale(int mode)
+{
+    return (mode == LVGL_PORT_AVOID_TEARING_MODE_SINGLE_HALF) ? 2 : 1;
+}
 
-#define ROTATE_90_ALL_BPP() \
-    { \
-        to_bytes_per_line = h * to_bytes_per_piexl; \
-        to_index_const = (w - x_start - 1) * to_bytes_per_line; \
-        for (int from_y = y_start; from_y < y_end + 1; from_y++) { \
-            from_index = from_y * from_bytes_per_line + x_start * from_bytes_per_piexl; \
-            to_index = to_index_const + from_y * to_bytes_per_piexl; \
-            for (int from_x = x_start; from_x < x_end + 1; from_x++) { \
-                COPY_PIXEL(LV_COLOR_DEPTH, to + to_index, from + from_index); \
-                from_index += from_bytes_per_piexl; \
-                to_index -= to_bytes_per_line; \
-            } \
-        } \
-    }
+/**
+ * @brief Rotation of the strategy of a mode, `0` when LVGL's frame is rotated at scanout instead. The modes 7 to 9
+ *        write bands of lines around the beam, which are not lines of the panel once rotated.
+ */
+static inline int config_render_rotation(const lvgl_port_config_t *config, int mode)
+{
+    return (config->scanout_rotation && (mode < LVGL_PORT_AVOID_TEARING_MODE_SINGLE_BEAM)) ? 0 : config->rotation;
+}
 
 /**
- * @brief Optimized transpose function for RGB565 format.
- *
- * @note  ESP32-P4 1024x600 full-screen: 738ms -> 34ms
- * @note  ESP32-S3 480x480  full-screen: 380ms -> 37ms
- */
-#define ROTATE_90_OPTIMIZED_16BPP(block_w, block_h) \
-    { \
-        for (int i = 0; i < h; i += block_h) { \
-            max_height = (i + block_h > h) ? h : (i + block_h); \
-            for (int j = 0; j < w; j += block_w) { \
-                max_width = (j + block_w > w) ? w : (j + block_w); \
-                start_y = w - 1 - j;   \
-                for (int x = i; x < max_height; x++) { \
-                    from_next = (uint16_t *)from + x * w; \
-                    for (int y = j, mirrored_y = start_y; y < max_width; y += 4, mirrored_y -= 4) { \
-                        ((uint16_t *)to)[(mirrored_y) * h + x] = *((uint32_t *)(from_next + y)) & 0xFFFF; \
-                        ((uint16_t *)to)[(mirrored_y - 1) * h + x] = (*((uint32_t *)(from_next + y)) >> 16) & 0xFFFF; \
-                        ((uint16_t *)to)[(mirrored_y - 2) * h + x] = *((uint32_t *)(from_next + y + 2)) & 0xFFFF; \
-                        ((uint16_t *)to)[(mirrored_y - 3) * h + x] = (*((uint32_t *)(from_next + y + 2)) >> 16) & 0xFFFF; \
-                    } \
-                } \
-            } \
-        } \
-    }
-
-#define ROTATE_180_ALL_BPP() \
-    { \
-        to_bytes_per_line = w * to_bytes_per_piexl; \
-        to_index_const = (h - 1) * to_bytes_per_line + (w - x_start - 1) * to_bytes_per_piexl; \
-        for (int from_y = y_start; from_y < y_end + 1; from_y++) { \
-            from_index = from_y * from_bytes_per_line + x_start * from_bytes_per_piexl; \
-            to_index = to_index_const - from_y * to_bytes_per_line; \
-            for (int from_x = x_start; from_x < x_end + 1; from_x++) { \
-                COPY_PIXEL(LV_COLOR_DEPTH, to + to_index, from + from_index); \
-                from_index += from_bytes_per_piexl; \
-                to_index -= to_bytes_per_piexl; \
-            } \
-        } \
-    }
-
-#define ROTATE_270_OPTIMIZED_16BPP(block_w, block_h) \
-    { \
-        for (int i = 0; i < h; i += block_h) { \
-            max_height = i + block_h > h ? h : i + block_h; \
-            for (int j = 0; j < w; j += block_w) { \
-                max_width = j + block_w > w ? w : j + block_w; \
-                for (int x = i; x < max_height; x++) { \
-                    from_next = (uint16_t *)from + x * w; \
-                    for (int y = j; y < max_width; y += 4) { \
-                        ((uint16_t *)to)[y * h + (h - 1 - x)] = *((uint32_t *)(from_next + y)) & 0xFFFF; \
-                        ((uint16_t *)to)[(y + 1) * h + (h - 1 - x)] = (*((uint32_t *)(from_next + y)) >> 16) & 0xFFFF; \
-                        ((uint16_t *)to)[(y + 2) * h + (h - 1 - x)] = *((uint32_t *)(from_next + y + 2)) & 0xFFFF; \
-                        ((uint16_t *)to)[(y + 3) * h + (h - 1 - x)] = (*((uint32_t *)(from_next + y + 2)) >> 16) & 0xFFFF; \
-                    } \
-                } \
-            } \
-        } \
-    }
-
-#define ROTATE_270_ALL_BPP() \
-    { \
-        to_bytes_per_line = h * to_bytes_per_piexl; \
-        from_index_const = x_start * from_bytes_per_piexl; \
-        to_index_const = x_start * to_bytes_per_line + (h - 1) * to_bytes_per_piexl; \
-        for (int from_y = y_start; from_y < y_end + 1; from_y++) { \
-            from_index = from_y * from_bytes_per_line + from_index_const; \
-            to_index = to_index_const - from_y * to_bytes_per_piexl; \
-            for (int from_x = x_start; from_x < x_end + 1; from_x++) { \
-                COPY_PIXEL(LV_COLOR_DEPTH, to + to_index, from + from_index); \
-                from_index += from_bytes_per_piexl; \
-                to_index += to_bytes_per_line; \
-            } \
-        } \
-    }
+ * @brief Read the frame buffers rotated at scanout, LVGL renders into them in its own orientation
+ */
+static void display_setup_scanout_rotation(LCD *lcd)
+{
+    ESP_UTILS_CHECK_FALSE_EXIT(display_init_scanout(lcd), "Initialize scanout failed");
+    ESP_UTILS_CHECK_FALSE_EXIT(
+        lvgl_port_rotate_init(lvgl_port_config.rotation, lcd->getFrameWidth(), lcd->getFrameHeight()),
+        "Initialize rotation failed"
+    );
+    display_set_mode_fill(lvgl_port_rotate_fill);
+}
 
-__attribute__((always_inline))
-IRAM_ATTR static inline void rotate_copy_pixel(
-    const uint8_t *from, uint8_t *to, uint16_t x_start, uint16_t y_start, uint16_t x_end, uint16_t y_end, uint16_t w,
-    uint16_t h, uint16_t rotate
-)
+/* ---------- PSRAM traffic ---------- */
+
+static lvgl_port_psram_stats_t psram_stats = {};
+static uint32_t psram_frame_read = 0;           // Bytes of the frame being rendered, until `monitor_callback()`
+static uint32_t psram_frame_write = 0;
+static lvgl_port_bandwidth_sim_frame_t *psram_trace = nullptr;     // Frames recorded by `monitor_callback()`
+static int psram_trace_max = 0;
+static int psram_trace_num = 0;
+static int64_t psram_trace_last_us = 0;         // End of the last recorded frame
+
+static inline void psram_account(uint32_t read_bytes, uint32_t write_bytes)
+{
+    psram_stats.read_bytes += read_bytes;
+    psram_stats.write_bytes += write_bytes;
+    psram_frame_read += read_bytes;
+    psram_frame_write += write_bytes;
+}
+
+/**
+ * @brief Account a copy of rectangles from one frame buffer into another
+ */
+static void psram_account_copy(const lvgl_port_copy_rect_t *rects, int rect_num)
 {
-    int from_bytes_per_piexl = sizeof(lv_color_t);
-    int from_bytes_per_line = w * from_bytes_per_piexl;
-    int from_index = 0;
+    uint32_t bytes = 0;
 
-    int to_bytes_per_piexl = LV_COLOR_DEPTH >> 3;
-    int to_bytes_per_line;
-    int to_index = 0;
-    int to_index_const = 0;
+    for (int i = 0; i < rect_num; i++) {
+        bytes += (uint32_t)(rects[i].x2 - rects[i].x1 + 1) * (rects[i].y2 - rects[i].y1 + 1) * sizeof(lv_color_t);
+    }
+    psram_account(bytes, bytes);
+}
 
-#if (LV_COLOR_DEPTH == 16) && LVGL_PORT_ENABLE_ROTATION_OPTIMIZED
-    int max_height = 0;
-    int max_width = 0;
-    int start_y = 0;
-    uint16_t *from_next = NULL;
-#endif
+/* ---------- Tile-hash damage filter ---------- */
 
-    // uint32_t time = esp_log_timestamp();
-    switch (rotate) {
-    case 90:
-#if (LV_COLOR_DEPTH == 16) && LVGL_PORT_ENABLE_ROTATION_OPTIMIZED
-        ROTATE_90_OPTIMIZED_16BPP(32, 256);
-#else
-        ROTATE_90_ALL_BPP();
-#endif
-        break;
-    case 180:
-        ROTATE_180_ALL_BPP();
-        break;
-    case 270:
-#if (LV_COLOR_DEPTH == 16) && LVGL_PORT_ENABLE_ROTATION_OPTIMIZED
-        ROTATE_270_OPTIMIZED_16BPP(32, 256);
-#else
-        int from_index_const = 0;
-        ROTATE_270_ALL_BPP();
-#endif
-        break;
-    default:
-        break;
+/**
+ * @brief Get the unjoined invalid areas of the frame being rendered
+ */
+static int flush_get_inv_rects(lv_disp_t *disp, lvgl_port_copy_rect_t *rects)
+{
+    int rect_num = 0;
+
+    for (int i = 0; (i < disp->inv_p) && (rect_num < LVGL_PORT_ASYNC_COPY_RECT_MAX); i++) {
+        if (disp->inv_area_joined[i] == 0) {
+            rects[rect_num].x1 = disp->inv_areas[i].x1;
+            rects[rect_num].y1 = disp->inv_areas[i].y1;
+            rects[rect_num].x2 = disp->inv_areas[i].x2;
+            rects[rect_num].y2 = disp->inv_areas[i].y2;
+            rect_num++;
+        }
+    }
+
+    return rect_num;
+}
+
+/**
+ * @brief Get the damage of the frame rendered into `buf`: its unjoined dirty areas, shrunk to the changed tiles if the
+ *        tile hash is enabled
+ *
+ * @return Number of rectangles, `0` only if the tile hash found the frame identical to the previous one
+ */
+static int flush_get_damage(lv_disp_t *disp, const void *buf, lvgl_port_copy_rect_t *rects)
+{
+    if (!lvgl_port_config.tile_hash) {
+        return flush_get_inv_rects(disp, rects);
     }
-    // ESP_LOGI(TAG, "rotate: end, time used:%d", (int)(esp_log_timestamp() - time));
+
+    lvgl_port_copy_rect_t dirty[LVGL_PORT_ASYNC_COPY_RECT_MAX];
+    int rect_num = flush_get_inv_rects(disp, dirty);
+
+    return lvgl_port_tile_hash_filter(buf, dirty, rect_num, rects);
 }
-#endif /* LVGL_PORT_ROTATION_DEGREE */
 
-#if LVGL_PORT_AVOID_TEAR
-#if LVGL_PORT_DIRECT_MODE
-#if LVGL_PORT_ROTATION_DEGREE != 0
+/* ---------- LCD double-buffer & LVGL direct-mode, rotated ---------- */
+
 typedef struct {
     uint16_t inv_p;
     uint8_t inv_area_joined[LV_INV_BUF_SIZE];
@@ -221,6 +330,25 @@ static void flush_dirty_save(lv_port_dirty_area_t *dirty_area)
     }
 }
 
+/**
+ * @brief Shrink the saved dirty area to the tiles that changed in LVGL's buffer
+ *
+ * @return false if nothing changed
+ */
+static bool flush_dirty_filter(const void *buf, lv_port_dirty_area_t *dirty_area)
+{
+    lvgl_port_copy_rect_t rects[LVGL_PORT_ASYNC_COPY_RECT_MAX];
+    int rect_num = flush_get_damage(_lv_refr_get_disp_refreshing(), buf, rects);
+
+    dirty_area->inv_p = rect_num;
+    for (int i = 0; i < rect_num; i++) {
+        dirty_area->inv_area_joined[i] = 0;
+        lv_area_set(&dirty_area->inv_areas[i], rects[i].x1, rects[i].y1, rects[i].x2, rects[i].y2);
+    }
+
+    return rect_num > 0;
+}
+
 typedef enum {
     FLUSH_STATUS_PART,
     FLUSH_STATUS_FULL
@@ -232,6 +360,8 @@ typedef enum {
     FLUSH_PROBE_FULL_COPY,
 } lv_port_flush_probe_t;
 
+static lv_port_flush_status_t flush_prev_status = FLUSH_STATUS_PART;
+
 /**
  * @brief Probe dirty area to copy
  *
@@ -239,7 +369,6 @@ typedef enum {
  */
 static lv_port_flush_probe_t flush_copy_probe(lv_disp_drv_t *drv)
 {
-    static lv_port_flush_status_t prev_status = FLUSH_STATUS_PART;
     lv_port_flush_status_t cur_status;
     lv_port_flush_probe_t probe_result;
     lv_disp_t *disp_refr = _lv_refr_get_disp_refreshing();
@@ -256,7 +385,7 @@ static lv_port_flush_probe_t flush_copy_probe(lv_disp_drv_t *drv)
     /* Check if the current full screen refreshes */
     cur_status = ((flush_ver == drv->ver_res) && (flush_hor == drv->hor_res)) ? (FLUSH_STATUS_FULL) : (FLUSH_STATUS_PART);
 
-    if (prev_status == FLUSH_STATUS_FULL) {
+    if (flush_prev_status == FLUSH_STATUS_FULL) {
         if ((cur_status == FLUSH_STATUS_PART)) {
             probe_result = FLUSH_PROBE_FULL_COPY;
         } else {
@@ -265,14 +394,48 @@ static lv_port_flush_probe_t flush_copy_probe(lv_disp_drv_t *drv)
     } else {
         probe_result = FLUSH_PROBE_PART_COPY;
     }
-    prev_status = cur_status;
+    flush_prev_status = cur_status;
 
     return probe_result;
 }
 
-static inline void *flush_get_next_buf(LCD *lcd)
+static inline void *flush_get_other_buf(void *fb)
 {
-    return get_next_frame_buffer(lcd);
+    return (fb == lvgl_port_fbs[0]) ? lvgl_port_fbs[1] : lvgl_port_fbs[0];
+}
+
+/**
+ * @brief Arm the DMA copy of the dirty area between two frame buffers, it will be started by the vsync ISR
+ *
+ * @note  The dirty area is rotated into the frame buffer coordinates, so the copy is a plain rectangle copy from the
+ *        frame buffer that was just rotated into, instead of rotating from the LVGL's buffer a second time.
+ *
+ * @return true if the copy is armed, false if the caller should copy with the CPU after the vsync
+ */
+template <class Rotation, class Sync>
+static bool flush_dirty_arm_async_rotated(LCD *lcd, void *dst, void *src, lv_port_dirty_area_t *dirty_area)
+{
+    lvgl_port_copy_rect_t rects[LVGL_PORT_ASYNC_COPY_RECT_MAX];
+    int rect_num = 0;
+
+    if (!Sync::async) {
+        return false;
+    }
+
+    for (int i = 0; (i < dirty_area->inv_p) && (rect_num < LVGL_PORT_ASYNC_COPY_RECT_MAX); i++) {
+        if (dirty_area->inv_area_joined[i] == 0) {
+            const lv_area_t *area = &dirty_area->inv_areas[i];
+            lvgl_port_copy_rect_t rect = { area->x1, area->y1, area->x2, area->y2 };
+            rects[rect_num++] = Rotation::map_rect(rect, LV_HOR_RES, LV_VER_RES);
+        }
+    }
+
+    if (!Sync::arm(dst, src, rects, rect_num, lcd->getFrameWidth(), lcd->getFrameHeight(), sizeof(lv_color_t))) {
+        return false;
+    }
+    psram_account_copy(rects, rect_num);
+
+    return true;
 }
 
 /**
@@ -280,32 +443,24 @@ static inline void *flush_get_next_buf(LCD *lcd)
  *
  * @note This function is used to avoid tearing effect, and only work with LVGL direct-mode.
  */
+template <class Rotation>
 static void flush_dirty_copy(void *dst, void *src, lv_port_dirty_area_t *dirty_area)
 {
-    lv_coord_t x_start, x_end, y_start, y_end;
     for (int i = 0; i < dirty_area->inv_p; i++) {
         /* Refresh the unjoined areas*/
         if (dirty_area->inv_area_joined[i] == 0) {
-            x_start = dirty_area->inv_areas[i].x1;
-            x_end = dirty_area->inv_areas[i].x2;
-            y_start = dirty_area->inv_areas[i].y1;
-            y_end = dirty_area->inv_areas[i].y2;
-
-            rotate_copy_pixel(
-                (uint8_t *)src, (uint8_t *)dst, x_start, y_start, x_end, y_end, LV_HOR_RES, LV_VER_RES,
-                LVGL_PORT_ROTATION_DEGREE
-            );
+            const lv_area_t *area = &dirty_area->inv_areas[i];
+            lvgl_port_copy_rect_t rect = { area->x1, area->y1, area->x2, area->y2 };
+            display_rotate_copy<Rotation>(src, dst, rect, LV_HOR_RES, LV_VER_RES);
+            psram_account_copy(&rect, 1);
         }
     }
 }
 
-static void flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+template <class Rotation, class Sync>
+static void flush_callback_direct_rotated(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
     LCD *lcd = (LCD *)drv->user_data;
-    const int offsetx1 = area->x1;
-    const int offsetx2 = area->x2;
-    const int offsety1 = area->y1;
-    const int offsety2 = area->y2;
     void *next_fb = NULL;
     lv_port_flush_probe_t probe_result = FLUSH_PROBE_PART_COPY;
     lv_disp_t *disp = lv_disp_get_default();
@@ -316,24 +471,36 @@ static void flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t
         if (drv->full_refresh) {
             /* Reset flag */
             drv->full_refresh = 0;
+            if (lvgl_port_config.tile_hash) {
+                /* The whole screen is rotated without being filtered */
+                lvgl_port_tile_hash_reset();
+            }
 
             // Rotate and copy data from the whole screen LVGL's buffer to the next frame buffer
-            next_fb = flush_get_next_buf(lcd);
-            rotate_copy_pixel(
-                (uint8_t *)color_map, (uint8_t *)next_fb, offsetx1, offsety1, offsetx2, offsety2,
-                LV_HOR_RES, LV_VER_RES, LVGL_PORT_ROTATION_DEGREE
-            );
+            next_fb = get_next_frame_buffer();
+            /* Make sure the last copy into `next_fb` has landed */
+            Sync::fence(next_fb);
+            lvgl_port_copy_rect_t rect = { area->x1, area->y1, area->x2, area->y2 };
+            display_rotate_copy<Rotation>(color_map, next_fb, rect, LV_HOR_RES, LV_VER_RES);
+            psram_account_copy(&rect, 1);
 
             /* Switch the current LCD frame buffer to `next_fb` */
-            lcd->switchFrameBufferTo(next_fb);
+            display_switch_frame_buffer(lcd, next_fb);
+
+            /* Update the dirty area for another frame buffer by DMA, starting at the coming vsync */
+            bool copy_armed = flush_dirty_arm_async_rotated<Rotation, Sync>(
+                                  lcd, flush_get_other_buf(next_fb), next_fb, &dirty_area
+                              );
 
             /* Waiting for the current frame buffer to complete transmission */
             ulTaskNotifyValueClear(NULL, ULONG_MAX);
             ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-            /* Synchronously update the dirty area for another frame buffer */
-            flush_dirty_copy(flush_get_next_buf(lcd), color_map, &dirty_area);
-            flush_get_next_buf(lcd);
+            if (!copy_armed) {
+                /* Synchronously update the dirty area for another frame buffer */
+                flush_dirty_copy<Rotation>(get_next_frame_buffer(), color_map, &dirty_area);
+                get_next_frame_buffer();
+            }
         } else {
             /* Probe the copy method for the current dirty area */
             probe_result = flush_copy_probe(drv);
@@ -351,12 +518,31 @@ static void flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t
                 lv_refr_now(_lv_refr_get_disp_refreshing());
             } else {
                 /* Update current dirty area for next frame buffer */
-                next_fb = flush_get_next_buf(lcd);
                 flush_dirty_save(&dirty_area);
-                flush_dirty_copy(next_fb, color_map, &dirty_area);
+                if (lvgl_port_config.tile_hash) {
+                    if (probe_result != FLUSH_PROBE_PART_COPY) {
+                        /* The other frame buffer lags behind the last frame, so every dirty pixel is copied */
+                        lvgl_port_tile_hash_reset();
+                    } else if (!flush_dirty_filter(color_map, &dirty_area)) {
+                        /* Nothing changed, keep the current frame on screen */
+                        lv_disp_flush_ready(drv);
+                        return;
+                    }
+                }
+                next_fb = get_next_frame_buffer();
+                Sync::fence(next_fb);
+                flush_dirty_copy<Rotation>(next_fb, color_map, &dirty_area);
 
                 /* Switch the current LCD frame buffer to `next_fb` */
-                lcd->switchFrameBufferTo(next_fb);
+                display_switch_frame_buffer(lcd, next_fb);
+
+                if ((probe_result == FLUSH_PROBE_PART_COPY) &&
+                        flush_dirty_arm_async_rotated<Rotation, Sync>(
+                            lcd, flush_get_other_buf(next_fb), next_fb, &dirty_area
+                        )) {
+                    /* The DMA takes over the copy below, starting at the coming vsync */
+                    probe_result = FLUSH_PROBE_SKIP_COPY;
+                }
 
                 /* Waiting for the current frame buffer to complete transmission */
                 ulTaskNotifyValueClear(NULL, ULONG_MAX);
@@ -364,9 +550,8 @@ static void flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t
 
                 if (probe_result == FLUSH_PROBE_PART_COPY) {
                     /* Synchronously update the dirty area for another frame buffer */
-                    flush_dirty_save(&dirty_area);
-                    flush_dirty_copy(flush_get_next_buf(lcd), color_map, &dirty_area);
-                    flush_get_next_buf(lcd);
+                    flush_dirty_copy<Rotation>(get_next_frame_buffer(), color_map, &dirty_area);
+                    get_next_frame_buffer();
                 }
             }
         }
@@ -375,337 +560,2456 @@ static void flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t
     lv_disp_flush_ready(drv);
 }
 
-#else
+static void setup_direct_rotated(lv_disp_drv_t *drv)
+{
+    // LVGL renders into the third frame buffer, which is rotated into the two others
+    drv->direct_mode = 1;
+    flush_prev_status = FLUSH_STATUS_PART;
+    lv_disp_draw_buf_init(drv->draw_buf, lvgl_port_fbs[2], nullptr, drv->hor_res * drv->ver_res);
+}
+
+/* ---------- LCD double-buffer & LVGL direct-mode ---------- */
+
+static void (*lvgl_draw_buffer_copy)(
+    lv_draw_ctx_t *draw_ctx, void *dest_buf, lv_coord_t dest_stride, const lv_area_t *dest_area, void *src_buf,
+    lv_coord_t src_stride, const lv_area_t *src_area
+) = nullptr;
+
+/**
+ * @brief LVGL's copy between its two render buffers, split over both cores like the rotated copies when it copies an
+ *        area between the same place of two buffers of the same stride, which is how direct-mode synchronizes them
+ */
+static void display_buffer_copy(
+    lv_draw_ctx_t *draw_ctx, void *dest_buf, lv_coord_t dest_stride, const lv_area_t *dest_area, void *src_buf,
+    lv_coord_t src_stride, const lv_area_t *src_area
+)
+{
+    if ((dest_stride != src_stride) || (dest_area->x1 != src_area->x1) || (dest_area->y1 != src_area->y1) ||
+            (dest_area->x2 != src_area->x2) || (dest_area->y2 != src_area->y2)) {
+        lvgl_draw_buffer_copy(draw_ctx, dest_buf, dest_stride, dest_area, src_buf, src_stride, src_area);
+        return;
+    }
+
+    lvgl_port_copy_rect_t rect = { dest_area->x1, dest_area->y1, dest_area->x2, dest_area->y2 };
+    display_rotate_copy<Rotate<0>>(src_buf, dest_buf, rect, dest_stride, dest_area->y2 + 1);
+}
+
+static lvgl_port_copy_rect_t flush_sync_rects[LVGL_PORT_ASYNC_COPY_RECT_MAX];
+static int flush_sync_rect_num = -1;            // Changed areas of the last frame, `-1` if it was not filtered
+
+/**
+ * @brief Replace LVGL's synchronization of the dirty areas in direct-mode (`refr_sync_areas()`)
+ *
+ * @note  LVGL doesn't wait for the flush before synchronizing, but the other buffer is only off screen once the vsync
+ *        ISR has completed the deferred flush. Then, the areas flushed in the last frame have already been copied by
+ *        the DMA, so only wait for the copy to land. LVGL's own copy is kept as a fallback.
+ */
+template <class Sync>
+static void flush_buffer_copy(
+    lv_draw_ctx_t *draw_ctx, void *dest_buf, lv_coord_t dest_stride, const lv_area_t *dest_area, void *src_buf,
+    lv_coord_t src_stride, const lv_area_t *src_area
+)
+{
+    lv_disp_drv_t *drv = _lv_refr_get_disp_refreshing()->driver;
+    while (drv->draw_buf->flushing) {
+        wait_callback(drv);
+    }
+    Sync::fence(dest_buf);
+    if (Sync::synced(dest_buf)) {
+        return;
+    }
+    if (flush_sync_rect_num >= 0) {
+        /* Outside the tiles that changed in the last frame, both buffers already hold the same pixels */
+        for (int i = 0; i < flush_sync_rect_num; i++) {
+            lv_area_t changed;
+            lv_area_t clipped;
+            lv_area_set(&changed, flush_sync_rects[i].x1, flush_sync_rects[i].y1, flush_sync_rects[i].x2,
+                        flush_sync_rects[i].y2);
+            if (_lv_area_intersect(&clipped, dest_area, &changed)) {
+                display_buffer_copy(draw_ctx, dest_buf, dest_stride, &clipped, src_buf, src_stride, &clipped);
+                psram_account(lv_area_get_size(&clipped) * sizeof(lv_color_t),
+                              lv_area_get_size(&clipped) * sizeof(lv_color_t));
+            }
+        }
+        return;
+    }
+    display_buffer_copy(draw_ctx, dest_buf, dest_stride, dest_area, src_buf, src_stride, src_area);
+    psram_account(lv_area_get_size(dest_area) * sizeof(lv_color_t), lv_area_get_size(dest_area) * sizeof(lv_color_t));
+}
+
+/**
+ * @brief Fence before LVGL starts to render into the active buffer, even if there is no area to synchronize
+ */
+template <class Sync>
+static void render_start_callback_direct(lv_disp_drv_t *drv)
+{
+    Sync::fence(drv->draw_buf->buf_act);
+}
+
+static inline void *flush_get_other_draw_buf(lv_disp_drv_t *drv, void *buf)
+{
+    return (drv->draw_buf->buf1 == buf) ? drv->draw_buf->buf2 : drv->draw_buf->buf1;
+}
 
-static void flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+template <class Sync>
+static void flush_callback_direct(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
     LCD *lcd = (LCD *)drv->user_data;
 
     /* Action after last area refresh */
     if (lv_disp_flush_is_last(drv)) {
+        lvgl_port_copy_rect_t rects[LVGL_PORT_ASYNC_COPY_RECT_MAX];
+        int rect_num = flush_get_damage(_lv_refr_get_disp_refreshing(), color_map, rects);
+
+        if (lvgl_port_config.tile_hash) {
+            /* LVGL synchronizes the dirty areas of this frame before the next one, only the changed ones matter */
+            memcpy(flush_sync_rects, rects, rect_num * sizeof(rects[0]));
+            flush_sync_rect_num = rect_num;
+            if (rect_num == 0) {
+                /* Nothing changed: keep the frame on screen and render the next one into `color_map` again, the
+                 * buffers are swapped back by LVGL after this call */
+                drv->draw_buf->buf_act = flush_get_other_draw_buf(drv, color_map);
+                lv_disp_flush_ready(drv);
+                return;
+            }
+        }
+        /* Copy the dirty areas into the other buffer by DMA, starting at the coming vsync */
+        if (Sync::arm(
+                    flush_get_other_draw_buf(drv, color_map), color_map, rects, rect_num, drv->hor_res, drv->ver_res,
+                    sizeof(lv_color_t)
+                )) {
+            psram_account_copy(rects, rect_num);
+        }
         /* Switch the current LCD frame buffer to `color_map` */
-        lcd->switchFrameBufferTo(color_map);
+        display_switch_frame_buffer(lcd, color_map);
 
-        /* Waiting for the last frame buffer to complete transmission */
-        ulTaskNotifyValueClear(NULL, ULONG_MAX);
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!lvgl_port_present_submit(esp_timer_get_time())) {
+            /* The vsync ISR calls `lv_disp_flush_ready()` once `color_map` is on screen */
+            return;
+        }
+        /* Not locked to the vsync, so don't wait for it to start the copy */
+        Sync::start();
     }
 
     lv_disp_flush_ready(drv);
 }
-#endif /* LVGL_PORT_ROTATION_DEGREE */
 
-#elif LVGL_PORT_FULL_REFRESH && LVGL_PORT_DISP_BUFFER_NUM == 2
+static void setup_direct(lv_disp_drv_t *drv)
+{
+    drv->direct_mode = 1;
+    flush_sync_rect_num = -1;
+    lv_disp_draw_buf_init(drv->draw_buf, lvgl_port_fbs[0], lvgl_port_fbs[1], drv->hor_res * drv->ver_res);
+}
+
+/* ---------- LCD triple-buffer & LVGL direct-mode with buffer-age damage tracking ---------- */
 
-static void flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+static volatile int lvgl_port_fb_front = 0;     // The frame buffer being scanned out
+static volatile int lvgl_port_fb_pending = 0;   // The frame buffer that will be scanned out from the next vsync
+static int lvgl_port_fb_render = 1;             // The frame buffer LVGL renders into
+static volatile bool lvgl_port_fb_waiting = false;  // The LVGL task waits for the pending frame buffer to be latched
+
+static int flush_get_buf_index(const void *fb)
 {
-    LCD *lcd = (LCD *)drv->user_data;
+    for (int i = 0; i < LVGL_PORT_FRAME_BUFFER_NUM_MAX; i++) {
+        if (lvgl_port_fbs[i] == fb) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-    /* Switch the current LCD frame buffer to `color_map` */
-    lcd->switchFrameBufferTo(color_map);
+/**
+ * @brief Pick the frame buffer to render the next frame into
+ *
+ * @note  It must be neither on screen nor waiting for the vsync. Among the remaining ones (only one with three
+ *        buffers), the youngest is picked so the least damage has to be brought up to date. The vsync ISR only moves
+ *        `pending` to `front`, so a stale `front` here only makes the choice more conservative.
+ */
+static int flush_pick_render_buf(int pending)
+{
+    int front = lvgl_port_fb_front;
+    int picked = -1;
+    int picked_age = 0;
 
-    /* Waiting for the last frame buffer to complete transmission */
-    ulTaskNotifyValueClear(NULL, ULONG_MAX);
-    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    for (int i = 0; i < LVGL_PORT_FRAME_BUFFER_NUM_MAX; i++) {
+        if ((i == front) || (i == pending)) {
+            continue;
+        }
+        int age = lvgl_port_damage_get_age(i);
+        if ((picked < 0) || ((age != 0) && ((picked_age == 0) || (age < picked_age)))) {
+            picked = i;
+            picked_age = age;
+        }
+    }
 
-    lv_disp_flush_ready(drv);
+    return picked;
+}
+
+/**
+ * @brief Drop the rectangles fully covered by the areas about to be rendered, like LVGL's `refr_sync_areas()` does
+ *
+ * @return Number of rectangles left
+ */
+static int flush_drop_covered(lv_disp_t *disp, lvgl_port_copy_rect_t *rects, int rect_num)
+{
+    int left = 0;
+
+    for (int i = 0; i < rect_num; i++) {
+        lv_area_t area = { rects[i].x1, rects[i].y1, rects[i].x2, rects[i].y2 };
+        bool covered = false;
+        for (int j = 0; (j < disp->inv_p) && !covered; j++) {
+            covered = (disp->inv_area_joined[j] == 0) && _lv_area_is_in(&area, &disp->inv_areas[j], 0);
+        }
+        if (!covered) {
+            rects[left++] = rects[i];
+        }
+    }
+
+    return left;
 }
 
-#elif LVGL_PORT_FULL_REFRESH && LVGL_PORT_DISP_BUFFER_NUM == 3
+/**
+ * @brief Bring the render buffer up to date before LVGL renders into it
+ *
+ * @note  The union of the damage since the buffer was last rendered is copied from the latest frame. Areas fully
+ *        covered by the areas about to be rendered are skipped.
+ */
+template <class Sync>
+static void render_start_callback_buffer_age(lv_disp_drv_t *drv)
+{
+    lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+    int latest = lvgl_port_damage_get_latest();
+    lvgl_port_copy_rect_t rects[LVGL_PORT_DAMAGE_RECT_MAX];
 
-#if LVGL_PORT_ROTATION_DEGREE == 0
-static void *lvgl_port_lcd_last_buf = NULL;
-static void *lvgl_port_lcd_next_buf = NULL;
-static void *lvgl_port_flush_next_buf = NULL;
-#endif
+    if ((latest < 0) || (latest == lvgl_port_fb_render)) {
+        return;
+    }
+
+    int rect_num = flush_drop_covered(disp, rects, lvgl_port_damage_collect(lvgl_port_fb_render, rects));
+    if (rect_num == 0) {
+        return;
+    }
+    psram_account_copy(rects, rect_num);
+
+    /* The render buffer is not on screen, so the copy can start right away */
+    if (Sync::arm(
+                lvgl_port_fbs[lvgl_port_fb_render], lvgl_port_fbs[latest], rects, rect_num, drv->hor_res,
+                drv->ver_res, sizeof(lv_color_t)
+            )) {
+        Sync::start();
+        Sync::fence(lvgl_port_fbs[lvgl_port_fb_render]);
+        return;
+    }
+    for (int i = 0; i < rect_num; i++) {
+        display_rotate_copy<Rotate<0>>(
+            lvgl_port_fbs[latest], lvgl_port_fbs[lvgl_port_fb_render], rects[i], drv->hor_res, drv->ver_res
+        );
+    }
+}
 
-void flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+static void flush_callback_buffer_age(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
     LCD *lcd = (LCD *)drv->user_data;
 
-#if LVGL_PORT_ROTATION_DEGREE != 0
-    const int offsetx1 = area->x1;
-    const int offsetx2 = area->x2;
-    const int offsety1 = area->y1;
-    const int offsety2 = area->y2;
-    void *next_fb = get_next_frame_buffer(lcd);
+    /* Action after last area refresh */
+    if (lv_disp_flush_is_last(drv)) {
+        lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+        int current = flush_get_buf_index(color_map);
+        lvgl_port_copy_rect_t rects[LVGL_PORT_DAMAGE_RECT_MAX];
+        int rect_num = flush_get_damage(disp, color_map, rects);
+
+        if (rect_num == 0) {
+            /* Nothing changed: keep the frame on screen, the render buffer already holds the latest frame */
+            lv_disp_flush_ready(drv);
+            return;
+        }
 
-    /* Rotate and copy dirty area from the current LVGL's buffer to the next LCD frame buffer */
-    rotate_copy_pixel(
-        (uint8_t *)color_map, (uint8_t *)next_fb, offsetx1, offsety1, offsetx2, offsety2, LV_HOR_RES,
-        LV_VER_RES, LVGL_PORT_ROTATION_DEGREE
-    );
+        /* FIFO: the frame waiting for its vsync isn't replaced, LVGL only waits here if it renders faster than that */
+        if (lvgl_port_present_get_mode() == LVGL_PORT_PRESENT_FIFO) {
+            ulTaskNotifyValueClear(NULL, ULONG_MAX);
+            lvgl_port_fb_waiting = true;
+            while (lvgl_port_present_is_queued()) {
+                wait_callback(drv);
+            }
+            lvgl_port_fb_waiting = false;
+        }
 
-    /* Switch the current LCD frame buffer to `next_fb` */
-    lcd->switchFrameBufferTo(next_fb);
-#else
-    drv->draw_buf->buf1 = color_map;
-    drv->draw_buf->buf2 = lvgl_port_flush_next_buf;
-    lvgl_port_flush_next_buf = color_map;
+        /* Record the damage of this frame, to bring the other buffers up to date later */
+        lvgl_port_damage_commit(current, rects, rect_num);
 
-    /* Switch the current LCD frame buffer to `color_map` */
-    lcd->switchFrameBufferTo(color_map);
+        /* Switch the current LCD frame buffer to `color_map`, it will be scanned out from the next vsync */
+        display_switch_frame_buffer(lcd, color_map);
+        lvgl_port_fb_pending = current;
 
-    lvgl_port_lcd_next_buf = color_map;
-#endif
+        /* Render the next frame into a buffer that is neither on screen nor pending, without waiting for the vsync */
+        lvgl_port_fb_render = flush_pick_render_buf(current);
+        drv->draw_buf->buf1 = lvgl_port_fbs[lvgl_port_fb_render];
+        drv->draw_buf->buf_act = lvgl_port_fbs[lvgl_port_fb_render];
+
+        /* The render buffer is a spare one, LVGL can render into it at once in every present mode */
+        lvgl_port_present_submit_spare(esp_timer_get_time());
+    }
 
     lv_disp_flush_ready(drv);
 }
-#endif
 
-IRAM_ATTR bool onLcdVsyncCallback(void *user_data)
+static void setup_buffer_age(lv_disp_drv_t *drv)
 {
-    BaseType_t need_yield = pdFALSE;
-#if LVGL_PORT_FULL_REFRESH && (LVGL_PORT_DISP_BUFFER_NUM == 3) && (LVGL_PORT_ROTATION_DEGREE == 0)
-    if (lvgl_port_lcd_next_buf != lvgl_port_lcd_last_buf) {
-        lvgl_port_flush_next_buf = lvgl_port_lcd_last_buf;
-        lvgl_port_lcd_last_buf = lvgl_port_lcd_next_buf;
-    }
-#else
-    TaskHandle_t task_handle = (TaskHandle_t)user_data;
-    // Notify that the current LCD frame buffer has been transmitted
-    xTaskNotifyFromISR(task_handle, ULONG_MAX, eNoAction, &need_yield);
-#endif
-    return (need_yield == pdTRUE);
+    // LVGL is only given the render buffer: the port replaces it after every frame and does the synchronization of
+    // the dirty areas itself, based on the age of the buffer
+    drv->direct_mode = 1;
+    lvgl_port_damage_init(LVGL_PORT_FRAME_BUFFER_NUM_MAX, drv->hor_res, drv->ver_res);
+    lvgl_port_fb_front = 0;
+    lvgl_port_fb_pending = 0;
+    lvgl_port_fb_render = 1;
+    lv_disp_draw_buf_init(drv->draw_buf, lvgl_port_fbs[lvgl_port_fb_render], nullptr, drv->hor_res * drv->ver_res);
 }
 
-#else
+/* ---------- LCD double-buffer & LVGL full-refresh ---------- */
 
-void flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+static void flush_callback_full_double(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
     LCD *lcd = (LCD *)drv->user_data;
-    const int offsetx1 = area->x1;
-    const int offsetx2 = area->x2;
-    const int offsety1 = area->y1;
-    const int offsety2 = area->y2;
 
-    lcd->drawBitmap(offsetx1, offsety1, offsetx2 - offsetx1 + 1, offsety2 - offsety1 + 1, (const uint8_t *)color_map);
-    // For RGB LCD, directly notify LVGL that the buffer is ready
-    if (lcd->getBus()->getBasicAttributes().type == ESP_PANEL_BUS_TYPE_RGB) {
+    /* Switch the current LCD frame buffer to `color_map` */
+    display_switch_frame_buffer(lcd, color_map);
+
+    if (lvgl_port_present_submit(esp_timer_get_time())) {
+        lv_disp_flush_ready(drv);
+    }
+    /* Otherwise, the vsync ISR calls `lv_disp_flush_ready()` once `color_map` is on screen */
+}
+
+static void setup_full_double(lv_disp_drv_t *drv)
+{
+    drv->full_refresh = 1;
+    lv_disp_draw_buf_init(drv->draw_buf, lvgl_port_fbs[0], lvgl_port_fbs[1], drv->hor_res * drv->ver_res);
+}
+
+/* ---------- LCD triple-buffer & LVGL full-refresh ---------- */
+
+static void *lvgl_port_lcd_last_buf = NULL;
+static void *lvgl_port_lcd_next_buf = NULL;
+static void *lvgl_port_flush_next_buf = NULL;
+
+static void flush_callback_full_triple(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    LCD *lcd = (LCD *)drv->user_data;
+
+    drv->draw_buf->buf1 = color_map;
+    drv->draw_buf->buf2 = lvgl_port_flush_next_buf;
+    lvgl_port_flush_next_buf = color_map;
+
+    /* Switch the current LCD frame buffer to `color_map` */
+    display_switch_frame_buffer(lcd, color_map);
+
+    lvgl_port_lcd_next_buf = color_map;
+
+    if (!lvgl_port_present_submit(esp_timer_get_time())) {
+        /* FIFO: don't replace the pending frame, the vsync ISR calls `lv_disp_flush_ready()` once it is shown */
+        return;
+    }
+
+    lv_disp_flush_ready(drv);
+}
+
+static void setup_full_triple(lv_disp_drv_t *drv)
+{
+    // With the usage of three buffers and full-refresh, we always have one buffer available for rendering,
+    // eliminating the need to wait for the LCD's sync signal
+    drv->full_refresh = 1;
+    lvgl_port_lcd_last_buf = lvgl_port_fbs[0];
+    lvgl_port_lcd_next_buf = lvgl_port_lcd_last_buf;
+    lvgl_port_flush_next_buf = lvgl_port_fbs[2];
+    lv_disp_draw_buf_init(drv->draw_buf, lvgl_port_fbs[1], lvgl_port_fbs[2], drv->hor_res * drv->ver_res);
+}
+
+/* ---------- LCD double-buffer & LVGL full-refresh, rotated ---------- */
+
+template <class Rotation>
+static void flush_callback_full_rotated(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    LCD *lcd = (LCD *)drv->user_data;
+    void *next_fb = get_next_frame_buffer();
+    lvgl_port_copy_rect_t rect = { area->x1, area->y1, area->x2, area->y2 };
+
+    /* Rotate and copy dirty area from the current LVGL's buffer to the next LCD frame buffer */
+    display_rotate_copy<Rotation>(color_map, next_fb, rect, LV_HOR_RES, LV_VER_RES);
+    psram_account_copy(&rect, 1);
+
+    /* Switch the current LCD frame buffer to `next_fb` */
+    display_switch_frame_buffer(lcd, next_fb);
+
+    lv_disp_flush_ready(drv);
+}
+
+static void setup_full_rotated(lv_disp_drv_t *drv)
+{
+    drv->full_refresh = 1;
+    lv_disp_draw_buf_init(drv->draw_buf, lvgl_port_fbs[2], nullptr, drv->hor_res * drv->ver_res);
+}
+
+/* ---------- LCD double-buffer & LVGL double render buffers, rotated by the flush worker ---------- */
+
+static void *pipeline_bufs[LVGL_PORT_FLUSH_WORKER_BUF_NUM] = {};    // LVGL's render buffers
+static void *pipeline_buf_alloc = nullptr;      // The render buffer that isn't a frame buffer of the LCD
+static int pipeline_fb = 0;                     // The frame buffer copied into next, only used by the worker
+static lvgl_port_copy_rect_t pipeline_last_rects[LVGL_PORT_ASYNC_COPY_RECT_MAX];
+static int pipeline_last_rect_num = 0;          // Damage of the last frame, missing from the frame buffer off screen
+
+static inline int pipeline_get_buf_index(const void *buf)
+{
+    return (buf == pipeline_bufs[1]) ? 1 : 0;
+}
+
+/**
+ * @brief Append the damage of the last frame to the damage of this one, except where this one covers it, and keep the
+ *        damage of this frame for the next one
+ *
+ * @note  The frame buffer off screen was last copied into two frames ago, so it misses both. The render buffer holds
+ *        the whole frame (LVGL synchronizes the render buffers in direct-mode), so both are copied from it.
+ *
+ * @return Number of rectangles, at most `LVGL_PORT_FLUSH_WORKER_RECT_MAX`
+ */
+static int pipeline_join_damage(lvgl_port_copy_rect_t *rects, int rect_num)
+{
+    int joined_num = rect_num;
+
+    for (int i = 0; i < pipeline_last_rect_num; i++) {
+        const lvgl_port_copy_rect_t *last = &pipeline_last_rects[i];
+        bool covered = false;
+        for (int j = 0; (j < rect_num) && !covered; j++) {
+            covered = (last->x1 >= rects[j].x1) && (last->y1 >= rects[j].y1) && (last->x2 <= rects[j].x2) &&
+                      (last->y2 <= rects[j].y2);
+        }
+        if (!covered) {
+            rects[joined_num++] = *last;
+        }
+    }
+    memcpy(pipeline_last_rects, rects, rect_num * sizeof(rects[0]));
+    pipeline_last_rect_num = rect_num;
+
+    return joined_num;
+}
+
+/**
+ * @brief Rotate the damage of a frame into the frame buffer off screen, in the flush worker
+ */
+template <class Rotation>
+static void pipeline_copy(int buf, const lvgl_port_copy_rect_t *rects, int rect_num, void *user_data)
+{
+    lv_disp_drv_t *drv = (lv_disp_drv_t *)user_data;
+
+    for (int i = 0; i < rect_num; i++) {
+        lvgl_port::rotate_copy<Rotation, lvgl_port_pixel_t>(
+            pipeline_bufs[buf], lvgl_port_fbs[pipeline_fb], rects[i], drv->hor_res, drv->ver_res
+        );
+    }
+}
+
+/**
+ * @brief Switch to the frame buffer just copied into and wait until it is on screen, in the flush worker. The other
+ *        frame buffer is off screen from then on.
+ */
+static void pipeline_present(void *user_data)
+{
+    lv_disp_drv_t *drv = (lv_disp_drv_t *)user_data;
+
+    display_switch_frame_buffer((LCD *)drv->user_data, lvgl_port_fbs[pipeline_fb]);
+    pipeline_fb ^= 1;
+    lvgl_port_flush_worker_wait_vsync(LVGL_PORT_PRESENT_WAIT_MS);
+}
+
+/**
+ * @brief Replace LVGL's synchronization of the dirty areas between the render buffers in direct-mode, once the worker
+ *        has handed the destination back
+ */
+static void pipeline_buffer_copy(
+    lv_draw_ctx_t *draw_ctx, void *dest_buf, lv_coord_t dest_stride, const lv_area_t *dest_area, void *src_buf,
+    lv_coord_t src_stride, const lv_area_t *src_area
+)
+{
+    lvgl_port_flush_worker_fence(pipeline_get_buf_index(dest_buf), -1);
+    lvgl_draw_buffer_copy(draw_ctx, dest_buf, dest_stride, dest_area, src_buf, src_stride, src_area);
+    psram_account(lv_area_get_size(dest_area) * sizeof(lv_color_t), lv_area_get_size(dest_area) * sizeof(lv_color_t));
+}
+
+/**
+ * @brief Fence before LVGL starts to render into the active buffer, even if there is no area to synchronize
+ */
+static void render_start_callback_pipelined(lv_disp_drv_t *drv)
+{
+    lvgl_port_flush_worker_fence(pipeline_get_buf_index(drv->draw_buf->buf_act), -1);
+}
+
+template <bool Full>
+static void flush_callback_pipelined(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    /* Action after last area refresh */
+    if (lv_disp_flush_is_last(drv)) {
+        lvgl_port_copy_rect_t rects[LVGL_PORT_FLUSH_WORKER_RECT_MAX];
+        int rect_num = 1;
+
+        if (Full) {
+            rects[0] = { 0, 0, (int16_t)(drv->hor_res - 1), (int16_t)(drv->ver_res - 1) };
+        } else {
+            rect_num = flush_get_damage(_lv_refr_get_disp_refreshing(), color_map, rects);
+            if (rect_num == 0) {
+                /* Nothing changed, keep the current frame on screen */
+                lv_disp_flush_ready(drv);
+                return;
+            }
+        }
+        rect_num = pipeline_join_damage(rects, rect_num);
+        psram_account_copy(rects, rect_num);
+
+        /* `color_map` is the worker's until its copy is over, LVGL renders the next frame into the other buffer */
+        lvgl_port_flush_worker_submit(pipeline_get_buf_index(color_map), rects, rect_num);
+    }
+
+    lv_disp_flush_ready(drv);
+}
+
+template <class Rotation, bool Full>
+static void setup_pipelined(lv_disp_drv_t *drv)
+{
+    uint32_t buf_size = drv->hor_res * drv->ver_res;
+
+    // The first render buffer is the third frame buffer, like the other rotated modes
+    if (pipeline_buf_alloc == nullptr) {
+        pipeline_buf_alloc = heap_caps_aligned_alloc(
+                                 LVGL_PORT_ASYNC_COPY_ALIGN, buf_size * sizeof(lv_color_t), MALLOC_CAP_SPIRAM
+                             );
+        assert(pipeline_buf_alloc);
+        ESP_UTILS_LOGD("Render buffer address: %p, size: %d", pipeline_buf_alloc, (int)(buf_size * sizeof(lv_color_t)));
+    }
+    pipeline_bufs[0] = lvgl_port_fbs[2];
+    pipeline_bufs[1] = pipeline_buf_alloc;
+    pipeline_fb = (lvgl_port_fb_shown == lvgl_port_fbs[0]) ? 1 : 0;
+    pipeline_last_rect_num = 0;
+    ESP_UTILS_CHECK_FALSE_EXIT(
+        lvgl_port_flush_worker_set_callbacks(pipeline_copy<Rotation>, pipeline_present, drv),
+        "Set flush worker callbacks failed"
+    );
+    drv->full_refresh = Full;
+    drv->direct_mode = !Full;
+    lv_disp_draw_buf_init(drv->draw_buf, pipeline_bufs[0], pipeline_bufs[1], buf_size);
+}
+
+/* ---------- LCD double-buffer & LVGL full-refresh or direct-mode, chosen per frame ---------- */
+
+static void (*lvgl_refr_timer_cb)(lv_timer_t *timer) = nullptr;
+static bool adaptive_full = false;              // The current frames use full-refresh
+static int adaptive_frames = 0;                 // Consecutive frames beyond the threshold of the other mode
+
+/**
+ * @brief Drop the areas LVGL would synchronize between the render buffers before the next frame, the `sync_areas` of
+ *        LVGL 8.3 and 8.4
+ */
+static void display_sync_areas_clear(lv_disp_t *disp)
+{
+    _lv_ll_clear(&disp->sync_areas);
+}
+
+static uint32_t adaptive_dirty_percent(lv_disp_t *disp)
+{
+    uint32_t screen = (uint32_t)disp->driver->hor_res * disp->driver->ver_res;
+    lvgl_port_copy_rect_t rects[LVGL_PORT_DAMAGE_RECT_MAX];
+    int rect_num = 0;
+
+    // The areas are not joined yet and may overlap, their union is joined like LVGL does before rendering them
+    for (int i = 0; i < disp->inv_p; i++) {
+        const lv_area_t *area = &disp->inv_areas[i];
+        lvgl_port_copy_rect_t rect = { area->x1, area->y1, area->x2, area->y2 };
+        rect_num = lvgl_port_damage_union_add(rects, rect_num, LVGL_PORT_DAMAGE_RECT_MAX, &rect);
+    }
+    uint32_t dirty = lvgl_port_damage_union_area(rects, rect_num);
+
+    return (dirty >= screen) ? 100 : (dirty * 100 / screen);
+}
+
+/**
+ * @brief Switch between full-refresh and direct-mode, keeping the two frame buffers consistent
+ *
+ * @note  Full-refresh renders the whole screen, so the areas LVGL would synchronize are dropped, like an armed copy.
+ *        Back to direct-mode, the render buffer is one frame behind on the whole screen, so it is synchronized with
+ *        the frame buffer on screen. LVGL does it in `refr_sync_areas()`, unless the DMA has already done it.
+ */
+static void adaptive_switch(lv_disp_t *disp, bool full)
+{
+    lv_disp_drv_t *drv = disp->driver;
+
+    adaptive_full = full;
+    adaptive_frames = 0;
+    flush_sync_rect_num = -1;
+    display_sync_areas_clear(disp);
+    if (full) {
+        if (lvgl_port_config.tile_hash) {
+            /* Full-refresh frames are not filtered */
+            lvgl_port_tile_hash_reset();
+        }
+        if (lvgl_port_config.async_copy) {
+            lvgl_port_async_copy_wait(nullptr, -1);
+        }
+        return;
+    }
+
+    lv_area_t *sync_area = (lv_area_t *)_lv_ll_ins_tail(&disp->sync_areas);
+    if (sync_area != nullptr) {
+        lv_area_set(sync_area, 0, 0, drv->hor_res - 1, drv->ver_res - 1);
+    }
+    if (lvgl_port_config.async_copy) {
+        void *dst = drv->draw_buf->buf_act;
+        void *src = (dst == drv->draw_buf->buf1) ? drv->draw_buf->buf2 : drv->draw_buf->buf1;
+        lvgl_port_copy_rect_t rect = { 0, 0, (int16_t)(drv->hor_res - 1), (int16_t)(drv->ver_res - 1) };
+
+        // The copy starts from the vsync ISR if the render buffer is still on screen
+        if (lvgl_port_async_copy_arm(dst, src, &rect, 1, drv->hor_res, drv->ver_res, sizeof(lv_color_t))) {
+            psram_account_copy(&rect, 1);
+            if (!drv->draw_buf->flushing) {
+                lvgl_port_async_copy_start();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Pick the mode of the coming frame from the invalid areas, then run LVGL's refresh
+ *
+ * @note  `full_refresh` is only set during the refresh: LVGL records any invalidation as the whole screen while it is
+ *        set, which would hide the real dirty area from the next decision.
+ */
+static void adaptive_refr_timer(lv_timer_t *timer)
+{
+    lv_disp_t *disp = (lv_disp_t *)timer->user_data;
+    lv_disp_drv_t *drv = disp->driver;
+
+    if (disp->inv_p > 0) {
+        uint32_t dirty = adaptive_dirty_percent(disp);
+        bool beyond = adaptive_full ? (dirty <= LVGL_PORT_ADAPTIVE_DIRECT_PERCENT) :
+                      (dirty >= LVGL_PORT_ADAPTIVE_FULL_PERCENT);
+
+        adaptive_frames = beyond ? (adaptive_frames + 1) : 0;
+        if (adaptive_frames >= LVGL_PORT_ADAPTIVE_FRAMES) {
+            ESP_UTILS_LOGD("Adaptive: switch to %s, dirty area %d%%", adaptive_full ? "direct-mode" : "full-refresh",
+                           (int)dirty);
+            adaptive_switch(disp, !adaptive_full);
+        }
+    }
+
+    drv->full_refresh = adaptive_full;
+    drv->direct_mode = !adaptive_full;
+    lvgl_refr_timer_cb(timer);
+    drv->full_refresh = 0;
+    drv->direct_mode = 1;
+}
+
+template <class Sync>
+static void flush_callback_adaptive(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    if (drv->full_refresh) {
+        flush_callback_full_double(drv, area, color_map);
+    } else {
+        flush_callback_direct<Sync>(drv, area, color_map);
+    }
+}
+
+static void setup_adaptive(lv_disp_drv_t *drv)
+{
+    adaptive_full = false;
+    adaptive_frames = 0;
+    setup_direct(drv);
+}
+
+/* ---------- LCD double-buffer & LVGL partial rendering into SRAM tiles ---------- */
+
+static int tiled_back = 1;                      // The frame buffer the tiles are written back into
+static lvgl_port_copy_rect_t tiled_sync_rects[LVGL_PORT_ASYNC_COPY_RECT_MAX];
+static int tiled_sync_rect_num = 0;             // Damage of the last frame, missing from the back frame buffer
+
+/**
+ * @brief Widen the invalid areas to whole lines, so every tile is one contiguous span of the frame buffer
+ */
+static void rounder_callback_tiled(lv_disp_drv_t *drv, lv_area_t *area)
+{
+    rounder_callback(drv, area);
+    area->x1 = 0;
+    area->x2 = drv->hor_res - 1;
+}
+
+/**
+ * @brief Bring the back frame buffer up to date with the last frame before the first tile is written back into it
+ *
+ * @note  The back frame buffer is only off screen once the vsync ISR has completed the deferred flush of the last
+ *        frame. The copy is not fenced here: the write-back of the first tile fences it, so it overlaps with rendering
+ *        that tile.
+ */
+template <class Sync>
+static void render_start_callback_tiled(lv_disp_drv_t *drv)
+{
+    void *back = lvgl_port_fbs[tiled_back];
+    void *front = lvgl_port_fbs[tiled_back ^ 1];
+
+    while (drv->draw_buf->flushing) {
+        wait_callback(drv);
+    }
+
+    int rect_num = flush_drop_covered(_lv_refr_get_disp_refreshing(), tiled_sync_rects, tiled_sync_rect_num);
+    tiled_sync_rect_num = 0;
+    if (rect_num == 0) {
+        return;
+    }
+    psram_account_copy(tiled_sync_rects, rect_num);
+
+    if (Sync::arm(back, front, tiled_sync_rects, rect_num, drv->hor_res, drv->ver_res, sizeof(lv_color_t))) {
+        Sync::start();
+        return;
+    }
+    for (int i = 0; i < rect_num; i++) {
+        display_rotate_copy<Rotate<0>>(front, back, tiled_sync_rects[i], drv->hor_res, drv->ver_res);
+    }
+}
+
+/**
+ * @brief Write a finished tile back into the back frame buffer, and present it after the last tile
+ *
+ * @note  LVGL renders the next tile into the other SRAM buffer as soon as the flush is ready, so the write-back of a
+ *        tile runs while the next one is rendered. It only has to land before the tile buffer is flushed again, which
+ *        is fenced at the start of the next flush. Every job is started as soon as it is armed, so the fences never
+ *        drop one.
+ */
+template <class Sync>
+static void flush_callback_tiled(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    LCD *lcd = (LCD *)drv->user_data;
+    void *back = lvgl_port_fbs[tiled_back];
+    uint8_t *dst = (uint8_t *)back + (size_t)area->y1 * drv->hor_res * sizeof(lv_color_t);
+    int16_t height = lv_area_get_height(area);
+    lvgl_port_copy_rect_t tile = { 0, 0, (int16_t)(drv->hor_res - 1), (int16_t)(height - 1) };
+    uint32_t bytes = lv_area_get_size(area) * sizeof(lv_color_t);
+
+    /* The previous tile, or the synchronization of the back frame buffer, must have landed first */
+    Sync::fence(nullptr);
+    psram_account(0, bytes);
+    if (Sync::arm(dst, color_map, &tile, 1, drv->hor_res, height, sizeof(lv_color_t))) {
+        Sync::start();
+    } else {
+        memcpy(dst, color_map, bytes);
+    }
+
+    /* Action after last area refresh */
+    if (lv_disp_flush_is_last(drv)) {
+        Sync::fence(nullptr);
+        /* The damage of this frame is missing from the other frame buffer */
+        tiled_sync_rect_num = flush_get_inv_rects(_lv_refr_get_disp_refreshing(), tiled_sync_rects);
+
+        /* Switch the current LCD frame buffer to `back`, and write the next frame into the other one */
+        display_switch_frame_buffer(lcd, back);
+        tiled_back ^= 1;
+
+        if (!lvgl_port_present_submit(esp_timer_get_time())) {
+            /* The vsync ISR calls `lv_disp_flush_ready()` once `back` is on screen */
+            return;
+        }
+    }
+
+    lv_disp_flush_ready(drv);
+}
+
+/**
+ * @brief Let LVGL render partially into two tiles of whole lines in SRAM, shared by the modes 6 to 9
+ */
+static void setup_tiles(lv_disp_drv_t *drv)
+{
+    // Aligned so the GDMA can write them back into the frame buffers
+    uint32_t tile_size = drv->hor_res * lvgl_port_config.buffer.height;
+    uint32_t caps = lvgl_port_config.buffer.caps | (lvgl_port_config.async_copy ? MALLOC_CAP_DMA : 0);
+
+    for (int i = 0; i < LVGL_PORT_BUFFER_NUM_MAX; i++) {
+        if (lvgl_buf[i] == nullptr) {
+            lvgl_buf[i] = heap_caps_aligned_alloc(LVGL_PORT_ASYNC_COPY_ALIGN, tile_size * sizeof(lv_color_t), caps);
+            assert(lvgl_buf[i]);
+            ESP_UTILS_LOGD("Tile[%d] address: %p, size: %d", i, lvgl_buf[i], (int)(tile_size * sizeof(lv_color_t)));
+        }
+    }
+    drv->rounder_cb = rounder_callback_tiled;
+    lv_disp_draw_buf_init(drv->draw_buf, lvgl_buf[0], lvgl_buf[1], tile_size);
+}
+
+static void setup_tiled(lv_disp_drv_t *drv)
+{
+    setup_tiles(drv);
+    tiled_back = 1;
+    tiled_sync_rect_num = 0;
+}
+
+/* ---------- Single frame buffer, racing the beam ---------- */
+
+/**
+ * @brief Write a finished tile into the only frame buffer, where the scanout is not reading it
+ *
+ * @note  The tile is written either behind the beam or ahead of it (see `lvgl_port_scanout.h`), so the wait is at
+ *        most the time the beam takes to cross it. The write is synchronous and timed, to refine the estimate the
+ *        next placements rely on. Without the beam (no bounce buffer), every tile waits for the timeout and may tear.
+ *        At half resolution, the beam is avoided on the lines of the panel that read the tile.
+ */
+template <class Sync, bool Half>
+static void flush_callback_beam(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    uint8_t *dst = (uint8_t *)lvgl_port_fbs[0] + (size_t)area->y1 * drv->hor_res * sizeof(lv_color_t);
+    int16_t height = lv_area_get_height(area);
+    lvgl_port_copy_rect_t tile = { 0, 0, (int16_t)(drv->hor_res - 1), (int16_t)(height - 1) };
+    uint32_t bytes = lv_area_get_size(area) * sizeof(lv_color_t);
+    int y1 = area->y1;
+    int y2 = area->y2;
+
+    if (Half) {
+        lvgl_port_upscale_get_lines(area->y1, area->y2, &y1, &y2);
+    }
+    lvgl_port_scanout_wait_band(y1, y2, bytes, LVGL_PORT_PRESENT_WAIT_MS * 1000);
+
+    int64_t start_us = esp_timer_get_time();
+    if (Sync::arm(dst, color_map, &tile, 1, drv->hor_res, height, sizeof(lv_color_t))) {
+        Sync::start();
+        Sync::fence(dst);
+    } else {
+        memcpy(dst, color_map, bytes);
+    }
+    lvgl_port_scanout_band_done(bytes, esp_timer_get_time() - start_us);
+    psram_account(0, bytes);
+
+    lv_disp_flush_ready(drv);
+}
+
+static void setup_beam(lv_disp_drv_t *drv)
+{
+    LCD *lcd = (LCD *)drv->user_data;
+
+    setup_tiles(drv);
+    ESP_UTILS_CHECK_FALSE_EXIT(display_init_scanout(lcd), "Initialize scanout failed");
+    display_switch_frame_buffer(lcd, lvgl_port_fbs[0]);
+}
+
+/* ---------- Single frame buffer of color indices, racing the beam ---------- */
+
+/**
+ * @brief Convert a finished tile into color indices, written into the frame buffer where the scanout is not reading
+ *
+ * @note  The conversion reads the tile from SRAM and writes one byte per pixel, so it is the write that
+ *        `lvgl_port_scanout_band_done()` times. It is done by the CPU, the GDMA can't convert.
+ */
+static void flush_callback_indexed(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    uint8_t *dst = (uint8_t *)lvgl_port_fbs[0] + (size_t)area->y1 * drv->hor_res;
+    uint32_t bytes = lv_area_get_size(area);
+
+    lvgl_port_scanout_wait_band(area->y1, area->y2, bytes, LVGL_PORT_PRESENT_WAIT_MS * 1000);
+
+    int64_t start_us = esp_timer_get_time();
+    lvgl_port_palette_convert(
+        dst, drv->hor_res, (const uint16_t *)color_map, drv->hor_res, 0, area->y1, drv->hor_res,
+        lv_area_get_height(area)
+    );
+    lvgl_port_scanout_band_done(bytes, esp_timer_get_time() - start_us);
+    psram_account(0, bytes);
+
+    lv_disp_flush_ready(drv);
+}
+
+static void setup_indexed(lv_disp_drv_t *drv)
+{
+    LCD *lcd = (LCD *)drv->user_data;
+
+    setup_tiles(drv);
+    ESP_UTILS_CHECK_FALSE_EXIT(display_init_scanout(lcd), "Initialize scanout failed");
+    ESP_UTILS_CHECK_FALSE_EXIT(
+        lvgl_port_palette_init(lvgl_port_fbs[0], lcd->getFrameWidth(), lcd->getFrameHeight()),
+        "Initialize palette failed"
+    );
+    display_set_mode_fill(lvgl_port_palette_fill);
+    display_switch_frame_buffer(lcd, lvgl_port_fbs[0]);
+}
+
+/* ---------- Single frame buffer at half resolution, racing the beam ---------- */
+
+static void setup_half(lv_disp_drv_t *drv)
+{
+    LCD *lcd = (LCD *)drv->user_data;
+
+    setup_tiles(drv);
+    ESP_UTILS_CHECK_FALSE_EXIT(display_init_scanout(lcd), "Initialize scanout failed");
+    ESP_UTILS_CHECK_FALSE_EXIT(
+        lvgl_port_upscale_init(lvgl_port_fbs[0], drv->hor_res, drv->ver_res, LVGL_PORT_HALF_BILINEAR),
+        "Initialize upscale failed"
+    );
+    display_set_mode_fill(lvgl_port_upscale_fill);
+    display_switch_frame_buffer(lcd, lvgl_port_fbs[0]);
+}
+
+/* ---------- Vsync ---------- */
+
+/**
+ * @brief Wake up the LVGL task for a frame of the scheduler, shared by the vsync ISRs
+ */
+__attribute__((always_inline))
+static inline void vsync_schedule(int64_t now_us, BaseType_t *need_yield)
+{
+    if (lvgl_port_frame_sched_on_vsync(now_us) && (lvgl_task_wake != nullptr)) {
+        xSemaphoreGiveFromISR(lvgl_task_wake, need_yield);
+    }
+}
+
+/**
+ * @brief Start the copy waiting for the vsync and complete the deferred flush, shared by the vsync ISRs
+ */
+__attribute__((always_inline))
+static inline bool vsync_present(TaskHandle_t task_handle)
+{
+    BaseType_t need_yield = pdFALSE;
+    int64_t now_us = esp_timer_get_time();
+
+    // The frame buffer that has just left the scanout can be written now, start copying the dirty areas into it
+    if (lvgl_port_async_copy_start_from_isr()) {
+        need_yield = pdTRUE;
+    }
+    vsync_schedule(now_us, &need_yield);
+    if (lvgl_port_present_on_vsync(now_us)) {
+        // Complete the deferred flush, and wake up LVGL if it waits for it in `wait_callback()`
+        lv_disp_flush_ready(lvgl_disp_drv);
+        xTaskNotifyFromISR(task_handle, ULONG_MAX, eNoAction, &need_yield);
+    }
+
+    return (need_yield == pdTRUE);
+}
+
+IRAM_ATTR static bool vsync_callback_present(void *user_data)
+{
+    return vsync_present((TaskHandle_t)user_data);
+}
+
+IRAM_ATTR static bool vsync_callback_full_triple(void *user_data)
+{
+    if (lvgl_port_lcd_next_buf != lvgl_port_lcd_last_buf) {
+        lvgl_port_flush_next_buf = lvgl_port_lcd_last_buf;
+        lvgl_port_lcd_last_buf = lvgl_port_lcd_next_buf;
+    }
+
+    return vsync_present((TaskHandle_t)user_data);
+}
+
+IRAM_ATTR static bool vsync_callback_buffer_age(void *user_data)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    // The pending frame buffer is being scanned out from now on
+    lvgl_port_fb_front = lvgl_port_fb_pending;
+    bool present_yield = vsync_present((TaskHandle_t)user_data);
+    if (lvgl_port_fb_waiting) {
+        // The next frame can be switched to
+        xTaskNotifyFromISR((TaskHandle_t)user_data, ULONG_MAX, eNoAction, &need_yield);
+    }
+
+    return present_yield || (need_yield == pdTRUE);
+}
+
+IRAM_ATTR static bool vsync_callback_notify(void *user_data)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    // The frame buffer that has just left the scanout can be written now, start copying the dirty areas into it
+    if (lvgl_port_async_copy_start_from_isr()) {
+        need_yield = pdTRUE;
+    }
+    vsync_schedule(esp_timer_get_time(), &need_yield);
+    // Notify that the current LCD frame buffer has been transmitted
+    xTaskNotifyFromISR((TaskHandle_t)user_data, ULONG_MAX, eNoAction, &need_yield);
+
+    return (need_yield == pdTRUE);
+}
+
+IRAM_ATTR static bool vsync_callback_pipelined(void *user_data)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    vsync_schedule(esp_timer_get_time(), &need_yield);
+    // Show the frame the worker has switched to, and let it copy the next one into the frame buffer that left
+    if (lvgl_port_flush_worker_vsync_from_isr()) {
+        need_yield = pdTRUE;
+    }
+
+    return (need_yield == pdTRUE);
+}
+
+/**
+ * @brief Called by LVGL while it waits for a flush, sleep until the vsync ISR completes it instead of spinning
+ */
+static void wait_callback(lv_disp_drv_t *drv)
+{
+    int64_t start_us = esp_timer_get_time();
+
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LVGL_PORT_PRESENT_WAIT_MS));
+    lvgl_port_present_add_wait(esp_timer_get_time() - start_us);
+}
+
+/* ---------- Avoid tearing disabled ---------- */
+
+static void flush_callback_bitmap(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    LCD *lcd = (LCD *)drv->user_data;
+    const int offsetx1 = area->x1;
+    const int offsetx2 = area->x2;
+    const int offsety1 = area->y1;
+    const int offsety2 = area->y2;
+
+    lcd->drawBitmap(offsetx1, offsety1, offsetx2 - offsetx1 + 1, offsety2 - offsety1 + 1, (const uint8_t *)color_map);
+    // For RGB LCD, directly notify LVGL that the buffer is ready
+    if (lcd->getBus()->getBasicAttributes().type == ESP_PANEL_BUS_TYPE_RGB) {
         lv_disp_flush_ready(drv);
     }
 }
 
 static void update_callback(lv_disp_drv_t *drv)
 {
-    LCD *lcd = (LCD *)drv->user_data;
-    auto transformation = lcd->getTransformation();
-    static bool disp_init_mirror_x = transformation.mirror_x;
-    static bool disp_init_mirror_y = transformation.mirror_y;
-    static bool disp_init_swap_xy = transformation.swap_xy;
+    LCD *lcd = (LCD *)drv->user_data;
+    auto transformation = lcd->getTransformation();
+    static bool disp_init_mirror_x = transformation.mirror_x;
+    static bool disp_init_mirror_y = transformation.mirror_y;
+    static bool disp_init_swap_xy = transformation.swap_xy;
+
+    switch (drv->rotated) {
+    case LV_DISP_ROT_NONE:
+        lcd->swapXY(disp_init_swap_xy);
+        lcd->mirrorX(disp_init_mirror_x);
+        lcd->mirrorY(disp_init_mirror_y);
+        break;
+    case LV_DISP_ROT_90:
+        lcd->swapXY(!disp_init_swap_xy);
+        lcd->mirrorX(disp_init_mirror_x);
+        lcd->mirrorY(!disp_init_mirror_y);
+        break;
+    case LV_DISP_ROT_180:
+        lcd->swapXY(disp_init_swap_xy);
+        lcd->mirrorX(!disp_init_mirror_x);
+        lcd->mirrorY(!disp_init_mirror_y);
+        break;
+    case LV_DISP_ROT_270:
+        lcd->swapXY(!disp_init_swap_xy);
+        lcd->mirrorX(!disp_init_mirror_x);
+        lcd->mirrorY(disp_init_mirror_y);
+        break;
+    }
+
+    ESP_UTILS_LOGD("Update display rotation to %d", drv->rotated);
+
+#if ESP_UTILS_CONF_LOG_LEVEL == ESP_UTILS_LOG_LEVEL_DEBUG
+    transformation = lcd->getTransformation();
+    disp_init_mirror_x = transformation.mirror_x;
+    disp_init_mirror_y = transformation.mirror_y;
+    disp_init_swap_xy = transformation.swap_xy;
+    ESP_UTILS_LOGD("Current mirror x: %d, mirror y: %d, swap xy: %d", disp_init_mirror_x, disp_init_mirror_y, disp_init_swap_xy);
+#endif
+}
+
+void rounder_callback(lv_disp_drv_t *drv, lv_area_t *area)
+{
+    LCD *lcd = (LCD *)drv->user_data;
+    uint8_t x_align = lcd->getBasicAttributes().basic_bus_spec.x_coord_align;
+    uint8_t y_align = lcd->getBasicAttributes().basic_bus_spec.y_coord_align;
+
+    if (x_align > 1) {
+        // round the start of coordinate down to the nearest aligned value
+        area->x1 &= ~(x_align - 1);
+        // round the end of coordinate up to the nearest aligned value
+        area->x2 = (area->x2 & ~(x_align - 1)) + x_align - 1;
+    }
+
+    if (y_align > 1) {
+        // round the start of coordinate down to the nearest aligned value
+        area->y1 &= ~(y_align - 1);
+        // round the end of coordinate up to the nearest aligned value
+        area->y2 = (area->y2 & ~(y_align - 1)) + y_align - 1;
+    }
+}
+
+// *INDENT-OFF*
+
+#define STRATEGY_SYNC_OF(_Sync)                 ((_Sync::async) ? STRATEGY_SYNC_ASYNC : STRATEGY_SYNC_CPU)
+#define STRATEGY_FULL_ROTATED(_mode, _degree)                                                                         \
+    { _mode, _degree, STRATEGY_SYNC_NONE, 3, false, false, setup_full_rotated,                                         \
+      flush_callback_full_rotated<Rotate<_degree>>, nullptr, vsync_callback_notify, nullptr, nullptr }
+#define STRATEGY_DIRECT_ROTATED(_degree, _Sync)                                                                       \
+    { LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_DIRECT, _degree, STRATEGY_SYNC_OF(_Sync), 3, false, false,                   \
+      setup_direct_rotated, flush_callback_direct_rotated<Rotate<_degree>, _Sync>, nullptr, vsync_callback_notify,     \
+      nullptr, nullptr }
+#define STRATEGY_PIPELINED(_mode, _degree, _full)                                                                     \
+    { _mode, _degree, STRATEGY_SYNC_WORKER, 3, false, false, setup_pipelined<Rotate<_degree>, _full>,                 \
+      flush_callback_pipelined<_full>, render_start_callback_pipelined, vsync_callback_pipelined, nullptr,            \
+      pipeline_buffer_copy }
+#define STRATEGY_DIRECT(_Sync)                                                                                        \
+    { LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_DIRECT, 0, STRATEGY_SYNC_OF(_Sync), 2, true, false, setup_direct,            \
+      flush_callback_direct<_Sync>, render_start_callback_direct<_Sync>, vsync_callback_present, nullptr,             \
+      flush_buffer_copy<_Sync> }
+#define STRATEGY_BUFFER_AGE(_Sync)                                                                                    \
+    { LVGL_PORT_AVOID_TEARING_MODE_TRIPLE_DIRECT, 0, STRATEGY_SYNC_OF(_Sync), 3, true, false, setup_buffer_age,        \
+      flush_callback_buffer_age, render_start_callback_buffer_age<_Sync>, vsync_callback_buffer_age, nullptr,         \
+      nullptr }
+#define STRATEGY_ADAPTIVE(_Sync)                                                                                      \
+    { LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_ADAPTIVE, 0, STRATEGY_SYNC_OF(_Sync), 2, true, false, setup_adaptive,        \
+      flush_callback_adaptive<_Sync>, render_start_callback_direct<_Sync>, vsync_callback_present,                    \
+      adaptive_refr_timer, flush_buffer_copy<_Sync> }
+#define STRATEGY_TILED(_Sync)                                                                                         \
+    { LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_TILED, 0, STRATEGY_SYNC_OF(_Sync), 2, true, false, setup_tiled,              \
+      flush_callback_tiled<_Sync>, render_start_callback_tiled<_Sync>, vsync_callback_present, nullptr, nullptr }
+#define STRATEGY_BEAM(_Sync)                                                                                          \
+    { LVGL_PORT_AVOID_TEARING_MODE_SINGLE_BEAM, 0, STRATEGY_SYNC_OF(_Sync), 1, false, true, setup_beam,               \
+      flush_callback_beam<_Sync, false>, nullptr, vsync_callback_notify, nullptr, nullptr }
+#define STRATEGY_INDEXED()                                                                                            \
+    { LVGL_PORT_AVOID_TEARING_MODE_SINGLE_INDEXED, 0, STRATEGY_SYNC_NONE, 1, false, true, setup_indexed,              \
+      flush_callback_indexed, nullptr, vsync_callback_notify, nullptr, nullptr }
+#define STRATEGY_HALF(_Sync)                                                                                          \
+    { LVGL_PORT_AVOID_TEARING_MODE_SINGLE_HALF, 0, STRATEGY_SYNC_OF(_Sync), 1, false, true, setup_half,               \
+      flush_callback_beam<_Sync, true>, nullptr, vsync_callback_notify, nullptr, nullptr }
+
+// *INDENT-ON*
+
+/**
+ * Every valid combination of avoid tearing mode, rotation and synchronization, the modes 4 to 9 don't support
+ * rotation. With the rotation at scanout, the modes 1 to 6 use their entries without rotation.
+ */
+static const lvgl_port_strategy_t lvgl_port_strategies[] = {
+    {
+        LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_FULL, 0, STRATEGY_SYNC_NONE, 2, true, false,
+        setup_full_double, flush_callback_full_double, nullptr, vsync_callback_present, nullptr, nullptr
+    },
+    STRATEGY_FULL_ROTATED(LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_FULL, 90),
+    STRATEGY_FULL_ROTATED(LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_FULL, 180),
+    STRATEGY_FULL_ROTATED(LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_FULL, 270),
+    {
+        LVGL_PORT_AVOID_TEARING_MODE_TRIPLE_FULL, 0, STRATEGY_SYNC_NONE, 3, true, false,
+        setup_full_triple, flush_callback_full_triple, nullptr, vsync_callback_full_triple, nullptr, nullptr
+    },
+    STRATEGY_FULL_ROTATED(LVGL_PORT_AVOID_TEARING_MODE_TRIPLE_FULL, 90),
+    STRATEGY_FULL_ROTATED(LVGL_PORT_AVOID_TEARING_MODE_TRIPLE_FULL, 180),
+    STRATEGY_FULL_ROTATED(LVGL_PORT_AVOID_TEARING_MODE_TRIPLE_FULL, 270),
+    STRATEGY_DIRECT(SyncCpu),
+    STRATEGY_DIRECT(SyncAsync),
+    STRATEGY_DIRECT_ROTATED(90, SyncCpu),
+    STRATEGY_DIRECT_ROTATED(90, SyncAsync),
+    STRATEGY_DIRECT_ROTATED(180, SyncCpu),
+    STRATEGY_DIRECT_ROTATED(180, SyncAsync),
+    STRATEGY_DIRECT_ROTATED(270, SyncCpu),
+    STRATEGY_DIRECT_ROTATED(270, SyncAsync),
+    STRATEGY_BUFFER_AGE(SyncCpu),
+    STRATEGY_BUFFER_AGE(SyncAsync),
+    STRATEGY_ADAPTIVE(SyncCpu),
+    STRATEGY_ADAPTIVE(SyncAsync),
+    STRATEGY_TILED(SyncCpu),
+    STRATEGY_TILED(SyncAsync),
+    STRATEGY_BEAM(SyncCpu),
+    STRATEGY_BEAM(SyncAsync),
+    STRATEGY_INDEXED(),
+    STRATEGY_HALF(SyncCpu),
+    STRATEGY_HALF(SyncAsync),
+    STRATEGY_PIPELINED(LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_FULL, 90, true),
+    STRATEGY_PIPELINED(LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_FULL, 180, true),
+    STRATEGY_PIPELINED(LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_FULL, 270, true),
+    STRATEGY_PIPELINED(LVGL_PORT_AVOID_TEARING_MODE_TRIPLE_FULL, 90, true),
+    STRATEGY_PIPELINED(LVGL_PORT_AVOID_TEARING_MODE_TRIPLE_FULL, 180, true),
+    STRATEGY_PIPELINED(LVGL_PORT_AVOID_TEARING_MODE_TRIPLE_FULL, 270, true),
+    STRATEGY_PIPELINED(LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_DIRECT, 90, false),
+    STRATEGY_PIPELINED(LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_DIRECT, 180, false),
+    STRATEGY_PIPELINED(LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_DIRECT, 270, false),
+};
+
+static const lvgl_port_strategy_t *strategy_find(
+    lvgl_port_avoid_tearing_mode_t mode, int rotation, bool async_copy, bool pipeline
+)
+{
+    lvgl_port_strategy_sync_t sync = async_copy ? STRATEGY_SYNC_ASYNC : STRATEGY_SYNC_CPU;
+
+    // The modes without a pipelined entry ignore `pipeline`
+    for (const auto &strategy : lvgl_port_strategies) {
+        if (pipeline && (strategy.mode == mode) && (strategy.rotation == rotation) &&
+                (strategy.sync == STRATEGY_SYNC_WORKER)) {
+            return &strategy;
+        }
+    }
+    for (const auto &strategy : lvgl_port_strategies) {
+        if ((strategy.mode == mode) && (strategy.rotation == rotation) &&
+                ((strategy.sync == STRATEGY_SYNC_NONE) || (strategy.sync == sync))) {
+            return &strategy;
+        }
+    }
+    return nullptr;
+}
+
+static bool config_check(const lvgl_port_config_t *config)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        (config->avoid_tearing_mode >= LVGL_PORT_AVOID_TEARING_MODE_NONE) &&
+        (config->avoid_tearing_mode < LVGL_PORT_AVOID_TEARING_MODE_MAX), false, "Invalid avoid tearing mode(%d)",
+        config->avoid_tearing_mode
+    );
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        (config->rotation == 0) || (config->rotation == 90) || (config->rotation == 180) || (config->rotation == 270),
+        false, "Invalid rotation degree(%d), please set to 0, 90, 180 or 270", config->rotation
+    );
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        config->frame_divisor >= 0, false, "Invalid frame divisor(%d)", config->frame_divisor
+    );
+    if (config->avoid_tearing_mode == LVGL_PORT_AVOID_TEARING_MODE_NONE) {
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            (config->buffer.num >= 1) && (config->buffer.num <= LVGL_PORT_BUFFER_NUM_MAX) && (config->buffer.height > 0),
+            false, "Invalid LVGL buffer number(%d) or height(%d)", config->buffer.num, config->buffer.height
+        );
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            config->frame_divisor == 0, false, "The frame scheduler needs the vsync of avoid tearing"
+        );
+    } else {
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            (config->avoid_tearing_mode < LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_TILED) || (config->buffer.height > 0),
+            false, "Invalid tile height(%d)", config->buffer.height
+        );
+        ESP_UTILS_CHECK_NULL_RETURN(
+            strategy_find(
+                config->avoid_tearing_mode, config_render_rotation(config, config->avoid_tearing_mode),
+                config->async_copy, config->pipeline
+            ), false,
+            "Rotation is not supported with avoid tearing mode %d", config->avoid_tearing_mode
+        );
+    }
+
+    return true;
+}
+
+/**
+ * @brief Swap LVGL's synchronization of the dirty areas in direct-mode and its refresh timer, only possible once the
+ *        driver is registered
+ */
+static void display_update_hooks(lv_disp_t *disp, const lvgl_port_strategy_t *strategy)
+{
+    lv_disp_drv_t *drv = disp->driver;
+
+    if (lvgl_draw_buffer_copy == nullptr) {
+        lvgl_draw_buffer_copy = drv->draw_ctx->buffer_copy;
+    }
+    drv->draw_ctx->buffer_copy = (strategy->buffer_copy != nullptr) ? strategy->buffer_copy : lvgl_draw_buffer_copy;
+
+    if (lvgl_refr_timer_cb == nullptr) {
+        lvgl_refr_timer_cb = disp->refr_timer->timer_cb;
+    }
+    lv_timer_set_cb(
+        disp->refr_timer, (strategy->refr_timer_cb != nullptr) ? strategy->refr_timer_cb : lvgl_refr_timer_cb
+    );
+}
+
+/**
+ * @brief Only available when the coordinate alignment is enabled
+ */
+static bool display_needs_rounder(LCD *lcd)
+{
+    return (lcd->getBasicAttributes().basic_bus_spec.x_coord_align > 1) ||
+           (lcd->getBasicAttributes().basic_bus_spec.y_coord_align > 1);
+}
+
+/**
+ * @brief Attach the vsync callback of a mode to the LCD
+ *
+ * @note  The scanout refill is attached while the mode or the user needs it: the modes 7 to 9, a mode whose scanout is
+ *        filled by the port (rotated at scanout), a fill or overlays of the user. Otherwise it is detached, and the
+ *        LCD driver copies the frame buffer again. Once attached, the callbacks of the LCD driver are replaced for
+ *        good, so every later mode gets its vsync from the scanout.
+ *
+ * @return true if success, otherwise false
+ */
+static bool display_attach_vsync(LCD *lcd, const lvgl_port_strategy_t *strategy)
+{
+    if (strategy->scanout || lvgl_port_mode_fill || lvgl_port_user_fill || lvgl_port_user_overlays) {
+        return lvgl_port_scanout_attach(lcd->getRefreshPanelHandle(), strategy->vsync_cb, (void *)lvgl_task_handle);
+    }
+    if (lvgl_port_scanout_owns_vsync()) {
+        return lvgl_port_scanout_detach(lcd->getRefreshPanelHandle(), strategy->vsync_cb, (void *)lvgl_task_handle);
+    }
+
+    return lcd->attachRefreshFinishCallback(strategy->vsync_cb, (void *)lvgl_task_handle);
+}
+
+/**
+ * @brief Stop the vsync ISR from calling into the port, the panel keeps scanning out the frame buffer on screen
+ */
+static void display_detach_vsync(LCD *lcd)
+{
+    if (lvgl_port_scanout_owns_vsync()) {
+        lvgl_port_scanout_detach(lcd->getRefreshPanelHandle(), nullptr, nullptr);
+    } else {
+        lcd->attachRefreshFinishCallback(nullptr, nullptr);
+    }
+}
+
+/**
+ * @brief Apply an avoid tearing mode to the display driver, between two frames
+ *
+ * @note  The frame buffers keep their content, but the first frames may tear until the new mode has rendered into
+ *        each of them, so the screen should be invalidated afterwards. Once the driver is registered,
+ *        `display_update_hooks()` has to be called too.
+ */
+static void display_apply_strategy(lv_disp_drv_t *drv, const lvgl_port_strategy_t *strategy)
+{
+    LCD *lcd = (LCD *)drv->user_data;
+
+    /* Let the last frame of the previous mode finish, a deferred flush is completed by its vsync ISR */
+    while (drv->draw_buf->flushing) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LVGL_PORT_PRESENT_WAIT_MS));
+    }
+    if (lvgl_port_config.async_copy) {
+        /* Drop an armed copy and wait for a running one */
+        lvgl_port_async_copy_wait(nullptr, -1);
+    }
+    if (lvgl_port_config.pipeline) {
+        /* Let the worker present the frames handed to it */
+        lvgl_port_flush_worker_wait_idle(-1);
+    }
+
+    drv->full_refresh = 0;
+    drv->direct_mode = 0;
+    drv->rounder_cb = display_needs_rounder(lcd) ? rounder_callback : nullptr;
+    lvgl_port_next_fb = NULL;
+    lvgl_port_tile_hash_reset();
+    if (lvgl_port_mode_fill) {
+        /* The frame buffer holds the colors of the panel again */
+        display_set_mode_fill(nullptr);
+        lvgl_port_palette_deinit();
+        lvgl_port_upscale_deinit();
+        lvgl_port_rotate_deinit();
+    }
+    strategy->setup(drv);
+    if (strategy->rotation != lvgl_port_config.rotation) {
+        display_setup_scanout_rotation(lcd);
+    }
+    drv->flush_cb = strategy->flush_cb;
+    drv->render_start_cb = strategy->render_start_cb;
+    drv->wait_cb = strategy->present_queue ? wait_callback : nullptr;
+    drv->monitor_cb = monitor_callback;
+    psram_stats = {};
+    psram_frame_read = 0;
+    psram_frame_write = 0;
+    if (strategy->present_queue) {
+        lvgl_port_present_init(strategy->frame_buffer_num, lvgl_port_config.present_mode, esp_timer_get_time());
+    }
+
+    lvgl_port_strategy = strategy;
+    lvgl_port_config.avoid_tearing_mode = strategy->mode;
+    if (lvgl_task_handle != nullptr) {
+        display_attach_vsync(lcd, strategy);
+    }
+}
+
+static lv_disp_t *display_init(LCD *lcd)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(lcd != nullptr, nullptr, "Invalid LCD device");
+    ESP_UTILS_CHECK_FALSE_RETURN(lcd->getRefreshPanelHandle() != nullptr, nullptr, "LCD device is not initialized");
+
+    static lv_disp_draw_buf_t disp_buf;
+    static lv_disp_drv_t disp_drv;
+
+    // Alloc draw buffers used by LVGL
+    auto lcd_width = lcd->getFrameWidth();
+    auto lcd_height = lcd->getFrameHeight();
+    const lvgl_port_strategy_t *strategy = nullptr;
+
+    ESP_UTILS_LOGD("Register display driver to LVGL");
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = lcd_width;
+    disp_drv.ver_res = lcd_height;
+    disp_drv.draw_buf = &disp_buf;
+    disp_drv.user_data = (void *)lcd;
+    if (display_needs_rounder(lcd)) {
+        disp_drv.rounder_cb = rounder_callback;
+    }
+
+    if (lvgl_port_config.avoid_tearing_mode == LVGL_PORT_AVOID_TEARING_MODE_NONE) {
+        // Avoid tearing function is disabled
+        ESP_UTILS_LOGD("Malloc memory for LVGL buffer");
+        int buffer_size = lcd_width * lvgl_port_config.buffer.height;
+        for (int i = 0; (i < lvgl_port_config.buffer.num) && (i < LVGL_PORT_BUFFER_NUM_MAX); i++) {
+            lvgl_buf[i] = heap_caps_malloc(buffer_size * sizeof(lv_color_t), lvgl_port_config.buffer.caps);
+            assert(lvgl_buf[i]);
+            ESP_UTILS_LOGD("Buffer[%d] address: %p, size: %d", i, lvgl_buf[i], buffer_size * sizeof(lv_color_t));
+        }
+        lv_disp_draw_buf_init(&disp_buf, lvgl_buf[0], lvgl_buf[1], buffer_size);
+
+        disp_drv.flush_cb = flush_callback_bitmap;
+        if (lcd->getBasicAttributes().basic_bus_spec.isFunctionValid(LCD::BasicBusSpecification::FUNC_SWAP_XY) &&
+                lcd->getBasicAttributes().basic_bus_spec.isFunctionValid(LCD::BasicBusSpecification::FUNC_MIRROR_X) &&
+                lcd->getBasicAttributes().basic_bus_spec.isFunctionValid(LCD::BasicBusSpecification::FUNC_MIRROR_Y)) {
+            disp_drv.drv_update_cb = update_callback;
+        } else {
+            disp_drv.sw_rotate = 1;
+        }
+    } else {
+        // To avoid the tearing effect, we should use at least two frame buffers: one for LVGL rendering and another for LCD refresh
+        strategy = strategy_find(
+                       lvgl_port_config.avoid_tearing_mode,
+                       config_render_rotation(&lvgl_port_config, lvgl_port_config.avoid_tearing_mode),
+                       lvgl_port_config.async_copy, lvgl_port_config.pipeline
+                   );
+        ESP_UTILS_CHECK_NULL_RETURN(strategy, nullptr, "Invalid avoid tearing mode");
+        for (int i = 0; i < strategy->frame_buffer_num; i++) {
+            lvgl_port_fbs[i] = lcd->getFrameBufferByIndex(i);
+            ESP_UTILS_CHECK_NULL_RETURN(
+                lvgl_port_fbs[i], nullptr, "Frame buffer %d is not available, the mode needs %d frame buffers", i,
+                strategy->frame_buffer_num
+            );
+        }
+        if ((lvgl_port_config.rotation == 90) || (lvgl_port_config.rotation == 270)) {
+            disp_drv.hor_res = lcd_height;
+            disp_drv.ver_res = lcd_width;
+        }
+        lvgl_port_scale = mode_scale(lvgl_port_config.avoid_tearing_mode);
+        disp_drv.hor_res /= lvgl_port_scale;
+        disp_drv.ver_res /= lvgl_port_scale;
+        display_apply_strategy(&disp_drv, strategy);
+    }
+
+    lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
+    lvgl_disp_drv = (disp != nullptr) ? disp->driver : nullptr;
+    if ((disp != nullptr) && (strategy != nullptr)) {
+        display_update_hooks(disp, strategy);
+    }
+
+    return disp;
+}
+
+int lvgl_port_get_frame_buffer_num(const lvgl_port_config_t *config)
+{
+    static const lvgl_port_config_t config_default = LVGL_PORT_CONFIG_DEFAULT();
+    if (config == nullptr) {
+        config = &config_default;
+    }
+    if (config->avoid_tearing_mode == LVGL_PORT_AVOID_TEARING_MODE_NONE) {
+        return 1;
+    }
+
+    const lvgl_port_strategy_t *strategy = strategy_find(
+            config->avoid_tearing_mode, config_render_rotation(config, config->avoid_tearing_mode), config->async_copy,
+            config->pipeline
+        );
+    ESP_UTILS_CHECK_NULL_RETURN(strategy, 1, "Invalid avoid tearing mode(%d) or rotation(%d)",
+                                config->avoid_tearing_mode, config->rotation);
+
+    return strategy->frame_buffer_num;
+}
+
+bool lvgl_port_get_config(lvgl_port_config_t *config)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(config, false, "Invalid config");
+
+    *config = lvgl_port_config;
+
+    return true;
+}
+
+bool lvgl_port_set_present_mode(lvgl_port_present_mode_t mode)
+{
+    static const char *present_names[] = { "FIFO", "mailbox", "immediate" };
+    lvgl_port_present_stats_t stats;
+
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        (lvgl_port_strategy != nullptr) && lvgl_port_strategy->present_queue, false,
+        "Present mode is only valid with anti-tearing and without rotation"
+    );
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_lock(-1), false, "Lock LVGL failed");
+
+    lvgl_port_present_get_stats(&stats);
+    int64_t now_us = esp_timer_get_time();
+    float elapsed_s = (now_us - stats.start_us) / 1000000.0f;
+    if ((elapsed_s > 0) && (stats.presented > 0)) {
+        ESP_UTILS_LOGI(
+            "Present %s: %.1f fps presented, %.1f fps rendered, %d dropped, latency avg %d us / max %d us, "
+            "render wait %d ms", present_names[stats.mode], stats.presented / elapsed_s, stats.submitted / elapsed_s,
+            (int)stats.dropped, (int)(stats.latency_us_sum / stats.presented), (int)stats.latency_us_max,
+            (int)(stats.render_wait_us / 1000)
+        );
+    }
+    lvgl_port_present_mode_t effective = lvgl_port_present_set_mode(mode, now_us);
+    if (effective != mode) {
+        ESP_UTILS_LOGW("Present %s needs 3 buffers, use %s instead", present_names[mode], present_names[effective]);
+    }
+    lvgl_port_config.present_mode = mode;
+
+    lvgl_port_unlock();
+
+    return true;
+}
+
+bool lvgl_port_get_present_stats(lvgl_port_present_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        (lvgl_port_strategy != nullptr) && lvgl_port_strategy->present_queue, false,
+        "Present mode is only valid with anti-tearing and without rotation"
+    );
+
+    lvgl_port_present_get_stats(stats);
+
+    return true;
+}
+
+bool lvgl_port_get_psram_stats(lvgl_port_psram_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_port_strategy, false, "Avoid tearing is not enabled");
+
+    *stats = psram_stats;
+
+    return true;
+}
+
+bool lvgl_port_start_frame_trace(lvgl_port_bandwidth_sim_frame_t *frames, int frame_max)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_port_strategy, false, "Avoid tearing is not enabled");
+    ESP_UTILS_CHECK_FALSE_RETURN((frames != nullptr) && (frame_max > 0), false, "Invalid trace");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_lock(-1), false, "Lock LVGL failed");
+
+    psram_trace = frames;
+    psram_trace_max = frame_max;
+    psram_trace_num = 0;
+    psram_trace_last_us = 0;
+
+    lvgl_port_unlock();
+
+    return true;
+}
+
+int lvgl_port_stop_frame_trace(void)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_lock(-1), -1, "Lock LVGL failed");
 
-    switch (drv->rotated) {
-    case LV_DISP_ROT_NONE:
-        lcd->swapXY(disp_init_swap_xy);
-        lcd->mirrorX(disp_init_mirror_x);
-        lcd->mirrorY(disp_init_mirror_y);
+    int frame_num = (psram_trace != nullptr) ? psram_trace_num : 0;
+    psram_trace = nullptr;
+    psram_trace_max = 0;
+
+    lvgl_port_unlock();
+
+    return frame_num;
+}
+
+bool lvgl_port_set_scanout_fill(lvgl_port_scanout_fill_cb_t fill_cb, void *user_data)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_port_strategy, false, "Avoid tearing is not enabled");
+    ESP_UTILS_CHECK_FALSE_RETURN(!lvgl_port_mode_fill, false, "The mode or the rotation generates the scanout itself");
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_task_handle, false, "LVGL task is not running");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_lock(-1), false, "Lock LVGL failed");
+
+    lvgl_port_scanout_set_fill(fill_cb, user_data);
+    lvgl_port_user_fill = (fill_cb != nullptr);
+    bool ret = display_update_scanout();
+    lvgl_port_unlock();
+    ESP_UTILS_CHECK_FALSE_RETURN(ret, false, "Attach scanout failed");
+
+    return true;
+}
+
+bool lvgl_port_set_scanout_overlays(bool enable)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_port_strategy, false, "Avoid tearing is not enabled");
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_task_handle, false, "LVGL task is not running");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_lock(-1), false, "Lock LVGL failed");
+
+    lvgl_port_scanout_set_compose(enable ? lvgl_port_overlay_compose : nullptr, nullptr);
+    lvgl_port_user_overlays = enable;
+    bool ret = display_update_scanout();
+    lvgl_port_unlock();
+    ESP_UTILS_CHECK_FALSE_RETURN(ret, false, "Attach scanout failed");
+
+    return true;
+}
+
+bool lvgl_port_get_scanout_stats(lvgl_port_scanout_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_scanout_attached(), false, "Scanout is not attached");
+
+    lvgl_port_scanout_get_stats(stats);
+
+    return true;
+}
+
+bool lvgl_port_get_tile_hash_stats(lvgl_port_tile_hash_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_config.tile_hash, false, "Tile hash is not enabled");
+
+    lvgl_port_tile_hash_get_stats(stats);
+
+    return true;
+}
+
+bool lvgl_port_get_pipeline_stats(lvgl_port_flush_worker_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_config.pipeline, false, "Pipeline is not enabled");
+
+    lvgl_port_flush_worker_get_stats(stats);
+
+    return true;
+}
+
+bool lvgl_port_get_parallel_copy_stats(lvgl_port_jobs_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_config.parallel_copy, false, "Parallel copy is not enabled");
+
+    lvgl_port_jobs_get_stats(stats);
+
+    return true;
+}
+
+static void task_wake(void);
+
+/**
+ * @brief Apply a command of `lvgl_port_ui_queue.h`, in the LVGL task with the lock held
+ *
+ * @note  The handle of a deleted target no longer resolves, so its commands are dropped here.
+ */
+static void ui_queue_apply(const lvgl_port_ui_cmd_t *cmd, void *)
+{
+    lv_obj_t *obj = (lv_obj_t *)lvgl_port_ui_queue_resolve(cmd->target);
+
+    if (obj == nullptr) {
+        return;
+    }
+
+    switch (cmd->type) {
+    case LVGL_PORT_UI_CMD_SET_TEXT:
+        if (lv_obj_check_type(obj, &lv_label_class)) {
+            lv_label_set_text(obj, cmd->text);
+        }
         break;
-    case LV_DISP_ROT_90:
-        lcd->swapXY(!disp_init_swap_xy);
-        lcd->mirrorX(disp_init_mirror_x);
-        lcd->mirrorY(!disp_init_mirror_y);
+    case LVGL_PORT_UI_CMD_SET_VALUE:
+        // A slider is a bar
+        if (lv_obj_has_class(obj, &lv_bar_class)) {
+            lv_bar_set_value(obj, cmd->value, LV_ANIM_OFF);
+        } else if (lv_obj_check_type(obj, &lv_arc_class)) {
+            lv_arc_set_value(obj, cmd->value);
+        }
         break;
-    case LV_DISP_ROT_180:
-        lcd->swapXY(disp_init_swap_xy);
-        lcd->mirrorX(!disp_init_mirror_x);
-        lcd->mirrorY(!disp_init_mirror_y);
+    case LVGL_PORT_UI_CMD_MOVE:
+        lv_obj_set_pos(obj, cmd->pos.x, cmd->pos.y);
         break;
-    case LV_DISP_ROT_270:
-        lcd->swapXY(!disp_init_swap_xy);
-        lcd->mirrorX(!disp_init_mirror_x);
-        lcd->mirrorY(disp_init_mirror_y);
+    case LVGL_PORT_UI_CMD_SET_HIDDEN:
+        if (cmd->hidden) {
+            lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+        }
+        break;
+    default:
         break;
     }
+}
+
+static void ui_handle_on_delete(lv_event_t *e)
+{
+    lvgl_port_ui_queue_unregister((lvgl_port_ui_handle_t)(uintptr_t)lv_event_get_user_data(e));
+}
+
+lvgl_port_ui_handle_t lvgl_port_ui_register(lv_obj_t *obj)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(obj, LVGL_PORT_UI_HANDLE_INVALID, "Invalid object");
+
+    lvgl_port_ui_handle_t handle = lvgl_port_ui_queue_register(obj);
+    ESP_UTILS_CHECK_FALSE_RETURN(handle != LVGL_PORT_UI_HANDLE_INVALID, handle, "No free UI handle");
+    lv_obj_add_event_cb(obj, ui_handle_on_delete, LV_EVENT_DELETE, (void *)(uintptr_t)handle);
+
+    return handle;
+}
+
+void lvgl_port_ui_unregister(lvgl_port_ui_handle_t handle)
+{
+    lv_obj_t *obj = (lv_obj_t *)lvgl_port_ui_queue_resolve(handle);
+
+    if (obj == nullptr) {
+        return;
+    }
+    lv_obj_remove_event_cb_with_user_data(obj, ui_handle_on_delete, (void *)(uintptr_t)handle);
+    lvgl_port_ui_queue_unregister(handle);
+}
+
+bool lvgl_port_ui_set_text(lvgl_port_ui_handle_t handle, const char *text)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        (handle != LVGL_PORT_UI_HANDLE_INVALID) && (text != nullptr), false, "Invalid command"
+    );
+
+    lvgl_port_ui_cmd_t cmd = {};
+    size_t len = strnlen(text, LVGL_PORT_UI_QUEUE_TEXT_MAX);
+    ESP_UTILS_CHECK_FALSE_RETURN(len < LVGL_PORT_UI_QUEUE_TEXT_MAX, false, "Text too long");
+    cmd.type = LVGL_PORT_UI_CMD_SET_TEXT;
+    cmd.target = handle;
+    memcpy(cmd.text, text, len + 1);
+
+    if (!lvgl_port_ui_queue_push(&cmd)) {
+        return false;
+    }
+    task_wake();
+
+    return true;
+}
+
+bool lvgl_port_ui_set_value(lvgl_port_ui_handle_t handle, int32_t value)
+{
+    lvgl_port_ui_cmd_t cmd = {};
+    cmd.type = LVGL_PORT_UI_CMD_SET_VALUE;
+    cmd.target = handle;
+    cmd.value = value;
+
+    if (!lvgl_port_ui_queue_push(&cmd)) {
+        return false;
+    }
+    task_wake();
+
+    return true;
+}
+
+bool lvgl_port_ui_move(lvgl_port_ui_handle_t handle, lv_coord_t x, lv_coord_t y)
+{
+    lvgl_port_ui_cmd_t cmd = {};
+    cmd.type = LVGL_PORT_UI_CMD_MOVE;
+    cmd.target = handle;
+    cmd.pos.x = x;
+    cmd.pos.y = y;
+
+    if (!lvgl_port_ui_queue_push(&cmd)) {
+        return false;
+    }
+    task_wake();
+
+    return true;
+}
+
+bool lvgl_port_ui_set_hidden(lvgl_port_ui_handle_t handle, bool hidden)
+{
+    lvgl_port_ui_cmd_t cmd = {};
+    cmd.type = LVGL_PORT_UI_CMD_SET_HIDDEN;
+    cmd.target = handle;
+    cmd.hidden = hidden;
+
+    if (!lvgl_port_ui_queue_push(&cmd)) {
+        return false;
+    }
+    task_wake();
+
+    return true;
+}
+
+bool lvgl_port_get_ui_queue_stats(lvgl_port_ui_queue_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+
+    lvgl_port_ui_queue_get_stats(stats);
+
+    return true;
+}
+
+static void touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data)
+{
+    Touch *tp = (Touch *)indev_drv->user_data;
+    TouchPoint point;
+
+    /* Read data from touch controller */
+    int read_touch_result = tp->readPoints(&point, 1, 0);
+    if (read_touch_result > 0) {
+        data->point.x = point.x / lvgl_port_scale;
+        data->point.y = point.y / lvgl_port_scale;
+        data->state = LV_INDEV_STATE_PRESSED;
+    } else {
+        data->state = LV_INDEV_STATE_RELEASED;
+        if (touch_by_interrupt) {
+            // Released, stop polling until the next interrupt
+            lv_timer_pause(indev_drv->read_timer);
+        }
+    }
+}
+
+IRAM_ATTR static bool touch_interrupt_callback(void *user_data)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    touch_pending = true;
+    lvgl_task_stats.touch_interrupts++;
+    if (lvgl_task_wake != nullptr) {
+        xSemaphoreGiveFromISR(lvgl_task_wake, &need_yield);
+    }
+
+    return (need_yield == pdTRUE);
+}
+
+static lv_indev_t *indev_init(Touch *tp)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(tp != nullptr, nullptr, "Invalid touch device");
+    ESP_UTILS_CHECK_FALSE_RETURN(tp->getPanelHandle() != nullptr, nullptr, "Touch device is not initialized");
+
+    static lv_indev_drv_t indev_drv_tp;
+
+    ESP_UTILS_LOGD("Register input driver to LVGL");
+    lv_indev_drv_init(&indev_drv_tp);
+    indev_drv_tp.type = LV_INDEV_TYPE_POINTER;
+    indev_drv_tp.read_cb = touchpad_read;
+    indev_drv_tp.user_data = (void *)tp;
+
+    lv_indev_t *indev = lv_indev_drv_register(&indev_drv_tp);
+    // With its interrupt, the touch panel is only polled while it is touched
+    if ((indev != nullptr) && tp->attachInterruptCallback(touch_interrupt_callback, nullptr)) {
+        touch_by_interrupt = true;
+        lv_timer_pause(indev->driver->read_timer);
+    }
+    lvgl_touch_indev = indev;
+
+    return indev;
+}
+
+#if !LV_TICK_CUSTOM
+#error "LVGL must read its tick from `lvgl_port_tick_get()`, set `LV_TICK_CUSTOM` in `lv_conf.h`"
+#endif
+
+/**
+ * @brief LVGL's tick, see `lvgl_port_tick.h`: the time of `esp_timer`, or the predicted presentation of the frame while
+ *        the frame scheduler runs. It never goes backward.
+ */
+uint32_t lvgl_port_tick_get(void)
+{
+    int64_t tick_us = tick_frame_us.load();
+
+    if (!tick_by_frame) {
+        int64_t now_us = esp_timer_get_time();
+        tick_us = (now_us > tick_us) ? now_us : tick_us;
+    }
+
+    return tick_us / 1000;
+}
+
+/**
+ * @brief Move LVGL's tick forward to a time, never backward
+ */
+static void tick_advance_to(int64_t time_us)
+{
+    if (time_us > tick_frame_us.load()) {
+        tick_frame_us.store(time_us);
+    }
+}
+
+/**
+ * @brief Wake the LVGL task up before its next timer, from a task or an ISR
+ */
+static void task_wake(void)
+{
+    if (lvgl_task_wake == nullptr) {
+        return;
+    }
+    if (xPortInIsrContext()) {
+        BaseType_t need_yield = pdFALSE;
+        xSemaphoreGiveFromISR(lvgl_task_wake, &need_yield);
+        if (need_yield == pdTRUE) {
+            portYIELD_FROM_ISR();
+        }
+    } else {
+        xSemaphoreGive(lvgl_task_wake);
+    }
+}
+
+/**
+ * @brief Called by LVGL after each rendered frame, `px` is the number of pixels rendered
+ */
+static void monitor_callback(lv_disp_drv_t *drv, uint32_t time_ms, uint32_t px)
+{
+    if (lvgl_port_config.avoid_tearing_mode < LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_TILED) {
+        /* LVGL rendered into a frame buffer, see `lvgl_port_psram_stats_t` */
+        psram_account(px * sizeof(lv_color_t), px * sizeof(lv_color_t));
+    }
+    psram_stats.frames++;
+    psram_stats.last_read_bytes = psram_frame_read;
+    psram_stats.last_write_bytes = psram_frame_write;
+    psram_frame_read = 0;
+    psram_frame_write = 0;
+    if ((psram_trace != nullptr) && (psram_trace_num < psram_trace_max)) {
+        int64_t now_us = esp_timer_get_time();
+        lvgl_port_bandwidth_sim_frame_t *frame = &psram_trace[psram_trace_num++];
+        frame->render_us = ((time_ms > 0) ? time_ms : 1) * 1000;
+        if (tick_by_frame) {
+            // LVGL's tick stands still within a frame of the scheduler
+            frame->render_us = now_us - frame_start_us;
+        }
+        frame->period_us = (psram_trace_last_us != 0) ? (now_us - psram_trace_last_us) : frame->render_us;
+        frame->read_bytes = psram_stats.last_read_bytes;
+        frame->write_bytes = psram_stats.last_write_bytes;
+        psram_trace_last_us = now_us;
+    }
+    lvgl_port_benchmark_rendered++;
+}
+
+static void benchmark_switch(lv_disp_t *disp, const lvgl_port_strategy_t *strategy)
+{
+    // The areas LVGL would synchronize belong to the previous mode, the whole screen is rendered again anyway
+    display_sync_areas_clear(disp);
+    display_apply_strategy(disp->driver, strategy);
+    display_update_hooks(disp, strategy);
+    lv_obj_invalidate(lv_disp_get_scr_act(disp));
+}
+
+/**
+ * @brief Measure the time of `lv_timer_handler()` when it renders a frame, skipping the first frames of the mode
+ *
+ * @note  The lock is released while sleeping until the next timer, like `lvgl_port_task()` does.
+ */
+static void benchmark_measure(uint32_t frames, lvgl_port_benchmark_result_t *result)
+{
+    uint64_t total_us = 0;
+    uint64_t psram_read = 0;
+    uint64_t psram_write = 0;
+    uint32_t warmup = 0;
+    int64_t deadline_us = esp_timer_get_time() + LVGL_PORT_BENCHMARK_TIMEOUT_MS * 1000LL;
+
+    while ((result->frames < frames) && (esp_timer_get_time() < deadline_us)) {
+        uint32_t rendered = lvgl_port_benchmark_rendered;
+        uint64_t read_bytes = psram_stats.read_bytes;
+        uint64_t write_bytes = psram_stats.write_bytes;
+        lvgl_port_ui_queue_drain(ui_queue_apply, nullptr);
+        int64_t start_us = esp_timer_get_time();
+        if (tick_by_frame) {
+            // The benchmark runs as fast as it can, LVGL's tick follows the time even with the frame scheduler
+            tick_advance_to(start_us);
+        }
+        uint32_t task_delay_ms = lv_timer_handler();
+        uint32_t frame_us = esp_timer_get_time() - start_us;
+
+        if (rendered != lvgl_port_benchmark_rendered) {
+            if (warmup < LVGL_PORT_BENCHMARK_WARMUP_FRAMES) {
+                warmup++;
+                continue;
+            }
+            total_us += frame_us;
+            psram_read += psram_stats.read_bytes - read_bytes;
+            psram_write += psram_stats.write_bytes - write_bytes;
+            result->frames++;
+            if (frame_us > result->frame_us_max) {
+                result->frame_us_max = frame_us;
+            }
+            continue;
+        }
+
+        if (task_delay_ms > LVGL_PORT_TASK_MAX_DELAY_MS) {
+            task_delay_ms = LVGL_PORT_TASK_MAX_DELAY_MS;
+        } else if (task_delay_ms < LVGL_PORT_TASK_MIN_DELAY_MS) {
+            task_delay_ms = LVGL_PORT_TASK_MIN_DELAY_MS;
+        }
+        lvgl_port_unlock();
+        vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
+        lvgl_port_lock(-1);
+    }
+    if (result->frames > 0) {
+        result->frame_us_avg = total_us / result->frames;
+        result->psram_read_avg = psram_read / result->frames;
+        result->psram_write_avg = psram_write / result->frames;
+    }
+}
+
+/**
+ * @brief Run the benchmark requested by `lvgl_port_run_benchmark()`, in the LVGL task with the lock held
+ */
+static void benchmark_run(lvgl_port_benchmark_t *bench)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+    LCD *lcd = (LCD *)disp->driver->user_data;
+    const lvgl_port_strategy_t *initial = lvgl_port_strategy;
+    int fb_num = 0;
+
+    while ((fb_num < LVGL_PORT_FRAME_BUFFER_NUM_MAX) && (lcd->getFrameBufferByIndex(fb_num) != nullptr)) {
+        lvgl_port_fbs[fb_num] = lcd->getFrameBufferByIndex(fb_num);
+        fb_num++;
+    }
+
+    // The modes are compared at the fastest clock, whatever the governor would choose for each
+    lvgl_port_governor_pin(true);
+    for (int mode = LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_FULL;
+            (mode < LVGL_PORT_AVOID_TEARING_MODE_MAX) && (bench->result_num < bench->result_max); mode++) {
+        const lvgl_port_strategy_t *strategy = strategy_find(
+                (lvgl_port_avoid_tearing_mode_t)mode, config_render_rotation(&lvgl_port_config, mode),
+                lvgl_port_config.async_copy, lvgl_port_config.pipeline
+            );
+        if ((strategy == nullptr) || (strategy->frame_buffer_num > fb_num)) {
+            ESP_UTILS_LOGW("Benchmark: skip %s, not supported with %d frame buffers and rotation %d",
+                           mode_names[mode], fb_num, lvgl_port_config.rotation);
+            continue;
+        }
+        if (mode_scale(mode) != lvgl_port_scale) {
+            ESP_UTILS_LOGW("Benchmark: skip %s, the screen is laid out for another resolution", mode_names[mode]);
+            continue;
+        }
+
+        lvgl_port_benchmark_result_t *result = &bench->results[bench->result_num++];
+        *result = {};
+        result->mode = strategy->mode;
+        benchmark_switch(disp, strategy);
+        benchmark_measure(bench->frames, result);
+        ESP_UTILS_LOGI("Benchmark: %s, %d frames, avg %d us, max %d us, PSRAM %d KB read / %d KB written per frame",
+                       mode_names[mode], (int)result->frames, (int)result->frame_us_avg, (int)result->frame_us_max,
+                       (int)(result->psram_read_avg / 1024), (int)(result->psram_write_avg / 1024));
+    }
+    benchmark_switch(disp, initial);
+    lvgl_port_governor_pin(false);
+}
+
+int lvgl_port_run_benchmark(uint32_t frames, lvgl_port_benchmark_result_t *results, int result_max)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN((results != nullptr) && (result_max > 0) && (frames > 0), -1, "Invalid arguments");
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_task_handle, -1, "LVGL task is not running");
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_port_strategy, -1, "Benchmark is only valid with anti-tearing");
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        xTaskGetCurrentTaskHandle() != lvgl_task_handle, -1, "Benchmark can't be run from the LVGL task"
+    );
+
+    lvgl_port_benchmark_t bench = {};
+    bench.frames = frames;
+    bench.results = results;
+    bench.result_max = result_max;
+    bench.done = xSemaphoreCreateBinary();
+    ESP_UTILS_CHECK_NULL_RETURN(bench.done, -1, "Create benchmark semaphore failed");
+
+    lvgl_port_benchmark_request = &bench;
+    task_wake();
+    xSemaphoreTake(bench.done, portMAX_DELAY);
+    vSemaphoreDelete(bench.done);
+
+    return bench.result_num;
+}
+
+/**
+ * @brief Time one copy of `rect` on one core or split over both, repeated so that each measurement copies about a
+ *        full screen
+ */
+template <class Rotation>
+static uint32_t copy_benchmark_time(
+    const void *src, void *dst, const lvgl_port_copy_rect_t &rect, int w, int h, bool parallel
+)
+{
+    int pixels = (rect.x2 - rect.x1 + 1) * (rect.y2 - rect.y1 + 1);
+    int repeat = (w * h) / pixels;
+    repeat = (repeat > LVGL_PORT_COPY_BENCHMARK_REPEAT_MAX) ? LVGL_PORT_COPY_BENCHMARK_REPEAT_MAX : repeat;
+
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < repeat; i++) {
+        if (parallel) {
+            lvgl_port::rotate_copy_parallel<Rotation, lvgl_port_pixel_t>(src, dst, rect, w, h);
+        } else {
+            lvgl_port::rotate_copy<Rotation, lvgl_port_pixel_t>(src, dst, rect, w, h);
+        }
+    }
 
-    ESP_UTILS_LOGD("Update display rotation to %d", drv->rotated);
+    return (esp_timer_get_time() - start_us) / repeat;
+}
 
-#if ESP_UTILS_CONF_LOG_LEVEL == ESP_UTILS_LOG_LEVEL_DEBUG
-    transformation = lcd->getTransformation();
-    disp_init_mirror_x = transformation.mirror_x;
-    disp_init_mirror_y = transformation.mirror_y;
-    disp_init_swap_xy = transformation.swap_xy;
-    ESP_UTILS_LOGD("Current mirror x: %d, mirror y: %d, swap xy: %d", disp_init_mirror_x, disp_init_mirror_y, disp_init_swap_xy);
-#endif
+/**
+ * @brief Measure a rotation from full-screen down, halving the width and the height in turn, until a copy is no longer
+ *        faster on both cores
+ */
+template <class Rotation>
+static void copy_benchmark_run(const void *src, void *dst, int w, int h, lvgl_port_copy_benchmark_result_t *result)
+{
+    int rect_w = w;
+    int rect_h = h;
+
+    result->rotation = Rotation::degree;
+    for (int step = 0; rect_w * rect_h >= LVGL_PORT_COPY_BENCHMARK_MIN_PIXELS; step++) {
+        lvgl_port_copy_rect_t rect = { 0, 0, (int16_t)(rect_w - 1), (int16_t)(rect_h - 1) };
+        uint32_t single_us = copy_benchmark_time<Rotation>(src, dst, rect, w, h, false);
+        uint32_t dual_us = copy_benchmark_time<Rotation>(src, dst, rect, w, h, true);
+        if (step == 0) {
+            result->single_us = single_us;
+            result->dual_us = dual_us;
+            result->speedup_percent = (dual_us > 0) ? (single_us * 100 / dual_us) : 0;
+        }
+        if (dual_us >= single_us) {
+            break;
+        }
+        result->crossover_px = rect_w * rect_h;
+        if (step & 1) {
+            rect_h /= 2;
+        } else {
+            rect_w /= 2;
+        }
+    }
 }
 
-#endif /* LVGL_PORT_AVOID_TEAR */
+int lvgl_port_run_copy_benchmark(lvgl_port_copy_benchmark_result_t *results, int result_max)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN((results != nullptr) && (result_max > 0), -1, "Invalid arguments");
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_disp_drv, -1, "LVGL is not initialized");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_config.parallel_copy, -1, "Parallel copy is not enabled");
+
+    int w = lvgl_disp_drv->hor_res;
+    int h = lvgl_disp_drv->ver_res;
+    size_t size = (size_t)w * h * sizeof(lv_color_t);
+    void *src = heap_caps_aligned_alloc(LVGL_PORT_ASYNC_COPY_ALIGN, size, MALLOC_CAP_SPIRAM);
+    void *dst = heap_caps_aligned_alloc(LVGL_PORT_ASYNC_COPY_ALIGN, size, MALLOC_CAP_SPIRAM);
+    if ((src == nullptr) || (dst == nullptr)) {
+        ESP_UTILS_LOGE("Allocate copy benchmark buffers failed");
+        heap_caps_free(src);
+        heap_caps_free(dst);
+        return -1;
+    }
+    memset(src, 0x5a, size);
 
-void rounder_callback(lv_disp_drv_t *drv, lv_area_t *area)
+    void (*runs[])(const void *, void *, int, int, lvgl_port_copy_benchmark_result_t *) = {
+        copy_benchmark_run<Rotate<0>>, copy_benchmark_run<Rotate<90>>, copy_benchmark_run<Rotate<180>>,
+        copy_benchmark_run<Rotate<270>>
+    };
+    int result_num = 0;
+
+    // The LVGL task doesn't copy while the lock is held, so the workers and PSRAM are the benchmark's
+    if (!lvgl_port_lock(-1)) {
+        ESP_UTILS_LOGE("Lock LVGL failed");
+        heap_caps_free(src);
+        heap_caps_free(dst);
+        return -1;
+    }
+    lvgl_port_governor_pin(true);
+    for (int i = 0; (i < 4) && (result_num < result_max); i++) {
+        lvgl_port_copy_benchmark_result_t *result = &results[result_num++];
+        *result = {};
+        runs[i](src, dst, w, h, result);
+        parallel_copy_min_pixels[i] = (result->crossover_px > 0) ? result->crossover_px : UINT32_MAX;
+        ESP_UTILS_LOGI("Copy benchmark: rotation %d, full-screen %d us on one core, %d us on both (%d%%), "
+                       "crossover %d pixels", result->rotation, (int)result->single_us, (int)result->dual_us,
+                       (int)result->speedup_percent, (int)result->crossover_px);
+    }
+    lvgl_port_governor_pin(false);
+    lvgl_port_unlock();
+    heap_caps_free(src);
+    heap_caps_free(dst);
+
+    return result_num;
+}
+
+/**
+ * @brief Start or stop the frame scheduler, in the LVGL task or with the lock held
+ */
+static void frame_sched_set_divisor(int divisor)
 {
-    LCD *lcd = (LCD *)drv->user_data;
-    uint8_t x_align = lcd->getBasicAttributes().basic_bus_spec.x_coord_align;
-    uint8_t y_align = lcd->getBasicAttributes().basic_bus_spec.y_coord_align;
+    lvgl_port_frame_sched_init(divisor);
+    // From now on, LVGL's tick starts from the current time and only moves with the frames
+    tick_advance_to(esp_timer_get_time());
+    tick_by_frame = (divisor > 0);
+}
 
-    if (x_align > 1) {
-        // round the start of coordinate down to the nearest aligned value
-        area->x1 &= ~(x_align - 1);
-        // round the end of coordinate up to the nearest aligned value
-        area->x2 = (area->x2 & ~(x_align - 1)) + x_align - 1;
+/**
+ * @brief Start a frame of the scheduler: LVGL's tick jumps to the predicted presentation, so the animations are
+ *        computed for the moment they are seen, and the refresh is due whatever `LV_DISP_DEF_REFR_PERIOD` says
+ *
+ * @return true if the frame started, false if the task wasn't woken up by a vsync nor by the timeout
+ */
+static bool frame_sched_begin(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    int64_t present_us = 0;
+    if (!lvgl_port_frame_sched_begin(now_us, LVGL_PORT_TASK_MAX_DELAY_MS * 1000, &present_us)) {
+        return false;
+    }
+    frame_start_us = now_us;
+    frame_present_us = present_us;
+    tick_advance_to(present_us);
+    lv_disp_t *disp = lv_disp_get_default();
+    if ((disp != nullptr) && (disp->refr_timer != nullptr)) {
+        lv_timer_resume(disp->refr_timer);
+        lv_timer_ready(disp->refr_timer);
     }
 
-    if (y_align > 1) {
-        // round the start of coordinate down to the nearest aligned value
-        area->y1 &= ~(y_align - 1);
-        // round the end of coordinate up to the nearest aligned value
-        area->y2 = (area->y2 & ~(y_align - 1)) + y_align - 1;
+    return true;
+}
+
+/**
+ * @brief Pause LVGL's refresh timer while nothing is invalid, so a static screen has no timer to wake up for, and
+ *        resume it as soon as something is
+ *
+ * @return true if it was resumed
+ */
+static bool task_refresh_when_invalid(void)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+
+    if ((disp == nullptr) || (disp->refr_timer == nullptr)) {
+        return false;
+    }
+    if (disp->inv_p > 0) {
+        if (disp->refr_timer->paused) {
+            lv_timer_resume(disp->refr_timer);
+            return true;
+        }
+    } else if (!disp->refr_timer->paused) {
+        lv_timer_pause(disp->refr_timer);
     }
+
+    return false;
 }
 
-static lv_disp_t *display_init(LCD *lcd)
+/**
+ * @brief Poll the touch panel at once after its interrupt, until it is released
+ */
+static void task_handle_touch(void)
 {
-    ESP_UTILS_CHECK_FALSE_RETURN(lcd != nullptr, nullptr, "Invalid LCD device");
-    ESP_UTILS_CHECK_FALSE_RETURN(lcd->getRefreshPanelHandle() != nullptr, nullptr, "LCD device is not initialized");
+    if (!touch_pending || (lvgl_touch_indev == nullptr)) {
+        return;
+    }
+    touch_pending = false;
+    lv_timer_resume(lvgl_touch_indev->driver->read_timer);
+    lv_timer_ready(lvgl_touch_indev->driver->read_timer);
+}
 
-    static lv_disp_draw_buf_t disp_buf;
-    static lv_disp_drv_t disp_drv;
+/**
+ * @brief Give the load of the frame to the CPU frequency governor, against the period of the frame scheduler if it
+ *        runs and `LV_DISP_DEF_REFR_PERIOD` otherwise
+ *
+ * @return Milliseconds until the governor drops to its lowest clock, if no frame is rendered meanwhile
+ */
+static uint32_t task_governor_update(bool scheduled, bool rendered, int64_t start_us, int64_t end_us)
+{
+    if (rendered) {
+        uint32_t period_us = LV_DISP_DEF_REFR_PERIOD * 1000;
+        if (scheduled) {
+            lvgl_port_frame_sched_stats_t stats;
+            lvgl_port_frame_sched_get_stats(&stats);
+            period_us = (stats.period_us > 0) ? (stats.period_us * stats.divisor) : period_us;
+        }
+        lvgl_port_governor_frame(end_us, (uint32_t)(end_us - start_us), period_us);
+    }
 
-    // Alloc draw buffers used by LVGL
-    auto lcd_width = lcd->getFrameWidth();
-    auto lcd_height = lcd->getFrameHeight();
-    int buffer_size = 0;
+    return lvgl_port_governor_idle(end_us);
+}
 
-    ESP_UTILS_LOGD("Malloc memory for LVGL buffer");
-#if !LVGL_PORT_AVOID_TEAR
-    // Avoid tearing function is disabled
-    buffer_size = lcd_width * LVGL_PORT_BUFFER_SIZE_HEIGHT;
-    for (int i = 0; (i < LVGL_PORT_BUFFER_NUM) && (i < LVGL_PORT_BUFFER_NUM_MAX); i++) {
-        lvgl_buf[i] = heap_caps_malloc(buffer_size * sizeof(lv_color_t), LVGL_PORT_BUFFER_MALLOC_CAPS);
-        assert(lvgl_buf[i]);
-        ESP_UTILS_LOGD("Buffer[%d] address: %p, size: %d", i, lvgl_buf[i], buffer_size * sizeof(lv_color_t));
+/**
+ * @brief Sleep until the next timer of LVGL, or until an event wakes the task up earlier
+ */
+static void task_sleep(uint32_t task_delay_ms)
+{
+    TickType_t timeout = portMAX_DELAY;
+
+    if (lvgl_port_frame_sched_get_divisor() > 0) {
+        // Until the vsync of the next frame, the timers only run along with the frames
+        timeout = pdMS_TO_TICKS(LVGL_PORT_TASK_MAX_DELAY_MS);
+    } else if (task_delay_ms != LV_NO_TIMER_READY) {
+        timeout = pdMS_TO_TICKS(
+                      (task_delay_ms > LVGL_PORT_TASK_MIN_DELAY_MS) ? task_delay_ms : LVGL_PORT_TASK_MIN_DELAY_MS
+                  );
     }
-#else
-    // To avoid the tearing effect, we should use at least two frame buffers: one for LVGL rendering and another for LCD refresh
-    buffer_size = lcd_width * lcd_height;
-#if (LVGL_PORT_DISP_BUFFER_NUM >= 3) && (LVGL_PORT_ROTATION_DEGREE == 0) && LVGL_PORT_FULL_REFRESH
 
-    // With the usage of three buffers and full-refresh, we always have one buffer available for rendering,
-    // eliminating the need to wait for the LCD's sync signal
-    lvgl_port_lcd_last_buf = lcd->getFrameBufferByIndex(0);
-    lvgl_buf[0] = lcd->getFrameBufferByIndex(1);
-    lvgl_buf[1] = lcd->getFrameBufferByIndex(2);
-    lvgl_port_lcd_next_buf = lvgl_port_lcd_last_buf;
-    lvgl_port_flush_next_buf = lvgl_buf[1];
+    int64_t start_us = esp_timer_get_time();
+    bool woken = (xSemaphoreTake(lvgl_task_wake, timeout) == pdTRUE);
+    lvgl_task_stats.sleep_us += esp_timer_get_time() - start_us;
+    lvgl_task_stats.wakes++;
+    lvgl_task_stats.wakes_by_event += woken;
+}
+
+bool lvgl_port_set_frame_divisor(int divisor)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_port_strategy, false, "Avoid tearing is not enabled");
+    ESP_UTILS_CHECK_FALSE_RETURN(divisor >= 0, false, "Invalid frame divisor(%d)", divisor);
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_lock(-1), false, "Lock LVGL failed");
+
+    frame_sched_set_divisor(divisor);
+    lvgl_port_config.frame_divisor = divisor;
+    lvgl_port_unlock();
+    // The LVGL task may sleep without a timeout for its next timer, or on the vsync of the previous divisor
+    task_wake();
+
+    return true;
+}
+
+bool lvgl_port_get_frame_sched_stats(lvgl_port_frame_sched_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_frame_sched_get_divisor() > 0, false, "Frame scheduler is not running");
+
+    lvgl_port_frame_sched_get_stats(stats);
 
-#elif (LVGL_PORT_DISP_BUFFER_NUM >= 3) && (LVGL_PORT_ROTATION_DEGREE != 0)
+    return true;
+}
+
+bool lvgl_port_get_task_stats(lvgl_port_task_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_task_handle, false, "LVGL task is not running");
 
-    lvgl_buf[0] = lcd->getFrameBufferByIndex(2);
+    *stats = lvgl_task_stats;
 
-#elif LVGL_PORT_DISP_BUFFER_NUM >= 2
+    return true;
+}
 
-    for (int i = 0; (i < LVGL_PORT_DISP_BUFFER_NUM) && (i < LVGL_PORT_BUFFER_NUM_MAX); i++) {
-        lvgl_buf[i] = lcd->getFrameBufferByIndex(i);
+static int timer_find(const lv_timer_t *timer)
+{
+    for (int i = 0; i < LVGL_PORT_TIMER_SCHED_MAX; i++) {
+        if ((timer_handles[i] != nullptr) && (timer_handles[i] == timer)) {
+            return i;
+        }
     }
 
-#endif
-#endif /* LVGL_PORT_AVOID_TEAR */
+    return -1;
+}
 
-    // initialize LVGL draw buffers
-    lv_disp_draw_buf_init(&disp_buf, lvgl_buf[0], lvgl_buf[1], buffer_size);
+static void timer_forget(int index)
+{
+    lvgl_port_timer_sched_unregister(timer_handles[index]);
+    timer_handles[index] = nullptr;
+    timer_cbs[index] = nullptr;
+}
 
-    ESP_UTILS_LOGD("Register display driver to LVGL");
-    lv_disp_drv_init(&disp_drv);
-    disp_drv.flush_cb = flush_callback;
-#if (LVGL_PORT_ROTATION_DEGREE == 90) || (LVGL_PORT_ROTATION_DEGREE == 270)
-    disp_drv.hor_res = lcd_height;
-    disp_drv.ver_res = lcd_width;
-#else
-    disp_drv.hor_res = lcd_width;
-    disp_drv.ver_res = lcd_height;
-#endif
-#if LVGL_PORT_AVOID_TEAR    // Only available when the tearing effect is enabled
-#if LVGL_PORT_FULL_REFRESH
-    disp_drv.full_refresh = 1;
-#elif LVGL_PORT_DIRECT_MODE
-    disp_drv.direct_mode = 1;
-#endif
-#else                       // Only available when the tearing effect is disabled
-    if (lcd->getBasicAttributes().basic_bus_spec.isFunctionValid(LCD::BasicBusSpecification::FUNC_SWAP_XY) &&
-            lcd->getBasicAttributes().basic_bus_spec.isFunctionValid(LCD::BasicBusSpecification::FUNC_MIRROR_X) &&
-            lcd->getBasicAttributes().basic_bus_spec.isFunctionValid(LCD::BasicBusSpecification::FUNC_MIRROR_Y)) {
-        disp_drv.drv_update_cb = update_callback;
-    } else {
-        disp_drv.sw_rotate = 1;
+/**
+ * @brief Callback of the timers of the port: run the callback of the application now and time it, or postpone it to
+ *        the next frame
+ */
+static void timer_callback(lv_timer_t *timer)
+{
+    int index = timer_find(timer);
+    if (index < 0) {
+        return;
     }
-#endif /* LVGL_PORT_AVOID_TEAR */
-    disp_drv.draw_buf = &disp_buf;
-    disp_drv.user_data = (void *)lcd;
-    // Only available when the coordinate alignment is enabled
-    if ((lcd->getBasicAttributes().basic_bus_spec.x_coord_align > 1) ||
-            (lcd->getBasicAttributes().basic_bus_spec.y_coord_align > 1)) {
-        disp_drv.rounder_cb = rounder_callback;
+
+    if (!lvgl_port_timer_sched_should_run(timer, esp_timer_get_time())) {
+        // Due again at the next frame, and the postponed run doesn't use up a repeat
+        if (timer->repeat_count >= 0) {
+            timer->repeat_count++;
+        }
+        lv_timer_ready(timer);
+        return;
     }
 
-    return lv_disp_drv_register(&disp_drv);
+    int64_t start_us = esp_timer_get_time();
+    timer_cbs[index](timer);
+    // The callback may have deleted its timer with `lvgl_port_timer_del()`
+    if (timer_handles[index] != timer) {
+        return;
+    }
+    lvgl_port_timer_sched_ran(timer, (uint32_t)(esp_timer_get_time() - start_us));
+    if (timer->repeat_count == 0) {
+        // LVGL deletes the timer after its last repeat
+        timer_forget(index);
+    }
 }
 
-static void touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data)
+lv_timer_t *lvgl_port_timer_create(
+    lv_timer_cb_t cb, uint32_t period_ms, void *user_data, lvgl_port_timer_class_t timer_class
+)
 {
-    Touch *tp = (Touch *)indev_drv->user_data;
-    TouchPoint point;
+    ESP_UTILS_CHECK_NULL_RETURN(cb, nullptr, "Invalid callback");
 
-    /* Read data from touch controller */
-    int read_touch_result = tp->readPoints(&point, 1, 0);
-    if (read_touch_result > 0) {
-        data->point.x = point.x;
-        data->point.y = point.y;
-        data->state = LV_INDEV_STATE_PRESSED;
-    } else {
-        data->state = LV_INDEV_STATE_RELEASED;
+    int index = -1;
+    for (int i = 0; (index < 0) && (i < LVGL_PORT_TIMER_SCHED_MAX); i++) {
+        if (timer_handles[i] == nullptr) {
+            index = i;
+        }
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(index >= 0, nullptr, "Too many timers, at most %d", LVGL_PORT_TIMER_SCHED_MAX);
+
+    lv_timer_t *timer = lv_timer_create(timer_callback, period_ms, user_data);
+    ESP_UTILS_CHECK_NULL_RETURN(timer, nullptr, "Create LVGL timer failed");
+    if (!lvgl_port_timer_sched_register(timer, timer_class)) {
+        lv_timer_del(timer);
+        ESP_UTILS_CHECK_FALSE_RETURN(false, nullptr, "Register timer failed");
     }
+    timer_handles[index] = timer;
+    timer_cbs[index] = cb;
+
+    return timer;
 }
 
-static lv_indev_t *indev_init(Touch *tp)
+bool lvgl_port_timer_del(lv_timer_t *timer)
 {
-    ESP_UTILS_CHECK_FALSE_RETURN(tp != nullptr, nullptr, "Invalid touch device");
-    ESP_UTILS_CHECK_FALSE_RETURN(tp->getPanelHandle() != nullptr, nullptr, "Touch device is not initialized");
+    int index = timer_find(timer);
+    ESP_UTILS_CHECK_FALSE_RETURN(index >= 0, false, "Timer is not created by the port");
 
-    static lv_indev_drv_t indev_drv_tp;
+    timer_forget(index);
+    lv_timer_del(timer);
 
-    ESP_UTILS_LOGD("Register input driver to LVGL");
-    lv_indev_drv_init(&indev_drv_tp);
-    indev_drv_tp.type = LV_INDEV_TYPE_POINTER;
-    indev_drv_tp.read_cb = touchpad_read;
-    indev_drv_tp.user_data = (void *)tp;
+    return true;
+}
+
+bool lvgl_port_get_timer_stats(lv_timer_t *timer, lvgl_port_timer_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
 
-    return lv_indev_drv_register(&indev_drv_tp);
+    return lvgl_port_timer_sched_get_timer_stats(timer, stats);
 }
 
-#if !LV_TICK_CUSTOM
-static void tick_increment(void *arg)
+bool lvgl_port_get_timer_sched_stats(lvgl_port_timer_sched_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_frame_sched_get_divisor() > 0, false, "Frame scheduler is not running");
+
+    lvgl_port_timer_sched_get_stats(stats);
+
+    return true;
+}
+
+/**
+ * @brief Wake the LVGL task up for the build steps, once the worker is over with `prepare_cb`
+ */
+static void screen_prep_wake(void)
 {
-    /* Tell LVGL how many milliseconds have elapsed */
-    lv_tick_inc(LVGL_PORT_TICK_PERIOD_MS);
+    if (lvgl_task_wake != nullptr) {
+        xSemaphoreGive(lvgl_task_wake);
+    }
 }
 
-static bool tick_init(void)
+bool lvgl_port_prepare_screen(const lvgl_port_screen_prep_t *prep)
 {
-    // Tick interface for LVGL (using esp_timer to generate 2ms periodic event)
-    const esp_timer_create_args_t lvgl_tick_timer_args = {
-        .callback = &tick_increment,
-        .name = "LVGL tick"
-    };
-    ESP_UTILS_CHECK_ERROR_RETURN(
-        esp_timer_create(&lvgl_tick_timer_args, &lvgl_tick_timer), false, "Create LVGL tick timer failed"
-    );
-    ESP_UTILS_CHECK_ERROR_RETURN(
-        esp_timer_start_periodic(lvgl_tick_timer, LVGL_PORT_TICK_PERIOD_MS * 1000), false,
-        "Start LVGL tick timer failed"
-    );
+    ESP_UTILS_CHECK_NULL_RETURN(prep, false, "Invalid preparation");
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_task_handle, false, "LVGL task is not running");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_lock(-1), false, "Lock LVGL failed");
+
+    // The worker is only started by the first preparation
+    if (!screen_prep_running) {
+        screen_prep_running = lvgl_port_screen_prep_init(LVGL_PORT_PIPELINE_CORE, screen_prep_wake);
+    }
+    bool started = screen_prep_running && lvgl_port_screen_prep_start(prep);
+    lvgl_port_unlock();
+    ESP_UTILS_CHECK_FALSE_RETURN(started, false, "Start screen preparation failed, another one is in progress");
 
     return true;
 }
 
-static bool tick_deinit(void)
+bool lvgl_port_get_screen_prep_stats(lvgl_port_screen_prep_stats_t *stats)
 {
-    ESP_UTILS_CHECK_ERROR_RETURN(
-        esp_timer_stop(lvgl_tick_timer), false, "Stop LVGL tick timer failed"
-    );
-    ESP_UTILS_CHECK_ERROR_RETURN(
-        esp_timer_delete(lvgl_tick_timer), false, "Delete LVGL tick timer failed"
-    );
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_FALSE_RETURN(screen_prep_running, false, "No screen was prepared");
+
+    lvgl_port_screen_prep_get_stats(stats);
+
+    return true;
+}
+
+bool lvgl_port_set_governor_config(const lvgl_port_governor_config_t *config)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(config, false, "Invalid config");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_config.governor, false, "Governor is not enabled");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_lock(-1), false, "Lock LVGL failed");
+
+    bool set = lvgl_port_governor_set_config(config);
+    lvgl_port_unlock();
+    ESP_UTILS_CHECK_FALSE_RETURN(set, false, "Invalid governor config");
+
+    return true;
+}
+
+bool lvgl_port_get_governor_stats(lvgl_port_governor_stats_t *stats)
+{
+    ESP_UTILS_CHECK_NULL_RETURN(stats, false, "Invalid stats");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_config.governor, false, "Governor is not enabled");
+    ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_lock(-1), false, "Lock LVGL failed");
+
+    lvgl_port_governor_get_stats(stats);
+    lvgl_port_unlock();
+
     return true;
 }
-#endif
 
 static void lvgl_port_task(void *arg)
 {
@@ -714,15 +3018,60 @@ static void lvgl_port_task(void *arg)
     uint32_t task_delay_ms = LVGL_PORT_TASK_MAX_DELAY_MS;
     while (1) {
         if (lvgl_port_lock(-1)) {
+            lvgl_port_benchmark_t *bench = lvgl_port_benchmark_request;
+            if (bench != nullptr) {
+                benchmark_run(bench);
+                lvgl_port_benchmark_request = nullptr;
+                xSemaphoreGive(bench->done);
+            }
+            bool scheduled = (lvgl_port_frame_sched_get_divisor() > 0);
+            uint32_t rendered = lvgl_port_benchmark_rendered;
+            bool frame = !scheduled || frame_sched_begin();
+            // The commands land in the frame about to be rendered
+            lvgl_port_ui_queue_drain(ui_queue_apply, nullptr);
+            task_handle_touch();
+            if (!frame) {
+                // With the scheduler, only a vsync starts a frame, the commands and the touch of the other wakes are
+                // rendered by the next one
+                lvgl_port_unlock();
+                task_sleep(task_delay_ms);
+                continue;
+            }
+            if (!scheduled) {
+                // Other tasks may have invalidated areas with the lock held
+                task_refresh_when_invalid();
+            }
+            if (scheduled) {
+                // The deferrable timers only run if they fit before the predicted presentation
+                lvgl_port_timer_sched_frame_begin(esp_timer_get_time(), frame_present_us);
+            }
+            int64_t handler_start_us = esp_timer_get_time();
             task_delay_ms = lv_timer_handler();
+            int64_t end_us = esp_timer_get_time();
+            if (rendered != lvgl_port_benchmark_rendered) {
+                lvgl_port_screen_prep_frame_rendered(end_us);
+            }
+            // Between two frames, a slice of the build steps of a screen being prepared
+            bool building = lvgl_port_screen_prep_run(
+                                scheduled ? frame_present_us : (end_us + LVGL_PORT_SCREEN_PREP_SLICE_US)
+                            );
+            if (scheduled) {
+                lvgl_port_timer_sched_frame_end(end_us, rendered != lvgl_port_benchmark_rendered);
+                lvgl_port_frame_sched_end(end_us, rendered != lvgl_port_benchmark_rendered);
+            } else if (task_refresh_when_invalid() || building) {
+                // The timers or the build steps invalidated areas after the refresh was paused, render them now
+                task_delay_ms = 0;
+            }
+            if (lvgl_port_config.governor) {
+                // A static screen may sleep past the drop of the clock, wake up for it
+                uint32_t idle_ms = task_governor_update(
+                                       scheduled, rendered != lvgl_port_benchmark_rendered, handler_start_us, end_us
+                                   );
+                task_delay_ms = (idle_ms < task_delay_ms) ? idle_ms : task_delay_ms;
+            }
             lvgl_port_unlock();
         }
-        if (task_delay_ms > LVGL_PORT_TASK_MAX_DELAY_MS) {
-            task_delay_ms = LVGL_PORT_TASK_MAX_DELAY_MS;
-        } else if (task_delay_ms < LVGL_PORT_TASK_MIN_DELAY_MS) {
-            task_delay_ms = LVGL_PORT_TASK_MIN_DELAY_MS;
-        }
-        vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
+        task_sleep(task_delay_ms);
     }
 }
 
@@ -735,34 +3084,80 @@ IRAM_ATTR bool onDrawBitmapFinishCallback(void *user_data)
     return false;
 }
 
-bool lvgl_port_init(LCD *lcd, Touch *tp)
+bool lvgl_port_init_with_config(LCD *lcd, Touch *tp, const lvgl_port_config_t *config)
 {
     ESP_UTILS_CHECK_FALSE_RETURN(lcd != nullptr, false, "Invalid LCD device");
+    if (config != nullptr) {
+        ESP_UTILS_CHECK_FALSE_RETURN(config_check(config), false, "Invalid config");
+        lvgl_port_config = *config;
+    }
 
     auto bus_type = lcd->getBus()->getBasicAttributes().type;
-#if LVGL_PORT_AVOID_TEAR
-    ESP_UTILS_CHECK_FALSE_RETURN(
-        (bus_type == ESP_PANEL_BUS_TYPE_RGB) || (bus_type == ESP_PANEL_BUS_TYPE_MIPI_DSI), false,
-        "Avoid tearing function only works with RGB/MIPI-DSI LCD now"
-    );
-    ESP_UTILS_LOGI(
-        "Avoid tearing is enabled, mode: %d, rotation: %d", LVGL_PORT_AVOID_TEARING_MODE, LVGL_PORT_ROTATION_DEGREE
-    );
-#endif
+    bool avoid_tear = (lvgl_port_config.avoid_tearing_mode != LVGL_PORT_AVOID_TEARING_MODE_NONE);
+    if (avoid_tear) {
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            (bus_type == ESP_PANEL_BUS_TYPE_RGB) || (bus_type == ESP_PANEL_BUS_TYPE_MIPI_DSI), false,
+            "Avoid tearing function only works with RGB/MIPI-DSI LCD now"
+        );
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            !lvgl_port_config.scanout_rotation || (lvgl_port_config.rotation == 0) ||
+            (bus_type == ESP_PANEL_BUS_TYPE_RGB), false, "Rotation at scanout only works with RGB LCD"
+        );
+        ESP_UTILS_LOGI(
+            "Avoid tearing is enabled, mode: %d (%s), rotation: %d", lvgl_port_config.avoid_tearing_mode,
+            mode_names[lvgl_port_config.avoid_tearing_mode], lvgl_port_config.rotation
+        );
+    }
 
     lv_disp_t *disp = nullptr;
     lv_indev_t *indev = nullptr;
 
     lv_init();
-#if !LV_TICK_CUSTOM
-    ESP_UTILS_CHECK_FALSE_RETURN(tick_init(), false, "Initialize LVGL tick failed");
-#endif
+    if (avoid_tear && lvgl_port_config.async_copy) {
+        ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_async_copy_init(), false, "Initialize async copy failed");
+    } else {
+        lvgl_port_config.async_copy = false;
+    }
+
+    if (avoid_tear && lvgl_port_config.pipeline) {
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            lvgl_port_flush_worker_init(LVGL_PORT_PIPELINE_CORE), false, "Initialize flush worker failed"
+        );
+    } else {
+        lvgl_port_config.pipeline = false;
+    }
+
+    // A single core has nothing to split with
+    if (avoid_tear && lvgl_port_config.parallel_copy && (portNUM_PROCESSORS == LVGL_PORT_JOBS_WORKER_NUM)) {
+        ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_jobs_init(), false, "Initialize job system failed");
+        for (int i = 0; i < 4; i++) {
+            parallel_copy_min_pixels[i] = LVGL_PORT_PARALLEL_COPY_MIN_PIXELS;
+        }
+    } else {
+        lvgl_port_config.parallel_copy = false;
+    }
 
     ESP_UTILS_LOGI("Initializing LVGL display driver");
     disp = display_init(lcd);
     ESP_UTILS_CHECK_NULL_RETURN(disp, false, "Initialize LVGL display driver failed");
+    if (avoid_tear && lvgl_port_config.tile_hash) {
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            lvgl_port_tile_hash_init(disp->driver->hor_res, disp->driver->ver_res, sizeof(lv_color_t)), false,
+            "Initialize tile hash failed"
+        );
+    } else {
+        lvgl_port_config.tile_hash = false;
+    }
+    if (lvgl_port_config.governor) {
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            lvgl_port_governor_init(nullptr), false, "Initialize CPU frequency governor failed"
+        );
+    }
     // Record the initial rotation of the display
     lv_disp_set_rotation(disp, LV_DISP_ROT_NONE);
+    if (!avoid_tear && (lvgl_port_config.rotation != 0)) {
+        lv_disp_set_rotation(disp, (lv_disp_rot_t)(lvgl_port_config.rotation / 90));
+    }
 
     // For non-RGB LCD, need to notify LVGL that the buffer is ready when the refresh is finished
     if (bus_type != ESP_PANEL_BUS_TYPE_RGB) {
@@ -775,61 +3170,86 @@ bool lvgl_port_init(LCD *lcd, Touch *tp)
         indev = indev_init(tp);
         ESP_UTILS_CHECK_NULL_RETURN(indev, false, "Initialize LVGL input driver failed");
 
-#if LVGL_PORT_ROTATION_DEGREE != 0
-        auto &transformation = tp->getTransformation();
-#if LVGL_PORT_ROTATION_DEGREE == 90
-        tp->swapXY(!transformation.swap_xy);
-        tp->mirrorY(!transformation.mirror_y);
-#elif LVGL_PORT_ROTATION_DEGREE == 180
-        tp->mirrorX(!transformation.mirror_x);
-        tp->mirrorY(!transformation.mirror_y);
-#elif LVGL_PORT_ROTATION_DEGREE == 270
-        tp->swapXY(!transformation.swap_xy);
-        tp->mirrorX(!transformation.mirror_x);
-#endif
-#endif
+        if (avoid_tear) {
+            auto &transformation = tp->getTransformation();
+            switch (lvgl_port_config.rotation) {
+            case 90:
+                tp->swapXY(!transformation.swap_xy);
+                tp->mirrorY(!transformation.mirror_y);
+                break;
+            case 180:
+                tp->mirrorX(!transformation.mirror_x);
+                tp->mirrorY(!transformation.mirror_y);
+                break;
+            case 270:
+                tp->swapXY(!transformation.swap_xy);
+                tp->mirrorX(!transformation.mirror_x);
+                break;
+            default:
+                break;
+            }
+        }
     }
 
     ESP_UTILS_LOGD("Create mutex for LVGL");
+    lvgl_lock_depth = 0;
     lvgl_mux = xSemaphoreCreateRecursiveMutex();
     ESP_UTILS_CHECK_NULL_RETURN(lvgl_mux, false, "Create LVGL mutex failed");
 
+    lvgl_task_wake = xSemaphoreCreateBinary();
+    ESP_UTILS_CHECK_NULL_RETURN(lvgl_task_wake, false, "Create LVGL task wake semaphore failed");
+    frame_sched_set_divisor(lvgl_port_config.frame_divisor);
+    lvgl_port_timer_sched_reset();
+
     ESP_UTILS_LOGD("Create LVGL task");
     BaseType_t core_id = (LVGL_PORT_TASK_CORE < 0) ? tskNO_AFFINITY : LVGL_PORT_TASK_CORE;
     BaseType_t ret = xTaskCreatePinnedToCore(lvgl_port_task, "lvgl", LVGL_PORT_TASK_STACK_SIZE, NULL,
                      LVGL_PORT_TASK_PRIORITY, &lvgl_task_handle, core_id);
     ESP_UTILS_CHECK_FALSE_RETURN(ret == pdPASS, false, "Create LVGL task failed");
 
-#if LVGL_PORT_AVOID_TEAR
-    lcd->attachRefreshFinishCallback(onLcdVsyncCallback, (void *)lvgl_task_handle);
-#endif
+    if (lvgl_port_strategy != nullptr) {
+        display_attach_vsync(lcd, lvgl_port_strategy);
+    }
 
     return true;
 }
 
+bool lvgl_port_init(LCD *lcd, Touch *tp)
+{
+    return lvgl_port_init_with_config(lcd, tp, nullptr);
+}
+
 bool lvgl_port_lock(int timeout_ms)
 {
     ESP_UTILS_CHECK_NULL_RETURN(lvgl_mux, false, "LVGL mutex is not initialized");
 
     const TickType_t timeout_ticks = (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-    return (xSemaphoreTakeRecursive(lvgl_mux, timeout_ticks) == pdTRUE);
+    if (xSemaphoreTakeRecursive(lvgl_mux, timeout_ticks) != pdTRUE) {
+        return false;
+    }
+    lvgl_lock_depth++;
+
+    return true;
 }
 
 bool lvgl_port_unlock(void)
 {
     ESP_UTILS_CHECK_NULL_RETURN(lvgl_mux, false, "LVGL mutex is not initialized");
 
+    // Whatever another task changed with the lock held (invalid areas, started animations, created, resumed or
+    // readied timers) may move the next timer of the LVGL task, which can sleep without a timeout: it is woken up
+    // once the lock is released, the nested unlocks wait for the outermost one
+    bool outermost = (--lvgl_lock_depth == 0);
     xSemaphoreGiveRecursive(lvgl_mux);
+    if (outermost && (xTaskGetCurrentTaskHandle() != lvgl_task_handle)) {
+        task_wake();
+    }
 
     return true;
 }
 
 bool lvgl_port_deinit(void)
 {
-#if !LV_TICK_CUSTOM
-    ESP_UTILS_CHECK_FALSE_RETURN(tick_deinit(), false, "Deinitialize LVGL tick failed");
-#endif
-
     ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_lock(-1), false, "Lock LVGL failed");
     if (lvgl_task_handle != nullptr) {
         vTaskDelete(lvgl_task_handle);
@@ -837,19 +3257,60 @@ bool lvgl_port_deinit(void)
     }
     ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_unlock(), false, "Unlock LVGL failed");
 
+    if ((lvgl_port_strategy != nullptr) && (lvgl_disp_drv != nullptr)) {
+        display_detach_vsync((LCD *)lvgl_disp_drv->user_data);
+        lvgl_port_scanout_set_fill(nullptr, nullptr);
+        lvgl_port_scanout_set_compose(nullptr, nullptr);
+        lvgl_port_mode_fill = false;
+        lvgl_port_user_fill = false;
+        lvgl_port_user_overlays = false;
+    }
+    if (lvgl_port_config.async_copy) {
+        ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_async_copy_deinit(), false, "Deinitialize async copy failed");
+    }
+    if (lvgl_port_config.pipeline) {
+        ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_flush_worker_deinit(), false, "Deinitialize flush worker failed");
+    }
+    if (lvgl_port_config.parallel_copy) {
+        ESP_UTILS_CHECK_FALSE_RETURN(lvgl_port_jobs_deinit(), false, "Deinitialize job system failed");
+    }
+    if (lvgl_port_config.tile_hash) {
+        lvgl_port_tile_hash_deinit();
+    }
+    if (lvgl_port_config.governor) {
+        lvgl_port_governor_deinit();
+    }
 #if LV_ENABLE_GC || !LV_MEM_CUSTOM
     lv_deinit();
 #else
     ESP_UTILS_LOGW("LVGL memory is custom, `lv_deinit()` will not work");
 #endif
-#if !LVGL_PORT_AVOID_TEAR
-    for (int i = 0; i < LVGL_PORT_BUFFER_NUM; i++) {
+    for (int i = 0; i < LVGL_PORT_BUFFER_NUM_MAX; i++) {
         if (lvgl_buf[i] != nullptr) {
-            free(lvgl_buf[i]);
+            heap_caps_free(lvgl_buf[i]);
             lvgl_buf[i] = nullptr;
         }
     }
-#endif
+    if (pipeline_buf_alloc != nullptr) {
+        heap_caps_free(pipeline_buf_alloc);
+        pipeline_buf_alloc = nullptr;
+    }
+    lvgl_port_strategy = nullptr;
+    lvgl_disp_drv = nullptr;
+    frame_sched_set_divisor(0);
+    if (screen_prep_running) {
+        lvgl_port_screen_prep_deinit();
+        screen_prep_running = false;
+    }
+    for (int i = 0; i < LVGL_PORT_TIMER_SCHED_MAX; i++) {
+        timer_forget(i);
+    }
+    lvgl_touch_indev = nullptr;
+    touch_by_interrupt = false;
+    if (lvgl_task_wake != nullptr) {
+        vSemaphoreDelete(lvgl_task_wake);
+        lvgl_task_wake = nullptr;
+    }
     if (lvgl_mux != nullptr) {
         vSemaphoreDelete(lvgl_mux);
         lvgl_mux = nullptr;
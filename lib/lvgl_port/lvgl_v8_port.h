@@ -11,19 +11,29 @@
 #endif
 #include "esp_display_panel.hpp"
 #include "lvgl.h"
+#include "lvgl_port_bandwidth_sim.h"
+#include "lvgl_port_flush_worker.h"
+#include "lvgl_port_frame_sched.h"
+#include "lvgl_port_governor.h"
+#include "lvgl_port_jobs.h"
+#include "lvgl_port_overlay.h"
+#include "lvgl_port_palette.h"
+#include "lvgl_port_present.h"
+#include "lvgl_port_scanout.h"
+#include "lvgl_port_screen_prep.h"
+#include "lvgl_port_tile_hash.h"
+#include "lvgl_port_timer_sched.h"
+#include "lvgl_port_ui_queue.h"
+#include "lvgl_port_upscale.h"
 
 // *INDENT-OFF*
 
-/**
- * LVGL related parameters, can be adjusted by users
- */
-#define LVGL_PORT_TICK_PERIOD_MS                (2) // The period of the LVGL tick task, in milliseconds
-
 /**
  *
  * LVGL buffer related parameters, can be adjusted by users:
  *
- *  (These parameters will be useless if the avoid tearing function is enabled)
+ *  (These parameters will be useless if the avoid tearing function is enabled, except for the modes 6 to 9 which
+ *   render into two tiles of `LVGL_PORT_BUFFER_SIZE_HEIGHT` lines, allocated with `LVGL_PORT_BUFFER_MALLOC_CAPS`)
  *
  *  - Memory type for buffer allocation:
  *      - MALLOC_CAP_SPIRAM: Allocate LVGL buffer in PSRAM
@@ -43,9 +53,13 @@
 
 /**
  * LVGL timer handle task related parameters, can be adjusted by users
+ *
+ * The task is tickless: LVGL reads its tick from `esp_timer` through `lvgl_port_tick.h`, and the task sleeps until its
+ * next timer is due or an event wakes it up (a touch interrupt, a UI command, an unlock from another task, a vsync of
+ * the frame scheduler). With nothing to do, such as a static screen without touch, it doesn't wake up at all.
  */
-#define LVGL_PORT_TASK_MAX_DELAY_MS             (500)       // The maximum delay of the LVGL timer task, in milliseconds
-#define LVGL_PORT_TASK_MIN_DELAY_MS             (2)         // The minimum delay of the LVGL timer task, in milliseconds
+#define LVGL_PORT_TASK_MAX_DELAY_MS             (500)       // The longest sleep when waiting for a vsync, in ms
+#define LVGL_PORT_TASK_MIN_DELAY_MS             (2)         // The shortest sleep before a timer is due, in milliseconds
 #define LVGL_PORT_TASK_STACK_SIZE               (6 * 1024)  // The stack size of the LVGL timer task, in bytes
 #define LVGL_PORT_TASK_PRIORITY                 (2)         // The priority of the LVGL timer task
 #ifdef ARDUINO_RUNNING_CORE
@@ -62,13 +76,24 @@
  * Avoid tering related configurations, can be adjusted by users.
  *
  *  (Currently, This function only supports RGB LCD and the version of LVGL must be >= 8.3.9)
+ *
+ * The macros below are only the defaults of `LVGL_PORT_CONFIG_DEFAULT()`. The mode, the rotation and the buffers are
+ * chosen at runtime by the `lvgl_port_config_t` passed to `lvgl_port_init_with_config()`, so one firmware can drive
+ * panels that need different modes and the modes can be compared without rebuilding.
  */
 /**
- * Set the avoid tearing mode:
+ * Set the avoid tearing mode, see `lvgl_port_avoid_tearing_mode_t`:
  *      - 0: Disable avoid tearing function
  *      - 1: LCD double-buffer & LVGL full-refresh
  *      - 2: LCD triple-buffer & LVGL full-refresh
  *      - 3: LCD double-buffer & LVGL direct-mode (recommended)
+ *      - 4: LCD triple-buffer & LVGL direct-mode with buffer-age damage tracking (only waits for the vsync in FIFO
+ *           present mode, when the last frame is still pending)
+ *      - 5: LCD double-buffer & LVGL full-refresh or direct-mode, chosen per frame from the dirty area
+ *      - 6: LCD double-buffer & LVGL partial rendering into SRAM tiles, written back into the frame buffers
+ *      - 7: LCD single-buffer & LVGL partial rendering into SRAM tiles, written where the scanout isn't reading
+ *      - 8: Like 7, with 8-bit color indices in the frame buffer, expanded through a palette at scanout
+ *      - 9: Like 7, with LVGL rendering at half the resolution of the panel, upscaled 2x at scanout
  */
 #ifdef CONFIG_LVGL_PORT_AVOID_TEARING_MODE
 #define LVGL_PORT_AVOID_TEARING_MODE            (CONFIG_LVGL_PORT_AVOID_TEARING_MODE)
@@ -77,10 +102,10 @@
 #define LVGL_PORT_AVOID_TEARING_MODE            (3)     // Valid if using Arduino
 #endif
 
-#if LVGL_PORT_AVOID_TEARING_MODE != 0
 /**
  * When avoid tearing is enabled, the LVGL software rotation `lv_disp_set_rotation()` is not supported.
  * But users can set the rotation degree(0/90/180/270) here, but this function will reduce FPS.
+ * When avoid tearing is disabled, the rotation is applied with `lv_disp_set_rotation()`.
  *
  * Set the rotation degree:
  *      - 0: 0 degree
@@ -96,37 +121,228 @@
 #endif
 
 /**
- * Here, some important configurations will be set based on different anti-tearing modes and rotation angles.
- * No modification is required here.
+ * Apply the rotation while the panel is scanned out, instead of copying LVGL's frame rotated into the frame buffers.
+ *
+ *  (Only valid for RGB LCD with bounce buffers and the avoid tearing modes 1 to 6. It replaces the fill of
+ *   `lvgl_port_set_scanout_fill()`, which can't be used with it)
+ *
+ * LVGL renders into the frame buffers in its own orientation, like without rotation, and the refill of the bounce
+ * buffers reads them rotated, see `lvgl_port_rotate.h`. The rotated copy and the frame buffer LVGL renders into
+ * before it are gone: a full-screen frame costs one write and one read of the frame buffer in PSRAM instead of two of
+ * each, the modes 1 and 3 need two frame buffers instead of three, and the modes 4 to 6 support rotation. 90/270
+ * degrees transpose bands of lines in SRAM (`LVGL_PORT_ROTATE_BAND_LINES` lines of the panel wide), which the refill
+ * ISR has to fit in its deadline, see `lvgl_port_scanout_sim_fill()`.
+ *
+ *      - 0: Rotate with a copy into the frame buffers
+ *      - 1: Rotate at scanout
+ */
+#define LVGL_PORT_ENABLE_SCANOUT_ROTATION       (0)
+
+/**
+ * Synchronize the dirty areas between the frame buffers with the GDMA instead of the CPU.
+ *
+ *  (Only valid for the avoid tearing modes 3, 4, 5, 6, 7 and 9)
+ *
+ * In mode 3, the copy is armed in `flush_callback()` and started from the vsync ISR, so it overlaps with the vsync
+ * wait. In mode 4, the render buffer is not on screen, so the copy starts as soon as rendering is about to begin.
+ * In both cases, rendering into a frame buffer is fenced until its copy has landed. In mode 6, each finished tile is
+ * also written back by the GDMA while LVGL renders the next one. In modes 7 and 9, the GDMA writes each tile into the
+ * frame buffer while the CPU waits.
+ *
+ *      - 0: Copy with the CPU inside the render path
+ *      - 1: Copy with the async memcpy engine (experimental)
+ */
+#define LVGL_PORT_ENABLE_ASYNC_COPY             (0)
+
+/**
+ * Pipeline the rotated copy onto the other core, see `lvgl_port_flush_worker.h`.
+ *
+ *  (Only valid for the avoid tearing modes 1, 2 and 3 with rotation copied into the frame buffers, the other modes
+ *   ignore it)
  *
- * Users should use `lcd_bus->configRgbFrameBufferNumber(LVGL_PORT_DISP_BUFFER_NUM);` to set the buffer number before. If screen drifting occurs, please refer to the Troubleshooting section in the README.
- * initializing the LCD bus
+ * Without it, the LVGL task renders a frame, rotates it into the frame buffer off screen, switches to it and waits for
+ * the vsync before it starts the next frame. With it, LVGL renders into two render buffers in turn, and a worker task
+ * on the other core rotates the damage of each finished frame into the frame buffer off screen, switches to it and
+ * waits for the vsync, while LVGL renders the next frame. The frame rate is set by the slower of rendering and
+ * rotating instead of their sum. The second render buffer is allocated in PSRAM, a whole screen in size.
+ *
+ *      - 0: Disable
+ *      - 1: Enable
  */
-#define LVGL_PORT_AVOID_TEAR                    (1)
-// Set the buffer number and refresh mode according to the different modes
-#if LVGL_PORT_AVOID_TEARING_MODE == 1
-    #define LVGL_PORT_DISP_BUFFER_NUM           (2)
-    #define LVGL_PORT_FULL_REFRESH              (1)
-#elif LVGL_PORT_AVOID_TEARING_MODE == 2
-    #define LVGL_PORT_DISP_BUFFER_NUM           (3)
-    #define LVGL_PORT_FULL_REFRESH              (1)
-#elif LVGL_PORT_AVOID_TEARING_MODE == 3
-    #define LVGL_PORT_DISP_BUFFER_NUM           (2)
-    #define LVGL_PORT_DIRECT_MODE               (1)
+#define LVGL_PORT_ENABLE_PIPELINE               (0)
+#if CONFIG_FREERTOS_UNICORE
+#define LVGL_PORT_PIPELINE_CORE                 (-1)
 #else
-    #error "Invalid avoid tearing mode, please set macro `LVGL_PORT_AVOID_TEARING_MODE` to one of `LVGL_PORT_AVOID_TEARING_MODE_*`"
-#endif
-// Check rotation
-#if (LVGL_PORT_ROTATION_DEGREE != 0) && (LVGL_PORT_ROTATION_DEGREE != 90) && (LVGL_PORT_ROTATION_DEGREE != 180) && \
-    (LVGL_PORT_ROTATION_DEGREE != 270)
-    #error "Invalid rotation degree, please set to 0, 90, 180 or 270"
-#elif LVGL_PORT_ROTATION_DEGREE != 0
-    #ifdef LVGL_PORT_DISP_BUFFER_NUM
-        #undef LVGL_PORT_DISP_BUFFER_NUM
-        #define LVGL_PORT_DISP_BUFFER_NUM           (3)
-    #endif
+#define LVGL_PORT_PIPELINE_CORE                 ((LVGL_PORT_TASK_CORE == 0) ? 1 : 0)
 #endif
-#endif /* LVGL_PORT_AVOID_TEARING_MODE */
+                                                        // The core of the flush worker, the one the LVGL task doesn't
+                                                        // use, `-1` means not to specify the core
+
+/**
+ * Split the rotated copies and the synchronization of the dirty areas over both cores, see `lvgl_port_jobs.h`.
+ *
+ *  (Only valid for the copies made by the CPU in the LVGL task: the modes 1 to 3 with rotation, and the modes 3 to 6
+ *   without `async_copy`. It needs both cores)
+ *
+ * Each copy is cut into tiles that the LVGL task and the worker of the other core share, and the copy returns once
+ * every tile is over. The copies smaller than the crossover stay on one core, since waking the worker up costs more
+ * than it saves. The crossover is `LVGL_PORT_PARALLEL_COPY_MIN_PIXELS` for every rotation until
+ * `lvgl_port_run_copy_benchmark()` measures it. The flush worker of `pipeline` doesn't split its copies, it already
+ * runs on the other core. The port starts the job system when this is enabled, the application can use it as well.
+ *
+ *      - 0: Disable
+ *      - 1: Enable
+ */
+#define LVGL_PORT_ENABLE_PARALLEL_COPY          (0)
+#define LVGL_PORT_PARALLEL_COPY_MIN_PIXELS      (8 * 1024)  // Crossover before it is measured, in pixels
+
+/**
+ * Shrink the damage of each frame to the tiles whose pixels actually changed, see `lvgl_port_tile_hash.h`.
+ *
+ *  (Only valid for the avoid tearing modes 3, 4 and 5, and for mode 3 with rotation)
+ *
+ * After a frame is rendered, the tiles of its dirty areas are hashed and compared with the previous frame. Only the
+ * changed tiles are synchronized between the frame buffers (and rotated), and a frame without any changed tile is not
+ * presented at all. Hashing reads the dirty areas back once, which pays off when redraws often produce the same pixels.
+ *
+ *      - 0: Disable
+ *      - 1: Enable
+ */
+#define LVGL_PORT_ENABLE_TILE_HASH              (0)
+
+/**
+ * Tiled mode (`LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_TILED`).
+ *
+ * In the other modes, LVGL renders straight into the PSRAM frame buffers: every fill and blend read-modify-writes
+ * PSRAM, which the RGB peripheral is streaming to the panel at the same time. In mode 6, LVGL renders into two tiles
+ * of whole lines in internal SRAM instead. While LVGL renders into one of them, the other is written back into the
+ * frame buffer that is not on screen, one tile after the other, and the frame buffers are switched at the vsync once
+ * the last tile has landed. Each frame buffer only sees the writes of the finished tiles and the synchronization of
+ * the last frame's damage, see `lvgl_port_get_psram_stats()`.
+ *
+ * The dirty areas are widened to whole lines, so every tile is one contiguous span of the frame buffer. The height
+ * of the tiles is `buffer.height` of `lvgl_port_config_t`.
+ *
+ *  (Only valid without rotation, the tile hash is not used since the frame is never complete in a render buffer)
+ */
+
+/**
+ * Race-the-beam mode (`LVGL_PORT_AVOID_TEARING_MODE_SINGLE_BEAM`).
+ *
+ * The panel scans out a single frame buffer, which halves the frame buffer memory and never copies dirty areas
+ * between frame buffers. LVGL renders tiles of whole lines in SRAM like mode 6, and each finished tile is written
+ * into the frame buffer only where the scanout is not reading it: behind the beam if the next frame won't reach it
+ * before the write is over, otherwise ahead of it, waiting for the beam to pass if neither fits. The beam is the
+ * refill of the RGB bounce buffers, which the port takes over, see `lvgl_port_scanout.h`.
+ *
+ * Tearing is avoided per tile, not per frame: a frame whose tiles are placed on both sides of the beam is shown half
+ * new, half old for one scanout, like a frame that takes longer than one scanout in the other modes.
+ *
+ *  (Only valid for RGB LCD with bounce buffers and without rotation. Without bounce buffers, every tile waits
+ *   `LVGL_PORT_PRESENT_WAIT_MS` for the beam and is written anyway)
+ */
+
+/**
+ * Indexed mode (`LVGL_PORT_AVOID_TEARING_MODE_SINGLE_INDEXED`).
+ *
+ * Like mode 7, with one byte per pixel in the frame buffer: each finished tile is converted into RGB332 color indices
+ * with an ordered dither while it is written around the beam, and the refill of the bounce buffers expands them back
+ * to RGB565 through a palette in SRAM, see `lvgl_port_palette.h`. The PSRAM traffic of both the writes and the scanout
+ * is halved, and `lvgl_port_palette_set()` recolors the whole screen from the next scanned frame without rendering.
+ *
+ * LVGL still renders in 16-bit colors, only the frame buffer is indexed. The indices use the first half of the first
+ * frame buffer of the LCD.
+ *
+ *  (Only valid for RGB LCD with bounce buffers and without rotation. It replaces the fill of
+ *   `lvgl_port_set_scanout_fill()`, which can't be used in this mode)
+ */
+
+/**
+ * Half-resolution mode (`LVGL_PORT_AVOID_TEARING_MODE_SINGLE_HALF`).
+ *
+ * Like mode 7, with a display of half the width and height of the panel: LVGL renders and writes a quarter of the
+ * pixels, and the refill of the bounce buffers upscales them 2x while the panel is scanned out, see
+ * `lvgl_port_upscale.h`. It suits screens of smooth content, where the loss of detail doesn't show. The touch points
+ * are scaled down to the resolution of the display.
+ *
+ * The resolution of the display is fixed at `lvgl_port_init_with_config()`, so the benchmark of this mode only runs
+ * if it is the initial one, and then it is the only mode measured.
+ *
+ *  (Only valid for RGB LCD with bounce buffers and without rotation. It replaces the fill of
+ *   `lvgl_port_set_scanout_fill()`, which can't be used in this mode)
+ *
+ *      - 0: Nearest filter, each pixel is repeated 2x2
+ *      - 1: Bilinear filter, smoother but text and edges are blurred
+ */
+#define LVGL_PORT_HALF_BILINEAR                 (1)
+
+/**
+ * Hysteresis of the adaptive mode (`LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_ADAPTIVE`).
+ *
+ * Before each frame, the invalid area is compared with the screen area. Full-refresh needs no synchronization of the
+ * dirty areas between the frame buffers, so it wins when most of the screen changes every frame. Direct-mode only
+ * renders the dirty areas, so it wins for small updates. The mode only changes after several frames beyond a threshold.
+ *
+ *  (Only valid without rotation)
+ */
+#define LVGL_PORT_ADAPTIVE_FULL_PERCENT         (70)    // Switch to full-refresh above this dirty area, in percent
+#define LVGL_PORT_ADAPTIVE_DIRECT_PERCENT       (30)    // Switch to direct-mode below this dirty area, in percent
+#define LVGL_PORT_ADAPTIVE_FRAMES               (3)     // Consecutive frames beyond a threshold before switching
+
+/**
+ * Present mode used at startup, it can be changed at runtime with `lvgl_port_set_present_mode()`.
+ *
+ *  (Only valid without rotation, the rotated modes always wait for the vsync in `flush_callback()`)
+ *
+ *      - LVGL_PORT_PRESENT_FIFO: Vsync-locked, every frame is shown and rendering waits until a buffer is free
+ *      - LVGL_PORT_PRESENT_MAILBOX: The latest frame wins and rendering never waits (needs 3 buffers, otherwise FIFO)
+ *      - LVGL_PORT_PRESENT_IMMEDIATE: Rendering never waits, tearing is possible with 2 buffers
+ */
+#define LVGL_PORT_PRESENT_MODE_DEFAULT          (LVGL_PORT_PRESENT_FIFO)
+#define LVGL_PORT_PRESENT_WAIT_MS               (50)    // Maximum sleep of LVGL's `wait_cb` per check of the flush
+
+/**
+ * Frame scheduler used at startup, it can be changed at runtime with `lvgl_port_set_frame_divisor()`.
+ *
+ *  (Only valid if the avoid tearing function is enabled)
+ *
+ * The vsync ISR wakes the LVGL task up once every `divisor` vsyncs, and each wake runs the timers then renders, see
+ * `lvgl_port_frame_sched.h`. LVGL's tick is set to the predicted presentation of each frame and stands still in
+ * between, so the timers and animations step with the frames: a timer shorter than a frame runs once per frame, and
+ * `LV_DISP_DEF_REFR_PERIOD` no longer applies.
+ *
+ *      - 0: Disable, the LVGL task sleeps for what `lv_timer_handler()` returns
+ *      - N: One frame every N vsyncs
+ */
+#define LVGL_PORT_FRAME_DIVISOR                 (0)
+
+/**
+ * Step the CPU clock with the load of the frames, see `lvgl_port_governor.h`.
+ *
+ * The load of a frame is the time of `lv_timer_handler()` when it renders, over the frame period: the vsync period
+ * times the divisor while the frame scheduler runs, `LV_DISP_DEF_REFR_PERIOD` otherwise. The thresholds start from
+ * `LVGL_PORT_GOVERNOR_CONFIG_DEFAULT()` and can be tuned at runtime with `lvgl_port_set_governor_config()`. The
+ * benchmarks run at the fastest clock. It needs the power management of ESP-IDF (`CONFIG_PM_ENABLE`), or Arduino.
+ *
+ *      - 0: Disable
+ *      - 1: Enable
+ */
+#define LVGL_PORT_ENABLE_GOVERNOR               (0)
+
+/**
+ * Self-benchmark related parameters, see `lvgl_port_run_benchmark()`
+ */
+#define LVGL_PORT_BENCHMARK_WARMUP_FRAMES       (3)     // Frames rendered after a mode switch before measuring
+#define LVGL_PORT_BENCHMARK_TIMEOUT_MS          (5000)  // Maximum time spent measuring each mode
+#define LVGL_PORT_COPY_BENCHMARK_MIN_PIXELS     (256)   // Smallest copy measured by `lvgl_port_run_copy_benchmark()`
+#define LVGL_PORT_COPY_BENCHMARK_REPEAT_MAX     (64)    // Most repetitions of one measured copy
+
+/**
+ * The number of LCD frame buffers depends on the avoid tearing mode and the rotation. Users should use
+ * `lcd->configFrameBufferNumber(lvgl_port_get_frame_buffer_num(&config));` to set it before initializing the LCD bus.
+ * If screen drifting occurs, please refer to the Troubleshooting section in the README.
+ */
+#define LVGL_PORT_FRAME_BUFFER_NUM_MAX          (3)
 
 // *INDENT-ON*
 
@@ -134,9 +350,141 @@
 extern "C" {
 #endif
 
+typedef enum {
+    LVGL_PORT_AVOID_TEARING_MODE_NONE = 0,          // Disable avoid tearing function
+    LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_FULL,       // LCD double-buffer & LVGL full-refresh
+    LVGL_PORT_AVOID_TEARING_MODE_TRIPLE_FULL,       // LCD triple-buffer & LVGL full-refresh
+    LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_DIRECT,     // LCD double-buffer & LVGL direct-mode
+    LVGL_PORT_AVOID_TEARING_MODE_TRIPLE_DIRECT,     // LCD triple-buffer & LVGL direct-mode with buffer-age damage tracking
+    LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_ADAPTIVE,   // LCD double-buffer & LVGL full-refresh or direct-mode per frame
+    LVGL_PORT_AVOID_TEARING_MODE_DOUBLE_TILED,      // LCD double-buffer & LVGL partial rendering into SRAM tiles
+    LVGL_PORT_AVOID_TEARING_MODE_SINGLE_BEAM,       // LCD single-buffer & LVGL partial rendering around the beam
+    LVGL_PORT_AVOID_TEARING_MODE_SINGLE_INDEXED,    // LCD single-buffer of 8-bit indices & LVGL partial rendering
+    LVGL_PORT_AVOID_TEARING_MODE_SINGLE_HALF,       // LCD single-buffer & LVGL partial rendering at half resolution
+    LVGL_PORT_AVOID_TEARING_MODE_MAX,
+} lvgl_port_avoid_tearing_mode_t;
+
+/**
+ * @brief Configuration of the LVGL porting, chosen at `lvgl_port_init_with_config()` time
+ */
+typedef struct {
+    lvgl_port_avoid_tearing_mode_t avoid_tearing_mode;
+    int rotation;                       // 0/90/180/270, rotation `!= 0` is not supported by the modes 4 to 9
+                                        // (the modes 4 to 6 support it at scanout)
+    struct {
+        uint32_t caps;                  // Memory type of the LVGL buffers
+        int height;                     // Height of the LVGL buffers, in lines
+        int num;                        // Number of LVGL buffers, 1 or 2
+    } buffer;                           // Only used if avoid tearing is disabled, the frame buffers are used otherwise
+                                        // (except for the tiles of the modes 6 to 9, whose number is always 2)
+    bool async_copy;                    // Synchronize the dirty areas with the GDMA, only used by the direct-modes
+    bool pipeline;                      // Rotate on the other core while LVGL renders, only used by the modes 1 to 3
+                                        // with rotation
+    bool parallel_copy;                 // Split the copies of the LVGL task over both cores
+    bool tile_hash;                     // Shrink the damage to the changed tiles, only used by the direct-modes
+    lvgl_port_present_mode_t present_mode;
+                                        // Initial present mode, only used with avoid tearing and without rotation
+                                        // (or with the rotation at scanout)
+    bool scanout_rotation;              // Rotate at scanout instead of copying, only used by the modes 1 to 6
+    int frame_divisor;                  // Vsyncs per frame of the frame scheduler, `0` to disable, only used with
+                                        // avoid tearing
+    bool governor;                      // Step the CPU clock with the load of the frames
+} lvgl_port_config_t;
+
+#define LVGL_PORT_CONFIG_DEFAULT()                                                      \
+    {                                                                                   \
+        .avoid_tearing_mode = (lvgl_port_avoid_tearing_mode_t)LVGL_PORT_AVOID_TEARING_MODE, \
+        .rotation = LVGL_PORT_ROTATION_DEGREE,                                          \
+        .buffer = {                                                                     \
+            .caps = LVGL_PORT_BUFFER_MALLOC_CAPS,                                       \
+            .height = LVGL_PORT_BUFFER_SIZE_HEIGHT,                                     \
+            .num = LVGL_PORT_BUFFER_NUM,                                                \
+        },                                                                              \
+        .async_copy = LVGL_PORT_ENABLE_ASYNC_COPY,                                      \
+        .pipeline = LVGL_PORT_ENABLE_PIPELINE,                                          \
+        .parallel_copy = LVGL_PORT_ENABLE_PARALLEL_COPY,                                \
+        .tile_hash = LVGL_PORT_ENABLE_TILE_HASH,                                        \
+        .present_mode = LVGL_PORT_PRESENT_MODE_DEFAULT,                                 \
+        .scanout_rotation = LVGL_PORT_ENABLE_SCANOUT_ROTATION,                          \
+        .frame_divisor = LVGL_PORT_FRAME_DIVISOR,                                       \
+        .governor = LVGL_PORT_ENABLE_GOVERNOR,                                          \
+    }
+
+/**
+ * @brief Result of the self-benchmark for one avoid tearing mode
+ */
+typedef struct {
+    lvgl_port_avoid_tearing_mode_t mode;
+    uint32_t frames;                    // Frames measured
+    uint32_t frame_us_avg;              // Average time of `lv_timer_handler()` when it renders a frame
+    uint32_t frame_us_max;              // Maximum of the above
+    uint32_t psram_read_avg;            // Average bytes read from the frame buffers per frame, see below
+    uint32_t psram_write_avg;           // Average bytes written into the frame buffers per frame
+} lvgl_port_benchmark_result_t;
+
+/**
+ * @brief Result of the copy benchmark for one rotation, see `lvgl_port_run_copy_benchmark()`
+ */
+typedef struct {
+    int rotation;
+    uint32_t single_us;                 // Time of a full-screen copy on one core
+    uint32_t dual_us;                   // Time of a full-screen copy split over both cores
+    uint32_t speedup_percent;           // `single_us` over `dual_us`, in percent
+    uint32_t crossover_px;              // Smallest copy measured faster on both cores, `0` if none was
+} lvgl_port_copy_benchmark_result_t;
+
+/**
+ * @brief Traffic of the frame buffers in PSRAM, accumulated since the avoid tearing mode was applied
+ *
+ * @note  The bytes moved by the port (synchronization of the dirty areas, rotation, write-back of the tiles) are
+ *        counted as they are copied. What LVGL reads and writes while it renders into a frame buffer can't be observed,
+ *        so every rendered pixel is counted as read and written once, which is a lower bound: a blend over an opaque
+ *        background touches each pixel at least twice.
+ */
+typedef struct {
+    uint32_t frames;                    // Frames rendered
+    uint64_t read_bytes;                // Bytes read from the frame buffers
+    uint64_t write_bytes;               // Bytes written into the frame buffers
+    uint32_t last_read_bytes;           // Bytes read from the frame buffers in the last frame
+    uint32_t last_write_bytes;          // Bytes written into the frame buffers in the last frame
+} lvgl_port_psram_stats_t;
+
+/**
+ * @brief Sleeps of the LVGL task, accumulated since `lvgl_port_init()`
+ */
+typedef struct {
+    uint32_t wakes;                     // Times the task woke up
+    uint32_t wakes_by_event;            // Of which woken up before the timeout, by a touch, a UI command or an unlock
+    uint32_t touch_interrupts;          // Interrupts of the touch panel, `0` if it is polled
+    uint64_t sleep_us;                  // Time spent sleeping
+} lvgl_port_task_stats_t;
+
+/**
+ * @brief Get the number of LCD frame buffers needed by a configuration.
+ *
+ * @param config The configuration, set to nullptr to use `LVGL_PORT_CONFIG_DEFAULT()`
+ *
+ * @return The number of frame buffers, `1` if avoid tearing is disabled
+ */
+int lvgl_port_get_frame_buffer_num(const lvgl_port_config_t *config);
+
 /**
  * @brief Porting LVGL with LCD and touch panel. This function should be called after the initialization of the LCD and touch panel.
  *
+ * @param lcd    The pointer to the LCD panel device, mustn't be nullptr
+ * @param tp     The pointer to the touch panel device, set to nullptr if is not used
+ * @param config The configuration, set to nullptr to use `LVGL_PORT_CONFIG_DEFAULT()`
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_init_with_config(
+    esp_panel::drivers::LCD *lcd, esp_panel::drivers::Touch *tp, const lvgl_port_config_t *config
+);
+
+/**
+ * @brief Porting LVGL with LCD and touch panel, with `LVGL_PORT_CONFIG_DEFAULT()`. This function should be called
+ *        after the initialization of the LCD and touch panel.
+ *
  * @param lcd The pointer to the LCD panel device, mustn't be nullptr
  * @param tp  The pointer to the touch panel device, set to nullptr if is not used
  *
@@ -169,6 +517,370 @@ bool lvgl_port_lock(int timeout_ms);
  */
 bool lvgl_port_unlock(void);
 
+/**
+ * @brief Register an object as the target of the UI commands below. Call it with the LVGL mutex held, or from the
+ *        LVGL task.
+ *
+ * @note  The handle is invalidated when the object is deleted, the commands queued for it are then ignored.
+ *
+ * @param obj The object
+ *
+ * @return Its handle, `LVGL_PORT_UI_HANDLE_INVALID` if `LVGL_PORT_UI_QUEUE_HANDLE_MAX` objects are registered
+ */
+lvgl_port_ui_handle_t lvgl_port_ui_register(lv_obj_t *obj);
+
+/**
+ * @brief Unregister an object that is kept, its handle is invalidated. Call it with the LVGL mutex held, or from the
+ *        LVGL task.
+ *
+ * @param handle Handle of the object
+ */
+void lvgl_port_ui_unregister(lvgl_port_ui_handle_t handle);
+
+/**
+ * @brief Set the text of a label from the next frame, without taking the LVGL mutex, see `lvgl_port_ui_queue.h`.
+ *        Callable from any task or ISR, it never blocks. The LVGL task is woken up if it sleeps.
+ *
+ * @param handle Handle of the label, from `lvgl_port_ui_register()`
+ * @param text   The text, copied, shorter than `LVGL_PORT_UI_QUEUE_TEXT_MAX`
+ *
+ * @return true if queued, false if the text is too long or the queue is full
+ */
+bool lvgl_port_ui_set_text(lvgl_port_ui_handle_t handle, const char *text);
+
+/**
+ * @brief Set the value of a bar, a slider or an arc from the next frame, without taking the LVGL mutex.
+ *
+ * @param handle Handle of the bar, slider or arc
+ * @param value  The value, without animation
+ *
+ * @return true if queued, false if the queue is full
+ */
+bool lvgl_port_ui_set_value(lvgl_port_ui_handle_t handle, int32_t value);
+
+/**
+ * @brief Move an object from the next frame, without taking the LVGL mutex.
+ *
+ * @param handle Handle of the object
+ * @param x      The position, like `lv_obj_set_pos()`
+ * @param y
+ *
+ * @return true if queued, false if the queue is full
+ */
+bool lvgl_port_ui_move(lvgl_port_ui_handle_t handle, lv_coord_t x, lv_coord_t y);
+
+/**
+ * @brief Show or hide an object from the next frame, without taking the LVGL mutex.
+ *
+ * @param handle Handle of the object
+ * @param hidden Whether to hide it
+ *
+ * @return true if queued, false if the queue is full
+ */
+bool lvgl_port_ui_set_hidden(lvgl_port_ui_handle_t handle, bool hidden);
+
+/**
+ * @brief Get the statistics of the UI command queue: its depth, the drops and the wait of the producers.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_ui_queue_stats(lvgl_port_ui_queue_stats_t *stats);
+
+/**
+ * @brief Change the present mode at runtime. The statistics of the previous mode are logged and reset.
+ *
+ * @note  This function is only valid if the avoid tearing function is enabled without rotation.
+ *
+ * @param mode The new present mode
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_set_present_mode(lvgl_port_present_mode_t mode);
+
+/**
+ * @brief Get the statistics of the current present mode, to compare throughput and latency between modes.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_present_stats(lvgl_port_present_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the tile-hash damage filter, including the bytes found unchanged in the last frame.
+ *
+ * @note  This function is only valid if `tile_hash` is enabled in the configuration.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_tile_hash_stats(lvgl_port_tile_hash_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the flush worker: the time it holds each render buffer, and the time the LVGL task
+ *        waited for it to hand one back.
+ *
+ * @note  This function is only valid if the pipeline is enabled.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_pipeline_stats(lvgl_port_flush_worker_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the job system that splits the copies over both cores.
+ *
+ * @note  This function is only valid if `parallel_copy` is enabled.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_parallel_copy_stats(lvgl_port_jobs_stats_t *stats);
+
+/**
+ * @brief Get the traffic of the frame buffers, to compare the tiled mode with rendering directly into PSRAM.
+ *
+ * @note  This function is only valid if the avoid tearing function is enabled.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_psram_stats(lvgl_port_psram_stats_t *stats);
+
+/**
+ * @brief Record the traffic of the frame buffers frame by frame (see `lvgl_port_psram_stats_t`), as a trace to replay
+ *        in `lvgl_port_bandwidth_sim.h`. The render times come from LVGL, to the millisecond.
+ *
+ * @note  This function is only valid if the avoid tearing function is enabled. Recording stops when `frames` is full.
+ *
+ * @param frames    Frames to record into, owned by the caller until `lvgl_port_stop_frame_trace()`
+ * @param frame_max Number of frames
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_start_frame_trace(lvgl_port_bandwidth_sim_frame_t *frames, int frame_max);
+
+/**
+ * @brief Stop recording the trace.
+ *
+ * @return The number of frames recorded, or `-1` if failed
+ */
+int lvgl_port_stop_frame_trace(void);
+
+/**
+ * @brief Generate the pixels of the scanout with a callback instead of copying them from the frame buffer, for
+ *        procedural layers like `lvgl_port_gradient.h`. See `lvgl_port_scanout_fill_cb_t`.
+ *
+ * @note  This function is only valid for RGB LCD with bounce buffers and if the avoid tearing function is enabled.
+ *        The refill of the bounce buffers is taken over, `fill_cb = NULL` gives it back to the LCD driver unless the
+ *        overlays or the mode still need it.
+ *
+ * @param fill_cb   Fill callback, in IRAM, `NULL` to copy the frame buffer again
+ * @param user_data Passed to `fill_cb`
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_set_scanout_fill(lvgl_port_scanout_fill_cb_t fill_cb, void *user_data);
+
+/**
+ * @brief Compose the overlay planes of `lvgl_port_overlay.h` on top of the scanout, in any avoid tearing mode. The
+ *        planes are then shown, moved and hidden with `lvgl_port_overlay_*()`, without involving LVGL.
+ *
+ * @note  This function is only valid for RGB LCD with bounce buffers and if the avoid tearing function is enabled.
+ *
+ * @param enable Whether to compose the planes
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_set_scanout_overlays(bool enable);
+
+/**
+ * @brief Get the statistics of the scanout: the measured frame period and where the tiles of the modes 7 to 9 were
+ *        placed.
+ *
+ * @note  This function is only valid while the scanout is attached, by a mode, a fill or the overlays.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_scanout_stats(lvgl_port_scanout_stats_t *stats);
+
+/**
+ * @brief Start the frame scheduler locked to the vsync, change its divisor, or stop it. See `LVGL_PORT_FRAME_DIVISOR`.
+ *
+ * @note  This function is only valid if the avoid tearing function is enabled.
+ *
+ * @param divisor Vsyncs per frame, `0` to stop
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_set_frame_divisor(int divisor);
+
+/**
+ * @brief Get the statistics of the frame scheduler: the vsync period, the slack of the frames before their predicted
+ *        presentation, and the frames that missed it.
+ *
+ * @note  This function is only valid while the frame scheduler is running.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_frame_sched_stats(lvgl_port_frame_sched_stats_t *stats);
+
+/**
+ * @brief Get the sleeps of the LVGL task, to check that it stays asleep while the screen is static.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_task_stats(lvgl_port_task_stats_t *stats);
+
+/**
+ * @brief Create an LVGL timer whose callback is timed by the port. In the frames of the frame scheduler, a deferrable
+ *        timer is postponed to the next frame when its estimated cost doesn't fit before the predicted presentation,
+ *        for at most `LVGL_PORT_TIMER_SCHED_DEFER_MAX` frames in a row. Without the scheduler, every timer runs when
+ *        it is due.
+ *
+ * @note  This function should be called with the lock held. The timer is deleted with `lvgl_port_timer_del()`, not
+ *        `lv_timer_del()`, or after its last repeat.
+ *
+ * @param cb          Callback of the timer, it gets the timer and its `user_data` as with `lv_timer_create()`
+ * @param period_ms   Period of the timer, in milliseconds
+ * @param user_data   User data of the timer
+ * @param timer_class Frame-critical or deferrable
+ *
+ * @return The timer, or `NULL` if failed
+ */
+lv_timer_t *lvgl_port_timer_create(
+    lv_timer_cb_t cb, uint32_t period_ms, void *user_data, lvgl_port_timer_class_t timer_class
+);
+
+/**
+ * @brief Delete a timer created by `lvgl_port_timer_create()`.
+ *
+ * @note  This function should be called with the lock held.
+ *
+ * @param timer Timer to delete
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_timer_del(lv_timer_t *timer);
+
+/**
+ * @brief Get the cost and the deferrals of a timer created by `lvgl_port_timer_create()`.
+ *
+ * @param timer Timer
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_timer_stats(lv_timer_t *timer, lvgl_port_timer_stats_t *stats);
+
+/**
+ * @brief Get the deferrals of all the timers, and the estimated frame without the deferrable ones.
+ *
+ * @note  This function is only valid while the frame scheduler is running.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_timer_sched_stats(lvgl_port_timer_sched_stats_t *stats);
+
+/**
+ * @brief Prepare a screen without freezing the UI: `prepare_cb` runs on a worker task on the other core, then the
+ *        build steps run in the LVGL task, a slice of them between two frames, and `ready_cb` is called after the last
+ *        one. See `lvgl_port_screen_prep.h`.
+ *
+ * @note  The worker is started by the first preparation. One preparation runs at a time.
+ *
+ * @param prep Screen to prepare, copied
+ *
+ * @return true if started, otherwise false
+ */
+bool lvgl_port_prepare_screen(const lvgl_port_screen_prep_t *prep);
+
+/**
+ * @brief Get the timings of the last screen preparation, its time to interactive included.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_screen_prep_stats(lvgl_port_screen_prep_stats_t *stats);
+
+/**
+ * @brief Change the thresholds of the CPU frequency governor, for instance to the ones tuned by replaying a trace of
+ *        `lvgl_port_start_frame_trace()` with `lvgl_port_governor_replay()`.
+ *
+ * @note  This function is only valid if `governor` is enabled.
+ *
+ * @param config Thresholds
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_set_governor_config(const lvgl_port_governor_config_t *config);
+
+/**
+ * @brief Get the time spent at each CPU clock, and the steps of the governor.
+ *
+ * @note  This function is only valid if `governor` is enabled.
+ *
+ * @param stats Pointer to the statistics to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_governor_stats(lvgl_port_governor_stats_t *stats);
+
+/**
+ * @brief Get the configuration in use. The avoid tearing mode may differ from the initial one during a benchmark.
+ *
+ * @param config Pointer to the configuration to be filled
+ *
+ * @return true if success, otherwise false
+ */
+bool lvgl_port_get_config(lvgl_port_config_t *config);
+
+/**
+ * @brief Run every avoid tearing mode supported by the LCD frame buffers on the current screen, and measure the frame
+ *        time of each. The initial mode is restored afterwards.
+ *
+ * @note  The benchmark runs in the LVGL task, with the timers of the application running as usual, so this function
+ *        mustn't be called with the LVGL mutex held. Only the modes using the same frame buffers as the rotation are
+ *        run, so the LCD should be configured with `LVGL_PORT_FRAME_BUFFER_NUM_MAX` frame buffers to run all of them.
+ *
+ * @param frames     Frames to measure for each mode
+ * @param results    Results, one per mode run
+ * @param result_max Maximum number of results
+ *
+ * @return The number of results, or `-1` if failed
+ */
+int lvgl_port_run_benchmark(uint32_t frames, lvgl_port_benchmark_result_t *results, int result_max);
+
+/**
+ * @brief Measure the rotated copy of each rotation on one core and split over both, from full-screen down to
+ *        `LVGL_PORT_COPY_BENCHMARK_MIN_PIXELS`, and use the measured crossovers from then on.
+ *
+ * @note  This function is only valid if `parallel_copy` is enabled. It copies between two full-screen buffers
+ *        allocated in PSRAM like the frame buffers, and holds the LVGL mutex meanwhile, so it mustn't be called with
+ *        the mutex held. It takes a few seconds.
+ *
+ * @param results    Results, one per rotation (0, 90, 180 and 270)
+ * @param result_max Maximum number of results
+ *
+ * @return The number of results, or `-1` if failed
+ */
+int lvgl_port_run_copy_benchmark(lvgl_port_copy_benchmark_result_t *results, int result_max);
+
 #ifdef __cplusplus
 }
 #endif
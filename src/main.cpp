@@ -8,6 +8,8 @@
 #include <esp_display_panel.hpp>
 #include <lvgl.h>
 #include "lvgl_v8_port.h"
+#include "lvgl_port_gradient.h"
+#include "lvgl_port_layer.h"
 #include "lv_conf.h"
 #include <math.h>
 
@@ -18,8 +20,23 @@ using namespace esp_panel::board;
 // RGB double-buffer + LVGL full-refresh mode (recommended for ESP32-S3)
 // This eliminates tearing by using hardware-level double buffering
 
+// Showcase of the optional features of the port on this screen, also settable with `-D DEMO_FEATURES=1`: frames locked
+// to the vsync, the gradient of the next frame rendered on the other core, the copies split between the cores, the
+// tile hash, the CPU governor and the timer budget, with their statistics printed every `STATS_PERIOD_MS`. Without it,
+// the example only draws the screen
+#ifndef DEMO_FEATURES
+#define DEMO_FEATURES 0
+#endif
+
 static const uint32_t TARGET_FPS = 30;
 static const uint32_t FRAME_MS = 1000 / TARGET_FPS;
+static const uint32_t BENCHMARK_FRAMES = 0; // Frames measured per anti-tearing mode at boot, 0 to skip
+static const uint32_t STATS_PERIOD_MS = 10000; // Period of the statistics printed with DEMO_FEATURES
+static const bool SCANOUT_GRADIENT = false; // Generate the gradient in the bounce-buffer refill instead of drawing it
+static const uint16_t SCANOUT_KEY = 0xF81F; // Background color (0xFF00FF) letting the generated gradient through
+static const int BOUNCE_BUFFER_DIVISOR = 10; // Lines per bounce buffer refill, as a fraction of the screen height
+static const int LAYER_WAIT_MS = 4; // Longest wait of the draw for a late layer, before it renders the gradient inline
+static const int GRADIENT_STEP = 32; // Small blocks for smooth appearance but good performance
 
 // UI об'єкти
 static lv_obj_t *gradient_obj;
@@ -49,10 +66,13 @@ static float orbit_radius[3] = {0.0f, 0.0f, 0.0f};
 static float orbit_scale_x = 2.0f; // X-axis scale multiplier (1.0 = normal, >1.0 = wider, <1.0 = narrower)
 static float orbit_scale_y = 1.5f; // Y-axis scale multiplier (1.0 = normal, >1.0 = taller, <1.0 = shorter)
 
-static ColorDot dots[3];
+static ColorDot dots[3];       // Dots of the frame being drawn
+static ColorDot layer_dots[3]; // Dots of the layer requested last, drawn by the next frame
+static uint32_t layer_seq = 0; // Sequence number of the layer requested last
+static bool layer_producer = false;
 
 // Optimized color interpolation function
-static lv_color_t interpolate_color_idw_fast(int px, int py)
+static lv_color_t interpolate_color_idw_fast(const ColorDot *dots, int px, int py)
 {
     float x = (float)px, y = (float)py;
 
@@ -105,6 +125,65 @@ static lv_color_t interpolate_color_idw_fast(int px, int py)
     return lv_color_make(r, g, b);
 }
 
+// Render the gradient of a frame into a layer, on the core of the producer
+// The blocks are the same as the ones of the draw callback, so a frame drawn inline looks the same
+static void gradient_layer_render(void *layer, int width, int height, const void *params, void *user_data)
+{
+    const ColorDot *frame_dots = (const ColorDot *)params;
+    lv_color_t *pixels = (lv_color_t *)layer;
+
+    for (int y = 0; y < height; y += GRADIENT_STEP)
+    {
+        int y2 = min(y + GRADIENT_STEP, height);
+        for (int x = 0; x < width; x += GRADIENT_STEP)
+        {
+            int x2 = min(x + GRADIENT_STEP, width);
+            lv_color_t color = interpolate_color_idw_fast(frame_dots, x + GRADIENT_STEP / 2, y + GRADIENT_STEP / 2);
+            for (int i = x; i < x2; ++i)
+            {
+                pixels[y * width + i] = color;
+            }
+        }
+        for (int j = y + 1; j < y2; ++j)
+        {
+            memcpy(&pixels[j * width], &pixels[y * width], width * sizeof(lv_color_t));
+        }
+    }
+}
+
+// Copy the layer of the frame being drawn into the draw buffer, clipped to the draw area
+static bool gradient_draw_layer(lv_draw_ctx_t *draw_ctx, const lv_area_t *coords)
+{
+    lv_area_t clip;
+    if (!_lv_area_intersect(&clip, coords, draw_ctx->clip_area))
+    {
+        return true;
+    }
+    // Masks (rounded parents, transformed layers) need LVGL's blending, the blocks are drawn instead
+    if (lv_draw_mask_is_any(&clip))
+    {
+        return false;
+    }
+
+    // The producer is late or skipped the frame: give up after a short wait and draw the blocks inline
+    const lv_color_t *layer = (const lv_color_t *)lvgl_port_layer_acquire(layer_seq - 1, LAYER_WAIT_MS);
+    if (layer == NULL)
+    {
+        return false;
+    }
+
+    lv_color_t *buf = (lv_color_t *)draw_ctx->buf;
+    lv_coord_t buf_w = lv_area_get_width(draw_ctx->buf_area);
+    lv_coord_t clip_w = lv_area_get_width(&clip);
+    for (lv_coord_t y = clip.y1; y <= clip.y2; ++y)
+    {
+        memcpy(&buf[(y - draw_ctx->buf_area->y1) * buf_w + (clip.x1 - draw_ctx->buf_area->x1)],
+               &layer[(y - coords->y1) * SCR_W + (clip.x1 - coords->x1)], clip_w * sizeof(lv_color_t));
+    }
+
+    return true;
+}
+
 // Custom draw event callback for smooth gradient rendering
 // This uses LVGL's proper rendering pipeline with anti-tearing
 static void gradient_draw_event_cb(lv_event_t *e)
@@ -119,8 +198,14 @@ static void gradient_draw_event_cb(lv_event_t *e)
     lv_coord_t obj_w = lv_area_get_width(&coords);
     lv_coord_t obj_h = lv_area_get_height(&coords);
 
+    // The layer of this frame was rendered on the other core, it only has to be copied
+    if (layer_producer && gradient_draw_layer(draw_ctx, &coords))
+    {
+        return;
+    }
+
     // Create gradient by drawing smaller blocks for good performance/quality balance
-    const int STEP = 32; // Small blocks for smooth appearance but good performance
+    const int STEP = GRADIENT_STEP;
 
     for (lv_coord_t y = 0; y < obj_h; y += STEP)
     {
@@ -131,7 +216,7 @@ static void gradient_draw_event_cb(lv_event_t *e)
             int screen_y = coords.y1 + y + STEP / 2;
 
             // Get interpolated color for this position
-            lv_color_t color = interpolate_color_idw_fast(screen_x, screen_y);
+            lv_color_t color = interpolate_color_idw_fast(dots, screen_x, screen_y);
 
             // Draw filled rectangle at this position using LVGL draw functions
             lv_area_t fill_area;
@@ -181,21 +266,198 @@ static void animation_timer_cb(lv_timer_t *timer)
             orbit_angle[i] += 6.2831853f;
     }
 
+    // With the producer, this frame draws the dots of the last one, and the new dots are drawn at the next frame
+    ColorDot *next = dots;
+    if (layer_producer)
+    {
+        memcpy(dots, layer_dots, sizeof(dots));
+        next = layer_dots;
+    }
+
     // Update dot positions with independent X/Y scaling
-    dots[0].x = orbit_cx + cosf(orbit_angle[0]) * orbit_radius[0] * orbit_scale_x;
-    dots[0].y = orbit_cy + sinf(orbit_angle[0]) * orbit_radius[0] * orbit_scale_y;
+    next[0].x = orbit_cx + cosf(orbit_angle[0]) * orbit_radius[0] * orbit_scale_x;
+    next[0].y = orbit_cy + sinf(orbit_angle[0]) * orbit_radius[0] * orbit_scale_y;
 
-    dots[1].x = orbit_cx + cosf(orbit_angle[1]) * orbit_radius[1] * orbit_scale_x;
-    dots[1].y = orbit_cy + sinf(orbit_angle[1]) * orbit_radius[1] * orbit_scale_y;
+    next[1].x = orbit_cx + cosf(orbit_angle[1]) * orbit_radius[1] * orbit_scale_x;
+    next[1].y = orbit_cy + sinf(orbit_angle[1]) * orbit_radius[1] * orbit_scale_y;
 
-    dots[2].x = orbit_cx + cosf(orbit_angle[2]) * orbit_radius[2] * orbit_scale_x;
-    dots[2].y = orbit_cy + sinf(orbit_angle[2]) * orbit_radius[2] * orbit_scale_y;
+    next[2].x = orbit_cx + cosf(orbit_angle[2]) * orbit_radius[2] * orbit_scale_x;
+    next[2].y = orbit_cy + sinf(orbit_angle[2]) * orbit_radius[2] * orbit_scale_y;
+
+    // The producer renders the layer of the new dots on the other core while this frame is rendered and presented
+    if (layer_producer)
+    {
+        lvgl_port_layer_request(++layer_seq, layer_dots, sizeof(layer_dots));
+    }
+
+    // The scanout picks the new gradient up at its next frame, nothing is redrawn
+    if (SCANOUT_GRADIENT)
+    {
+        lvgl_port_gradient_point_t points[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            points[i] = {dots[i].x, dots[i].y, dots[i].color.full};
+        }
+        lvgl_port_gradient_set_points(points, 3);
+        return;
+    }
 
     // Trigger redraw using LVGL's proper invalidation
     // This works correctly with RGB double-buffer anti-tearing
     lv_obj_invalidate(gradient_obj);
 }
 
+#if DEMO_FEATURES
+// Compare the anti-tearing modes and the copies on this screen, the configuration is restored afterwards
+static void run_benchmarks(Board *board, const lvgl_port_config_t *lvgl_config)
+{
+    if (lvgl_config->avoid_tearing_mode != LVGL_PORT_AVOID_TEARING_MODE_NONE)
+    {
+        lvgl_port_benchmark_result_t results[LVGL_PORT_AVOID_TEARING_MODE_MAX];
+        int result_num = lvgl_port_run_benchmark(BENCHMARK_FRAMES, results, LVGL_PORT_AVOID_TEARING_MODE_MAX);
+        for (int i = 0; i < result_num; i++)
+        {
+            Serial.printf("Anti-tearing mode %d: %.2f ms/frame avg, %.2f ms max (%u frames), PSRAM %.1f KB read / "
+                          "%.1f KB written per frame\n", results[i].mode, results[i].frame_us_avg / 1000.0f,
+                          results[i].frame_us_max / 1000.0f, (unsigned)results[i].frames,
+                          results[i].psram_read_avg / 1024.0f, results[i].psram_write_avg / 1024.0f);
+        }
+
+        // Replay the measured traffic of each mode against the refills of the bounce buffers of this panel
+        auto lcd = board->getLCD();
+        lvgl_port_bandwidth_sim_config_t sim_config = LVGL_PORT_BANDWIDTH_SIM_CONFIG_DEFAULT();
+        sim_config.width = lcd->getFrameWidth();
+        sim_config.height = lcd->getFrameHeight();
+        sim_config.bounce_lines = lcd->getFrameHeight() / BOUNCE_BUFFER_DIVISOR;
+        for (int i = 0; i < result_num; i++)
+        {
+            lvgl_port_bandwidth_sim_frame_t frame = {max(FRAME_MS * 1000, results[i].frame_us_avg),
+                                                     results[i].frame_us_avg, results[i].psram_read_avg,
+                                                     results[i].psram_write_avg};
+            lvgl_port_bandwidth_sim_profile_t profile;
+            lvgl_port_bandwidth_sim_result_t sim;
+            lvgl_port_bandwidth_sim_profile(
+                &profile, sim_config.width, (results[i].mode == LVGL_PORT_AVOID_TEARING_MODE_SINGLE_INDEXED) ? 1 : 2,
+                (results[i].mode == LVGL_PORT_AVOID_TEARING_MODE_SINGLE_HALF) ? 2 : 1, 0);
+            if (lvgl_port_bandwidth_sim_run(&sim_config, &profile, &frame, 1, &sim))
+            {
+                Serial.printf("Scanout of mode %d: slowest refill %u of %u us (%u%% margin, %u misses), PSRAM %u%% "
+                              "busy, safe up to %u%% of the traffic\n", results[i].mode, (unsigned)sim.refill_us_max,
+                              (unsigned)sim.deadline_us, (unsigned)sim.margin_percent, (unsigned)sim.misses,
+                              (unsigned)sim.bus_percent, (unsigned)sim.scale_max_percent);
+            }
+        }
+    }
+
+    // Time the copies of the port on one core and on both, and split them from the measured crossovers on
+    if (lvgl_config->parallel_copy)
+    {
+        lvgl_port_copy_benchmark_result_t copy_results[4];
+        int copy_result_num = lvgl_port_run_copy_benchmark(copy_results, 4);
+        for (int i = 0; i < copy_result_num; i++)
+        {
+            Serial.printf("Copy rotated by %d: %.2f ms on one core, %.2f ms on both (x%.2f), split above %u pixels\n",
+                          copy_results[i].rotation, copy_results[i].single_us / 1000.0f,
+                          copy_results[i].dual_us / 1000.0f, copy_results[i].speedup_percent / 100.0f,
+                          (unsigned)copy_results[i].crossover_px);
+        }
+    }
+}
+
+// Print the statistics of the features of the port, those that aren't running are skipped
+static void print_stats()
+{
+    lvgl_port_tile_hash_stats_t tile_stats;
+    if (lvgl_port_get_tile_hash_stats(&tile_stats) && (tile_stats.frames > 0))
+    {
+        Serial.printf("Tile hash: %u/%u frames unchanged, %.1f%% of dirty bytes skipped (%u of %u in the last frame)\n",
+                      (unsigned)tile_stats.frames_unchanged, (unsigned)tile_stats.frames,
+                      (tile_stats.dirty_bytes > 0) ? (tile_stats.skipped_bytes * 100.0f / tile_stats.dirty_bytes) : 0.0f,
+                      (unsigned)tile_stats.last_skipped_bytes, (unsigned)tile_stats.last_dirty_bytes);
+    }
+
+    lvgl_port_flush_worker_stats_t pipeline_stats;
+    if (lvgl_port_get_pipeline_stats(&pipeline_stats) && (pipeline_stats.jobs > 0))
+    {
+        Serial.printf("Pipeline: %u frames rotated on the other core in %u us avg (%u max), LVGL waited %u times "
+                      "(%.2f ms total)\n", (unsigned)pipeline_stats.jobs, (unsigned)pipeline_stats.copy_us_avg,
+                      (unsigned)pipeline_stats.copy_us_max, (unsigned)pipeline_stats.fence_waits,
+                      pipeline_stats.fence_wait_us / 1000.0f);
+    }
+
+    lvgl_port_jobs_stats_t jobs_stats;
+    if (lvgl_port_get_parallel_copy_stats(&jobs_stats) && (jobs_stats.runs > 0))
+    {
+        Serial.printf("Parallel copy: %u copies over both cores (%u tiles, %u stolen), %u inline, %.2f ms waiting for "
+                      "the other core\n", (unsigned)jobs_stats.runs, (unsigned)jobs_stats.tiles,
+                      (unsigned)jobs_stats.steals, (unsigned)jobs_stats.runs_inline, jobs_stats.wait_us / 1000.0f);
+    }
+
+    lvgl_port_layer_stats_t layer_stats;
+    lvgl_port_layer_get_stats(&layer_stats);
+    if (layer_producer && (layer_stats.produced > 0))
+    {
+        Serial.printf("Layer producer: %u gradients rendered on the other core in %u us avg (%u max), %u draws copied "
+                      "them, %u drawn inline, %u skipped, %.2f ms waiting\n", (unsigned)layer_stats.produced,
+                      (unsigned)layer_stats.render_us_avg, (unsigned)layer_stats.render_us_max,
+                      (unsigned)layer_stats.hits, (unsigned)layer_stats.misses, (unsigned)layer_stats.skipped,
+                      layer_stats.wait_us / 1000.0f);
+    }
+
+    lvgl_port_scanout_stats_t scanout_stats;
+    if (lvgl_port_get_scanout_stats(&scanout_stats) && (scanout_stats.frames > 0))
+    {
+        Serial.printf("Scanout: %.2f ms/frame, tiles %u behind / %u ahead of the beam, %u waited (%.2f ms avg), "
+                      "%u timeouts\n", scanout_stats.frame_us / 1000.0f, (unsigned)scanout_stats.bands_behind,
+                      (unsigned)scanout_stats.bands_ahead, (unsigned)scanout_stats.band_waits,
+                      (scanout_stats.band_waits > 0) ? (scanout_stats.band_wait_us / 1000.0f / scanout_stats.band_waits) : 0.0f,
+                      (unsigned)scanout_stats.band_timeouts);
+    }
+
+    lvgl_port_frame_sched_stats_t frame_stats;
+    if (lvgl_port_get_frame_sched_stats(&frame_stats) && (frame_stats.frames > 0))
+    {
+        Serial.printf("Frames: 1 per %u vsyncs of %.2f ms, %u rendered, %u late, slack %.2f ms avg / %.2f ms min, "
+                      "%u vsyncs skipped\n", (unsigned)frame_stats.divisor, frame_stats.period_us / 1000.0f,
+                      (unsigned)frame_stats.frames, (unsigned)frame_stats.missed, frame_stats.slack_us_avg / 1000.0f,
+                      frame_stats.slack_us_min / 1000.0f, (unsigned)frame_stats.skipped);
+    }
+
+    lvgl_port_timer_stats_t animation_stats;
+    lvgl_port_timer_sched_stats_t timer_stats;
+    if (lvgl_port_get_timer_stats(animation_timer, &animation_stats) && lvgl_port_get_timer_sched_stats(&timer_stats))
+    {
+        Serial.printf("Timers: animation %u us avg (%u max) over %u runs, frame %u us without the deferrable timers, "
+                      "%u deferrals, %u forced\n", (unsigned)animation_stats.cost_us_avg,
+                      (unsigned)animation_stats.cost_us_max, (unsigned)animation_stats.runs,
+                      (unsigned)timer_stats.rest_us_est, (unsigned)timer_stats.deferrals, (unsigned)timer_stats.forced);
+    }
+
+    lvgl_port_governor_stats_t governor_stats;
+    if (lvgl_port_get_governor_stats(&governor_stats))
+    {
+        Serial.printf("CPU clock: %u MHz now, %u MHz avg, %u steps up / %u down, %u late frames, load %u%% |",
+                      (unsigned)governor_stats.mhz, (unsigned)governor_stats.mhz_avg,
+                      (unsigned)governor_stats.steps_up, (unsigned)governor_stats.steps_down,
+                      (unsigned)governor_stats.late, (unsigned)governor_stats.load_percent_last);
+        for (int i = 0; i < LVGL_PORT_GOVERNOR_LEVEL_NUM; i++)
+        {
+            Serial.printf(" %u MHz %.1f s (%u frames)", (unsigned)governor_stats.level_mhz[i],
+                          governor_stats.level_us[i] / 1000000.0f, (unsigned)governor_stats.level_frames[i]);
+        }
+        Serial.println();
+    }
+
+    lvgl_port_task_stats_t task_stats;
+    if (lvgl_port_get_task_stats(&task_stats))
+    {
+        Serial.printf("LVGL task: %u wakes, %u by an event, %u touch interrupts, asleep %.1f s\n",
+                      (unsigned)task_stats.wakes, (unsigned)task_stats.wakes_by_event,
+                      (unsigned)task_stats.touch_interrupts, task_stats.sleep_us / 1000000.0f);
+    }
+}
+#endif
+
 void setup()
 {
     Serial.begin(115200);
@@ -206,39 +468,59 @@ void setup()
     Board *board = new Board();
     board->init();
 
-// Configure anti-tearing RGB double-buffer mode (ESP-BSP style)
-#if LVGL_PORT_AVOID_TEARING_MODE
-    auto lcd = board->getLCD();
+    // The anti-tearing mode and rotation are chosen at runtime, defaults come from `lvgl_v8_port.h`
+    lvgl_port_config_t lvgl_config = LVGL_PORT_CONFIG_DEFAULT();
+#if DEMO_FEATURES
+    // The gradient is quantized to RGB565 steps, so many redrawn tiles keep their pixels from one frame to the next
+    lvgl_config.tile_hash = true;
+    // Most frames of this screen leave most of their period unused, the CPUs can run slower for them
+    lvgl_config.governor = true;
+    // The rotated copies of full frames are split between both cores
+    lvgl_config.parallel_copy = true;
+    if (lvgl_config.avoid_tearing_mode != LVGL_PORT_AVOID_TEARING_MODE_NONE)
+    {
+        // Render once every vsync of the panel
+        lvgl_config.frame_divisor = 1;
+    }
+#endif
 
-    Serial.println("Configuring RGB double-buffer for anti-tearing...");
-    // Enable RGB double-buffer mode: 2 frame buffers for ping-pong operation
-    lcd->configFrameBufferNumber(2); // RGB double-buffer mode
+    // Configure anti-tearing RGB double-buffer mode (ESP-BSP style)
+    if (lvgl_config.avoid_tearing_mode != LVGL_PORT_AVOID_TEARING_MODE_NONE)
+    {
+        auto lcd = board->getLCD();
+
+        // The number of frame buffers depends on the anti-tearing mode and rotation (2 for ping-pong, 3 for triple-buffer),
+        // the boot benchmark needs enough of them to run every mode
+        int fb_num = (DEMO_FEATURES && (BENCHMARK_FRAMES > 0)) ? LVGL_PORT_FRAME_BUFFER_NUM_MAX
+                                                               : lvgl_port_get_frame_buffer_num(&lvgl_config);
+        Serial.printf("Configuring RGB %d frame buffers for anti-tearing...\n", fb_num);
+        lcd->configFrameBufferNumber(fb_num);
 
 #if ESP_PANEL_DRIVERS_BUS_ENABLE_RGB && CONFIG_IDF_TARGET_ESP32S3
-    auto lcd_bus = lcd->getBus();
+        auto lcd_bus = lcd->getBus();
 
-    // Configure bounce buffer for ESP32-S3 RGB LCD (essential for anti-tearing)
-    if (lcd_bus->getBasicAttributes().type == ESP_PANEL_BUS_TYPE_RGB)
-    {
-        Serial.println("Configuring RGB bounce buffer for ESP32-S3...");
-        // Bounce buffer size: screen_width * height_fraction (ESP-BSP recommendation)
-        // This greatly reduces tearing artifacts on ESP32-S3 RGB displays
-        int bounce_buffer_height = lcd->getFrameHeight() / 10; // 48 pixels for 480px height
-        int bounce_buffer_size = lcd->getFrameWidth() * bounce_buffer_height;
+        // Configure bounce buffer for ESP32-S3 RGB LCD (essential for anti-tearing)
+        if (lcd_bus->getBasicAttributes().type == ESP_PANEL_BUS_TYPE_RGB)
+        {
+            Serial.println("Configuring RGB bounce buffer for ESP32-S3...");
+            // Bounce buffer size: screen_width * height_fraction (ESP-BSP recommendation)
+            // This greatly reduces tearing artifacts on ESP32-S3 RGB displays
+            int bounce_buffer_height = lcd->getFrameHeight() / BOUNCE_BUFFER_DIVISOR; // 48 pixels for 480px height
+            int bounce_buffer_size = lcd->getFrameWidth() * bounce_buffer_height;
 
-        static_cast<BusRGB *>(lcd_bus)->configRGB_BounceBufferSize(bounce_buffer_size);
+            static_cast<BusRGB *>(lcd_bus)->configRGB_BounceBufferSize(bounce_buffer_size);
 
-        Serial.printf("RGB bounce buffer configured: %dx%d pixels\n",
-                      lcd->getFrameWidth(), bounce_buffer_height);
-    }
-#endif
+            Serial.printf("RGB bounce buffer configured: %dx%d pixels\n",
+                          lcd->getFrameWidth(), bounce_buffer_height);
+        }
 #endif
+    }
 
     assert(board->begin());
     Serial.println("Board initialized with anti-tearing RGB configuration!");
 
     Serial.println("Initializing LVGL with full-refresh mode...");
-    lvgl_port_init(board->getLCD(), board->getTouch());
+    lvgl_port_init_with_config(board->getLCD(), board->getTouch(), &lvgl_config);
 
     Serial.println("Creating UI with anti-tearing gradient...");
 
@@ -273,6 +555,7 @@ void setup()
     dots[0].color = lv_color_make(255, 0, 0); // Red
     dots[1].color = lv_color_make(0, 255, 0); // Green
     dots[2].color = lv_color_make(0, 0, 255); // Blue
+    memcpy(layer_dots, dots, sizeof(layer_dots));
 
     // Create background gradient object that uses proper LVGL drawing
     gradient_obj = lv_obj_create(lv_scr_act());
@@ -282,8 +565,21 @@ void setup()
     lv_obj_set_style_radius(gradient_obj, 0, 0);
     lv_obj_set_style_bg_opa(gradient_obj, LV_OPA_TRANSP, 0); // Transparent, we draw manually
 
-    // Add custom draw event for gradient rendering
-    lv_obj_add_event_cb(gradient_obj, gradient_draw_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+    if (SCANOUT_GRADIENT)
+    {
+        // The frame buffer only holds the labels on the key color, the gradient is generated at scanout
+        lv_obj_set_style_bg_color(gradient_obj, lv_color_hex(0xFF00FF), 0);
+        lv_obj_set_style_bg_opa(gradient_obj, LV_OPA_COVER, 0);
+    }
+    else
+    {
+        // Add custom draw event for gradient rendering
+        lv_obj_add_event_cb(gradient_obj, gradient_draw_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+
+        // The producer takes the core the LVGL task doesn't use, the gradient is drawn inline without it
+        layer_producer = DEMO_FEATURES && lvgl_port_layer_init(SCR_W, SCR_H, sizeof(lv_color_t), gradient_layer_render,
+                                                               NULL, LVGL_PORT_PIPELINE_CORE);
+    }
 
     // Create text labels with Cyrillic text using 96px Minecraft font
     main_label = lv_label_create(lv_scr_act());
@@ -319,10 +615,46 @@ void setup()
     // lv_obj_align(desc_label_2, LV_ALIGN_BOTTOM_MID, 0, -20);
 
     // Start animation timer
+#if DEMO_FEATURES
+    // With the frame scheduler, the animation steps once per frame, on the predicted presentation time
+    // It is frame-critical: the timers that can wait (data refreshes) are created as deferrable
+    animation_timer = lvgl_port_timer_create(animation_timer_cb, (lvgl_config.frame_divisor > 0) ? 0 : FRAME_MS, NULL,
+                                             LVGL_PORT_TIMER_CLASS_CRITICAL);
+#else
     animation_timer = lv_timer_create(animation_timer_cb, FRAME_MS, NULL);
+#endif
 
     lvgl_port_unlock();
 
+#if DEMO_FEATURES
+    if (BENCHMARK_FRAMES > 0)
+    {
+        run_benchmarks(board, &lvgl_config);
+    }
+#endif
+
+    if (SCANOUT_GRADIENT && lvgl_port_gradient_init(SCR_W, SCR_H))
+    {
+        // Only the labels are read from the frame buffer, their anti-aliased edges keep a tint of the key color
+        lvgl_port_lock(-1);
+        lv_obj_update_layout(lv_scr_act());
+        lvgl_port_copy_rect_t overlays[2];
+        lv_obj_t *labels[2] = {main_label, sub_label_1};
+        for (int i = 0; i < 2; ++i)
+        {
+            lv_area_t coords;
+            lv_obj_get_coords(labels[i], &coords);
+            overlays[i] = {(int16_t)coords.x1, (int16_t)coords.y1, (int16_t)coords.x2, (int16_t)coords.y2};
+        }
+        lvgl_port_gradient_set_overlays(overlays, 2, SCANOUT_KEY);
+        lvgl_port_unlock();
+
+        if (!lvgl_port_set_scanout_fill(lvgl_port_gradient_fill, NULL))
+        {
+            Serial.println("Scanout fill is not available in this mode, the gradient is not shown");
+        }
+    }
+
     Serial.println("=== ANTI-TEARING CONFIGURATION COMPLETE ===");
     Serial.println("RGB LCD should now display smooth animation without tearing!");
     Serial.println("Mode: RGB double-buffer + LVGL full-refresh (ESP-BSP proven solution)");
@@ -330,5 +662,13 @@ void setup()
 
 void loop()
 {
+#if DEMO_FEATURES
+    static uint32_t stats_ms = 0;
+    if (millis() - stats_ms >= STATS_PERIOD_MS)
+    {
+        stats_ms = millis();
+        print_stats();
+    }
+#endif
     delay(5);
 }
@@ -0,0 +1,244 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the copy engine, where a worker thread stands in for the GDMA: `pio test -e native`
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_async_copy.cpp"
+
+#define TEST_WIDTH              (100)
+#define TEST_HEIGHT             (40)
+#define TEST_BPP                (2)
+#define TEST_SIZE               (TEST_WIDTH * TEST_HEIGHT * TEST_BPP)
+
+static uint8_t *test_src = nullptr;
+static uint8_t *test_dst = nullptr;
+static uint8_t *test_old = nullptr;
+
+void setUp(void)
+{
+    // One more alignment unit, so the buffers can also be offset out of the DMA alignment
+    test_src = (uint8_t *)aligned_alloc(LVGL_PORT_ASYNC_COPY_ALIGN, TEST_SIZE + LVGL_PORT_ASYNC_COPY_ALIGN);
+    test_dst = (uint8_t *)aligned_alloc(LVGL_PORT_ASYNC_COPY_ALIGN, TEST_SIZE + LVGL_PORT_ASYNC_COPY_ALIGN);
+    test_old = (uint8_t *)malloc(TEST_SIZE + LVGL_PORT_ASYNC_COPY_ALIGN);
+    for (int i = 0; i < TEST_SIZE + LVGL_PORT_ASYNC_COPY_ALIGN; i++) {
+        test_src[i] = (uint8_t)(i * 7 + 1);
+        test_dst[i] = (uint8_t)(i * 13 + 5);
+    }
+    memcpy(test_old, test_dst, TEST_SIZE + LVGL_PORT_ASYNC_COPY_ALIGN);
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_init());
+}
+
+void tearDown(void)
+{
+    lvgl_port_async_copy_deinit();
+    free(test_src);
+    free(test_dst);
+    free(test_old);
+}
+
+static bool rects_contain(const lvgl_port_copy_rect_t *rects, int rect_num, int x, int y)
+{
+    for (int i = 0; i < rect_num; i++) {
+        if ((x >= rects[i].x1) && (x <= rects[i].x2) && (y >= rects[i].y1) && (y <= rects[i].y2)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool spans_contain(const lvgl_port_copy_rect_t *rects, int rect_num, int offset)
+{
+    for (int i = 0; i < rect_num; i++) {
+        int x2 = (rects[i].x2 < TEST_WIDTH) ? rects[i].x2 : (TEST_WIDTH - 1);
+        int y2 = (rects[i].y2 < TEST_HEIGHT) ? rects[i].y2 : (TEST_HEIGHT - 1);
+        for (int y = rects[i].y1; y <= y2; y++) {
+            int start = (y * TEST_WIDTH + rects[i].x1) * TEST_BPP;
+            int end = (y * TEST_WIDTH + x2 + 1) * TEST_BPP;
+            start -= start % LVGL_PORT_ASYNC_COPY_ALIGN;
+            end += (LVGL_PORT_ASYNC_COPY_ALIGN - end % LVGL_PORT_ASYNC_COPY_ALIGN) % LVGL_PORT_ASYNC_COPY_ALIGN;
+            if ((offset >= start) && (offset < end)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Every pixel of the rectangles must come from `src`. The spans are widened to the DMA alignment, so the bytes
+ * around a rectangle may come from `src` as well, but none farther away may be written.
+ */
+static void check_copy(
+    const uint8_t *dst, const uint8_t *src, const uint8_t *old, const lvgl_port_copy_rect_t *rects, int rect_num
+)
+{
+    for (int offset = 0; offset < TEST_SIZE; offset++) {
+        int pixel = offset / TEST_BPP;
+        if (rects_contain(rects, rect_num, pixel % TEST_WIDTH, pixel / TEST_WIDTH)) {
+            TEST_ASSERT_EQUAL_MESSAGE(src[offset], dst[offset], "Pixel of a rect not copied");
+        } else if (!spans_contain(rects, rect_num, offset)) {
+            TEST_ASSERT_EQUAL_MESSAGE(old[offset], dst[offset], "Byte out of the spans written");
+        } else {
+            TEST_ASSERT_TRUE_MESSAGE((dst[offset] == src[offset]) || (dst[offset] == old[offset]), "Byte corrupted");
+        }
+    }
+}
+
+static void test_copy_rects_dma(void)
+{
+    const lvgl_port_copy_rect_t rects[] = {
+        {3, 2, 17, 5},
+        {0, 10, TEST_WIDTH - 1, 19},        // Full width, a single contiguous span
+        {50, 12, 60, 25},                   // Overlaps the previous one
+        {90, 30, 120, 50},                  // Clipped to the buffer
+    };
+    const int rect_num = sizeof(rects) / sizeof(rects[0]);
+
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_arm(
+                         test_dst, test_src, rects, rect_num, TEST_WIDTH, TEST_HEIGHT, TEST_BPP
+                     ));
+    lvgl_port_async_copy_start();
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_wait(test_dst, -1));
+    check_copy(test_dst, test_src, test_old, rects, rect_num);
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_synced(test_dst));
+    TEST_ASSERT_FALSE(lvgl_port_async_copy_synced(test_src));
+
+    lvgl_port_async_copy_stats_t stats;
+    lvgl_port_async_copy_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.jobs);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.dma_requests);
+    TEST_ASSERT_TRUE(stats.dma_bytes > 0);
+    TEST_ASSERT_TRUE(stats.cpu_bytes == 0);
+    // The spans are whole units of the alignment
+    TEST_ASSERT_TRUE((stats.dma_bytes % LVGL_PORT_ASYNC_COPY_ALIGN) == 0);
+}
+
+static void test_copy_rects_unaligned(void)
+{
+    // Out of the DMA alignment, the job is copied by the CPU at the fence
+    uint8_t *dst = test_dst + TEST_BPP;
+    uint8_t *old = test_old + TEST_BPP;
+    const lvgl_port_copy_rect_t rects[] = {
+        {5, 5, 30, 8},
+        {70, 20, 99, 39},
+    };
+    const int rect_num = sizeof(rects) / sizeof(rects[0]);
+
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_arm(dst, test_src, rects, rect_num, TEST_WIDTH, TEST_HEIGHT, TEST_BPP));
+    lvgl_port_async_copy_start();
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_wait(dst, -1));
+    check_copy(dst, test_src, old, rects, rect_num);
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_synced(dst));
+
+    lvgl_port_async_copy_stats_t stats;
+    lvgl_port_async_copy_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.jobs);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dma_requests);
+    TEST_ASSERT_TRUE(stats.dma_bytes == 0);
+    TEST_ASSERT_TRUE(stats.cpu_bytes > 0);
+}
+
+static void test_fence_before_start(void)
+{
+    const lvgl_port_copy_rect_t rect = {0, 0, 9, 9};
+
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_arm(test_dst, test_src, &rect, 1, TEST_WIDTH, TEST_HEIGHT, TEST_BPP));
+    // A second job can't be armed over a pending one
+    TEST_ASSERT_FALSE(lvgl_port_async_copy_arm(test_dst, test_src, &rect, 1, TEST_WIDTH, TEST_HEIGHT, TEST_BPP));
+    // Not started, so the destination may still be on screen: the fence times out and nothing is written
+    TEST_ASSERT_FALSE(lvgl_port_async_copy_wait(test_dst, 5));
+    TEST_ASSERT_EQUAL_MEMORY(test_old, test_dst, TEST_SIZE);
+    TEST_ASSERT_FALSE(lvgl_port_async_copy_synced(test_dst));
+    // Another buffer isn't fenced
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_wait(test_src, 0));
+
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_start_from_isr() == false);
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_wait(test_dst, -1));
+    check_copy(test_dst, test_src, test_old, &rect, 1);
+}
+
+static void test_drop_armed_job(void)
+{
+    const lvgl_port_copy_rect_t rect = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_arm(test_dst, test_src, &rect, 1, TEST_WIDTH, TEST_HEIGHT, TEST_BPP));
+    // Waiting for any job drops the armed one, nothing is copied
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_wait(nullptr, 0));
+    lvgl_port_async_copy_start();
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_wait(test_dst, -1));
+    TEST_ASSERT_EQUAL_MEMORY(test_old, test_dst, TEST_SIZE);
+    TEST_ASSERT_FALSE(lvgl_port_async_copy_synced(test_dst));
+
+    // The engine takes a new job afterwards
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_arm(test_dst, test_src, &rect, 1, TEST_WIDTH, TEST_HEIGHT, TEST_BPP));
+    lvgl_port_async_copy_start();
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_wait(test_dst, -1));
+    TEST_ASSERT_EQUAL_MEMORY(test_src, test_dst, TEST_SIZE);
+}
+
+static void test_arm_invalid(void)
+{
+    const lvgl_port_copy_rect_t outside = {TEST_WIDTH, TEST_HEIGHT, TEST_WIDTH + 10, TEST_HEIGHT + 10};
+    const lvgl_port_copy_rect_t rect = {0, 0, 1, 1};
+
+    TEST_ASSERT_FALSE(lvgl_port_async_copy_arm(test_dst, test_src, &outside, 1, TEST_WIDTH, TEST_HEIGHT, TEST_BPP));
+    TEST_ASSERT_FALSE(lvgl_port_async_copy_arm(nullptr, test_src, &rect, 1, TEST_WIDTH, TEST_HEIGHT, TEST_BPP));
+    TEST_ASSERT_FALSE(lvgl_port_async_copy_arm(test_dst, test_src, &rect, 0, TEST_WIDTH, TEST_HEIGHT, TEST_BPP));
+    TEST_ASSERT_FALSE(lvgl_port_async_copy_arm(
+                          test_dst, test_src, &rect, LVGL_PORT_ASYNC_COPY_RECT_MAX + 1, TEST_WIDTH, TEST_HEIGHT,
+                          TEST_BPP
+                      ));
+    // Nothing pending
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_wait(test_dst, 0));
+}
+
+static void test_many_jobs(void)
+{
+    lvgl_port_copy_rect_t rects[LVGL_PORT_ASYNC_COPY_RECT_MAX];
+    const int job_num = 50;
+
+    srand(1);
+    for (int job = 0; job < job_num; job++) {
+        int rect_num = 1 + rand() % LVGL_PORT_ASYNC_COPY_RECT_MAX;
+        for (int i = 0; i < rect_num; i++) {
+            rects[i].x1 = rand() % TEST_WIDTH;
+            rects[i].y1 = rand() % TEST_HEIGHT;
+            rects[i].x2 = rects[i].x1 + rand() % 20;
+            rects[i].y2 = rects[i].y1 + rand() % 5;
+        }
+        // Flip the source so each job has something new to copy
+        for (int i = 0; i < TEST_SIZE; i++) {
+            test_src[i] ^= 0x5a;
+        }
+        memcpy(test_old, test_dst, TEST_SIZE);
+        TEST_ASSERT_TRUE(lvgl_port_async_copy_arm(
+                             test_dst, test_src, rects, rect_num, TEST_WIDTH, TEST_HEIGHT, TEST_BPP
+                         ));
+        lvgl_port_async_copy_start();
+        TEST_ASSERT_TRUE(lvgl_port_async_copy_wait(test_dst, -1));
+        check_copy(test_dst, test_src, test_old, rects, rect_num);
+    }
+
+    lvgl_port_async_copy_stats_t stats;
+    lvgl_port_async_copy_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(job_num, stats.jobs);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_copy_rects_dma);
+    RUN_TEST(test_copy_rects_unaligned);
+    RUN_TEST(test_fence_before_start);
+    RUN_TEST(test_drop_armed_job);
+    RUN_TEST(test_arm_invalid);
+    RUN_TEST(test_many_jobs);
+    return UNITY_END();
+}
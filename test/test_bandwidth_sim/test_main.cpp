@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the PSRAM bandwidth model: `pio test -e native`
+ */
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_bandwidth_sim.cpp"
+
+#define TEST_FRAME_NUM          (4)
+
+static lvgl_port_bandwidth_sim_config_t test_config;
+static lvgl_port_bandwidth_sim_profile_t test_copy;     // Scanout copying a RGB565 frame buffer
+static lvgl_port_bandwidth_sim_frame_t test_trace[TEST_FRAME_NUM];
+
+/**
+ * @brief Fill the trace with frames of 60 Hz, each one writing `write_bytes` and reading half of it
+ */
+static void set_trace(uint32_t write_bytes)
+{
+    for (int i = 0; i < TEST_FRAME_NUM; i++) {
+        test_trace[i].period_us = 16600;
+        test_trace[i].render_us = 8000 + 1000 * i;
+        test_trace[i].write_bytes = write_bytes;
+        test_trace[i].read_bytes = write_bytes / 2;
+    }
+}
+
+void setUp(void)
+{
+    test_config = LVGL_PORT_BANDWIDTH_SIM_CONFIG_DEFAULT();
+    lvgl_port_bandwidth_sim_profile(&test_copy, test_config.width, 2, 1, 0);
+    set_trace(0);
+}
+
+void tearDown(void)
+{
+}
+
+static void test_profiles(void)
+{
+    lvgl_port_bandwidth_sim_profile_t profile;
+
+    TEST_ASSERT_EQUAL_UINT32(1600, test_copy.refill_bytes_per_line);
+    TEST_ASSERT_EQUAL_UINT32(0, test_copy.fill_ns_per_line);
+    // The indexed mode reads a byte per pixel, the half-resolution mode a line of half the width every two lines
+    lvgl_port_bandwidth_sim_profile(&profile, 800, 1, 1, 5000);
+    TEST_ASSERT_EQUAL_UINT32(800, profile.refill_bytes_per_line);
+    TEST_ASSERT_EQUAL_UINT32(5000, profile.fill_ns_per_line);
+    lvgl_port_bandwidth_sim_profile(&profile, 800, 2, 2, 0);
+    TEST_ASSERT_EQUAL_UINT32(400, profile.refill_bytes_per_line);
+    lvgl_port_bandwidth_sim_profile(&profile, 800, 2, 0, 0);
+    TEST_ASSERT_EQUAL_UINT32(1600, profile.refill_bytes_per_line);
+}
+
+static void test_idle_screen_keeps_up(void)
+{
+    lvgl_port_bandwidth_sim_result_t result;
+
+    TEST_ASSERT_TRUE(lvgl_port_bandwidth_sim_run(&test_config, &test_copy, test_trace, TEST_FRAME_NUM, &result));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, result.refills);
+    TEST_ASSERT_EQUAL_UINT32(0, result.misses);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, result.margin_percent);
+    TEST_ASSERT_LESS_THAN_UINT32(result.deadline_us, result.refill_us_max);
+    TEST_ASSERT_EQUAL_UINT32(0, result.render_stretch_percent);
+    TEST_ASSERT_EQUAL_UINT32(LVGL_PORT_BANDWIDTH_SIM_SCALE_MAX, result.scale_max_percent);
+}
+
+static void test_heavy_traffic_misses(void)
+{
+    lvgl_port_bandwidth_sim_result_t result;
+
+    // Three full screens per frame, more than the PSRAM can give next to the scanout
+    set_trace(3 * 800 * 480 * 2);
+    TEST_ASSERT_TRUE(lvgl_port_bandwidth_sim_run(&test_config, &test_copy, test_trace, TEST_FRAME_NUM, &result));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, result.misses);
+    TEST_ASSERT_EQUAL_UINT32(0, result.margin_percent);
+    TEST_ASSERT_GREATER_THAN_UINT32(result.deadline_us, result.refill_us_max);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, result.render_stretch_percent);
+    TEST_ASSERT_LESS_THAN_UINT32(100, result.scale_max_percent);
+}
+
+static void test_safe_margin_is_the_limit(void)
+{
+    lvgl_port_bandwidth_sim_result_t result;
+    lvgl_port_bandwidth_sim_result_t scaled;
+    const uint32_t write_bytes = 800 * 480 * 2;
+
+    set_trace(write_bytes);
+    TEST_ASSERT_TRUE(lvgl_port_bandwidth_sim_run(&test_config, &test_copy, test_trace, TEST_FRAME_NUM, &result));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, result.scale_max_percent);
+    TEST_ASSERT_LESS_THAN_UINT32(LVGL_PORT_BANDWIDTH_SIM_SCALE_MAX, result.scale_max_percent);
+
+    // The trace scaled to the margin misses nothing, one percent more does
+    set_trace(write_bytes / 100 * result.scale_max_percent);
+    TEST_ASSERT_TRUE(lvgl_port_bandwidth_sim_run(&test_config, &test_copy, test_trace, TEST_FRAME_NUM, &scaled));
+    TEST_ASSERT_EQUAL_UINT32(0, scaled.misses);
+    set_trace(write_bytes / 100 * (result.scale_max_percent + 1));
+    TEST_ASSERT_TRUE(lvgl_port_bandwidth_sim_run(&test_config, &test_copy, test_trace, TEST_FRAME_NUM, &scaled));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, scaled.misses);
+}
+
+static void test_lighter_refills_leave_more_margin(void)
+{
+    lvgl_port_bandwidth_sim_profile_t indexed;
+    lvgl_port_bandwidth_sim_result_t copy_result;
+    lvgl_port_bandwidth_sim_result_t indexed_result;
+
+    set_trace(800 * 480 * 2);
+    lvgl_port_bandwidth_sim_profile(&indexed, test_config.width, 1, 1, 0);
+    TEST_ASSERT_TRUE(
+        lvgl_port_bandwidth_sim_run(&test_config, &test_copy, test_trace, TEST_FRAME_NUM, &copy_result)
+    );
+    TEST_ASSERT_TRUE(
+        lvgl_port_bandwidth_sim_run(&test_config, &indexed, test_trace, TEST_FRAME_NUM, &indexed_result)
+    );
+    TEST_ASSERT_LESS_THAN_UINT32(copy_result.refill_us_max, indexed_result.refill_us_max);
+    TEST_ASSERT_GREATER_THAN_UINT32(copy_result.scale_max_percent, indexed_result.scale_max_percent);
+}
+
+static void test_slow_fill_misses_alone(void)
+{
+    lvgl_port_bandwidth_sim_profile_t profile;
+    lvgl_port_bandwidth_sim_result_t result;
+
+    // A fill callback slower than the panel misses even without any rendering
+    uint32_t line_ns = (uint32_t)((test_config.width + test_config.hblank_px) * 1000000000ULL / test_config.pclk_hz);
+    lvgl_port_bandwidth_sim_profile(&profile, test_config.width, 2, 1, line_ns * 2);
+    TEST_ASSERT_TRUE(lvgl_port_bandwidth_sim_run(&test_config, &profile, test_trace, TEST_FRAME_NUM, &result));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, result.misses);
+    TEST_ASSERT_EQUAL_UINT32(0, result.scale_max_percent);
+}
+
+static void test_invalid_config(void)
+{
+    lvgl_port_bandwidth_sim_result_t result;
+
+    TEST_ASSERT_FALSE(lvgl_port_bandwidth_sim_run(nullptr, &test_copy, test_trace, TEST_FRAME_NUM, &result));
+    TEST_ASSERT_FALSE(lvgl_port_bandwidth_sim_run(&test_config, nullptr, test_trace, TEST_FRAME_NUM, &result));
+    TEST_ASSERT_FALSE(lvgl_port_bandwidth_sim_run(&test_config, &test_copy, test_trace, 0, &result));
+    test_config.psram_bytes_per_us = 0;
+    TEST_ASSERT_FALSE(lvgl_port_bandwidth_sim_run(&test_config, &test_copy, test_trace, TEST_FRAME_NUM, &result));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_profiles);
+    RUN_TEST(test_idle_screen_keeps_up);
+    RUN_TEST(test_heavy_traffic_misses);
+    RUN_TEST(test_safe_margin_is_the_limit);
+    RUN_TEST(test_lighter_refills_leave_more_margin);
+    RUN_TEST(test_slow_fill_misses_alone);
+    RUN_TEST(test_invalid_config);
+    return UNITY_END();
+}
@@ -0,0 +1,219 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the buffer-age damage tracking: `pio test -e native`
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_damage.cpp"
+
+#define TEST_WIDTH              (64)
+#define TEST_HEIGHT             (48)
+#define TEST_BUFFER_NUM         (3)
+
+static uint16_t test_bufs[TEST_BUFFER_NUM][TEST_WIDTH * TEST_HEIGHT];
+static uint16_t test_ref[TEST_WIDTH * TEST_HEIGHT];
+
+void setUp(void)
+{
+    srand(1);
+    TEST_ASSERT_TRUE(lvgl_port_damage_init(TEST_BUFFER_NUM, TEST_WIDTH, TEST_HEIGHT));
+}
+
+void tearDown(void)
+{
+}
+
+static void buf_copy_rect(uint16_t *dst, const uint16_t *src, const lvgl_port_copy_rect_t *rect)
+{
+    for (int y = rect->y1; y <= rect->y2; y++) {
+        memcpy(&dst[y * TEST_WIDTH + rect->x1], &src[y * TEST_WIDTH + rect->x1], (rect->x2 - rect->x1 + 1) * 2);
+    }
+}
+
+static void buf_fill_rect(uint16_t *buf, const lvgl_port_copy_rect_t *rect, uint16_t color)
+{
+    for (int y = rect->y1; y <= rect->y2; y++) {
+        for (int x = rect->x1; x <= rect->x2; x++) {
+            buf[y * TEST_WIDTH + x] = color;
+        }
+    }
+}
+
+static lvgl_port_copy_rect_t rect_random(void)
+{
+    lvgl_port_copy_rect_t rect;
+
+    rect.x1 = rand() % TEST_WIDTH;
+    rect.y1 = rand() % TEST_HEIGHT;
+    rect.x2 = rect.x1 + rand() % (TEST_WIDTH - rect.x1);
+    rect.y2 = rect.y1 + rand() % (TEST_HEIGHT - rect.y1);
+
+    return rect;
+}
+
+static bool union_contains(const lvgl_port_copy_rect_t *rects, int rect_num, int x, int y)
+{
+    for (int i = 0; i < rect_num; i++) {
+        if ((x >= rects[i].x1) && (x <= rects[i].x2) && (y >= rects[i].y1) && (y <= rects[i].y2)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_ages(void)
+{
+    const lvgl_port_copy_rect_t rect = {0, 0, 9, 9};
+    lvgl_port_copy_rect_t rects[LVGL_PORT_DAMAGE_RECT_MAX];
+
+    TEST_ASSERT_EQUAL_INT(-1, lvgl_port_damage_get_latest());
+    for (int i = 0; i < TEST_BUFFER_NUM; i++) {
+        TEST_ASSERT_EQUAL_INT(0, lvgl_port_damage_get_age(i));
+        // Undefined content, the whole screen is copied
+        TEST_ASSERT_EQUAL_INT(1, lvgl_port_damage_collect(i, rects));
+        TEST_ASSERT_EQUAL_INT(0, rects[0].x1);
+        TEST_ASSERT_EQUAL_INT(0, rects[0].y1);
+        TEST_ASSERT_EQUAL_INT(TEST_WIDTH - 1, rects[0].x2);
+        TEST_ASSERT_EQUAL_INT(TEST_HEIGHT - 1, rects[0].y2);
+    }
+
+    lvgl_port_damage_commit(0, &rect, 1);
+    lvgl_port_damage_commit(1, &rect, 1);
+    TEST_ASSERT_EQUAL_INT(1, lvgl_port_damage_get_latest());
+    TEST_ASSERT_EQUAL_INT(1, lvgl_port_damage_get_age(1));
+    TEST_ASSERT_EQUAL_INT(2, lvgl_port_damage_get_age(0));
+    TEST_ASSERT_EQUAL_INT(0, lvgl_port_damage_get_age(2));
+    // The latest buffer misses nothing
+    TEST_ASSERT_EQUAL_INT(0, lvgl_port_damage_collect(1, rects));
+}
+
+static void test_union_covers(void)
+{
+    lvgl_port_copy_rect_t rects[LVGL_PORT_DAMAGE_RECT_MAX];
+    lvgl_port_copy_rect_t added[100];
+    int rect_num = 0;
+
+    for (int i = 0; i < 100; i++) {
+        added[i] = rect_random();
+        // Small ones, so the union fills up and has to merge
+        added[i].x2 = (added[i].x1 + 3 < TEST_WIDTH) ? (added[i].x1 + 3) : (TEST_WIDTH - 1);
+        added[i].y2 = (added[i].y1 + 2 < TEST_HEIGHT) ? (added[i].y1 + 2) : (TEST_HEIGHT - 1);
+        rect_num = lvgl_port_damage_union_add(rects, rect_num, LVGL_PORT_DAMAGE_RECT_MAX, &added[i]);
+        TEST_ASSERT_LESS_OR_EQUAL(LVGL_PORT_DAMAGE_RECT_MAX, rect_num);
+    }
+    for (int i = 0; i < 100; i++) {
+        for (int y = added[i].y1; y <= added[i].y2; y++) {
+            for (int x = added[i].x1; x <= added[i].x2; x++) {
+                TEST_ASSERT_TRUE_MESSAGE(union_contains(rects, rect_num, x, y), "Pixel dropped from the union");
+            }
+        }
+    }
+}
+
+static void test_union_area(void)
+{
+    const lvgl_port_copy_rect_t overlapping[] = {{0, 0, 9, 9}, {5, 5, 14, 14}, {0, 0, 9, 9}, {20, 0, 20, 0}};
+    lvgl_port_copy_rect_t rects[LVGL_PORT_DAMAGE_RECT_MAX];
+    static bool covered[TEST_HEIGHT][TEST_WIDTH];
+
+    // Overlaps and duplicates are counted once
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_damage_union_area(overlapping, 0));
+    TEST_ASSERT_EQUAL_UINT32(100 + 100 - 25 + 1, lvgl_port_damage_union_area(overlapping, 4));
+
+    // Random unions, against the pixels they cover
+    for (int round = 0; round < 50; round++) {
+        int rect_num = 1 + rand() % LVGL_PORT_DAMAGE_RECT_MAX;
+        uint32_t pixels = 0;
+        memset(covered, 0, sizeof(covered));
+        for (int i = 0; i < rect_num; i++) {
+            rects[i] = rect_random();
+            for (int y = rects[i].y1; y <= rects[i].y2; y++) {
+                for (int x = rects[i].x1; x <= rects[i].x2; x++) {
+                    pixels += !covered[y][x];
+                    covered[y][x] = true;
+                }
+            }
+        }
+        TEST_ASSERT_EQUAL_UINT32(pixels, lvgl_port_damage_union_area(rects, rect_num));
+    }
+}
+
+/**
+ * Render frames into the buffers in turn: before each one, the collected areas are copied from the latest frame, then
+ * random areas are drawn. Every buffer must then match the reference, which is drawn to the same way.
+ */
+static void run_frames(int frame_num, int max_rects, bool skip_buffers)
+{
+    lvgl_port_copy_rect_t rects[LVGL_PORT_DAMAGE_RECT_MAX];
+    lvgl_port_copy_rect_t drawn[LVGL_PORT_DAMAGE_RECT_MAX + 8];
+    int buffer_index = 0;
+
+    memset(test_bufs, 0xff, sizeof(test_bufs));
+    memset(test_ref, 0, sizeof(test_ref));
+    for (int frame = 0; frame < frame_num; frame++) {
+        int latest = lvgl_port_damage_get_latest();
+        int rect_num = lvgl_port_damage_collect(buffer_index, rects);
+        for (int i = 0; i < rect_num; i++) {
+            // Nothing to copy from before the first frame, the buffer is all drawn by the full-screen first frame
+            if (latest >= 0) {
+                buf_copy_rect(test_bufs[buffer_index], test_bufs[latest], &rects[i]);
+            }
+        }
+
+        int drawn_num = (frame == 0) ? 1 : (1 + rand() % max_rects);
+        for (int i = 0; i < drawn_num; i++) {
+            if (frame == 0) {
+                drawn[i] = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+            } else {
+                drawn[i] = rect_random();
+            }
+            uint16_t color = (uint16_t)(frame * 31 + i + 1);
+            buf_fill_rect(test_bufs[buffer_index], &drawn[i], color);
+            buf_fill_rect(test_ref, &drawn[i], color);
+        }
+        lvgl_port_damage_commit(buffer_index, drawn, drawn_num);
+        TEST_ASSERT_EQUAL_INT(buffer_index, lvgl_port_damage_get_latest());
+        TEST_ASSERT_EQUAL_MEMORY_MESSAGE(test_ref, test_bufs[buffer_index], sizeof(test_ref), "Frame differs");
+
+        if (skip_buffers) {
+            // Any buffer but the latest, one may go unused for longer than the history
+            buffer_index = (buffer_index + 1 + rand() % (TEST_BUFFER_NUM - 1)) % TEST_BUFFER_NUM;
+        } else {
+            buffer_index = (buffer_index + 1) % TEST_BUFFER_NUM;
+        }
+    }
+}
+
+static void test_frames_in_turn(void)
+{
+    run_frames(200, 4, false);
+}
+
+static void test_frames_many_rects(void)
+{
+    // More rectangles than a frame can keep, they are merged
+    run_frames(100, LVGL_PORT_DAMAGE_RECT_MAX + 8, false);
+}
+
+static void test_frames_skipped_buffers(void)
+{
+    run_frames(200, 4, true);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ages);
+    RUN_TEST(test_union_covers);
+    RUN_TEST(test_union_area);
+    RUN_TEST(test_frames_in_turn);
+    RUN_TEST(test_frames_many_rects);
+    RUN_TEST(test_frames_skipped_buffers);
+    return UNITY_END();
+}
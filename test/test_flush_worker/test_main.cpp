@@ -0,0 +1,187 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the handoff of the render buffers to the flush worker, a thread on the host: `pio test -e native`
+ *
+ * The test renders frames into the two render buffers in turn, as the LVGL task does, and the copy callback checks that
+ * the buffer it reads isn't written meanwhile: every pixel of a rendered buffer holds the number of its frame.
+ */
+#include <atomic>
+#include <string.h>
+#include <thread>
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_flush_worker.cpp"
+
+#define TEST_SIZE               (64 * 32)
+#define TEST_FRAMES             (200)
+
+static uint16_t test_bufs[LVGL_PORT_FLUSH_WORKER_BUF_NUM][TEST_SIZE];  // Render buffers
+static uint16_t test_fb[TEST_SIZE];                                     // Frame buffer
+static int test_copy_sleep_us = 0;                  // Length of each copy
+static std::atomic<bool> test_copy_block(false);    // The copies wait until it is cleared
+static int test_torn = 0;                           // Copies that saw their buffer written meanwhile, or wrong
+                                                    // rectangles
+static int test_presented[TEST_FRAMES];             // Frame of each present, in order
+static int test_present_num = 0;
+
+static void test_copy_cb(int buf, const lvgl_port_copy_rect_t *rects, int rect_num, void *)
+{
+    // On the worker thread, the checks are counted rather than asserted
+    while (test_copy_block.load()) {
+        std::this_thread::yield();
+    }
+    if ((rect_num != 1) || (rects[0].x2 != 63) || (rects[0].y2 != 31)) {
+        test_torn++;
+    }
+    uint16_t frame = test_bufs[buf][0];
+    for (int i = 0; i < TEST_SIZE; i++) {
+        test_fb[i] = test_bufs[buf][i];
+        if (i == TEST_SIZE / 2) {
+            std::this_thread::sleep_for(std::chrono::microseconds(test_copy_sleep_us));
+        }
+    }
+    for (int i = 0; i < TEST_SIZE; i++) {
+        if (test_fb[i] != frame) {
+            test_torn++;
+            break;
+        }
+    }
+}
+
+static void test_present_cb(void *)
+{
+    if (test_present_num < TEST_FRAMES) {
+        test_presented[test_present_num] = test_fb[0];
+    }
+    test_present_num++;
+}
+
+void setUp(void)
+{
+    memset(test_bufs, 0, sizeof(test_bufs));
+    memset(test_fb, 0, sizeof(test_fb));
+    test_copy_sleep_us = 0;
+    test_copy_block.store(false);
+    test_torn = 0;
+    test_present_num = 0;
+    TEST_ASSERT_TRUE(lvgl_port_flush_worker_init(-1));
+    TEST_ASSERT_TRUE(lvgl_port_flush_worker_set_callbacks(test_copy_cb, test_present_cb, nullptr));
+}
+
+void tearDown(void)
+{
+    test_copy_block.store(false);
+    lvgl_port_flush_worker_deinit();
+}
+
+static void test_render(int buf, uint16_t frame)
+{
+    for (int i = 0; i < TEST_SIZE; i++) {
+        test_bufs[buf][i] = frame;
+    }
+}
+
+static void test_run_frames(int copy_sleep_us)
+{
+    const lvgl_port_copy_rect_t rect = {0, 0, 63, 31};
+
+    test_copy_sleep_us = copy_sleep_us;
+    for (int frame = 1; frame <= TEST_FRAMES; frame++) {
+        int buf = frame % LVGL_PORT_FLUSH_WORKER_BUF_NUM;
+        TEST_ASSERT_TRUE(lvgl_port_flush_worker_fence(buf, -1));
+        test_render(buf, frame);
+        TEST_ASSERT_TRUE(lvgl_port_flush_worker_submit(buf, &rect, 1));
+    }
+    TEST_ASSERT_TRUE(lvgl_port_flush_worker_wait_idle(-1));
+
+    TEST_ASSERT_EQUAL(0, test_torn);
+    TEST_ASSERT_EQUAL(TEST_FRAMES, test_present_num);
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        TEST_ASSERT_EQUAL(i + 1, test_presented[i]);
+    }
+    lvgl_port_flush_worker_stats_t stats;
+    lvgl_port_flush_worker_get_stats(&stats);
+    TEST_ASSERT_EQUAL(TEST_FRAMES, stats.jobs);
+}
+
+static void test_fast_worker(void)
+{
+    test_run_frames(0);
+}
+
+static void test_slow_worker_fences(void)
+{
+    test_run_frames(200);
+
+    // Rendering is faster than the copies, so LVGL had to wait for its buffers
+    lvgl_port_flush_worker_stats_t stats;
+    lvgl_port_flush_worker_get_stats(&stats);
+    TEST_ASSERT_TRUE(stats.fence_waits > 0);
+}
+
+static void test_owned_buffer_is_refused(void)
+{
+    const lvgl_port_copy_rect_t rect = {0, 0, 63, 31};
+
+    test_copy_block.store(true);
+    test_render(0, 1);
+    TEST_ASSERT_TRUE(lvgl_port_flush_worker_submit(0, &rect, 1));
+    // The buffer is the worker's until its copy is over
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_submit(0, &rect, 1));
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_fence(0, 10));
+    TEST_ASSERT_TRUE(lvgl_port_flush_worker_fence(1, 0));
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_set_callbacks(test_copy_cb, test_present_cb, nullptr));
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_wait_idle(10));
+
+    test_copy_block.store(false);
+    TEST_ASSERT_TRUE(lvgl_port_flush_worker_fence(0, -1));
+    TEST_ASSERT_TRUE(lvgl_port_flush_worker_wait_idle(-1));
+    TEST_ASSERT_EQUAL(1, test_present_num);
+    TEST_ASSERT_TRUE(lvgl_port_flush_worker_set_callbacks(test_copy_cb, test_present_cb, nullptr));
+}
+
+static void test_vsync_before_the_switch_is_dropped(void)
+{
+    lvgl_port_flush_worker_vsync_from_isr();
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_wait_vsync(10));
+
+    std::thread vsync([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        lvgl_port_flush_worker_vsync_from_isr();
+    });
+    TEST_ASSERT_TRUE(lvgl_port_flush_worker_wait_vsync(1000));
+    vsync.join();
+
+    lvgl_port_flush_worker_stats_t stats;
+    lvgl_port_flush_worker_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.vsync_timeouts);
+}
+
+static void test_invalid_arguments(void)
+{
+    const lvgl_port_copy_rect_t rects[LVGL_PORT_FLUSH_WORKER_RECT_MAX + 1] = {};
+
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_init(-1));
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_submit(-1, rects, 1));
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_submit(LVGL_PORT_FLUSH_WORKER_BUF_NUM, rects, 1));
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_submit(0, nullptr, 1));
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_submit(0, rects, LVGL_PORT_FLUSH_WORKER_RECT_MAX + 1));
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_set_callbacks(nullptr, test_present_cb, nullptr));
+    TEST_ASSERT_FALSE(lvgl_port_flush_worker_set_callbacks(test_copy_cb, nullptr, nullptr));
+    TEST_ASSERT_EQUAL(0, test_present_num);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fast_worker);
+    RUN_TEST(test_slow_worker_fences);
+    RUN_TEST(test_owned_buffer_is_refused);
+    RUN_TEST(test_vsync_before_the_switch_is_dropped);
+    RUN_TEST(test_invalid_arguments);
+    return UNITY_END();
+}
@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the frame scheduler locked to the vsync: `pio test -e native`
+ *
+ * The vsyncs are counted at a steady period of a test clock, only a vsync asking for a frame or the timeout may start
+ * one, and the frame is stamped with the first vsync after its start.
+ */
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_frame_sched.cpp"
+
+#define TEST_PERIOD_US          (16667)
+#define TEST_TIMEOUT_US         (500000)
+
+static int64_t test_now_us = 1000000;           // Never goes back, the scheduler keeps the vsync period across tests
+
+static bool test_vsync(void)
+{
+    test_now_us += TEST_PERIOD_US;
+
+    return lvgl_port_frame_sched_on_vsync(test_now_us);
+}
+
+void setUp(void)
+{
+    // A gap of several periods, ignored by the measure of the period
+    test_now_us += 10 * TEST_PERIOD_US;
+    lvgl_port_frame_sched_init(1);
+    // A frame is asked for
+    TEST_ASSERT_TRUE(test_vsync());
+}
+
+void tearDown(void)
+{
+    lvgl_port_frame_sched_init(0);
+}
+
+static void test_only_vsyncs_start_frames(void)
+{
+    lvgl_port_frame_sched_stats_t stats;
+    int64_t present_us = 0;
+
+    // The pending vsync starts the frame, a wake by a command or the touch right after it doesn't
+    TEST_ASSERT_TRUE(lvgl_port_frame_sched_begin(test_now_us + 1000, TEST_TIMEOUT_US, &present_us));
+    lvgl_port_frame_sched_end(test_now_us + 3000, true);
+    TEST_ASSERT_FALSE(lvgl_port_frame_sched_begin(test_now_us + 4000, TEST_TIMEOUT_US, &present_us));
+    TEST_ASSERT_FALSE(lvgl_port_frame_sched_begin(test_now_us + 5000, TEST_TIMEOUT_US, &present_us));
+
+    TEST_ASSERT_TRUE(test_vsync());
+    TEST_ASSERT_TRUE(lvgl_port_frame_sched_begin(test_now_us + 1000, TEST_TIMEOUT_US, &present_us));
+    lvgl_port_frame_sched_end(test_now_us + 3000, true);
+
+    lvgl_port_frame_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.wakes);
+    TEST_ASSERT_EQUAL(0, stats.timeouts);
+    TEST_ASSERT_EQUAL(2, stats.frames);
+}
+
+static void test_timeout_without_vsyncs(void)
+{
+    lvgl_port_frame_sched_stats_t stats;
+    int64_t present_us = 0;
+    int64_t start_us = test_now_us;
+
+    // The first frame after the start isn't waited for
+    lvgl_port_frame_sched_init(1);
+    TEST_ASSERT_TRUE(lvgl_port_frame_sched_begin(start_us, TEST_TIMEOUT_US, &present_us));
+    // The panel stopped: nothing before the timeout, then one frame per timeout
+    TEST_ASSERT_FALSE(lvgl_port_frame_sched_begin(start_us + TEST_TIMEOUT_US - 1, TEST_TIMEOUT_US, &present_us));
+    TEST_ASSERT_TRUE(lvgl_port_frame_sched_begin(start_us + TEST_TIMEOUT_US, TEST_TIMEOUT_US, &present_us));
+    TEST_ASSERT_FALSE(lvgl_port_frame_sched_begin(start_us + TEST_TIMEOUT_US + 1, TEST_TIMEOUT_US, &present_us));
+
+    lvgl_port_frame_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.wakes);
+    TEST_ASSERT_EQUAL(2, stats.timeouts);
+}
+
+static void test_divisor(void)
+{
+    lvgl_port_frame_sched_stats_t stats;
+    int64_t present_us = 0;
+
+    lvgl_port_frame_sched_init(3);
+    for (int i = 0; i < 9; i++) {
+        TEST_ASSERT_EQUAL((i % 3) == 2, test_vsync());
+        if ((i % 3) == 2) {
+            TEST_ASSERT_TRUE(lvgl_port_frame_sched_begin(test_now_us + 100, TEST_TIMEOUT_US, &present_us));
+        }
+    }
+
+    // Stopped, the vsyncs still measure the period but never ask for a frame
+    lvgl_port_frame_sched_init(0);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_FALSE(test_vsync());
+    }
+    lvgl_port_frame_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.divisor);
+    TEST_ASSERT_EQUAL(TEST_PERIOD_US, stats.period_us);
+}
+
+static void test_presentation_is_the_next_vsync(void)
+{
+    lvgl_port_frame_sched_stats_t stats;
+    int64_t present_us = 0;
+
+    // Two vsyncs in a row measure the period
+    TEST_ASSERT_TRUE(lvgl_port_frame_sched_begin(test_now_us + 100, TEST_TIMEOUT_US, &present_us));
+    lvgl_port_frame_sched_end(test_now_us + 200, false);
+    TEST_ASSERT_TRUE(test_vsync());
+    int64_t vsync_us = test_now_us;
+
+    // Started 5 ms after the vsync, the frame is seen at the next one
+    TEST_ASSERT_TRUE(lvgl_port_frame_sched_begin(vsync_us + 5000, TEST_TIMEOUT_US, &present_us));
+    TEST_ASSERT_EQUAL_INT64(vsync_us + TEST_PERIOD_US, present_us);
+    lvgl_port_frame_sched_end(vsync_us + 12000, true);
+
+    // Started late, after a vsync that didn't wake the task up: the first vsync after the start
+    TEST_ASSERT_TRUE(test_vsync());
+    vsync_us = test_now_us;
+    TEST_ASSERT_TRUE(lvgl_port_frame_sched_begin(vsync_us + TEST_PERIOD_US + 2000, TEST_TIMEOUT_US, &present_us));
+    TEST_ASSERT_EQUAL_INT64(vsync_us + 2 * TEST_PERIOD_US, present_us);
+    lvgl_port_frame_sched_end(vsync_us + 2 * TEST_PERIOD_US + 1000, true);
+
+    lvgl_port_frame_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.frames);
+    TEST_ASSERT_EQUAL(1, stats.missed);
+    TEST_ASSERT_EQUAL(-1000, stats.slack_us_last);
+    TEST_ASSERT_EQUAL(-1000, stats.slack_us_min);
+    TEST_ASSERT_EQUAL((TEST_PERIOD_US - 12000 - 1000) / 2, stats.slack_us_avg);
+}
+
+static void test_merged_vsyncs_are_skipped(void)
+{
+    lvgl_port_frame_sched_stats_t stats;
+    int64_t present_us = 0;
+
+    // The task starts the frame of the pending vsync only after the next two, they are merged into it
+    TEST_ASSERT_TRUE(test_vsync());
+    TEST_ASSERT_TRUE(test_vsync());
+    TEST_ASSERT_TRUE(lvgl_port_frame_sched_begin(test_now_us + 100, TEST_TIMEOUT_US, &present_us));
+    TEST_ASSERT_FALSE(lvgl_port_frame_sched_begin(test_now_us + 200, TEST_TIMEOUT_US, &present_us));
+
+    lvgl_port_frame_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.skipped);
+    TEST_ASSERT_EQUAL(1, stats.wakes);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_only_vsyncs_start_frames);
+    RUN_TEST(test_timeout_without_vsyncs);
+    RUN_TEST(test_divisor);
+    RUN_TEST(test_presentation_is_the_next_vsync);
+    RUN_TEST(test_merged_vsyncs_are_skipped);
+    return UNITY_END();
+}
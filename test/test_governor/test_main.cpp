@@ -0,0 +1,221 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the decisions of the CPU frequency governor, through replayed traces and the calls of the LVGL task:
+ * `pio test -e native`
+ *
+ * The traces are recorded at the fastest clock, with frames of 30 ms: at the default `scaling_percent` (80%), a frame
+ * takes 1.4 times as long at 160 MHz and 2.6 times as long at 80 MHz.
+ */
+#include <string.h>
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_governor.cpp"
+
+#define TEST_MHZ                (240)
+#define TEST_FRAME_US           (30000)
+#define TEST_FRAMES             (400)
+
+static lvgl_port_bandwidth_sim_frame_t test_trace[TEST_FRAMES];
+
+void setUp(void)
+{
+    memset(test_trace, 0, sizeof(test_trace));
+}
+
+void tearDown(void)
+{
+    lvgl_port_governor_deinit();
+}
+
+static void test_fill(int first, int num, uint32_t render_us, uint32_t period_us)
+{
+    for (int i = first; i < first + num; i++) {
+        test_trace[i].render_us = render_us;
+        test_trace[i].period_us = period_us;
+    }
+}
+
+static void test_light_frames_step_down(void)
+{
+    lvgl_port_governor_config_t config = LVGL_PORT_GOVERNOR_CONFIG_DEFAULT();
+    lvgl_port_governor_stats_t stats;
+
+    // 20% of the period: 28% at 160 MHz and 52% at 80 MHz, both under `down_percent`
+    test_fill(0, TEST_FRAMES, TEST_FRAME_US / 5, TEST_FRAME_US);
+    TEST_ASSERT_TRUE(lvgl_port_governor_replay(nullptr, test_trace, TEST_FRAMES, TEST_MHZ, TEST_FRAME_US, &stats));
+    TEST_ASSERT_EQUAL(160, stats.mhz);
+    TEST_ASSERT_EQUAL(1, stats.steps_down);
+    TEST_ASSERT_EQUAL(0, stats.steps_up);
+    TEST_ASSERT_EQUAL(0, stats.late);
+    TEST_ASSERT_EQUAL(TEST_FRAMES, stats.frames);
+    // The first `down_frames` frames ran at the fastest clock
+    TEST_ASSERT_EQUAL(config.down_frames, stats.level_frames[2]);
+
+    config.min_mhz = 80;
+    TEST_ASSERT_TRUE(lvgl_port_governor_replay(&config, test_trace, TEST_FRAMES, TEST_MHZ, TEST_FRAME_US, &stats));
+    TEST_ASSERT_EQUAL(80, stats.mhz);
+    TEST_ASSERT_EQUAL(2, stats.steps_down);
+    TEST_ASSERT_EQUAL(0, stats.late);
+    TEST_ASSERT_TRUE(stats.mhz_avg < 160);
+}
+
+static void test_heavy_frames_stay_fast(void)
+{
+    lvgl_port_governor_stats_t stats;
+
+    // 50% of the period is 70% at 160 MHz, over `down_percent`
+    test_fill(0, TEST_FRAMES, TEST_FRAME_US / 2, TEST_FRAME_US);
+    TEST_ASSERT_TRUE(lvgl_port_governor_replay(nullptr, test_trace, TEST_FRAMES, TEST_MHZ, TEST_FRAME_US, &stats));
+    TEST_ASSERT_EQUAL(TEST_MHZ, stats.mhz);
+    TEST_ASSERT_EQUAL(0, stats.steps_down);
+    TEST_ASSERT_EQUAL(TEST_MHZ, stats.mhz_avg);
+}
+
+static void test_load_steps_up_at_once(void)
+{
+    lvgl_port_governor_config_t config = LVGL_PORT_GOVERNOR_CONFIG_DEFAULT();
+    lvgl_port_governor_stats_t stats;
+
+    // Down to 80 MHz, then frames of 60% of the period, 156% at 80 MHz: only the first of them is late
+    config.min_mhz = 80;
+    test_fill(0, TEST_FRAMES / 2, TEST_FRAME_US / 5, TEST_FRAME_US);
+    test_fill(TEST_FRAMES / 2, TEST_FRAMES / 2, TEST_FRAME_US * 3 / 5, TEST_FRAME_US);
+    TEST_ASSERT_TRUE(lvgl_port_governor_replay(&config, test_trace, TEST_FRAMES, TEST_MHZ, TEST_FRAME_US, &stats));
+    TEST_ASSERT_EQUAL(TEST_MHZ, stats.mhz);
+    TEST_ASSERT_EQUAL(1, stats.late);
+    TEST_ASSERT_EQUAL(1, stats.steps_up);
+    TEST_ASSERT_EQUAL(2, stats.steps_down);
+
+    // Frames of 45%, 117% at 80 MHz: late, so straight to the fastest clock, where they stay (63% at 160 MHz)
+    test_fill(TEST_FRAMES / 2, TEST_FRAMES / 2, TEST_FRAME_US * 45 / 100, TEST_FRAME_US);
+    TEST_ASSERT_TRUE(lvgl_port_governor_replay(&config, test_trace, TEST_FRAMES, TEST_MHZ, TEST_FRAME_US, &stats));
+    TEST_ASSERT_EQUAL(1, stats.late);
+    TEST_ASSERT_EQUAL(1, stats.steps_up);
+}
+
+static void test_up_to_the_middle_of_the_band(void)
+{
+    lvgl_port_governor_config_t config = LVGL_PORT_GOVERNOR_CONFIG_DEFAULT();
+    lvgl_port_governor_stats_t stats;
+
+    // Down to 80 MHz, then frames of 34% of the period, 88% at 80 MHz: 48% at 160 MHz is under the middle of the band
+    config.min_mhz = 80;
+    test_fill(0, TEST_FRAMES / 2, TEST_FRAME_US / 5, TEST_FRAME_US);
+    test_fill(TEST_FRAMES / 2, TEST_FRAMES / 2, TEST_FRAME_US * 34 / 100, TEST_FRAME_US);
+    TEST_ASSERT_TRUE(lvgl_port_governor_replay(&config, test_trace, TEST_FRAMES, TEST_MHZ, TEST_FRAME_US, &stats));
+    TEST_ASSERT_EQUAL(160, stats.mhz);
+    TEST_ASSERT_EQUAL(0, stats.late);
+    TEST_ASSERT_EQUAL(1, stats.steps_up);
+}
+
+static void test_idle_drops_to_the_lowest_clock(void)
+{
+    lvgl_port_governor_stats_t stats;
+
+    // Frames of 50%, then nothing rendered for 3 s
+    test_fill(0, 10, TEST_FRAME_US / 2, TEST_FRAME_US);
+    test_trace[9].period_us = 3000000;
+    test_fill(10, 1, TEST_FRAME_US / 10, TEST_FRAME_US);
+    TEST_ASSERT_TRUE(lvgl_port_governor_replay(nullptr, test_trace, 11, TEST_MHZ, TEST_FRAME_US, &stats));
+    TEST_ASSERT_EQUAL(1, stats.idle_drops);
+    TEST_ASSERT_EQUAL(160, stats.mhz);
+    TEST_ASSERT_EQUAL(1, stats.level_frames[1]);
+}
+
+static void test_live_api(void)
+{
+    lvgl_port_governor_config_t config = LVGL_PORT_GOVERNOR_CONFIG_DEFAULT();
+    lvgl_port_governor_stats_t stats;
+    int64_t now_us = governor_time_us();
+
+    TEST_ASSERT_TRUE(lvgl_port_governor_init(nullptr));
+    TEST_ASSERT_FALSE(lvgl_port_governor_init(nullptr));
+    lvgl_port_governor_get_stats(&stats);
+    TEST_ASSERT_EQUAL(TEST_MHZ, stats.mhz);
+
+    // Light frames step down once `down_frames` of them are in a row
+    for (int i = 0; i < config.down_frames; i++) {
+        now_us += TEST_FRAME_US;
+        lvgl_port_governor_frame(now_us, TEST_FRAME_US / 5, TEST_FRAME_US);
+    }
+    lvgl_port_governor_get_stats(&stats);
+    TEST_ASSERT_EQUAL(160, stats.mhz);
+
+    // A heavy frame steps up at once
+    now_us += TEST_FRAME_US;
+    lvgl_port_governor_frame(now_us, TEST_FRAME_US * 9 / 10, TEST_FRAME_US);
+    lvgl_port_governor_get_stats(&stats);
+    TEST_ASSERT_EQUAL(TEST_MHZ, stats.mhz);
+    TEST_ASSERT_EQUAL(1, stats.steps_up);
+
+    // The drop is due `idle_ms` after the last frame
+    TEST_ASSERT_EQUAL(config.idle_ms, lvgl_port_governor_idle(now_us));
+    TEST_ASSERT_EQUAL(UINT32_MAX, lvgl_port_governor_idle(now_us + config.idle_ms * 1000LL));
+    lvgl_port_governor_get_stats(&stats);
+    TEST_ASSERT_EQUAL(160, stats.mhz);
+    TEST_ASSERT_EQUAL(1, stats.idle_drops);
+
+    // A higher lowest clock applies at once
+    config.min_mhz = TEST_MHZ;
+    TEST_ASSERT_TRUE(lvgl_port_governor_set_config(&config));
+    lvgl_port_governor_get_stats(&stats);
+    TEST_ASSERT_EQUAL(TEST_MHZ, stats.mhz);
+    config.min_mhz = 80;
+    TEST_ASSERT_TRUE(lvgl_port_governor_set_config(&config));
+
+    // Pinned, the clock stays the fastest whatever the frames
+    lvgl_port_governor_pin(true);
+    for (int i = 0; i < 2 * config.down_frames; i++) {
+        now_us += TEST_FRAME_US;
+        lvgl_port_governor_frame(now_us, TEST_FRAME_US / 10, TEST_FRAME_US);
+    }
+    TEST_ASSERT_EQUAL(UINT32_MAX, lvgl_port_governor_idle(now_us + 10 * config.idle_ms * 1000LL));
+    lvgl_port_governor_get_stats(&stats);
+    TEST_ASSERT_EQUAL(TEST_MHZ, stats.mhz);
+    lvgl_port_governor_pin(false);
+
+    TEST_ASSERT_TRUE(lvgl_port_governor_deinit());
+    TEST_ASSERT_FALSE(lvgl_port_governor_deinit());
+}
+
+static void test_invalid_config(void)
+{
+    lvgl_port_governor_config_t config = LVGL_PORT_GOVERNOR_CONFIG_DEFAULT();
+    lvgl_port_governor_stats_t stats;
+
+    test_fill(0, 1, TEST_FRAME_US / 2, TEST_FRAME_US);
+    config.min_mhz = 100;
+    TEST_ASSERT_FALSE(lvgl_port_governor_init(&config));
+    TEST_ASSERT_FALSE(lvgl_port_governor_replay(&config, test_trace, 1, TEST_MHZ, TEST_FRAME_US, &stats));
+    config = LVGL_PORT_GOVERNOR_CONFIG_DEFAULT();
+    config.down_percent = config.up_percent;
+    TEST_ASSERT_FALSE(lvgl_port_governor_init(&config));
+    config = LVGL_PORT_GOVERNOR_CONFIG_DEFAULT();
+    config.scaling_percent = 101;
+    TEST_ASSERT_FALSE(lvgl_port_governor_set_config(&config));
+    TEST_ASSERT_FALSE(lvgl_port_governor_set_config(nullptr));
+
+    TEST_ASSERT_FALSE(lvgl_port_governor_replay(nullptr, nullptr, 1, TEST_MHZ, TEST_FRAME_US, &stats));
+    TEST_ASSERT_FALSE(lvgl_port_governor_replay(nullptr, test_trace, 0, TEST_MHZ, TEST_FRAME_US, &stats));
+    TEST_ASSERT_FALSE(lvgl_port_governor_replay(nullptr, test_trace, 1, 0, TEST_FRAME_US, &stats));
+    TEST_ASSERT_FALSE(lvgl_port_governor_replay(nullptr, test_trace, 1, TEST_MHZ, 0, &stats));
+    TEST_ASSERT_FALSE(lvgl_port_governor_replay(nullptr, test_trace, 1, TEST_MHZ, TEST_FRAME_US, nullptr));
+    TEST_ASSERT_FALSE(lvgl_port_governor_deinit());
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_light_frames_step_down);
+    RUN_TEST(test_heavy_frames_stay_fast);
+    RUN_TEST(test_load_steps_up_at_once);
+    RUN_TEST(test_up_to_the_middle_of_the_band);
+    RUN_TEST(test_idle_drops_to_the_lowest_clock);
+    RUN_TEST(test_live_api);
+    RUN_TEST(test_invalid_config);
+    return UNITY_END();
+}
@@ -0,0 +1,194 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the gradient generated at scanout: `pio test -e native`
+ */
+#include <string.h>
+#include <unity.h>
+// The native environment ignores the library, the modules are built with the test
+#include "lvgl_port_gradient.cpp"
+#include "lvgl_port_scanout.cpp"
+#include "lvgl_port_scanout_sim.cpp"
+
+#define TEST_WIDTH              (200)
+#define TEST_HEIGHT             (120)
+#define TEST_KEY                (0x0000)
+
+static uint16_t test_fb[TEST_WIDTH * TEST_HEIGHT];
+static uint16_t test_line[TEST_WIDTH];
+
+void setUp(void)
+{
+    for (int i = 0; i < TEST_WIDTH * TEST_HEIGHT; i++) {
+        test_fb[i] = (uint16_t)(i * 7 + 1);
+    }
+    TEST_ASSERT_TRUE(lvgl_port_gradient_init(TEST_WIDTH, TEST_HEIGHT));
+}
+
+void tearDown(void)
+{
+    lvgl_port_scanout_set_fill(nullptr, nullptr);
+    lvgl_port_gradient_deinit();
+}
+
+/**
+ * @brief Scan out a whole frame line by line, like the refills do
+ */
+static void fill_frame(uint16_t *out)
+{
+    for (int y = 0; y < TEST_HEIGHT; y++) {
+        lvgl_port_gradient_fill(out + y * TEST_WIDTH, test_fb + y * TEST_WIDTH, 0, y, TEST_WIDTH, nullptr);
+    }
+}
+
+static void test_copies_without_points(void)
+{
+    static uint16_t out[TEST_WIDTH * TEST_HEIGHT];
+
+    fill_frame(out);
+    TEST_ASSERT_EQUAL_MEMORY(test_fb, out, sizeof(test_fb));
+}
+
+static void test_single_point_is_solid(void)
+{
+    static uint16_t out[TEST_WIDTH * TEST_HEIGHT];
+    const uint16_t colors[] = {0xF800, 0x07E0, 0x001F, 0xFFFF, 0x8410, 0x0000};
+
+    for (uint16_t color : colors) {
+        lvgl_port_gradient_point_t point = {50.0f, 30.0f, color};
+        TEST_ASSERT_TRUE(lvgl_port_gradient_set_points(&point, 1));
+        fill_frame(out);
+        for (int i = 0; i < TEST_WIDTH * TEST_HEIGHT; i++) {
+            TEST_ASSERT_EQUAL_HEX16(color, out[i]);
+        }
+    }
+}
+
+static void test_points_take_their_color(void)
+{
+    // On nodes of the grid, each point snaps its node to its color
+    const lvgl_port_gradient_point_t points[] = {
+        {0.0f, 0.0f, 0xF800},
+        {(float)(4 * LVGL_PORT_GRADIENT_CELL), (float)(2 * LVGL_PORT_GRADIENT_CELL), 0x07E0},
+        {(float)(2 * LVGL_PORT_GRADIENT_CELL), (float)(3 * LVGL_PORT_GRADIENT_CELL), 0x001F},
+    };
+
+    TEST_ASSERT_TRUE(lvgl_port_gradient_set_points(points, 3));
+    for (const lvgl_port_gradient_point_t &point : points) {
+        int x = (int)point.x;
+        int y = (int)point.y;
+        lvgl_port_gradient_fill(test_line, nullptr, 0, y, TEST_WIDTH, nullptr);
+        TEST_ASSERT_EQUAL_HEX16(point.color, test_line[x]);
+    }
+}
+
+static void test_segments_match_lines(void)
+{
+    const lvgl_port_gradient_point_t points[] = {
+        {10.0f, 10.0f, 0xF800},
+        {190.0f, 20.0f, 0x07E0},
+        {100.0f, 110.0f, 0x001F},
+    };
+    uint16_t segment[TEST_WIDTH];
+
+    // A refill may end in the middle of a line, the next one goes on from there
+    TEST_ASSERT_TRUE(lvgl_port_gradient_set_points(points, 3));
+    for (int y = 0; y < TEST_HEIGHT; y += 7) {
+        lvgl_port_gradient_fill(test_line, nullptr, 0, y, TEST_WIDTH, nullptr);
+        for (int x = 0; x < TEST_WIDTH; x += 37) {
+            int len = (x + 37 <= TEST_WIDTH) ? 37 : (TEST_WIDTH - x);
+            lvgl_port_gradient_fill(segment + x, nullptr, x, y, len, nullptr);
+        }
+        TEST_ASSERT_EQUAL_MEMORY(test_line, segment, sizeof(segment));
+    }
+}
+
+static void test_overlays_show_the_frame_buffer(void)
+{
+    const lvgl_port_gradient_point_t point = {0.0f, 0.0f, 0x8410};
+    const lvgl_port_copy_rect_t window = {20, 10, 59, 29};
+    static uint16_t out[TEST_WIDTH * TEST_HEIGHT];
+
+    test_fb[15 * TEST_WIDTH + 30] = TEST_KEY;
+    TEST_ASSERT_TRUE(lvgl_port_gradient_set_points(&point, 1));
+    TEST_ASSERT_TRUE(lvgl_port_gradient_set_overlays(&window, 1, TEST_KEY));
+    fill_frame(out);
+    for (int y = 0; y < TEST_HEIGHT; y++) {
+        for (int x = 0; x < TEST_WIDTH; x++) {
+            int i = y * TEST_WIDTH + x;
+            bool inside = (x >= window.x1) && (x <= window.x2) && (y >= window.y1) && (y <= window.y2);
+            uint16_t expected = (inside && (test_fb[i] != TEST_KEY)) ? test_fb[i] : point.color;
+            TEST_ASSERT_EQUAL_HEX16(expected, out[i]);
+        }
+    }
+}
+
+static void test_new_points_wait_for_the_frame(void)
+{
+    const lvgl_port_gradient_point_t first = {0.0f, 0.0f, 0xF800};
+    const lvgl_port_gradient_point_t second = {0.0f, 0.0f, 0x001F};
+
+    TEST_ASSERT_TRUE(lvgl_port_gradient_set_points(&first, 1));
+    lvgl_port_gradient_fill(test_line, nullptr, 0, 0, TEST_WIDTH, nullptr);
+    TEST_ASSERT_EQUAL_HEX16(first.color, test_line[0]);
+
+    // The rest of the frame keeps the gradient it started with, the next frame latches the new one
+    TEST_ASSERT_TRUE(lvgl_port_gradient_set_points(&second, 1));
+    lvgl_port_gradient_fill(test_line, nullptr, 0, 1, TEST_WIDTH, nullptr);
+    TEST_ASSERT_EQUAL_HEX16(first.color, test_line[0]);
+    lvgl_port_gradient_fill(test_line, nullptr, 0, 0, TEST_WIDTH, nullptr);
+    TEST_ASSERT_EQUAL_HEX16(second.color, test_line[0]);
+}
+
+static void test_invalid_arguments(void)
+{
+    lvgl_port_gradient_point_t points[LVGL_PORT_GRADIENT_POINT_MAX + 1] = {};
+    lvgl_port_copy_rect_t windows[LVGL_PORT_GRADIENT_OVERLAY_MAX + 1] = {};
+
+    TEST_ASSERT_FALSE(lvgl_port_gradient_set_points(nullptr, 1));
+    TEST_ASSERT_FALSE(lvgl_port_gradient_set_points(points, 0));
+    TEST_ASSERT_FALSE(lvgl_port_gradient_set_points(points, LVGL_PORT_GRADIENT_POINT_MAX + 1));
+    TEST_ASSERT_FALSE(lvgl_port_gradient_set_overlays(nullptr, 1, TEST_KEY));
+    TEST_ASSERT_FALSE(lvgl_port_gradient_set_overlays(windows, LVGL_PORT_GRADIENT_OVERLAY_MAX + 1, TEST_KEY));
+}
+
+static void test_refills_in_time(void)
+{
+    const lvgl_port_gradient_point_t points[] = {
+        {10.0f, 10.0f, 0xF800},
+        {190.0f, 20.0f, 0x07E0},
+        {100.0f, 110.0f, 0x001F},
+    };
+    const lvgl_port_copy_rect_t window = {20, 10, 59, 29};
+    lvgl_port_scanout_sim_config_t config = LVGL_PORT_SCANOUT_SIM_CONFIG_DEFAULT();
+    lvgl_port_scanout_sim_fill_result_t result;
+
+    config.width = TEST_WIDTH;
+    config.height = TEST_HEIGHT;
+    config.frames = 100;
+    TEST_ASSERT_TRUE(lvgl_port_gradient_set_points(points, 3));
+    TEST_ASSERT_TRUE(lvgl_port_gradient_set_overlays(&window, 1, TEST_KEY));
+    lvgl_port_scanout_set_fill(lvgl_port_gradient_fill, nullptr);
+    TEST_ASSERT_TRUE(lvgl_port_scanout_sim_fill(&config, test_fb, &result));
+    TEST_ASSERT_EQUAL_UINT32(config.frames * (TEST_HEIGHT / config.bounce_lines), result.refills);
+    // The host times are only meaningful against each other, a preempted refill may still miss
+    TEST_ASSERT_LESS_THAN_UINT32(100, result.load_percent);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(result.refills / 100, result.misses);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_copies_without_points);
+    RUN_TEST(test_single_point_is_solid);
+    RUN_TEST(test_points_take_their_color);
+    RUN_TEST(test_segments_match_lines);
+    RUN_TEST(test_overlays_show_the_frame_buffer);
+    RUN_TEST(test_new_points_wait_for_the_frame);
+    RUN_TEST(test_invalid_arguments);
+    RUN_TEST(test_refills_in_time);
+    return UNITY_END();
+}
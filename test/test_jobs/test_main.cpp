@@ -0,0 +1,232 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the job system, where the caller and a thread share the tiles: `pio test -e native`
+ *
+ * Every element of a range must be run by exactly one tile, whichever worker runs it, and a copy split into tiles must
+ * match the same copy in one piece.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_jobs.cpp"
+
+#define TEST_WIDTH              (200)
+#define TEST_HEIGHT             (120)
+#define TEST_SIZE               (TEST_WIDTH * TEST_HEIGHT)
+
+static uint8_t test_counts[TEST_SIZE];          // Runs of each element
+static uint16_t *test_src = nullptr;
+static uint16_t *test_dst = nullptr;
+static int test_out_of_range = 0;               // Tiles outside of the range of their call, or nested calls that
+                                                // weren't run inline
+
+void setUp(void)
+{
+    memset(test_counts, 0, sizeof(test_counts));
+    test_out_of_range = 0;
+    test_src = (uint16_t *)malloc(TEST_SIZE * sizeof(uint16_t));
+    test_dst = (uint16_t *)calloc(TEST_SIZE, sizeof(uint16_t));
+    for (int i = 0; i < TEST_SIZE; i++) {
+        test_src[i] = (uint16_t)(i * 31 + 7);
+    }
+    TEST_ASSERT_TRUE(lvgl_port_jobs_init());
+}
+
+void tearDown(void)
+{
+    lvgl_port_jobs_deinit();
+    free(test_src);
+    free(test_dst);
+}
+
+static void test_count_fn(const lvgl_port_copy_rect_t *tile, int worker, void *user_data)
+{
+    const lvgl_port_copy_rect_t *range = (const lvgl_port_copy_rect_t *)user_data;
+
+    if ((worker < 0) || (worker >= LVGL_PORT_JOBS_WORKER_NUM) || (tile->x1 < range->x1) || (tile->y1 < range->y1) ||
+            (tile->x2 > range->x2) || (tile->y2 > range->y2) || (tile->x1 > tile->x2) || (tile->y1 > tile->y2)) {
+        __atomic_fetch_add(&test_out_of_range, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    for (int y = tile->y1; y <= tile->y2; y++) {
+        for (int x = tile->x1; x <= tile->x2; x++) {
+            __atomic_fetch_add(&test_counts[y * TEST_WIDTH + x], 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void test_copy_fn(const lvgl_port_copy_rect_t *tile, int, void *)
+{
+    for (int y = tile->y1; y <= tile->y2; y++) {
+        memcpy(&test_dst[y * TEST_WIDTH + tile->x1], &test_src[y * TEST_WIDTH + tile->x1],
+               (tile->x2 - tile->x1 + 1) * sizeof(uint16_t));
+    }
+}
+
+static void test_check_counts(const lvgl_port_copy_rect_t *range)
+{
+    TEST_ASSERT_EQUAL(0, test_out_of_range);
+    for (int y = 0; y < TEST_HEIGHT; y++) {
+        for (int x = 0; x < TEST_WIDTH; x++) {
+            bool inside = (x >= range->x1) && (x <= range->x2) && (y >= range->y1) && (y <= range->y2);
+            TEST_ASSERT_EQUAL_MESSAGE(inside ? 1 : 0, test_counts[y * TEST_WIDTH + x], "Element run count");
+        }
+    }
+}
+
+static void test_every_element_once(void)
+{
+    // Whole frame, unaligned ranges, tiles that don't divide the range, and tiles of a single element
+    const lvgl_port_copy_rect_t ranges[] = {
+        {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1}, {3, 5, 190, 117}, {17, 0, 18, TEST_HEIGHT - 1}, {0, 60, 199, 61},
+    };
+    const int tile_sizes[][2] = {{TEST_WIDTH, 8}, {16, TEST_HEIGHT}, {7, 13}, {64, 64}, {1, 1}};
+
+    for (const lvgl_port_copy_rect_t &range : ranges) {
+        for (const int *tile_size : tile_sizes) {
+            memset(test_counts, 0, sizeof(test_counts));
+            lvgl_port_jobs_parallel_for(&range, tile_size[0], tile_size[1], test_count_fn, (void *)&range);
+            test_check_counts(&range);
+        }
+    }
+}
+
+static void test_copy_matches(void)
+{
+    const lvgl_port_copy_rect_t ranges[] = {{0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1}, {9, 2, 150, 3}, {1, 1, 40, 99}};
+    lvgl_port_jobs_stats_t stats;
+
+    for (const lvgl_port_copy_rect_t &range : ranges) {
+        int tile_w;
+        int tile_h;
+        memset(test_dst, 0, TEST_SIZE * sizeof(uint16_t));
+        lvgl_port_jobs_tile_size(&range, sizeof(uint16_t), &tile_w, &tile_h);
+        lvgl_port_jobs_parallel_for(&range, tile_w, tile_h, test_copy_fn, nullptr);
+        for (int y = 0; y < TEST_HEIGHT; y++) {
+            for (int x = 0; x < TEST_WIDTH; x++) {
+                bool inside = (x >= range.x1) && (x <= range.x2) && (y >= range.y1) && (y <= range.y2);
+                TEST_ASSERT_EQUAL_HEX16(inside ? test_src[y * TEST_WIDTH + x] : 0, test_dst[y * TEST_WIDTH + x]);
+            }
+        }
+    }
+
+    // The whole frame is large enough to be spread over the workers
+    lvgl_port_jobs_get_stats(&stats);
+    TEST_ASSERT_TRUE(stats.runs > 0);
+    TEST_ASSERT_TRUE(stats.tiles >= 2 * stats.runs);
+}
+
+static void test_tile_size(void)
+{
+    const lvgl_port_copy_rect_t tall = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+    const lvgl_port_copy_rect_t flat = {5, 10, 196, 11};
+    int tile_w;
+    int tile_h;
+
+    // Enough lines: bands of whole lines, at least `LVGL_PORT_JOBS_TILE_MIN_BYTES` each
+    lvgl_port_jobs_tile_size(&tall, sizeof(uint16_t), &tile_w, &tile_h);
+    TEST_ASSERT_EQUAL(TEST_WIDTH, tile_w);
+    TEST_ASSERT_TRUE(tile_w * tile_h * (int)sizeof(uint16_t) >= LVGL_PORT_JOBS_TILE_MIN_BYTES);
+    TEST_ASSERT_TRUE(tile_h < TEST_HEIGHT);
+
+    // Too few lines: columns as high as the range, cut on cache lines
+    lvgl_port_jobs_tile_size(&flat, sizeof(uint16_t), &tile_w, &tile_h);
+    TEST_ASSERT_EQUAL(flat.y2 + 1, tile_h);
+    TEST_ASSERT_EQUAL(0, (tile_w * (int)sizeof(uint16_t)) % LVGL_PORT_JOBS_CACHE_LINE);
+    TEST_ASSERT_TRUE(tile_w * (flat.y2 - flat.y1 + 1) * (int)sizeof(uint16_t) >= LVGL_PORT_JOBS_TILE_MIN_BYTES);
+}
+
+static void test_slow_first_half_fn(const lvgl_port_copy_rect_t *tile, int worker, void *user_data)
+{
+    if (tile->y1 < TEST_HEIGHT / 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    test_count_fn(tile, worker, user_data);
+}
+
+static void test_steals_even_out(void)
+{
+    const lvgl_port_copy_rect_t range = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+    lvgl_port_jobs_stats_t stats;
+
+    // The tiles of the share of the caller are slow, the other worker steals some of them
+    lvgl_port_jobs_parallel_for(&range, TEST_WIDTH, 8, test_slow_first_half_fn, (void *)&range);
+    test_check_counts(&range);
+    lvgl_port_jobs_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.runs);
+    TEST_ASSERT_EQUAL(TEST_HEIGHT / 8, stats.tiles);
+    TEST_ASSERT_TRUE(stats.steals > 0);
+}
+
+static void test_nested_fn(const lvgl_port_copy_rect_t *tile, int, void *)
+{
+    // On either worker, the checks are counted rather than asserted
+    if (lvgl_port_jobs_parallel_for(tile, 50, 5, test_copy_fn, nullptr)) {
+        __atomic_fetch_add(&test_out_of_range, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void test_nested_call_runs_inline(void)
+{
+    const lvgl_port_copy_rect_t range = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+    lvgl_port_jobs_stats_t stats;
+
+    // Each tile of the outer call copies its lines with a call of its own, which can only run inline
+    TEST_ASSERT_TRUE(lvgl_port_jobs_parallel_for(&range, TEST_WIDTH, 10, test_nested_fn, nullptr));
+    TEST_ASSERT_EQUAL(0, test_out_of_range);
+    TEST_ASSERT_EQUAL_MEMORY(test_src, test_dst, TEST_SIZE * sizeof(uint16_t));
+    lvgl_port_jobs_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.runs);
+    TEST_ASSERT_EQUAL(TEST_HEIGHT / 10, stats.runs_inline);
+}
+
+static void test_inline_without_workers(void)
+{
+    const lvgl_port_copy_rect_t range = {2, 3, 100, 90};
+    const lvgl_port_copy_rect_t single = {0, 0, 9, 9};
+
+    // A single tile isn't worth waking the other worker up
+    TEST_ASSERT_FALSE(lvgl_port_jobs_parallel_for(&single, 16, 16, test_count_fn, (void *)&single));
+    test_check_counts(&single);
+
+    TEST_ASSERT_TRUE(lvgl_port_jobs_deinit());
+    memset(test_counts, 0, sizeof(test_counts));
+    TEST_ASSERT_FALSE(lvgl_port_jobs_parallel_for(&range, 16, 16, test_count_fn, (void *)&range));
+    test_check_counts(&range);
+}
+
+static void test_invalid_arguments(void)
+{
+    const lvgl_port_copy_rect_t range = {0, 0, 9, 9};
+    const lvgl_port_copy_rect_t reversed = {9, 0, 0, 9};
+    const lvgl_port_copy_rect_t negative = {-1, 0, 9, 9};
+
+    TEST_ASSERT_FALSE(lvgl_port_jobs_parallel_for(nullptr, 4, 4, test_count_fn, nullptr));
+    TEST_ASSERT_FALSE(lvgl_port_jobs_parallel_for(&range, 4, 4, nullptr, nullptr));
+    TEST_ASSERT_FALSE(lvgl_port_jobs_parallel_for(&range, 0, 4, test_count_fn, (void *)&range));
+    TEST_ASSERT_FALSE(lvgl_port_jobs_parallel_for(&range, 4, -1, test_count_fn, (void *)&range));
+    TEST_ASSERT_FALSE(lvgl_port_jobs_parallel_for(&reversed, 4, 4, test_count_fn, (void *)&reversed));
+    TEST_ASSERT_FALSE(lvgl_port_jobs_parallel_for(&negative, 4, 4, test_count_fn, (void *)&negative));
+    for (int i = 0; i < TEST_SIZE; i++) {
+        TEST_ASSERT_EQUAL(0, test_counts[i]);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_every_element_once);
+    RUN_TEST(test_copy_matches);
+    RUN_TEST(test_tile_size);
+    RUN_TEST(test_steals_even_out);
+    RUN_TEST(test_nested_call_runs_inline);
+    RUN_TEST(test_inline_without_workers);
+    RUN_TEST(test_invalid_arguments);
+    return UNITY_END();
+}
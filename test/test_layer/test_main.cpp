@@ -0,0 +1,176 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the background layer producer, a thread on the host: `pio test -e native`
+ *
+ * The render callback fills the layer with the value passed in the parameters of its request, and can be held back to
+ * play a producer that is late or busy.
+ */
+#include <atomic>
+#include <thread>
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_layer.cpp"
+
+#define TEST_WIDTH              (32)
+#define TEST_HEIGHT             (16)
+#define TEST_SIZE               (TEST_WIDTH * TEST_HEIGHT)
+
+static std::atomic<bool> test_render_block(false);  // The renders wait until it is cleared
+static std::atomic<int> test_render_started(0);     // Renders started so far
+static int test_wrong_size = 0;                     // Renders called with a wrong layer size
+
+static void test_render_cb(void *layer, int width, int height, const void *params, void *)
+{
+    // On the producer thread, the checks are counted rather than asserted
+    test_render_started++;
+    while (test_render_block.load()) {
+        std::this_thread::yield();
+    }
+    if ((width != TEST_WIDTH) || (height != TEST_HEIGHT)) {
+        test_wrong_size++;
+        return;
+    }
+    uint16_t value = *(const uint16_t *)params;
+    for (int i = 0; i < TEST_SIZE; i++) {
+        ((uint16_t *)layer)[i] = value;
+    }
+}
+
+static void test_wait_render_started(int num)
+{
+    while (test_render_started.load() < num) {
+        std::this_thread::yield();
+    }
+}
+
+static void test_check_layer(const void *layer, uint16_t value)
+{
+    TEST_ASSERT_NOT_NULL(layer);
+    for (int i = 0; i < TEST_SIZE; i++) {
+        TEST_ASSERT_EQUAL_HEX16(value, ((const uint16_t *)layer)[i]);
+    }
+}
+
+static void test_request(uint32_t seq)
+{
+    uint16_t value = (uint16_t)(seq * 0x101);
+
+    TEST_ASSERT_TRUE(lvgl_port_layer_request(seq, &value, sizeof(value)));
+}
+
+void setUp(void)
+{
+    test_render_block.store(false);
+    test_render_started.store(0);
+    test_wrong_size = 0;
+    TEST_ASSERT_TRUE(lvgl_port_layer_init(TEST_WIDTH, TEST_HEIGHT, sizeof(uint16_t), test_render_cb, nullptr, -1));
+}
+
+void tearDown(void)
+{
+    test_render_block.store(false);
+    lvgl_port_layer_deinit();
+}
+
+static void test_request_and_acquire(void)
+{
+    lvgl_port_layer_stats_t stats;
+
+    // Frame after frame, each layer is acquired once per draw of its frame
+    for (uint32_t seq = 1; seq <= 20; seq++) {
+        test_request(seq);
+        const void *layer = lvgl_port_layer_acquire(seq, 1000);
+        test_check_layer(layer, seq * 0x101);
+        TEST_ASSERT_EQUAL_PTR(layer, lvgl_port_layer_acquire(seq, 0));
+    }
+
+    lvgl_port_layer_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, test_wrong_size);
+    TEST_ASSERT_EQUAL(20, stats.requests);
+    TEST_ASSERT_EQUAL(20, stats.produced);
+    TEST_ASSERT_EQUAL(0, stats.skipped);
+    TEST_ASSERT_EQUAL(40, stats.hits);
+    TEST_ASSERT_EQUAL(0, stats.misses);
+}
+
+static void test_busy_producer_skips(void)
+{
+    lvgl_port_layer_stats_t stats;
+
+    // Frame 2 is replaced by frame 3 before the producer, still busy with frame 1, could start it
+    test_render_block.store(true);
+    test_request(1);
+    test_wait_render_started(1);
+    test_request(2);
+    test_request(3);
+
+    // A skipped layer is never waited for
+    TEST_ASSERT_NULL(lvgl_port_layer_acquire(2, 1000));
+    test_render_block.store(false);
+    test_check_layer(lvgl_port_layer_acquire(3, 1000), 3 * 0x101);
+    // The layer of the last frame is still there
+    test_check_layer(lvgl_port_layer_acquire(1, 0), 1 * 0x101);
+
+    lvgl_port_layer_get_stats(&stats);
+    TEST_ASSERT_EQUAL(3, stats.requests);
+    TEST_ASSERT_EQUAL(2, stats.produced);
+    TEST_ASSERT_EQUAL(1, stats.skipped);
+    TEST_ASSERT_EQUAL(2, stats.hits);
+    TEST_ASSERT_EQUAL(1, stats.misses);
+    TEST_ASSERT_TRUE(stats.wait_us < 1000000);
+}
+
+static void test_late_producer_misses(void)
+{
+    lvgl_port_layer_stats_t stats;
+
+    // The producer doesn't make it in time, the frame is rendered inline
+    test_render_block.store(true);
+    test_request(1);
+    TEST_ASSERT_NULL(lvgl_port_layer_acquire(1, 10));
+    TEST_ASSERT_NULL(lvgl_port_layer_acquire(1, 0));
+
+    // Once over, the layer can still be acquired
+    test_render_block.store(false);
+    test_check_layer(lvgl_port_layer_acquire(1, 1000), 1 * 0x101);
+
+    lvgl_port_layer_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.produced);
+    TEST_ASSERT_EQUAL(1, stats.hits);
+    TEST_ASSERT_EQUAL(2, stats.misses);
+    TEST_ASSERT_TRUE(stats.wait_us >= 10000);
+}
+
+static void test_invalid_arguments(void)
+{
+    uint8_t params[LVGL_PORT_LAYER_PARAMS_MAX + 1] = {};
+
+    TEST_ASSERT_FALSE(lvgl_port_layer_init(TEST_WIDTH, TEST_HEIGHT, sizeof(uint16_t), test_render_cb, nullptr, -1));
+    TEST_ASSERT_FALSE(lvgl_port_layer_request(0, params, sizeof(uint16_t)));
+    TEST_ASSERT_FALSE(lvgl_port_layer_request(1, params, sizeof(params)));
+    TEST_ASSERT_FALSE(lvgl_port_layer_request(1, nullptr, sizeof(uint16_t)));
+    TEST_ASSERT_NULL(lvgl_port_layer_acquire(0, 0));
+    // A layer never requested isn't waited for
+    TEST_ASSERT_NULL(lvgl_port_layer_acquire(1, 1000));
+
+    TEST_ASSERT_TRUE(lvgl_port_layer_deinit());
+    TEST_ASSERT_FALSE(lvgl_port_layer_deinit());
+    TEST_ASSERT_FALSE(lvgl_port_layer_request(1, params, sizeof(uint16_t)));
+    TEST_ASSERT_FALSE(lvgl_port_layer_init(0, TEST_HEIGHT, sizeof(uint16_t), test_render_cb, nullptr, -1));
+    TEST_ASSERT_FALSE(lvgl_port_layer_init(TEST_WIDTH, TEST_HEIGHT, sizeof(uint16_t), nullptr, nullptr, -1));
+    TEST_ASSERT_EQUAL(0, test_render_started.load());
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_request_and_acquire);
+    RUN_TEST(test_busy_producer_skips);
+    RUN_TEST(test_late_producer_misses);
+    RUN_TEST(test_invalid_arguments);
+    return UNITY_END();
+}
@@ -0,0 +1,186 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the 8 bpp indexed mode expanded at scanout: `pio test -e native`
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_palette.cpp"
+
+#define TEST_WIDTH              (96)
+#define TEST_HEIGHT             (16)
+
+static uint8_t test_indices[TEST_WIDTH * TEST_HEIGHT];
+static uint16_t test_line[TEST_WIDTH];
+
+/**
+ * @brief Scan out the first segment of a frame, which latches a pending palette
+ */
+static void start_frame(void)
+{
+    lvgl_port_palette_fill(test_line, nullptr, 0, 0, 1, nullptr);
+}
+
+void setUp(void)
+{
+    srand(1);
+    for (int i = 0; i < TEST_WIDTH * TEST_HEIGHT; i++) {
+        test_indices[i] = (uint8_t)rand();
+    }
+    TEST_ASSERT_TRUE(lvgl_port_palette_init(test_indices, TEST_WIDTH, TEST_HEIGHT));
+}
+
+void tearDown(void)
+{
+    uint16_t colors[LVGL_PORT_PALETTE_SIZE];
+
+    // The palette outlives the module's frame buffer, the next test starts from RGB332 again
+    for (int i = 0; i < LVGL_PORT_PALETTE_SIZE; i++) {
+        colors[i] = lvgl_port_palette_rgb332(i);
+    }
+    lvgl_port_palette_set(colors, 0, LVGL_PORT_PALETTE_SIZE);
+    start_frame();
+    lvgl_port_palette_deinit();
+}
+
+static void test_rgb332_range(void)
+{
+    TEST_ASSERT_EQUAL_HEX16(0x0000, lvgl_port_palette_rgb332(0x00));
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, lvgl_port_palette_rgb332(0xFF));
+    TEST_ASSERT_EQUAL_HEX16(0xF800, lvgl_port_palette_rgb332(0xE0));
+    TEST_ASSERT_EQUAL_HEX16(0x07E0, lvgl_port_palette_rgb332(0x1C));
+    TEST_ASSERT_EQUAL_HEX16(0x001F, lvgl_port_palette_rgb332(0x03));
+}
+
+static void test_expand_is_bit_exact(void)
+{
+    uint16_t palette[LVGL_PORT_PALETTE_SIZE];
+    uint16_t out[TEST_WIDTH + 2];
+
+    for (int i = 0; i < LVGL_PORT_PALETTE_SIZE; i++) {
+        palette[i] = (uint16_t)rand();
+    }
+    // Every alignment of the indices and every length around the word reads
+    for (int offset = 0; offset < 4; offset++) {
+        for (int len = 0; len <= TEST_WIDTH - offset; len++) {
+            out[len] = 0x5A5A;
+            lvgl_port_palette_expand(out, test_indices + offset, len, palette);
+            for (int i = 0; i < len; i++) {
+                TEST_ASSERT_EQUAL_HEX16(palette[test_indices[offset + i]], out[i]);
+            }
+            TEST_ASSERT_EQUAL_HEX16(0x5A5A, out[len]);
+        }
+    }
+}
+
+static void test_convert_keeps_palette_colors(void)
+{
+    uint16_t pixels[PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE];
+    uint8_t indices[PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE];
+
+    // A color of the palette maps back to its index at every phase of the dither
+    for (int index = 0; index < LVGL_PORT_PALETTE_SIZE; index++) {
+        for (int i = 0; i < PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE; i++) {
+            pixels[i] = lvgl_port_palette_rgb332(index);
+        }
+        lvgl_port_palette_convert(
+            indices, PALETTE_DITHER_SIZE, pixels, PALETTE_DITHER_SIZE, 0, 0, PALETTE_DITHER_SIZE, PALETTE_DITHER_SIZE
+        );
+        for (int i = 0; i < PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE; i++) {
+            TEST_ASSERT_EQUAL_UINT8(index, indices[i]);
+        }
+    }
+}
+
+static void test_convert_dithers_between_levels(void)
+{
+    uint16_t pixels[PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE];
+    uint8_t indices[PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE];
+
+    // Every red between two levels of the palette averages out over the matrix to about itself
+    for (int red = 0; red < 32; red++) {
+        for (int i = 0; i < PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE; i++) {
+            pixels[i] = (uint16_t)(red << 11);
+        }
+        lvgl_port_palette_convert(
+            indices, PALETTE_DITHER_SIZE, pixels, PALETTE_DITHER_SIZE, 0, 0, PALETTE_DITHER_SIZE, PALETTE_DITHER_SIZE
+        );
+        int sum = 0;
+        for (int i = 0; i < PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE; i++) {
+            TEST_ASSERT_EQUAL_UINT8(0, indices[i] & 0x1F);
+            sum += lvgl_port_palette_rgb332(indices[i]) >> 11;
+        }
+        TEST_ASSERT_INT_WITHIN(3, red * PALETTE_DITHER_SIZE * PALETTE_DITHER_SIZE, sum);
+    }
+}
+
+static void test_fill_expands_the_frame_buffer(void)
+{
+    for (int y = 0; y < TEST_HEIGHT; y++) {
+        lvgl_port_palette_fill(test_line, nullptr, 0, y, TEST_WIDTH, nullptr);
+        for (int x = 0; x < TEST_WIDTH; x++) {
+            TEST_ASSERT_EQUAL_HEX16(lvgl_port_palette_rgb332(test_indices[y * TEST_WIDTH + x]), test_line[x]);
+        }
+    }
+}
+
+static void test_new_colors_wait_for_the_frame(void)
+{
+    const uint16_t color = 0x1234;
+    const uint8_t index = test_indices[TEST_WIDTH];
+
+    start_frame();
+    TEST_ASSERT_TRUE(lvgl_port_palette_set(&color, index, 1));
+    // The rest of the frame keeps the palette it started with, the next frame latches the new one
+    lvgl_port_palette_fill(test_line, nullptr, 0, 1, TEST_WIDTH, nullptr);
+    TEST_ASSERT_EQUAL_HEX16(lvgl_port_palette_rgb332(index), test_line[0]);
+    start_frame();
+    lvgl_port_palette_fill(test_line, nullptr, 0, 1, TEST_WIDTH, nullptr);
+    TEST_ASSERT_EQUAL_HEX16(color, test_line[0]);
+    for (int x = 1; x < TEST_WIDTH; x++) {
+        uint8_t other = test_indices[TEST_WIDTH + x];
+        TEST_ASSERT_EQUAL_HEX16((other == index) ? color : lvgl_port_palette_rgb332(other), test_line[x]);
+    }
+}
+
+static void test_fill_copies_without_indices(void)
+{
+    uint16_t src[TEST_WIDTH];
+
+    for (int x = 0; x < TEST_WIDTH; x++) {
+        src[x] = (uint16_t)rand();
+    }
+    lvgl_port_palette_deinit();
+    lvgl_port_palette_fill(test_line, src, 0, 3, TEST_WIDTH, nullptr);
+    TEST_ASSERT_EQUAL_MEMORY(src, test_line, sizeof(src));
+}
+
+static void test_invalid_arguments(void)
+{
+    uint16_t colors[LVGL_PORT_PALETTE_SIZE] = {};
+
+    TEST_ASSERT_FALSE(lvgl_port_palette_init(nullptr, TEST_WIDTH, TEST_HEIGHT));
+    TEST_ASSERT_FALSE(lvgl_port_palette_init(test_indices, 0, TEST_HEIGHT));
+    TEST_ASSERT_FALSE(lvgl_port_palette_set(nullptr, 0, 1));
+    TEST_ASSERT_FALSE(lvgl_port_palette_set(colors, -1, 1));
+    TEST_ASSERT_FALSE(lvgl_port_palette_set(colors, 1, LVGL_PORT_PALETTE_SIZE));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rgb332_range);
+    RUN_TEST(test_expand_is_bit_exact);
+    RUN_TEST(test_convert_keeps_palette_colors);
+    RUN_TEST(test_convert_dithers_between_levels);
+    RUN_TEST(test_fill_expands_the_frame_buffer);
+    RUN_TEST(test_new_colors_wait_for_the_frame);
+    RUN_TEST(test_fill_copies_without_indices);
+    RUN_TEST(test_invalid_arguments);
+    return UNITY_END();
+}
@@ -0,0 +1,284 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the policies of the flush pipeline: `pio test -e native`
+ *
+ * The flush callbacks of `lvgl_v8_port.cpp` need LVGL and the LCD, so each entry of `lvgl_port_strategies[]` is run
+ * here as the sequence of copies its flush callback makes, with the same rotation and synchronization policies. After
+ * every frame, the frame buffer on screen must match the frame of LVGL rotated pixel by pixel.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+// The native environment ignores the library, the modules are built with the test
+#include "lvgl_port_async_copy.cpp"
+#include "lvgl_port_jobs.cpp"
+#include "lvgl_port_pipeline.hpp"
+
+using namespace lvgl_port;
+
+#define TEST_WIDTH              (100)   // LVGL's frame
+#define TEST_HEIGHT             (40)
+#define TEST_SIZE               (TEST_WIDTH * TEST_HEIGHT)
+#define TEST_FRAMES             (60)
+
+typedef uint16_t test_pixel_t;
+
+static test_pixel_t *test_lvgl = nullptr;       // Frame rendered by LVGL, not rotated
+static test_pixel_t *test_fbs[2] = {};          // Frame buffers of the LCD
+static test_pixel_t *test_ref = nullptr;        // Frame of LVGL rotated pixel by pixel
+
+void setUp(void)
+{
+    srand(1);
+    test_lvgl = (test_pixel_t *)calloc(TEST_SIZE, sizeof(test_pixel_t));
+    test_ref = (test_pixel_t *)calloc(TEST_SIZE, sizeof(test_pixel_t));
+    for (int i = 0; i < 2; i++) {
+        // Aligned for the DMA, so `SyncAsync` doesn't fall back to the CPU
+        test_fbs[i] = (test_pixel_t *)aligned_alloc(LVGL_PORT_ASYNC_COPY_ALIGN, TEST_SIZE * sizeof(test_pixel_t));
+        memset(test_fbs[i], 0xa5, TEST_SIZE * sizeof(test_pixel_t));
+    }
+    TEST_ASSERT_TRUE(lvgl_port_async_copy_init());
+    TEST_ASSERT_TRUE(lvgl_port_jobs_init());
+}
+
+void tearDown(void)
+{
+    lvgl_port_jobs_deinit();
+    lvgl_port_async_copy_deinit();
+    free(test_lvgl);
+    free(test_ref);
+    free(test_fbs[0]);
+    free(test_fbs[1]);
+}
+
+/**
+ * @brief Rotate the frame of LVGL pixel by pixel, independently of the steps of the policies
+ */
+static void reference_rotate(int degree)
+{
+    for (int y = 0; y < TEST_HEIGHT; y++) {
+        for (int x = 0; x < TEST_WIDTH; x++) {
+            int row = y;
+            int col = x;
+            int fb_w = TEST_WIDTH;
+            switch (degree) {
+            case 90:
+                row = TEST_WIDTH - 1 - x;
+                col = y;
+                fb_w = TEST_HEIGHT;
+                break;
+            case 180:
+                row = TEST_HEIGHT - 1 - y;
+                col = TEST_WIDTH - 1 - x;
+                break;
+            case 270:
+                row = x;
+                col = TEST_HEIGHT - 1 - y;
+                fb_w = TEST_HEIGHT;
+                break;
+            default:
+                break;
+            }
+            test_ref[row * fb_w + col] = test_lvgl[y * TEST_WIDTH + x];
+        }
+    }
+}
+
+/**
+ * @brief Draw a frame: random areas of LVGL's frame get new pixels
+ *
+ * @return Number of dirty areas
+ */
+static int render_frame(int frame, lvgl_port_copy_rect_t *dirty)
+{
+    if (frame == 0) {
+        dirty[0] = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+    }
+    int dirty_num = (frame == 0) ? 1 : (1 + rand() % 6);
+    for (int i = 0; i < dirty_num; i++) {
+        if (frame > 0) {
+            dirty[i].x1 = rand() % TEST_WIDTH;
+            dirty[i].y1 = rand() % TEST_HEIGHT;
+            dirty[i].x2 = dirty[i].x1 + rand() % (TEST_WIDTH - dirty[i].x1);
+            dirty[i].y2 = dirty[i].y1 + rand() % (TEST_HEIGHT - dirty[i].y1);
+        }
+        for (int y = dirty[i].y1; y <= dirty[i].y2; y++) {
+            for (int x = dirty[i].x1; x <= dirty[i].x2; x++) {
+                test_lvgl[y * TEST_WIDTH + x] = (test_pixel_t)rand();
+            }
+        }
+    }
+
+    return dirty_num;
+}
+
+template <class Rotation, bool Parallel>
+static void copy_rotated(const void *from, void *to, const lvgl_port_copy_rect_t &rect)
+{
+    if (Parallel) {
+        rotate_copy_parallel<Rotation, test_pixel_t>(from, to, rect, TEST_WIDTH, TEST_HEIGHT);
+    } else {
+        rotate_copy<Rotation, test_pixel_t>(from, to, rect, TEST_WIDTH, TEST_HEIGHT);
+    }
+}
+
+static void check_shown(const test_pixel_t *fb, int degree)
+{
+    reference_rotate(degree);
+    TEST_ASSERT_EQUAL_MEMORY_MESSAGE(test_ref, fb, TEST_SIZE * sizeof(test_pixel_t), "Frame on screen differs");
+}
+
+/**
+ * @brief `STRATEGY_FULL_ROTATED` and the full modes: the whole frame is rotated into the frame buffer off screen
+ */
+template <class Rotation, bool Parallel>
+static void run_full(void)
+{
+    lvgl_port_copy_rect_t dirty[8];
+    const lvgl_port_copy_rect_t full = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+    int shown = 1;
+
+    for (int frame = 0; frame < TEST_FRAMES; frame++) {
+        render_frame(frame, dirty);
+        shown ^= 1;
+        copy_rotated<Rotation, Parallel>(test_lvgl, test_fbs[shown], full);
+        check_shown(test_fbs[shown], Rotation::degree);
+    }
+}
+
+/**
+ * @brief `STRATEGY_DIRECT` and `STRATEGY_DIRECT_ROTATED`: the dirty areas are rotated into the frame buffer off screen,
+ *        which is switched to, then brought into the other frame buffer, by `Sync` from the frame buffer on screen if
+ *        it can arm the copy, by the CPU from LVGL's frame otherwise
+ */
+template <class Rotation, class Sync, bool Parallel>
+static void run_direct(void)
+{
+    lvgl_port_copy_rect_t dirty[8];
+    lvgl_port_copy_rect_t mapped[8];
+    const int fb_w = Rotation::transpose ? TEST_HEIGHT : TEST_WIDTH;
+    const int fb_h = Rotation::transpose ? TEST_WIDTH : TEST_HEIGHT;
+    int shown = 1;
+    int armed = 0;
+
+    for (int frame = 0; frame < TEST_FRAMES; frame++) {
+        int dirty_num = render_frame(frame, dirty);
+        int next = shown ^ 1;
+        // The copy into the frame buffer about to be written must have landed
+        Sync::fence(test_fbs[next]);
+        for (int i = 0; i < dirty_num; i++) {
+            copy_rotated<Rotation, Parallel>(test_lvgl, test_fbs[next], dirty[i]);
+            mapped[i] = Rotation::map_rect(dirty[i], TEST_WIDTH, TEST_HEIGHT);
+        }
+        shown = next;
+        check_shown(test_fbs[shown], Rotation::degree);
+
+        if (Sync::arm(test_fbs[shown ^ 1], test_fbs[shown], mapped, dirty_num, fb_w, fb_h, sizeof(test_pixel_t))) {
+            // Started by the vsync
+            Sync::start();
+            armed++;
+        } else {
+            for (int i = 0; i < dirty_num; i++) {
+                copy_rotated<Rotation, Parallel>(test_lvgl, test_fbs[shown ^ 1], dirty[i]);
+            }
+        }
+    }
+
+    // Both frame buffers end up with the last frame
+    Sync::fence(test_fbs[shown ^ 1]);
+    check_shown(test_fbs[shown ^ 1], Rotation::degree);
+    TEST_ASSERT_EQUAL_INT(Sync::async ? TEST_FRAMES : 0, armed);
+}
+
+static void test_rotation_policies(void)
+{
+    // Every pixel of a rectangle mapped by `map_rect()` is where `rotate_copy()` writes it
+    TEST_ASSERT_TRUE(rotation_is_consistent<Rotate<0>>(TEST_WIDTH, TEST_HEIGHT));
+    TEST_ASSERT_TRUE(rotation_is_consistent<Rotate<90>>(TEST_WIDTH, TEST_HEIGHT));
+    TEST_ASSERT_TRUE(rotation_is_consistent<Rotate<180>>(TEST_WIDTH, TEST_HEIGHT));
+    TEST_ASSERT_TRUE(rotation_is_consistent<Rotate<270>>(TEST_WIDTH, TEST_HEIGHT));
+}
+
+static void test_strategy_full(void)
+{
+    run_full<Rotate<0>, false>();
+}
+
+static void test_strategy_full_rotated_90(void)
+{
+    run_full<Rotate<90>, false>();
+}
+
+static void test_strategy_full_rotated_180(void)
+{
+    run_full<Rotate<180>, false>();
+}
+
+static void test_strategy_full_rotated_270(void)
+{
+    run_full<Rotate<270>, false>();
+}
+
+static void test_strategy_full_rotated_parallel(void)
+{
+    run_full<Rotate<90>, true>();
+    run_full<Rotate<180>, true>();
+    run_full<Rotate<270>, true>();
+}
+
+static void test_strategy_direct_cpu(void)
+{
+    run_direct<Rotate<0>, SyncCpu, false>();
+}
+
+static void test_strategy_direct_async(void)
+{
+    run_direct<Rotate<0>, SyncAsync, false>();
+}
+
+static void test_strategy_direct_rotated_cpu(void)
+{
+    run_direct<Rotate<90>, SyncCpu, false>();
+    run_direct<Rotate<180>, SyncCpu, false>();
+    run_direct<Rotate<270>, SyncCpu, false>();
+}
+
+static void test_strategy_direct_rotated_async(void)
+{
+    run_direct<Rotate<90>, SyncAsync, false>();
+    run_direct<Rotate<180>, SyncAsync, false>();
+    run_direct<Rotate<270>, SyncAsync, false>();
+}
+
+static void test_strategy_direct_rotated_parallel(void)
+{
+    run_direct<Rotate<0>, SyncCpu, true>();
+    run_direct<Rotate<90>, SyncCpu, true>();
+    run_direct<Rotate<180>, SyncAsync, true>();
+    run_direct<Rotate<270>, SyncAsync, true>();
+
+    lvgl_port_jobs_stats_t stats;
+    lvgl_port_jobs_get_stats(&stats);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.runs);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rotation_policies);
+    RUN_TEST(test_strategy_full);
+    RUN_TEST(test_strategy_full_rotated_90);
+    RUN_TEST(test_strategy_full_rotated_180);
+    RUN_TEST(test_strategy_full_rotated_270);
+    RUN_TEST(test_strategy_full_rotated_parallel);
+    RUN_TEST(test_strategy_direct_cpu);
+    RUN_TEST(test_strategy_direct_async);
+    RUN_TEST(test_strategy_direct_rotated_cpu);
+    RUN_TEST(test_strategy_direct_rotated_async);
+    RUN_TEST(test_strategy_direct_rotated_parallel);
+    return UNITY_END();
+}
@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the rotation at scanout: `pio test -e native`
+ *
+ * The frames scanned out through `lvgl_port_rotate_fill()` must match the rotated copies of `lvgl_port_pipeline.hpp`
+ * that the rotation at scanout replaces.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+// The native environment ignores the library, the modules are built with the test
+#include "lvgl_port_rotate.cpp"
+#include "lvgl_port_scanout.cpp"
+#include "lvgl_port_pipeline.hpp"
+
+using namespace lvgl_port;
+
+#define TEST_SIZE_MAX           (64 * 48)
+
+static uint16_t test_fbs[2][TEST_SIZE_MAX];     // LVGL's frames, not rotated
+static uint16_t test_ref[TEST_SIZE_MAX];        // The same rotated by `rotate_copy()`
+static uint16_t test_out[TEST_SIZE_MAX];        // Scanned out frame
+
+void setUp(void)
+{
+    srand(1);
+    for (int i = 0; i < TEST_SIZE_MAX; i++) {
+        test_fbs[0][i] = (uint16_t)rand();
+        test_fbs[1][i] = (uint16_t)rand();
+    }
+}
+
+void tearDown(void)
+{
+    lvgl_port_scanout_set_fill(nullptr, nullptr);
+    lvgl_port_rotate_deinit();
+}
+
+/**
+ * @brief Rotate LVGL's frame of a panel with `rotate_copy()`
+ */
+template <class Rotation>
+static void reference(const uint16_t *fb, int width, int height)
+{
+    // LVGL's frame is transposed on the panel at 90/270 degrees
+    const int lvgl_w = Rotation::transpose ? height : width;
+    const int lvgl_h = Rotation::transpose ? width : height;
+    const lvgl_port_copy_rect_t full = {0, 0, (int16_t)(lvgl_w - 1), (int16_t)(lvgl_h - 1)};
+
+    rotate_copy<Rotation, uint16_t>(fb, test_ref, full, lvgl_w, lvgl_h);
+}
+
+/**
+ * @brief Scan out one frame through the refills of the scanout, `refill_px` pixels each so they cross the lines
+ */
+static void scan_frame(int width, int height, int refill_px)
+{
+    const int size = width * height;
+
+    memset(test_out, 0, sizeof(test_out));
+    for (int pos = 0; pos < size; pos += refill_px) {
+        int len = (pos + refill_px <= size) ? refill_px : (size - pos);
+        lvgl_port_scanout_refill(test_out + pos, pos, len * sizeof(uint16_t), 0);
+    }
+}
+
+template <class Rotation>
+static void check_rotation(int width, int height, int refill_px)
+{
+    TEST_ASSERT_TRUE(width * height <= TEST_SIZE_MAX);
+    TEST_ASSERT_TRUE(lvgl_port_scanout_init(width, height, sizeof(uint16_t)));
+    TEST_ASSERT_TRUE(lvgl_port_rotate_init(Rotation::degree, width, height));
+    lvgl_port_scanout_set_fill(lvgl_port_rotate_fill, nullptr);
+
+    // The frame buffer changes every frame, like with the double buffering of the port
+    for (int frame = 0; frame < 4; frame++) {
+        const uint16_t *fb = test_fbs[frame & 1];
+        lvgl_port_scanout_set_frame_buffer(fb);
+        // The end of the previous frame switches to it
+        lvgl_port_scanout_frame_end();
+        scan_frame(width, height, refill_px);
+        reference<Rotation>(fb, width, height);
+        TEST_ASSERT_EQUAL_MEMORY_MESSAGE(test_ref, test_out, width * height * sizeof(uint16_t), "Frame differs");
+    }
+    lvgl_port_scanout_set_fill(nullptr, nullptr);
+    lvgl_port_rotate_deinit();
+}
+
+template <class Rotation>
+static void check_sizes(void)
+{
+    // Whole lines, lines and a half, a few pixels, with even and odd widths and partial bands
+    check_rotation<Rotation>(64, 48, 64 * 10);
+    check_rotation<Rotation>(64, 48, 64 * 3 / 2 + 1);
+    check_rotation<Rotation>(63, 37, 63 * 4);
+    check_rotation<Rotation>(63, 37, 7);
+    check_rotation<Rotation>(17, 64, 17 * 16);
+}
+
+static void test_rotate_90(void)
+{
+    check_sizes<Rotate<90>>();
+}
+
+static void test_rotate_180(void)
+{
+    check_sizes<Rotate<180>>();
+}
+
+static void test_rotate_270(void)
+{
+    check_sizes<Rotate<270>>();
+}
+
+static void test_nothing_without_frame_buffer(void)
+{
+    uint16_t line[16];
+
+    TEST_ASSERT_TRUE(lvgl_port_rotate_init(90, 16, 16));
+    memset(line, 0x5A, sizeof(line));
+    lvgl_port_rotate_fill(line, nullptr, 0, 0, 16, nullptr);
+    for (int i = 0; i < 16; i++) {
+        TEST_ASSERT_EQUAL_HEX16(0x5A5A, line[i]);
+    }
+}
+
+static void test_invalid_arguments(void)
+{
+    TEST_ASSERT_FALSE(lvgl_port_rotate_init(0, 16, 16));
+    TEST_ASSERT_FALSE(lvgl_port_rotate_init(45, 16, 16));
+    TEST_ASSERT_FALSE(lvgl_port_rotate_init(90, 0, 16));
+    TEST_ASSERT_FALSE(lvgl_port_rotate_init(270, 16, 0));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rotate_90);
+    RUN_TEST(test_rotate_180);
+    RUN_TEST(test_rotate_270);
+    RUN_TEST(test_nothing_without_frame_buffer);
+    RUN_TEST(test_invalid_arguments);
+    return UNITY_END();
+}
@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the beam model of the scanout, through its simulation: `pio test -e native`
+ */
+#include <string.h>
+#include <unity.h>
+// The native environment ignores the library, the modules are built with the test
+#include "lvgl_port_scanout.cpp"
+#include "lvgl_port_scanout_sim.cpp"
+
+#define TEST_FRAMES             (300)
+
+static lvgl_port_scanout_sim_config_t test_config;
+
+void setUp(void)
+{
+    test_config = LVGL_PORT_SCANOUT_SIM_CONFIG_DEFAULT();
+    test_config.frames = TEST_FRAMES;
+}
+
+void tearDown(void)
+{
+}
+
+static void check_counts(const lvgl_port_scanout_sim_result_t *result)
+{
+    TEST_ASSERT_EQUAL_UINT32(test_config.frames, result->frames_rendered);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, result->frames_scanned);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, result->bands);
+    TEST_ASSERT_EQUAL_UINT32(result->bands, result->bands_ahead + result->bands_behind + result->bands_forced);
+}
+
+static void test_no_tears_at_defaults(void)
+{
+    lvgl_port_scanout_sim_result_t result;
+
+    TEST_ASSERT_TRUE(lvgl_port_scanout_sim_run(&test_config, &result));
+    check_counts(&result);
+    TEST_ASSERT_EQUAL_UINT32(0, result.tears);
+    TEST_ASSERT_EQUAL_UINT32(0, result.bands_forced);
+}
+
+static void test_no_tears_across_seeds(void)
+{
+    lvgl_port_scanout_sim_result_t result;
+
+    for (uint32_t seed = 2; seed < 10; seed++) {
+        test_config.seed = seed;
+        TEST_ASSERT_TRUE(lvgl_port_scanout_sim_run(&test_config, &result));
+        check_counts(&result);
+        TEST_ASSERT_EQUAL_UINT32(0, result.tears);
+    }
+}
+
+static void test_tears_beyond_margin(void)
+{
+    lvgl_port_scanout_sim_result_t result;
+
+    // A refill later than the margin reads lines the model already handed to the writer
+    test_config.refill_jitter_us = LVGL_PORT_SCANOUT_MARGIN_US * 10;
+    TEST_ASSERT_TRUE(lvgl_port_scanout_sim_run(&test_config, &result));
+    check_counts(&result);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, result.tears);
+}
+
+static void test_same_seed_same_run(void)
+{
+    lvgl_port_scanout_sim_result_t first;
+    lvgl_port_scanout_sim_result_t second;
+
+    TEST_ASSERT_TRUE(lvgl_port_scanout_sim_run(&test_config, &first));
+    TEST_ASSERT_TRUE(lvgl_port_scanout_sim_run(&test_config, &second));
+    TEST_ASSERT_EQUAL_MEMORY(&first, &second, sizeof(first));
+}
+
+static void test_invalid_config(void)
+{
+    lvgl_port_scanout_sim_result_t result;
+
+    TEST_ASSERT_FALSE(lvgl_port_scanout_sim_run(nullptr, &result));
+    TEST_ASSERT_FALSE(lvgl_port_scanout_sim_run(&test_config, nullptr));
+    test_config.bounce_lines = 0;
+    TEST_ASSERT_FALSE(lvgl_port_scanout_sim_run(&test_config, &result));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_no_tears_at_defaults);
+    RUN_TEST(test_no_tears_across_seeds);
+    RUN_TEST(test_tears_beyond_margin);
+    RUN_TEST(test_same_seed_same_run);
+    RUN_TEST(test_invalid_config);
+    return UNITY_END();
+}
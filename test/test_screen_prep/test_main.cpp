@@ -0,0 +1,226 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the preparation of a screen in the background, the worker is a thread on the host: `pio test -e native`
+ *
+ * The test plays the LVGL task: it waits for the wake of the worker, runs the slices of build steps, and counts the
+ * rendered frames for the time to interactive.
+ */
+#include <atomic>
+#include <thread>
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_screen_prep.cpp"
+
+#define TEST_PREPARE_US         (5000)
+#define TEST_DEADLINE_FAR_US    (1000000000LL)
+
+static std::atomic<int> test_wakes(0);              // Wakes of the LVGL task by the worker
+static std::atomic<bool> test_prepared(false);      // `prepare_cb` is over
+static std::thread::id test_prepare_thread;         // Thread `prepare_cb` ran on
+static int test_steps = 0;                          // Steps of the screen
+static int test_step_us = 0;                        // Length of each step
+static int test_next_step = 0;                      // Step expected next
+static int test_wrong_steps = 0;                    // Steps run out of order, or before `prepare_cb` was over
+static int test_ready_num = 0;
+static lvgl_port_screen_prep_stats_t test_ready_stats = {};
+static lvgl_port_screen_prep_t test_next_prep = {}; // Started by `ready_cb` if it has a `build_cb`
+
+static void test_wake_cb(void)
+{
+    test_wakes++;
+}
+
+static void test_prepare_cb(void *)
+{
+    test_prepare_thread = std::this_thread::get_id();
+    std::this_thread::sleep_for(std::chrono::microseconds(TEST_PREPARE_US));
+    test_prepared.store(true);
+}
+
+static bool test_build_cb(int step, void *user_data)
+{
+    if ((step != test_next_step) || ((user_data != nullptr) && !test_prepared.load())) {
+        test_wrong_steps++;
+    }
+    test_next_step = step + 1;
+    if (test_step_us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(test_step_us));
+    }
+
+    return (step + 1 < test_steps);
+}
+
+static void test_ready_cb(const lvgl_port_screen_prep_stats_t *stats, void *)
+{
+    test_ready_num++;
+    test_ready_stats = *stats;
+    if (test_next_prep.build_cb != nullptr) {
+        test_next_step = 0;
+        TEST_ASSERT_TRUE(lvgl_port_screen_prep_start(&test_next_prep));
+        test_next_prep = {};
+    }
+}
+
+static void test_wait_wakes(int num)
+{
+    while (test_wakes.load() < num) {
+        std::this_thread::yield();
+    }
+}
+
+void setUp(void)
+{
+    test_wakes.store(0);
+    test_prepared.store(false);
+    test_prepare_thread = std::thread::id();
+    test_steps = 5;
+    test_step_us = 0;
+    test_next_step = 0;
+    test_wrong_steps = 0;
+    test_ready_num = 0;
+    test_ready_stats = {};
+    test_next_prep = {};
+    TEST_ASSERT_TRUE(lvgl_port_screen_prep_init(-1, test_wake_cb));
+}
+
+void tearDown(void)
+{
+    lvgl_port_screen_prep_deinit();
+}
+
+static void test_prepare_then_build(void)
+{
+    // The user data tells the build steps to check that `prepare_cb` is over
+    lvgl_port_screen_prep_t prep = {test_prepare_cb, test_build_cb, test_ready_cb, (void *)&test_prepared};
+
+    TEST_ASSERT_TRUE(lvgl_port_screen_prep_start(&prep));
+    // One preparation at a time
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_start(&prep));
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_run(prep_time_us() + TEST_DEADLINE_FAR_US));
+
+    test_wait_wakes(1);
+    TEST_ASSERT_TRUE(test_prepared.load());
+    TEST_ASSERT_TRUE(test_prepare_thread != std::this_thread::get_id());
+    // Quick steps, all of them fit in one slice
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_run(prep_time_us() + TEST_DEADLINE_FAR_US));
+
+    TEST_ASSERT_EQUAL(0, test_wrong_steps);
+    TEST_ASSERT_EQUAL(5, test_next_step);
+    TEST_ASSERT_EQUAL(1, test_ready_num);
+    TEST_ASSERT_EQUAL(1, test_ready_stats.preps);
+    TEST_ASSERT_EQUAL(5, test_ready_stats.build_steps);
+    TEST_ASSERT_EQUAL(1, test_ready_stats.build_slices);
+    TEST_ASSERT_TRUE(test_ready_stats.prepare_us >= TEST_PREPARE_US);
+    TEST_ASSERT_TRUE(test_ready_stats.ready_us >= test_ready_stats.prepare_us + test_ready_stats.build_us);
+    TEST_ASSERT_EQUAL(0, test_ready_stats.tti_us);
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_run(prep_time_us() + TEST_DEADLINE_FAR_US));
+    TEST_ASSERT_EQUAL(1, test_ready_num);
+}
+
+static void test_build_slices(void)
+{
+    lvgl_port_screen_prep_t prep = {nullptr, test_build_cb, test_ready_cb, nullptr};
+    lvgl_port_screen_prep_stats_t stats;
+
+    // Without `prepare_cb`, the build steps can start at once
+    test_steps = 10;
+    test_step_us = 1000;
+    TEST_ASSERT_TRUE(lvgl_port_screen_prep_start(&prep));
+    TEST_ASSERT_EQUAL(1, test_wakes.load());
+
+    // A deadline already past still runs one step
+    TEST_ASSERT_TRUE(lvgl_port_screen_prep_run(prep_time_us()));
+    TEST_ASSERT_EQUAL(1, test_next_step);
+    // A far deadline is cut to the longest slice, steps of 1 ms at least fit 4 times in it at most
+    int runs = 0;
+    while (lvgl_port_screen_prep_run(prep_time_us() + TEST_DEADLINE_FAR_US)) {
+        runs++;
+    }
+
+    lvgl_port_screen_prep_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, test_wrong_steps);
+    TEST_ASSERT_EQUAL(1, test_ready_num);
+    TEST_ASSERT_EQUAL(10, stats.build_steps);
+    TEST_ASSERT_EQUAL(runs + 2, stats.build_slices);
+    TEST_ASSERT_TRUE(stats.build_slices >= 1 + 3);
+    TEST_ASSERT_TRUE(stats.slice_us_max >= 1000);
+    TEST_ASSERT_TRUE(stats.build_us >= 10 * 1000);
+}
+
+static void test_time_to_interactive(void)
+{
+    lvgl_port_screen_prep_t prep = {nullptr, test_build_cb, test_ready_cb, nullptr};
+    lvgl_port_screen_prep_stats_t stats;
+
+    // A frame rendered before `ready_cb` doesn't count
+    int64_t start_us = prep_time_us();
+    TEST_ASSERT_TRUE(lvgl_port_screen_prep_start(&prep));
+    lvgl_port_screen_prep_frame_rendered(start_us + 1000);
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_run(prep_time_us() + TEST_DEADLINE_FAR_US));
+    lvgl_port_screen_prep_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.tti_us);
+
+    // The first frame after it does, the next ones don't
+    int64_t frame_us = prep_time_us() + 20000;
+    lvgl_port_screen_prep_frame_rendered(frame_us);
+    lvgl_port_screen_prep_frame_rendered(frame_us + 20000);
+    lvgl_port_screen_prep_get_stats(&stats);
+    TEST_ASSERT_TRUE(stats.tti_us > stats.ready_us);
+    TEST_ASSERT_TRUE(stats.tti_us <= (uint32_t)(frame_us - start_us));
+    TEST_ASSERT_TRUE(stats.tti_us >= 20000);
+
+    // The next preparation starts its timings over, and keeps the count
+    TEST_ASSERT_TRUE(lvgl_port_screen_prep_start(&prep));
+    lvgl_port_screen_prep_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.preps);
+    TEST_ASSERT_EQUAL(0, stats.tti_us);
+    TEST_ASSERT_EQUAL(0, stats.build_steps);
+}
+
+static void test_ready_cb_starts_the_next(void)
+{
+    lvgl_port_screen_prep_t prep = {nullptr, test_build_cb, test_ready_cb, nullptr};
+
+    // Waiting for its time to interactive, the preparation can be replaced by the next one
+    test_next_prep = prep;
+    TEST_ASSERT_TRUE(lvgl_port_screen_prep_start(&prep));
+    TEST_ASSERT_TRUE(lvgl_port_screen_prep_run(prep_time_us() + TEST_DEADLINE_FAR_US));
+    TEST_ASSERT_EQUAL(1, test_ready_num);
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_run(prep_time_us() + TEST_DEADLINE_FAR_US));
+    TEST_ASSERT_EQUAL(2, test_ready_num);
+    TEST_ASSERT_EQUAL(2, test_ready_stats.preps);
+    TEST_ASSERT_EQUAL(0, test_wrong_steps);
+}
+
+static void test_invalid_arguments(void)
+{
+    lvgl_port_screen_prep_t prep = {test_prepare_cb, nullptr, test_ready_cb, nullptr};
+
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_init(-1, test_wake_cb));
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_start(nullptr));
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_start(&prep));
+
+    // Without the worker, nothing starts
+    prep.build_cb = test_build_cb;
+    TEST_ASSERT_TRUE(lvgl_port_screen_prep_deinit());
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_deinit());
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_start(&prep));
+    TEST_ASSERT_FALSE(lvgl_port_screen_prep_run(prep_time_us() + TEST_DEADLINE_FAR_US));
+    TEST_ASSERT_EQUAL(0, test_wakes.load());
+    TEST_ASSERT_EQUAL(0, test_ready_num);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_prepare_then_build);
+    RUN_TEST(test_build_slices);
+    RUN_TEST(test_time_to_interactive);
+    RUN_TEST(test_ready_cb_starts_the_next);
+    RUN_TEST(test_invalid_arguments);
+    return UNITY_END();
+}
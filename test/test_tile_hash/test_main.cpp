@@ -0,0 +1,177 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the tile-hash damage filter: `pio test -e native`
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+// The native environment ignores the library, the modules are built with the test
+#include "lvgl_port_damage.cpp"
+#include "lvgl_port_tile_hash.cpp"
+
+#define TEST_WIDTH              (200)   // Not a multiple of the tile size, the last column and row are partial
+#define TEST_HEIGHT             (120)
+#define TEST_BPP                (2)
+
+static uint16_t test_render[TEST_WIDTH * TEST_HEIGHT];  // Render buffer, holds the whole frame
+static uint16_t test_shown[TEST_WIDTH * TEST_HEIGHT];   // Frame buffer, only receives the changed areas
+
+void setUp(void)
+{
+    srand(1);
+    memset(test_render, 0, sizeof(test_render));
+    memset(test_shown, 0, sizeof(test_shown));
+    TEST_ASSERT_TRUE(lvgl_port_tile_hash_init(TEST_WIDTH, TEST_HEIGHT, TEST_BPP));
+}
+
+void tearDown(void)
+{
+    lvgl_port_tile_hash_deinit();
+}
+
+static void buf_fill_rect(uint16_t *buf, const lvgl_port_copy_rect_t *rect, uint16_t color)
+{
+    for (int y = rect->y1; y <= rect->y2; y++) {
+        for (int x = rect->x1; x <= rect->x2; x++) {
+            buf[y * TEST_WIDTH + x] = color;
+        }
+    }
+}
+
+static void buf_copy_rect(uint16_t *dst, const uint16_t *src, const lvgl_port_copy_rect_t *rect)
+{
+    for (int y = rect->y1; y <= rect->y2; y++) {
+        memcpy(&dst[y * TEST_WIDTH + rect->x1], &src[y * TEST_WIDTH + rect->x1], (rect->x2 - rect->x1 + 1) * 2);
+    }
+}
+
+static lvgl_port_copy_rect_t rect_random(int size_max)
+{
+    lvgl_port_copy_rect_t rect;
+
+    rect.x1 = rand() % TEST_WIDTH;
+    rect.y1 = rand() % TEST_HEIGHT;
+    rect.x2 = rect.x1 + rand() % size_max;
+    rect.y2 = rect.y1 + rand() % size_max;
+    rect.x2 = (rect.x2 < TEST_WIDTH) ? rect.x2 : (TEST_WIDTH - 1);
+    rect.y2 = (rect.y2 < TEST_HEIGHT) ? rect.y2 : (TEST_HEIGHT - 1);
+
+    return rect;
+}
+
+/**
+ * Filter a frame whose dirty areas have been drawn into the render buffer, and copy the changed areas into the shown
+ * frame, as the port does with the frame buffers
+ */
+static int present_filtered(const lvgl_port_copy_rect_t *dirty, int dirty_num)
+{
+    lvgl_port_copy_rect_t changed[LVGL_PORT_TILE_HASH_RECT_MAX];
+    int changed_num = lvgl_port_tile_hash_filter(test_render, dirty, dirty_num, changed);
+
+    for (int i = 0; i < changed_num; i++) {
+        buf_copy_rect(test_shown, test_render, &changed[i]);
+    }
+
+    return changed_num;
+}
+
+static void test_first_frame_not_shrunk(void)
+{
+    const lvgl_port_copy_rect_t full = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+
+    // Same content as the frame buffer, but the tiles are unknown yet
+    TEST_ASSERT_GREATER_THAN(0, present_filtered(&full, 1));
+
+    lvgl_port_tile_hash_stats_t stats;
+    lvgl_port_tile_hash_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.frames_unchanged);
+    TEST_ASSERT_TRUE(stats.skipped_bytes == 0);
+}
+
+static void test_redraw_unchanged(void)
+{
+    const lvgl_port_copy_rect_t full = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+    const lvgl_port_copy_rect_t rect = {10, 10, 90, 50};
+
+    present_filtered(&full, 1);
+    // Redrawn with the same pixels, nothing is left to present
+    buf_fill_rect(test_render, &rect, 0);
+    TEST_ASSERT_EQUAL_INT(0, present_filtered(&rect, 1));
+
+    lvgl_port_tile_hash_stats_t stats;
+    lvgl_port_tile_hash_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.frames_unchanged);
+    TEST_ASSERT_EQUAL_UINT32(stats.last_dirty_bytes, stats.last_skipped_bytes);
+
+    // After a reset, the same redraw is reported again
+    lvgl_port_tile_hash_reset();
+    TEST_ASSERT_GREATER_THAN(0, present_filtered(&rect, 1));
+}
+
+static void test_single_pixel(void)
+{
+    const lvgl_port_copy_rect_t full = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+    lvgl_port_copy_rect_t changed[LVGL_PORT_TILE_HASH_RECT_MAX];
+
+    present_filtered(&full, 1);
+    // One pixel of the last, partial tile changes in a dirty area spanning many tiles
+    test_render[(TEST_HEIGHT - 1) * TEST_WIDTH + TEST_WIDTH - 1] = 0x1234;
+    TEST_ASSERT_EQUAL_INT(1, lvgl_port_tile_hash_filter(test_render, &full, 1, changed));
+    TEST_ASSERT_TRUE(changed[0].x1 <= TEST_WIDTH - 1);
+    TEST_ASSERT_TRUE(changed[0].y1 <= TEST_HEIGHT - 1);
+    TEST_ASSERT_EQUAL_INT(TEST_WIDTH - 1, changed[0].x2);
+    TEST_ASSERT_EQUAL_INT(TEST_HEIGHT - 1, changed[0].y2);
+    // Within the tile of the pixel
+    TEST_ASSERT_TRUE((TEST_WIDTH - 1 - changed[0].x1) < LVGL_PORT_TILE_HASH_SIZE);
+    TEST_ASSERT_TRUE((TEST_HEIGHT - 1 - changed[0].y1) < LVGL_PORT_TILE_HASH_SIZE);
+}
+
+/**
+ * Random frames, some of their dirty areas redrawn with the pixels they already had: the frame buffer that only
+ * receives the changed areas must always match the render buffer
+ */
+static void test_frames_match_reference(void)
+{
+    const lvgl_port_copy_rect_t full = {0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1};
+    lvgl_port_copy_rect_t dirty[LVGL_PORT_TILE_HASH_RECT_MAX + 8];
+
+    present_filtered(&full, 1);
+    for (int frame = 0; frame < 300; frame++) {
+        int dirty_num = 1 + rand() % (LVGL_PORT_TILE_HASH_RECT_MAX + 8);
+        for (int i = 0; i < dirty_num; i++) {
+            dirty[i] = rect_random(60);
+            if ((rand() % 3) != 0) {
+                // A few pixels change, the rest of the area is redrawn as it was
+                for (int n = rand() % 4; n > 0; n--) {
+                    int x = dirty[i].x1 + rand() % (dirty[i].x2 - dirty[i].x1 + 1);
+                    int y = dirty[i].y1 + rand() % (dirty[i].y2 - dirty[i].y1 + 1);
+                    test_render[y * TEST_WIDTH + x] = (uint16_t)rand();
+                }
+            }
+        }
+        present_filtered(dirty, dirty_num);
+        TEST_ASSERT_EQUAL_MEMORY_MESSAGE(test_render, test_shown, sizeof(test_render), "Frame differs");
+    }
+
+    lvgl_port_tile_hash_stats_t stats;
+    lvgl_port_tile_hash_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(301, stats.frames);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.frames_unchanged);
+    TEST_ASSERT_TRUE(stats.skipped_bytes > 0);
+    TEST_ASSERT_TRUE(stats.skipped_bytes <= stats.dirty_bytes);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_frame_not_shrunk);
+    RUN_TEST(test_redraw_unchanged);
+    RUN_TEST(test_single_pixel);
+    RUN_TEST(test_frames_match_reference);
+    return UNITY_END();
+}
@@ -0,0 +1,196 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the budget of the LVGL timers within a frame: `pio test -e native`
+ *
+ * The timers are plain addresses and the times are given by the test, as the port would from the LVGL task.
+ */
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_timer_sched.cpp"
+
+#define TEST_FRAME_US           (16667)
+
+static int test_critical;                       // Addresses of the timers
+static int test_deferrable;
+static int64_t test_now_us = 1000000;
+
+/**
+ * @brief Run a rendered frame without timers, to set the estimated rest of the frame
+ */
+static void test_frame(uint32_t rest_us)
+{
+    lvgl_port_timer_sched_frame_begin(test_now_us, test_now_us + TEST_FRAME_US);
+    test_now_us += rest_us;
+    lvgl_port_timer_sched_frame_end(test_now_us, true);
+    test_now_us += TEST_FRAME_US;
+}
+
+void setUp(void)
+{
+    lvgl_port_timer_sched_reset();
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_register(&test_critical, LVGL_PORT_TIMER_CLASS_CRITICAL));
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_register(&test_deferrable, LVGL_PORT_TIMER_CLASS_DEFERRABLE));
+}
+
+void tearDown(void)
+{
+}
+
+static void test_cost_estimate(void)
+{
+    lvgl_port_timer_stats_t stats;
+    lvgl_port_timer_sched_stats_t sched_stats;
+
+    // The first run sets the average, with a deviation of half of it
+    lvgl_port_timer_sched_ran(&test_deferrable, 1000);
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_get_timer_stats(&test_deferrable, &stats));
+    TEST_ASSERT_EQUAL(1000 + 2 * 500, stats.cost_us_est);
+
+    // Then an eighth of the error moves the average, and a quarter of the change of the error moves the deviation
+    lvgl_port_timer_sched_ran(&test_deferrable, 1800);
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_get_timer_stats(&test_deferrable, &stats));
+    TEST_ASSERT_EQUAL(1100 + 2 * 575, stats.cost_us_est);
+    lvgl_port_timer_sched_ran(&test_deferrable, 200);
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_get_timer_stats(&test_deferrable, &stats));
+    TEST_ASSERT_EQUAL(988 + 2 * 656, stats.cost_us_est);
+    TEST_ASSERT_EQUAL(3, stats.runs);
+    TEST_ASSERT_EQUAL(200, stats.cost_us_last);
+    TEST_ASSERT_EQUAL(1000, stats.cost_us_avg);
+    TEST_ASSERT_EQUAL(1800, stats.cost_us_max);
+
+    // The rest of the frame leaves out the deferrable timers run in it
+    lvgl_port_timer_sched_frame_begin(test_now_us, test_now_us + TEST_FRAME_US);
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_should_run(&test_deferrable, test_now_us));
+    lvgl_port_timer_sched_ran(&test_deferrable, 3000);
+    lvgl_port_timer_sched_ran(&test_critical, 1000);
+    lvgl_port_timer_sched_frame_end(test_now_us + 7000, true);
+    // A frame that didn't render isn't counted
+    lvgl_port_timer_sched_frame_begin(test_now_us, test_now_us + TEST_FRAME_US);
+    lvgl_port_timer_sched_frame_end(test_now_us + 100, false);
+
+    lvgl_port_timer_sched_get_stats(&sched_stats);
+    TEST_ASSERT_EQUAL(1, sched_stats.frames);
+    TEST_ASSERT_EQUAL(0, sched_stats.late);
+    TEST_ASSERT_EQUAL(4000 + 2 * 2000, sched_stats.rest_us_est);
+}
+
+static void test_deferrable_runs_within_the_budget(void)
+{
+    lvgl_port_timer_stats_t stats;
+
+    // The timer is estimated at 2 ms, the rest of the frame at 8 ms
+    lvgl_port_timer_sched_ran(&test_deferrable, 1000);
+    test_frame(4000);
+
+    // Room for both before the deadline, with the margin
+    int64_t deadline_us = test_now_us + 2000 + 8000 + LVGL_PORT_TIMER_SCHED_MARGIN_US;
+    lvgl_port_timer_sched_frame_begin(test_now_us, deadline_us);
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_should_run(&test_deferrable, test_now_us));
+    lvgl_port_timer_sched_frame_end(test_now_us + 10000, false);
+    test_now_us += TEST_FRAME_US;
+
+    // One microsecond short, the timer waits for the next frame, the critical one runs anyway
+    lvgl_port_timer_sched_frame_begin(test_now_us, test_now_us + 2000 + 8000 + LVGL_PORT_TIMER_SCHED_MARGIN_US - 1);
+    TEST_ASSERT_FALSE(lvgl_port_timer_sched_should_run(&test_deferrable, test_now_us));
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_should_run(&test_critical, test_now_us));
+    // Later in the frame, the part of the rest already done isn't counted again
+    TEST_ASSERT_FALSE(lvgl_port_timer_sched_should_run(&test_deferrable, test_now_us + 1000));
+    lvgl_port_timer_sched_frame_end(test_now_us + 20000, true);
+
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_get_timer_stats(&test_deferrable, &stats));
+    TEST_ASSERT_EQUAL(2, stats.deferrals);
+    TEST_ASSERT_EQUAL(2, stats.deferred_max);
+    TEST_ASSERT_EQUAL(0, stats.forced);
+    lvgl_port_timer_sched_stats_t sched_stats;
+    lvgl_port_timer_sched_get_stats(&sched_stats);
+    TEST_ASSERT_EQUAL(1, sched_stats.late);
+}
+
+static void test_deferrals_are_bounded(void)
+{
+    lvgl_port_timer_stats_t stats;
+    lvgl_port_timer_sched_stats_t sched_stats;
+
+    lvgl_port_timer_sched_ran(&test_deferrable, 1000);
+    // No budget at all: postponed `LVGL_PORT_TIMER_SCHED_DEFER_MAX` frames in a row, then forced, twice
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i <= LVGL_PORT_TIMER_SCHED_DEFER_MAX; i++) {
+            lvgl_port_timer_sched_frame_begin(test_now_us, test_now_us);
+            TEST_ASSERT_EQUAL(i == LVGL_PORT_TIMER_SCHED_DEFER_MAX,
+                              lvgl_port_timer_sched_should_run(&test_deferrable, test_now_us));
+            if (i == LVGL_PORT_TIMER_SCHED_DEFER_MAX) {
+                lvgl_port_timer_sched_ran(&test_deferrable, 1000);
+            }
+            lvgl_port_timer_sched_frame_end(test_now_us + 1000, false);
+            test_now_us += TEST_FRAME_US;
+        }
+    }
+
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_get_timer_stats(&test_deferrable, &stats));
+    TEST_ASSERT_EQUAL(3, stats.runs);
+    TEST_ASSERT_EQUAL(2 * LVGL_PORT_TIMER_SCHED_DEFER_MAX, stats.deferrals);
+    TEST_ASSERT_EQUAL(2, stats.forced);
+    TEST_ASSERT_EQUAL(LVGL_PORT_TIMER_SCHED_DEFER_MAX, stats.deferred_max);
+    lvgl_port_timer_sched_get_stats(&sched_stats);
+    TEST_ASSERT_EQUAL(2 * LVGL_PORT_TIMER_SCHED_DEFER_MAX, sched_stats.deferrals);
+    TEST_ASSERT_EQUAL(2, sched_stats.forced);
+    TEST_ASSERT_EQUAL(0, sched_stats.frames);
+}
+
+static void test_runs_outside_of_the_budget(void)
+{
+    int other;
+
+    // A timer that never ran, outside of a frame, or not registered, always runs
+    lvgl_port_timer_sched_frame_begin(test_now_us, test_now_us + 1000);
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_should_run(&test_deferrable, test_now_us));
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_should_run(&other, test_now_us));
+    lvgl_port_timer_sched_frame_end(test_now_us, false);
+    lvgl_port_timer_sched_ran(&test_deferrable, 100000);
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_should_run(&test_deferrable, test_now_us));
+
+    lvgl_port_timer_stats_t stats;
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_get_timer_stats(&test_deferrable, &stats));
+    TEST_ASSERT_EQUAL(0, stats.deferrals);
+}
+
+static void test_registration(void)
+{
+    int timers[LVGL_PORT_TIMER_SCHED_MAX];
+    lvgl_port_timer_stats_t stats;
+
+    TEST_ASSERT_FALSE(lvgl_port_timer_sched_register(nullptr, LVGL_PORT_TIMER_CLASS_CRITICAL));
+    TEST_ASSERT_FALSE(lvgl_port_timer_sched_register(&test_critical, LVGL_PORT_TIMER_CLASS_DEFERRABLE));
+    // Two entries are taken by the setup
+    for (int i = 0; i < LVGL_PORT_TIMER_SCHED_MAX - 2; i++) {
+        TEST_ASSERT_TRUE(lvgl_port_timer_sched_register(&timers[i], LVGL_PORT_TIMER_CLASS_DEFERRABLE));
+    }
+    TEST_ASSERT_FALSE(lvgl_port_timer_sched_register(&timers[LVGL_PORT_TIMER_SCHED_MAX - 2],
+                                                     LVGL_PORT_TIMER_CLASS_DEFERRABLE));
+
+    // An unregistered timer frees its entry and forgets its statistics
+    lvgl_port_timer_sched_ran(&test_critical, 1000);
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_unregister(&test_critical));
+    TEST_ASSERT_FALSE(lvgl_port_timer_sched_unregister(&test_critical));
+    TEST_ASSERT_FALSE(lvgl_port_timer_sched_get_timer_stats(&test_critical, &stats));
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_register(&test_critical, LVGL_PORT_TIMER_CLASS_CRITICAL));
+    TEST_ASSERT_TRUE(lvgl_port_timer_sched_get_timer_stats(&test_critical, &stats));
+    TEST_ASSERT_EQUAL(0, stats.runs);
+    TEST_ASSERT_EQUAL(LVGL_PORT_TIMER_CLASS_CRITICAL, stats.timer_class);
+    TEST_ASSERT_FALSE(lvgl_port_timer_sched_get_timer_stats(&test_critical, nullptr));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_cost_estimate);
+    RUN_TEST(test_deferrable_runs_within_the_budget);
+    RUN_TEST(test_deferrals_are_bounded);
+    RUN_TEST(test_runs_outside_of_the_budget);
+    RUN_TEST(test_registration);
+    return UNITY_END();
+}
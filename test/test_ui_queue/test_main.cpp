@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/**
+ * Host tests of the UI command queue and the handles of its targets: `pio test -e native`
+ */
+#include <string.h>
+#include <unity.h>
+// The native environment ignores the library, the module is built with the test
+#include "lvgl_port_ui_queue.cpp"
+
+static int test_objects[LVGL_PORT_UI_QUEUE_HANDLE_MAX + 1];    // Targets, only their addresses are used
+static lvgl_port_ui_cmd_t test_applied[LVGL_PORT_UI_QUEUE_SIZE];
+static int test_applied_num = 0;
+
+static void apply(const lvgl_port_ui_cmd_t *cmd, void *)
+{
+    // Like the port, a command whose target is gone is dropped
+    if (lvgl_port_ui_queue_resolve(cmd->target) != nullptr) {
+        test_applied[test_applied_num++] = *cmd;
+    }
+}
+
+static bool push_value(lvgl_port_ui_handle_t handle, int32_t value)
+{
+    lvgl_port_ui_cmd_t cmd = {};
+    cmd.type = LVGL_PORT_UI_CMD_SET_VALUE;
+    cmd.target = handle;
+    cmd.value = value;
+
+    return lvgl_port_ui_queue_push(&cmd);
+}
+
+void setUp(void)
+{
+    test_applied_num = 0;
+}
+
+void tearDown(void)
+{
+    // The table and the ring are static, leave them empty for the next test
+    lvgl_port_ui_queue_drain(nullptr, nullptr);
+    for (int i = 0; i < LVGL_PORT_UI_QUEUE_HANDLE_MAX; i++) {
+        lvgl_port_ui_queue_unregister(ui_queue_handle(i));
+    }
+}
+
+static void test_handles_resolve(void)
+{
+    lvgl_port_ui_handle_t first = lvgl_port_ui_queue_register(&test_objects[0]);
+    lvgl_port_ui_handle_t second = lvgl_port_ui_queue_register(&test_objects[1]);
+
+    TEST_ASSERT_NOT_EQUAL(LVGL_PORT_UI_HANDLE_INVALID, first);
+    TEST_ASSERT_NOT_EQUAL(first, second);
+    TEST_ASSERT_EQUAL_PTR(&test_objects[0], lvgl_port_ui_queue_resolve(first));
+    TEST_ASSERT_EQUAL_PTR(&test_objects[1], lvgl_port_ui_queue_resolve(second));
+    TEST_ASSERT_NULL(lvgl_port_ui_queue_resolve(LVGL_PORT_UI_HANDLE_INVALID));
+    TEST_ASSERT_EQUAL(LVGL_PORT_UI_HANDLE_INVALID, lvgl_port_ui_queue_register(nullptr));
+}
+
+static void test_reused_entry_is_a_new_handle(void)
+{
+    lvgl_port_ui_handle_t old_handle = lvgl_port_ui_queue_register(&test_objects[0]);
+
+    // A new object at the address of a deleted one must not take the commands of the old one
+    lvgl_port_ui_queue_unregister(old_handle);
+    TEST_ASSERT_NULL(lvgl_port_ui_queue_resolve(old_handle));
+    lvgl_port_ui_handle_t new_handle = lvgl_port_ui_queue_register(&test_objects[0]);
+    TEST_ASSERT_NOT_EQUAL(old_handle, new_handle);
+    TEST_ASSERT_NULL(lvgl_port_ui_queue_resolve(old_handle));
+    TEST_ASSERT_EQUAL_PTR(&test_objects[0], lvgl_port_ui_queue_resolve(new_handle));
+
+    // Unregistering a stale handle leaves the new one alone
+    lvgl_port_ui_queue_unregister(old_handle);
+    TEST_ASSERT_EQUAL_PTR(&test_objects[0], lvgl_port_ui_queue_resolve(new_handle));
+}
+
+static void test_commands_of_deleted_targets_are_dropped(void)
+{
+    lvgl_port_ui_handle_t kept = lvgl_port_ui_queue_register(&test_objects[0]);
+    lvgl_port_ui_handle_t deleted = lvgl_port_ui_queue_register(&test_objects[1]);
+
+    TEST_ASSERT_TRUE(push_value(kept, 1));
+    TEST_ASSERT_TRUE(push_value(deleted, 2));
+    lvgl_port_ui_queue_unregister(deleted);
+    lvgl_port_ui_handle_t reused = lvgl_port_ui_queue_register(&test_objects[1]);
+    TEST_ASSERT_TRUE(push_value(reused, 3));
+
+    TEST_ASSERT_EQUAL_INT(3, lvgl_port_ui_queue_drain(apply, nullptr));
+    TEST_ASSERT_EQUAL_INT(2, test_applied_num);
+    TEST_ASSERT_EQUAL(kept, test_applied[0].target);
+    TEST_ASSERT_EQUAL_INT32(1, test_applied[0].value);
+    TEST_ASSERT_EQUAL(reused, test_applied[1].target);
+    TEST_ASSERT_EQUAL_INT32(3, test_applied[1].value);
+}
+
+static void test_coalesced_by_handle(void)
+{
+    lvgl_port_ui_handle_t first = lvgl_port_ui_queue_register(&test_objects[0]);
+    lvgl_port_ui_handle_t second = lvgl_port_ui_queue_register(&test_objects[1]);
+
+    for (int32_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(push_value(first, i));
+        TEST_ASSERT_TRUE(push_value(second, 10 + i));
+    }
+    TEST_ASSERT_EQUAL_INT(10, lvgl_port_ui_queue_drain(apply, nullptr));
+    TEST_ASSERT_EQUAL_INT(2, test_applied_num);
+    TEST_ASSERT_EQUAL_INT32(4, test_applied[0].value);
+    TEST_ASSERT_EQUAL_INT32(14, test_applied[1].value);
+}
+
+static void test_table_full(void)
+{
+    for (int i = 0; i < LVGL_PORT_UI_QUEUE_HANDLE_MAX; i++) {
+        TEST_ASSERT_NOT_EQUAL(LVGL_PORT_UI_HANDLE_INVALID, lvgl_port_ui_queue_register(&test_objects[i]));
+    }
+    TEST_ASSERT_EQUAL(
+        LVGL_PORT_UI_HANDLE_INVALID, lvgl_port_ui_queue_register(&test_objects[LVGL_PORT_UI_QUEUE_HANDLE_MAX])
+    );
+}
+
+static void test_ring_full(void)
+{
+    lvgl_port_ui_handle_t handle = lvgl_port_ui_queue_register(&test_objects[0]);
+
+    for (int i = 0; i < LVGL_PORT_UI_QUEUE_SIZE; i++) {
+        TEST_ASSERT_TRUE(push_value(handle, i));
+    }
+    TEST_ASSERT_FALSE(push_value(handle, LVGL_PORT_UI_QUEUE_SIZE));
+    TEST_ASSERT_FALSE(push_value(LVGL_PORT_UI_HANDLE_INVALID, 0));
+    TEST_ASSERT_EQUAL_INT(LVGL_PORT_UI_QUEUE_SIZE, lvgl_port_ui_queue_drain(apply, nullptr));
+    TEST_ASSERT_EQUAL_INT(1, test_applied_num);
+    TEST_ASSERT_EQUAL_INT32(LVGL_PORT_UI_QUEUE_SIZE - 1, test_applied[0].value);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_handles_resolve);
+    RUN_TEST(test_reused_entry_is_a_new_handle);
+    RUN_TEST(test_commands_of_deleted_targets_are_dropped);
+    RUN_TEST(test_coalesced_by_handle);
+    RUN_TEST(test_table_full);
+    RUN_TEST(test_ring_full);
+    return UNITY_END();
+}